@@ -0,0 +1,321 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the class stCachedPageManager.
+*
+* @version 1.0
+*/
+#ifndef __STCACHEDPAGEMANAGER_H
+#define __STCACHEDPAGEMANAGER_H
+
+#include <stdexcept>
+
+#include <arboretum/stPageManager.h>
+#include <arboretum/stPage.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//==============================================================================
+// stCachedPageManager
+//------------------------------------------------------------------------------
+/**
+* This class is a page cache which may be placed in front of any page manager.
+* It keeps the most recently used pages in memory, up to a given number of
+* bytes.
+*
+* <p>The cache is split in shards by page ID. Each shard has its own lock and
+* its own LRU list, so many threads may call GetPage() and ReleasePage() at
+* once if the page manager below allows concurrent reads. The methods that
+* change pages must not run concurrently with any other method.
+*
+* <p>GetPage() returns the cached instance of the page itself and pins it. A
+* pinned page is never evicted, so it stays valid until ReleasePage(). Since
+* the same instance is returned to all callers, a page must not be changed
+* while other threads use it, and every change must be written with
+* WritePage(). WritePage() only marks the page as dirty; dirty pages are
+* written to the page manager below when they are evicted or by Flush().
+*
+* <p>The read and write counters of this class count the pages requested by
+* the tree (as stPlainDiskPageManager does), so GetReadCount() does not change
+* when the cache is added. GetHitCount() and GetMissCount() tell how many of
+* these reads were served by the cache. The counters of the page manager below
+* count the true reads and writes.
+*
+* <p>The header page is not cached. The page manager below must copy the
+* data of the pages given to WritePage(), as the disk page managers do (a
+* stMemoryPageManager does not need a cache anyway).
+*
+* @version 1.0
+* @see stPageManager
+* @ingroup storage
+*/
+class stCachedPageManager: public stPageManager{
+   public:
+      /**
+      * Creates a new cache.
+      *
+      * @param pageManager The page manager below this cache. It is not owned
+      * by this cache and must outlive it.
+      * @param cacheSize The maximum size of the cached pages in bytes. At
+      * least one page per shard is kept.
+      * @param nShards The number of shards. Default 16.
+      */
+      stCachedPageManager(stPageManager * pageManager, size_t cacheSize,
+                          u_int32_t nShards = 16);
+
+      /**
+      * Writes the dirty pages and disposes this cache. The page manager below
+      * is not disposed.
+      */
+      virtual ~stCachedPageManager();
+
+      /**
+      * Returns the page manager below this cache.
+      */
+      stPageManager * GetPageManager(){
+         return pageManager;
+      }//end GetPageManager
+
+      /**
+      * This method will checks if this page manager is empty.
+      *
+      * @return True if the page manager is empty or false otherwise.
+      */
+      virtual bool IsEmpty(){
+         return pageManager->IsEmpty();
+      }//end IsEmpty
+
+      /**
+      * Returns the header page of the page manager below.
+      *
+      * @return The header page.
+      */
+      virtual stPage * GetHeaderPage();
+
+      /**
+      * Writes the header page to the page manager below.
+      *
+      * @param headerpage The header page.
+      */
+      virtual void WriteHeaderPage(stPage * headerpage);
+
+      /**
+      * Returns the page with the given page ID. It is read from the page
+      * manager below if it is not in the cache. The page is pinned until
+      * ReleasePage() is called.
+      *
+      * @param pageid The desired page id.
+      * @return The page or NULL for an invalid page ID.
+      * @see ReleasePage()
+      */
+      virtual stPage * GetPage(u_int32_t pageid);
+
+      /**
+      * Unpins the given page.
+      *
+      * @param page The page.
+      * @see GetPage()
+      */
+      virtual void ReleasePage(stPage * page);
+
+      /**
+      * Allocates a new page in the page manager below and caches it.
+      *
+      * @return A new page or NULL for errors.
+      */
+      virtual stPage * GetNewPage();
+
+      /**
+      * Marks the given page as dirty. It is written to the page manager below
+      * when evicted or by Flush().
+      *
+      * @param page The page to be written.
+      */
+      virtual void WritePage(stPage * page);
+
+      /**
+      * Removes the given page from the cache and disposes it in the page
+      * manager below.
+      *
+      * @param page The page to be disposed.
+      */
+      virtual void DisposePage(stPage * page);
+
+      /**
+      * Writes all dirty pages and flushes the page manager below.
+      */
+      virtual void Flush();
+
+      /**
+      * Restarts the statistics of this cache (but not those of the page
+      * manager below).
+      */
+      virtual void ResetStatistics(){
+         stPageManager::ResetStatistics();
+         HitCount = 0;
+         MissCount = 0;
+      }//end ResetStatistics
+
+      /**
+      * Returns the number of GetPage() calls served by the cache since the
+      * last call of ResetStatistics().
+      */
+      long int GetHitCount(){
+         return HitCount;
+      }//end GetHitCount
+
+      /**
+      * Returns the number of GetPage() calls which read the page manager
+      * below since the last call of ResetStatistics().
+      */
+      long int GetMissCount(){
+         return MissCount;
+      }//end GetMissCount
+
+      /**
+      * Returns the number of cached pages.
+      */
+      u_int32_t GetCachedPageCount();
+
+      /**
+      * Returns the minimum size of a page.
+      */
+      virtual u_int32_t GetMinimumPageSize(){
+         return pageManager->GetMinimumPageSize();
+      }//end GetMinimumPageSize
+
+      /**
+      * Returns the number of pages.
+      */
+      virtual u_int32_t GetPageCount(){
+         return pageManager->GetPageCount();
+      }//end GetPageCount
+
+   private:
+      /**
+      * A cached page.
+      */
+      struct tFrame{
+         /**
+         * The page.
+         */
+         stPage * Page;
+
+         /**
+         * Number of users of this page. It is not evicted while pinned.
+         */
+         u_int32_t Pins;
+
+         /**
+         * If true, the page must be written before eviction.
+         */
+         bool Dirty;
+
+         /**
+         * Position of this frame in the LRU list of its shard.
+         */
+         std::list <tFrame *>::iterator Position;
+      };//end tFrame
+
+      /**
+      * A shard of the cache.
+      */
+      struct tShard{
+         /**
+         * Guards this shard.
+         */
+         std::mutex Mutex;
+
+         /**
+         * The frames of this shard by page ID.
+         */
+         std::unordered_map <u_int32_t, tFrame *> Frames;
+
+         /**
+         * The frames of this shard. The most recently used is the first.
+         */
+         std::list <tFrame *> LRU;
+      };//end tShard
+
+      /**
+      * The page manager below this cache.
+      */
+      stPageManager * pageManager;
+
+      /**
+      * The shards.
+      */
+      std::vector <tShard *> shards;
+
+      /**
+      * Maximum number of frames of each shard.
+      */
+      u_int32_t shardCapacity;
+
+      /**
+      * Number of hits.
+      */
+      std::atomic<long int> HitCount;
+
+      /**
+      * Number of misses.
+      */
+      std::atomic<long int> MissCount;
+
+      /**
+      * Returns the shard of a page.
+      */
+      tShard * GetShard(u_int32_t pageid){
+         return shards[pageid % shards.size()];
+      }//end GetShard
+
+      /**
+      * Adds a pinned frame with a copy of the given page to a shard and evicts
+      * the least recently used frames if it is full. If the page is already
+      * there, the existing frame is pinned instead. The shard must be locked.
+      *
+      * @param shard The shard.
+      * @param page The page.
+      * @return The frame.
+      */
+      tFrame * AddFrame(tShard * shard, stPage * page);
+
+      /**
+      * Evicts unpinned frames, from the least recently used, until the shard
+      * is not over its capacity. The shard must be locked.
+      *
+      * @param shard The shard.
+      */
+      void Evict(tShard * shard);
+
+      /**
+      * Writes a frame to the page manager below if it is dirty.
+      *
+      * @param frame The frame.
+      */
+      void WriteFrame(tFrame * frame);
+
+      // Copies are not allowed.
+      stCachedPageManager(const stCachedPageManager &);
+      stCachedPageManager & operator = (const stCachedPageManager &);
+};//end stCachedPageManager
+
+#endif //__STCACHEDPAGEMANAGER_H
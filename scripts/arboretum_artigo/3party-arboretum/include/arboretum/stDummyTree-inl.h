@@ -136,7 +136,8 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::RangeQuery(
    stPage * currPage;
    stDummyNode * currNode;
    tResult * result;
-   tObject tmp;
+   std::vector <tObject *> objects;
+   std::vector <double> distances;
    double distance;
    u_int32_t i;
    u_int32_t nextPageID;
@@ -154,18 +155,17 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::RangeQuery(
       currPage = this->myPageManager->GetPage(nextPageID);
       currNode = new stDummyNode(currPage);
 
+      // Rebuild the objects of this node and evaluate their distances
+      EvaluateNode(currNode, sample, range, objects, distances);
+
       // Lets check all objects in this node
       for (i = 0; i < currNode->GetNumberOfEntries(); i++){
-         // Rebuild the object
-         tmp.Unserialize(currNode->GetObject(i), currNode->GetObjectSize(i));
-
-         // Evaluate distance
-         distance = this->myMetricEvaluator->GetDistance(tmp, *sample);
+         distance = distances[i];
 
          // Is it qualified ?
          if (distance <= range){
             // Yes! I'm qualified !
-            result->AddPair(tmp.Clone(), distance);
+            result->AddPair(objects[i]->Clone(), distance);
          }//end if
       }//end for
 
@@ -177,6 +177,11 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::RangeQuery(
       this->myPageManager->ReleasePage(currPage);
    }//end while
 
+   // Free the objects of the nodes.
+   for (i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+
    // Return the result.
    return result;
 }//end stDummyTree<ObjectType><EvaluatorType>::RangeQuery
@@ -188,7 +193,8 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::ReversedRangeQuer
    stPage * currPage;
    stDummyNode * currNode;
    tResult * result;
-   tObject tmp;
+   std::vector <tObject *> objects;
+   std::vector <double> distances;
    double distance;
    u_int32_t i;
    u_int32_t nextPageID;
@@ -206,18 +212,17 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::ReversedRangeQuer
       currPage = this->myPageManager->GetPage(nextPageID);
       currNode = new stDummyNode(currPage);
 
+      // Rebuild the objects of this node and evaluate their distances
+      EvaluateNode(currNode, sample, MAXDOUBLE, objects, distances);
+
       // Lets check all objects in this node
       for (i = 0; i < currNode->GetNumberOfEntries(); i++){
-         // Rebuild the object
-         tmp.Unserialize(currNode->GetObject(i), currNode->GetObjectSize(i));
-
-         // Evaluate distance
-         distance = this->myMetricEvaluator->GetDistance(tmp, *sample);
+         distance = distances[i];
 
          // Is it qualified ?
          if (distance >= range){
             // Yes! I'm qualified !
-            result->AddPair(tmp.Clone(), distance);
+            result->AddPair(objects[i]->Clone(), distance);
          }//end if
       }//end for
 
@@ -229,6 +234,11 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::ReversedRangeQuer
       this->myPageManager->ReleasePage(currPage);
    }//end while
 
+   // Free the objects of the nodes.
+   for (i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+
    // Return the result.
    return result;
 }//end stDummyTree<ObjectType><EvaluatorType>::ReversedRangeQuery
@@ -240,7 +250,8 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::NearestQuery(
    stPage * currPage;
    stDummyNode * currNode;
    tResult * result;
-   tObject tmp;
+   std::vector <tObject *> objects;
+   std::vector <double> distances;
    double distance;
    u_int32_t i;
    u_int32_t nextPageID;
@@ -258,23 +269,23 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::NearestQuery(
       currPage = this->myPageManager->GetPage(nextPageID);
       currNode = new stDummyNode(currPage);
 
+      // Rebuild the objects of this node and evaluate their distances
+      EvaluateNode(currNode, sample, (result->GetNumOfEntries() < k) ?
+            MAXDOUBLE : result->GetMaximumDistance(), objects, distances);
+
       // Lets check all objects in this node
       for (i = 0; i < currNode->GetNumberOfEntries(); i++){
-         // Rebuild the object
-         tmp.Unserialize(currNode->GetObject(i), currNode->GetObjectSize(i));
-
-         // Evaluate distance
-         distance = this->myMetricEvaluator->GetDistance(tmp, *sample);
+         distance = distances[i];
 
          // Is it qualified ?
          if (result->GetNumOfEntries() < k){
             // Unnecessary to check. Just add.
-            result->AddPair(tmp.Clone(), distance);
+            result->AddPair(objects[i]->Clone(), distance);
          }else{
             // Will I add ?
             if (distance <= result->GetMaximumDistance()){
                // Yes! I'll.
-               result->AddPair(tmp.Clone(), distance);
+               result->AddPair(objects[i]->Clone(), distance);
                result->Cut(k);
             }//end if
          }//end if
@@ -288,6 +299,11 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::NearestQuery(
       this->myPageManager->ReleasePage(currPage);
    }//end while
 
+   // Free the objects of the nodes.
+   for (i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+
    // Return the result.
    return result;
 }//end NearestQuery
@@ -299,7 +315,8 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::FarthestQuery(
    stPage * currPage;
    stDummyNode * currNode;
    tResult * result;
-   tObject tmp;
+   std::vector <tObject *> objects;
+   std::vector <double> distances;
    double distance;
    u_int32_t i;
    u_int32_t nextPageID;
@@ -317,23 +334,22 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::FarthestQuery(
       currPage = this->myPageManager->GetPage(nextPageID);
       currNode = new stDummyNode(currPage);
 
+      // Rebuild the objects of this node and evaluate their distances
+      EvaluateNode(currNode, sample, MAXDOUBLE, objects, distances);
+
       // Lets check all objects in this node
       for (i = 0; i < currNode->GetNumberOfEntries(); i++){
-         // Rebuild the object
-         tmp.Unserialize(currNode->GetObject(i), currNode->GetObjectSize(i));
-
-         // Evaluate distance
-         distance = this->myMetricEvaluator->GetDistance(tmp, *sample);
+         distance = distances[i];
 
          // Is it qualified ?
          if (result->GetNumOfEntries() < k){
             // Unnecessary to check. Just add.
-            result->AddPair(tmp.Clone(), distance);
+            result->AddPair(objects[i]->Clone(), distance);
          }else{
             // Will I add ?
             if (distance >= result->GetMinimumDistance()){
                // Yes! I'll.
-               result->AddPair(tmp.Clone(), distance);
+               result->AddPair(objects[i]->Clone(), distance);
                result->CutFirst(k);
             }//end if
          }//end if
@@ -347,6 +363,11 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::FarthestQuery(
       this->myPageManager->ReleasePage(currPage);
    }//end while
 
+   // Free the objects of the nodes.
+   for (i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+
    // Return the result.
    return result;
 }//end FarthestQuery
@@ -358,7 +379,8 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::KAndRangeQuery(
    stPage * currPage;
    stDummyNode * currNode;
    tResult * result;
-   tObject tmp;
+   std::vector <tObject *> objects;
+   std::vector <double> distances;
    double distance;
    u_int32_t i;
    u_int32_t nextPageID;
@@ -376,25 +398,24 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::KAndRangeQuery(
       currPage = this->myPageManager->GetPage(nextPageID);
       currNode = new stDummyNode(currPage);
 
+      // Rebuild the objects of this node and evaluate their distances
+      EvaluateNode(currNode, sample, range, objects, distances);
+
       // Lets check all objects in this node
       for (i = 0; i < currNode->GetNumberOfEntries(); i++){
-         // Rebuild the object
-         tmp.Unserialize(currNode->GetObject(i), currNode->GetObjectSize(i));
-
-         // Evaluate distance
-         distance = this->myMetricEvaluator->GetDistance(tmp, *sample);
+         distance = distances[i];
 
          // Is it qualified ?
          if (distance <= range){
             // Yes! I'm qualified !
             if (result->GetNumOfEntries() < k){
                // Has less than k.
-               result->AddPair(tmp.Clone(), distance);
+               result->AddPair(objects[i]->Clone(), distance);
             }else{
                // May I add ?
                if (distance <= result->GetMaximumDistance()){
                   // Yes! I'll add it and cut the results if necessary
-                  result->AddPair(tmp.Clone(), distance);
+                  result->AddPair(objects[i]->Clone(), distance);
                   result->Cut(k);
                }//end if
             }//end if
@@ -409,6 +430,11 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::KAndRangeQuery(
       this->myPageManager->ReleasePage(currPage);
    }//end while
 
+   // Free the objects of the nodes.
+   for (i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+
    // Return the result.
    return result;
 }//end KAndRangeQuery
@@ -420,7 +446,8 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::KOrRangeQuery(
    stPage * currPage;
    stDummyNode * currNode;
    tResult * result;
-   tObject tmp;
+   std::vector <tObject *> objects;
+   std::vector <double> distances;
    double distance, dk=MAXDOUBLE;
    u_int32_t i;
    u_int32_t nextPageID;
@@ -438,18 +465,17 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::KOrRangeQuery(
       currPage = this->myPageManager->GetPage(nextPageID);
       currNode = new stDummyNode(currPage);
 
+      // Rebuild the objects of this node and evaluate their distances
+      EvaluateNode(currNode, sample, dk, objects, distances);
+
       // Lets check all objects in this node
       for (i = 0; i < currNode->GetNumberOfEntries(); i++){
-         // Rebuild the object
-         tmp.Unserialize(currNode->GetObject(i), currNode->GetObjectSize(i));
-
-         // Evaluate distance
-         distance = this->myMetricEvaluator->GetDistance(tmp, *sample);
+         distance = distances[i];
 
          // KorRange part
          if (distance <= dk){
             // Add in the result
-            result->AddPair(tmp.Clone(), distance);
+            result->AddPair(objects[i]->Clone(), distance);
             // Test if Nearest > Range.
             if (dk > range){
                // Cut the result if it is possible.
@@ -477,6 +503,11 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::KOrRangeQuery(
       this->myPageManager->ReleasePage(currPage);
    }//end while
 
+   // Free the objects of the nodes.
+   for (i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+
    // Return the result.
    return result;
 }//end KOrRangeQuery
@@ -488,7 +519,8 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::RingQuery(
    stPage * currPage;
    stDummyNode * currNode;
    tResult * result;
-   tObject tmp;
+   std::vector <tObject *> objects;
+   std::vector <double> distances;
    double distance;
    u_int32_t i;
    u_int32_t nextPageID;
@@ -506,18 +538,17 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::RingQuery(
       currPage = this->myPageManager->GetPage(nextPageID);
       currNode = new stDummyNode(currPage);
 
+      // Rebuild the objects of this node and evaluate their distances
+      EvaluateNode(currNode, sample, outRange, objects, distances);
+
       // Lets check all objects in this node
       for (i = 0; i < currNode->GetNumberOfEntries(); i++){
-         // Rebuild the object
-         tmp.Unserialize(currNode->GetObject(i), currNode->GetObjectSize(i));
-
-         // Evaluate distance
-         distance = this->myMetricEvaluator->GetDistance(tmp, *sample);
+         distance = distances[i];
 
          // Is it qualified ?
          if ((distance <= outRange) && (distance > inRange)){
             // Yes! I'm qualified !
-            result->AddPair(tmp.Clone(), distance);
+            result->AddPair(objects[i]->Clone(), distance);
          }//end if
       }//end for
 
@@ -529,6 +560,11 @@ stResult<ObjectType> * stDummyTree<ObjectType, EvaluatorType>::RingQuery(
       this->myPageManager->ReleasePage(currPage);
    }//end while
 
+   // Free the objects of the nodes.
+   for (i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+
    // Return the result.
    return result;
 }//end RingQuery
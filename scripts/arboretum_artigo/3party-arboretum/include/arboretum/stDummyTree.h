@@ -22,6 +22,7 @@
 
 #include <exception>
 #include <iostream>
+#include <vector>
 
 
 /**
@@ -637,6 +638,32 @@ class stDummyTree: public stMetricTree<ObjectType, EvaluatorType>{
          HeaderUpdate = true;
       }//end UpdateObjectCounter
 
+      /**
+      * Rebuilds the objects of a node and evaluates their bounded distances
+      * to the sample at once (see GetBoundedDistances()).
+      *
+      * @param node The node.
+      * @param sample The query object.
+      * @param bound The largest distance of any use to the caller.
+      * @param objects The objects of the node. New ones are created as
+      * needed and must be deleted by the caller.
+      * @param distances Their distances.
+      */
+      void EvaluateNode(stDummyNode * node, tObject * sample, double bound,
+                        std::vector <tObject *> & objects,
+                        std::vector <double> & distances){
+
+         while (objects.size() < node->GetNumberOfEntries()){
+            objects.push_back(new tObject());
+         }//end while
+         distances.resize(node->GetNumberOfEntries());
+         for (u_int32_t i = 0; i < node->GetNumberOfEntries(); i++){
+            objects[i]->Unserialize(node->GetObject(i), node->GetObjectSize(i));
+         }//end for
+         this->GetBoundedDistances(*sample, objects.data(),
+               node->GetNumberOfEntries(), distances.data(), bound);
+      }//end EvaluateNode
+
 };//end stDummyTree
 
 #include <arboretum/stDummyTree-inl.h>
@@ -0,0 +1,243 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the class stMMapPageManager.
+*
+* @version 1.0
+*/
+#ifndef __STMMAPPAGEMANAGER_H
+#define __STMMAPPAGEMANAGER_H
+
+#include <stdexcept>
+
+#include <arboretum/stPageManager.h>
+#include <arboretum/stUtil.h>
+#include <arboretum/stCommonIO.h>
+#include <mutex>
+
+//==============================================================================
+// stMMapPageManager
+//------------------------------------------------------------------------------
+/**
+* This class implements a read only page manager over a memory mapped file
+* created by stPlainDiskPageManager or stPositionalDiskPageManager.
+*
+* <p>GetPage() returns stPageView instances which point to the mapping, so
+* pages are never copied. These pages must not be changed (the mapping is
+* read only). The header page is a private copy of the file header: it may be
+* changed (an empty tree writes its default header, for instance), but
+* WriteHeaderPage() does not write it back. GetNewPage(), WritePage() and
+* DisposePage() raise std::logic_error.
+*
+* <p>Every GetPage() and GetHeaderPage() counts a read, as the other disk page
+* managers do, even though the page may already be in memory.
+*
+* <p>Since nothing is written, many threads may use this page manager at once.
+*
+* @version 1.0
+* @see stPageManager
+* @see stPageView
+* @ingroup storage
+*/
+class stMMapPageManager: public stPageManager{
+   public:
+      /**
+      * Creates a new instance of this class. This constructor maps an
+      * existing file.
+      *
+      * @param fName The file name.
+      * @exception std::logic_error If the file can not be opened or mapped or
+      * if it is not a valid disk page manager file.
+      */
+      stMMapPageManager(const char * fName);
+
+      /**
+      * Unmaps the file and free all allocated resources.
+      */
+      virtual ~stMMapPageManager();
+
+      /**
+      * This method will checks if this page manager is empty.
+      *
+      * @return True if the page manager is empty or false otherwise.
+      */
+      virtual bool IsEmpty();
+
+      /**
+      * Returns a private copy of the header page.
+      *
+      * @return The header page.
+      * @see ReleasePage()
+      */
+      virtual stPage * GetHeaderPage();
+
+      /**
+      * Returns a view of the page with the given page ID. The view must not
+      * be changed.
+      *
+      * <P>Use ReleasePage() to release this instance.
+      *
+      * @param pageid The desired page id.
+      * @return The page or NULL for an invalid page ID.
+      * @exception std::logic_error If the page is beyond the end of the file.
+      * @see ReleasePage()
+      */
+      virtual stPage * GetPage(u_int32_t pageid);
+
+      /**
+      * Releases this instace for reuse by this page manager.
+      *
+      * @param page The locked page.
+      * @see GetPage()
+      * @see GetHeaderPage()
+      */
+      virtual void ReleasePage(stPage * page);
+
+      /**
+      * This page manager is read only.
+      *
+      * @exception std::logic_error Always.
+      */
+      virtual stPage * GetNewPage();
+
+      /**
+      * This page manager is read only.
+      *
+      * @exception std::logic_error Always.
+      */
+      virtual void WritePage(stPage * page);
+
+      /**
+      * Does nothing. The changes of the header page are kept in memory only.
+      *
+      * @param headerpage The header page.
+      */
+      virtual void WriteHeaderPage(stPage * headerpage);
+
+      /**
+      * This page manager is read only.
+      *
+      * @exception std::logic_error Always.
+      */
+      virtual void DisposePage(stPage * page);
+
+      /**
+      * Returns the minimum size of a page. The size of the header page is
+      * always ignored since it may be smaller than others.
+      */
+      virtual u_int32_t GetMinimumPageSize(){
+         return header->PageSize;
+      }//end GetMinimumPageSize
+
+      /**
+      * Returns the number of pages.
+      */
+      virtual u_int32_t GetPageCount() {
+         return header->PageCount;
+      }//end GetPageCount
+
+   private:
+      #pragma pack(1)
+      /**
+      * The header of the file. It is the header of stPlainDiskPageManager.
+      */
+      struct tHeader{
+         /**
+         * Magic header. Always "DPM1".
+         */
+         char Magic[4];
+
+         /**
+         * Size of each page in bytes.
+         */
+         u_int32_t PageSize;
+
+         /**
+         * Number of pages allocated including deleted ones and the header pages.
+         * In other words, it is the id of last allocated page.
+         */
+         u_int32_t PageCount;
+
+         /**
+         * Number of used pages.
+         */
+         u_int32_t UsedPages;
+
+         /**
+         * The page ID of the first available page.
+         */
+         u_int32_t Available;
+      };//end tHeader
+      #pragma pack()
+
+      /**
+      * Type of the view cache used by this page manager.
+      */
+      typedef stInstanceCache <stPageView, stPageViewAllocator> stPageViewCache;
+
+      /**
+      * The page view cache used by this page manager.
+      */
+      stPageViewCache * pageViewCache;
+
+      /**
+      * Guards pageViewCache.
+      */
+      std::mutex pageViewCacheMutex;
+
+      /**
+      * The mapping.
+      */
+      unsigned char * data;
+
+      /**
+      * Size of the mapping in bytes.
+      */
+      size_t dataSize;
+
+      /**
+      * The header of this instance. It points to the headerPage's
+      * internal buffer.
+      */
+      tHeader * header;
+
+      /**
+      * The private copy of the header page.
+      */
+      stLockablePage * headerPage;
+
+      /**
+      * Validates a header.
+      *
+      * @param header The header.
+      * @return True for a valid header of false otherwise.
+      */
+      bool IsValidHeader(tHeader * header);
+
+      /**
+      * Converts a page ID to the file offset.
+      *
+      * @param pageid The page id.
+      * @return The offset of the given page id.
+      */
+      size_t PageID2Offset(u_int32_t pageid){
+         return (size_t) pageid * header->PageSize;
+      }//end PageID2Offset
+
+};//end stMMapPageManager
+
+#endif //__STMMAPPAGEMANAGER_H
@@ -134,8 +134,8 @@ int stMLogicNode<ObjectType, EvaluatorType>::TestDistribution(
    }//end for
 
    // Sorting by distance...
-   sort(ind0, ind0 + Count);
-   sort(ind1, ind1 + Count);
+   std::sort(ind0, ind0 + Count);
+   std::sort(ind1, ind1 + Count);
 
    // Make one of then get the minimum occupation.
    l0 = l1 = 0;
@@ -243,8 +243,8 @@ int stMLogicNode<ObjectType, EvaluatorType>::TestDistribution(
    }//end for
 
    // Sorting by distance...
-   sort(ind0, ind0 + Count);
-   sort(ind1, ind1 + Count);
+   std::sort(ind0, ind0 + Count);
+   std::sort(ind1, ind1 + Count);
 
    // Make one of then get the minimum occupation.
    l0 = l1 = 0;
@@ -2197,7 +2197,8 @@ stResult<ObjectType> * tmpl_stMTree::RangeQuery(
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
+            distance = this->GetBoundedDistance(&tmpObj, sample,
+                  range + indexNode->GetIndexEntry(idx).Radius);
             // test if this subtree qualifies.
             if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
                // Yes! Analyze this subtree.
@@ -2210,18 +2211,26 @@ stResult<ObjectType> * tmpl_stMTree::RangeQuery(
          // No, it is a leaf node. Get it.
          stMLeafNode * leafNode = (stMLeafNode *)currNode;
          numberOfEntries = leafNode->GetNumberOfEntries();
+         std::vector <ObjectType *> block(numberOfEntries);
+         std::vector <double> distances(numberOfEntries);
 
-         // For each entry...
+         // Rebuild the objects and evaluate their distances at once.
          for (idx = 0; idx < numberOfEntries; idx++) {
-            // Rebuild the object
-            tmpObj.Unserialize(leafNode->GetObject(idx),
-                               leafNode->GetObjectSize(idx));
-            // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
+            block[idx] = new ObjectType();
+            block[idx]->Unserialize(leafNode->GetObject(idx),
+                                    leafNode->GetObjectSize(idx));
+         }//end for
+         this->GetBoundedDistances(sample, block.data(), block.size(),
+                                   distances.data(), range);
+
+         // For each entry...
+         for (idx = 0; idx < block.size(); idx++) {
             // is it a object that qualified?
-            if (distance <= range){
+            if (distances[idx] <= range){
                // Yes! Put it in the result set.
-               result->AddPair(tmpObj.Clone(), distance);
+               result->AddPair(block[idx], distances[idx]);
+            }else{
+               delete block[idx];
             }//end if
          }//end for
       }//end else
@@ -2265,7 +2274,8 @@ void tmpl_stMTree::RangeQuery(
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx), indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
+               distance = this->GetBoundedDistance(&tmpObj, sample,
+                     range + indexNode->GetIndexEntry(idx).Radius);
                // is this a qualified subtree?
                if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
                   // Yes! Analyze it!
@@ -2278,21 +2288,30 @@ void tmpl_stMTree::RangeQuery(
          // No, it is a leaf node. Get it.
          stMLeafNode * leafNode = (stMLeafNode *)currNode;
          numberOfEntries = leafNode->GetNumberOfEntries();
+         std::vector <ObjectType *> block;
+         std::vector <double> distances(numberOfEntries);
 
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // use of the triangle inequality.
             if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
                       range){
-               // Rebuild the object
-               tmpObj.Unserialize(leafNode->GetObject(idx), leafNode->GetObjectSize(idx));
-               // No, it is not a representative. Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
-               // Is this a qualified object?
-               if (distance <= range){
-                  // Yes! Put it in the result set.
-                  result->AddPair(tmpObj.Clone(), distance);
-               }//end if
+               // Rebuild the object. Its distance is evaluated with the block.
+               block.push_back(new ObjectType());
+               block.back()->Unserialize(leafNode->GetObject(idx), leafNode->GetObjectSize(idx));
+            }//end if
+         }//end for
+         this->GetBoundedDistances(sample, block.data(), block.size(),
+                                   distances.data(), range);
+
+         // for each entry of the block...
+         for (idx = 0; idx < block.size(); idx++) {
+            // Is this a qualified object?
+            if (distances[idx] <= range){
+               // Yes! Put it in the result set.
+               result->AddPair(block[idx], distances[idx]);
+            }else{
+               delete block[idx];
             }//end if
          }//end for
       }//end else
@@ -2334,6 +2353,8 @@ void stMTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
    u_int32_t numberOfEntries;
    stQueryPriorityQueueValue pqCurrValue;
    stQueryPriorityQueueValue pqTmpValue;
+   std::vector <ObjectType *> block;
+   std::vector <double> distances;
    bool stop;
 
    // Root node
@@ -2362,7 +2383,8 @@ void stMTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx), indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
+               distance = this->GetBoundedDistance(&tmpObj, sample,
+                     rangeK + indexNode->GetIndexEntry(idx).Radius);
 
                if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius){
                   // Yes! I'm qualified! Put it in the queue.
@@ -2376,30 +2398,38 @@ void stMTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
          // No, it is a leaf node. Get it.
          stMLeafNode * leafNode = (stMLeafNode *)currNode;
          numberOfEntries = leafNode->GetNumberOfEntries();
+         block.clear();
 
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this object with the triangle inequality.
             if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
                       rangeK){
-               // Rebuild the object
-               tmpObj.Unserialize(leafNode->GetObject(idx), leafNode->GetObjectSize(idx));
-               // When this entry is a representative, it does not need to evaluate
-               // a distance, because distanceRepres is iqual to distance.
-               // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
-               //test if the object qualify
-               if (distance <= rangeK){
-                  // Add the object.
-                  result->AddPair(tmpObj.Clone(), distance);
-                  // there is more than k elements?
-                  if (result->GetNumOfEntries() >= k){
-                     //cut if there is more than k elements
-                     result->Cut(k);
-                     //may I use this for performance?
-                     rangeK = result->GetMaximumDistance();
-                  }//end if
+               // Rebuild the object. Its distance is evaluated with the block,
+               // against the rangeK of the start of the node.
+               block.push_back(new ObjectType());
+               block.back()->Unserialize(leafNode->GetObject(idx), leafNode->GetObjectSize(idx));
+            }//end if
+         }//end for
+         distances.resize(block.size());
+         this->GetBoundedDistances(sample, block.data(), block.size(),
+                                   distances.data(), rangeK);
+
+         // for each entry of the block...
+         for (idx = 0; idx < block.size(); idx++) {
+            //test if the object qualify
+            if (distances[idx] <= rangeK){
+               // Add the object.
+               result->AddPair(block[idx], distances[idx]);
+               // there is more than k elements?
+               if (result->GetNumOfEntries() >= k){
+                  //cut if there is more than k elements
+                  result->Cut(k);
+                  //may I use this for performance?
+                  rangeK = result->GetMaximumDistance();
                }//end if
+            }else{
+               delete block[idx];
             }//end if
          }//end for
       }//end else
@@ -2743,7 +2773,7 @@ u_int32_t tmpl_stMTree::setBulkHeight(u_int32_t numObj,u_int32_t objSize,double
 
 template <class ObjectType, class EvaluatorType>
 u_int32_t tmpl_stMTree::getNodeFreeSize() {
-   return GetPageManager()->GetMinimumPageSize() - stMNode::GetGlobalOverhead();
+   return tMetricTree::GetPageManager()->GetMinimumPageSize() - stMNode::GetGlobalOverhead();
 } //end stMTree<ObjectType, EvaluatorType>::getNodeFreeSize
 
 template <class ObjectType, class EvaluatorType>
@@ -315,8 +315,143 @@ class stMetricTree: public stMetricAccessMethod < ObjectType, EvaluatorType >{
       * The page manager used by thismetric tree.
       */
       stPageManager * myPageManager;
-      
+
+      /**
+      * Returns the distance between two objects if it is not larger than
+      * bound. Otherwise it returns any value larger than bound. The metric
+      * evaluator may then stop early if it has a GetDistance(obj1, obj2,
+      * bound) method, as the Lp distance functions of hermes do.
+      *
+      * @param obj1 Object 1.
+      * @param obj2 Object 2.
+      * @param bound The largest distance of any use to the caller.
+      */
+      double GetBoundedDistance(ObjectType & obj1, ObjectType & obj2, double bound){
+         return GetBoundedDistance<ObjectType &>(this->myMetricEvaluator,
+                                                 obj1, obj2, bound, 0);
+      }//end GetBoundedDistance
+
+      /**
+      * @copydoc GetBoundedDistance(ObjectType & obj1, ObjectType & obj2, double bound)
+      *
+      * <p>The bounded distance is evaluated on *obj1 and *obj2, as the
+      * distance functions of hermes take references. The full distance is
+      * evaluated on the pointers.
+      */
+      double GetBoundedDistance(ObjectType * obj1, ObjectType * obj2, double bound){
+         return GetBoundedDistance<ObjectType *>(this->myMetricEvaluator,
+                                                 obj1, obj2, bound, 0);
+      }//end GetBoundedDistance
+
+      /**
+      * Evaluates the bounded distances (see GetBoundedDistance()) between
+      * sample and n objects. The metric evaluator computes them at once if
+      * it has a GetDistances(sample, objects, n, distances, bound) method,
+      * as the distance functions of hermes do. Otherwise they are evaluated
+      * one by one.
+      *
+      * @param sample The query object.
+      * @param objects The objects.
+      * @param n Number of objects.
+      * @param distances The n distances, in the order of the objects.
+      * @param bound The largest distance of any use to the caller.
+      */
+      void GetBoundedDistances(ObjectType & sample, ObjectType ** objects,
+                               u_int32_t n, double * distances, double bound){
+         GetBoundedDistances<ObjectType &>(this->myMetricEvaluator, sample,
+                                           objects, n, distances, bound, 0);
+      }//end GetBoundedDistances
+
+      /**
+      * @copydoc GetBoundedDistances(ObjectType & sample, ObjectType ** objects, u_int32_t n, double * distances, double bound)
+      *
+      * <p>One by one, the distances are evaluated on pointers, as the ones
+      * of GetBoundedDistance(ObjectType * obj1, ObjectType * obj2, double bound).
+      */
+      void GetBoundedDistances(ObjectType * sample, ObjectType ** objects,
+                               u_int32_t n, double * distances, double bound){
+         GetBoundedDistances<ObjectType *>(this->myMetricEvaluator, sample,
+                                           objects, n, distances, bound, 0);
+      }//end GetBoundedDistances
+
    private:
+      /**
+      * Returns the object itself.
+      */
+      static ObjectType & Dereference(ObjectType & obj){
+         return obj;
+      }//end Dereference
+
+      /**
+      * Returns the object pointed by obj.
+      */
+      static ObjectType & Dereference(ObjectType * obj){
+         return *obj;
+      }//end Dereference
+
+      /**
+      * Evaluates a bounded distance with the evaluator.
+      */
+      template <class Object, class Evaluator>
+      static auto GetBoundedDistance(Evaluator * evaluator, Object obj1,
+            Object obj2, double bound, int)
+            -> decltype(evaluator->GetDistance(Dereference(obj1),
+                  Dereference(obj2), bound)){
+         return evaluator->GetDistance(Dereference(obj1), Dereference(obj2), bound);
+      }//end GetBoundedDistance
+
+      /**
+      * Evaluates the full distance when the evaluator has no bounded one.
+      */
+      template <class Object, class Evaluator>
+      static double GetBoundedDistance(Evaluator * evaluator, Object obj1,
+            Object obj2, double bound, long){
+         return evaluator->GetDistance(obj1, obj2);
+      }//end GetBoundedDistance
+
+      /**
+      * Returns objects[i] as a reference.
+      */
+      static ObjectType & GetElement(ObjectType ** objects, u_int32_t i,
+                                     ObjectType &){
+         return *objects[i];
+      }//end GetElement
+
+      /**
+      * Returns objects[i] as a pointer.
+      */
+      static ObjectType * GetElement(ObjectType ** objects, u_int32_t i,
+                                     ObjectType *){
+         return objects[i];
+      }//end GetElement
+
+      /**
+      * Evaluates the bounded distances with the GetDistances() of the
+      * evaluator.
+      */
+      template <class Object, class Evaluator>
+      static auto GetBoundedDistances(Evaluator * evaluator, Object sample,
+            ObjectType ** objects, u_int32_t n, double * distances,
+            double bound, int)
+            -> decltype(evaluator->GetDistances(Dereference(sample), objects,
+                  (size_t) n, distances, bound)){
+         evaluator->GetDistances(Dereference(sample), objects, (size_t) n,
+                                 distances, bound);
+      }//end GetBoundedDistances
+
+      /**
+      * Evaluates the bounded distances one by one.
+      */
+      template <class Object, class Evaluator>
+      static void GetBoundedDistances(Evaluator * evaluator, Object sample,
+            ObjectType ** objects, u_int32_t n, double * distances,
+            double bound, long){
+         for (u_int32_t i = 0; i < n; i++){
+            distances[i] = GetBoundedDistance<Object>(evaluator,
+                  GetElement(objects, i, sample), sample, bound, 0);
+         }//end for
+      }//end GetBoundedDistances
+
       /**
       * If this flag is true, the metric evaluator pointed by myMetricEvaluator
       * is shared.
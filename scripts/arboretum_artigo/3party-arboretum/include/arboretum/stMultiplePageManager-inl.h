@@ -23,6 +23,7 @@ stMultiplePageManager<PageManager>::stMultiplePageManager(const string &fileName
     this->fileName = fileName;
     this->pagesPerPM = pagesPerPM;
     this->pageCount = 0;
+    this->StoresPages = false;
 
     tempFileName.append(this->fileName).append(".0");
 
@@ -39,6 +40,7 @@ stMultiplePageManager<PageManager>::stMultiplePageManager(const std::string &fil
     this->fileName = fileName;
     this->pagesPerPM = pagesPerPM;
     this->pageCount = 0;
+    this->StoresPages = false;
 
     tempFileName.append(this->fileName).append(".0");
 
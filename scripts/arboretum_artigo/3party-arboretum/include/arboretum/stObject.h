@@ -147,6 +147,28 @@ class stObject{
       * @note This method is required to fulfil the stObject interface.
       */
       virtual void Unserialize(const unsigned char * data, u_int32_t datasize) = 0;
+
+      /**
+      * This method may rebuild the object as a view of its serialized version.
+      * Unlike Unserialize(), the object is allowed to keep pointers to the data
+      * array instead of copying it, so it is valid only while the data array
+      * is. A view becomes independent again when it is cloned or unserialized.
+      *
+      * <P>It is used by the query methods of the SlimTree when __stOBJECTVIEW__
+      * is defined. In that mode the distances are evaluated directly on the
+      * bytes of the node pages and only the objects added to the result are
+      * cloned (materialized).
+      *
+      * <P>This method is optional. The default implementation calls
+      * Unserialize().
+      *
+      * @param data The serialized object.
+      * @param datasize The size (in bytes) of the data array.
+      * @see Unserialize()
+      */
+      virtual void UnserializeView(const unsigned char * data, u_int32_t datasize){
+         Unserialize(data, datasize);
+      }//end UnserializeView
       
       /**
       * This method must return something that identifies uniquely the
@@ -126,6 +126,18 @@ class stPage{
 
    protected:
 
+      /**
+      * Creates a page over a buffer owned by someone else. The buffer is not
+      * copied. Subclasses which use this constructor must set Buffer to 0
+      * in their destructors, so it is not disposed by this class.
+      *
+      * @param buffer The buffer. It may be NULL.
+      * @param size The page size in bytes.
+      * @param pageid Page id.
+      * @see stPageView
+      */
+      stPage (unsigned char * buffer, u_int32_t size, u_int32_t pageid);
+
       /**
       * The page (buffer).
       */
@@ -337,4 +349,100 @@ class stPageAllocator{
         
 };//end stPageAllocator
 
+//----------------------------------------------------------------------------
+// Class stPageView
+//----------------------------------------------------------------------------
+/**
+* This class is a page which does not own its data. It points to a buffer
+* kept by the page manager (a memory mapped file, for instance), so the page
+* contents are never copied.
+*
+* <P>The buffer may be read only. Users of this page must not change it
+* unless the page manager says otherwise.
+*
+* @version 1.0
+* @see stMMapPageManager
+* @ingroup storage
+*/
+class stPageView: public stPage{
+
+   public:
+
+      /**
+      * Creates a new view which points to nothing.
+      *
+      * @param size The page size in bytes.
+      */
+      stPageView(u_int32_t size): stPage(NULL, size, 0){
+      }//end stPageView
+
+      /**
+      * Disposes this view. The buffer is not disposed.
+      */
+      virtual ~stPageView(){
+         Buffer = 0;
+      }//end ~stPageView
+
+      /**
+      * Points this view to another buffer.
+      *
+      * @param buffer The buffer with at least GetPageSize() bytes.
+      * @param pageid Page id.
+      */
+      void SetView(unsigned char * buffer, u_int32_t pageid){
+         Buffer = buffer;
+         SetPageID(pageid);
+      }//end SetView
+
+};//end stPageView
+
+//----------------------------------------------------------------------------
+// Class stPageViewAllocator
+//----------------------------------------------------------------------------
+/**
+* This class is the allocator implementation that allows the use of the
+* stInstanceCache with stPageView instances.
+*
+* @version 1.0
+* @ingroup storage
+*/
+class stPageViewAllocator{
+
+   public:
+
+      /**
+      * Creates a new allocator for stPageView instances. All views will have
+      * pageSize bytes.
+      *
+      * @param pageSize The size of the views created by this allocator.
+      */
+      stPageViewAllocator(u_int32_t pageSize){
+         this->pageSize = pageSize;
+      }//end stPageViewAllocator
+
+      /**
+      * Creates new stPageView instances.
+      */
+      stPageView * Create(){
+         return new stPageView(pageSize);
+      }//end Create
+
+      /**
+      * Disposes the given stPageView instance.
+      *
+      * @param instance The instance to be disposed.
+      */
+      void Dispose(stPageView * instance){
+         delete instance;
+      }//end Dispose
+
+   private:
+
+      /**
+      * Size of the views to be created.
+      */
+      u_int32_t pageSize;
+
+};//end stPageViewAllocator
+
 #endif //__STPAGE_H
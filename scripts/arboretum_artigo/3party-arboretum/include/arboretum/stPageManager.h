@@ -26,6 +26,8 @@
 #define __STPAGEMANAGER_H
 
 #include  <arboretum/stPage.h>
+#include <util/stStatistics.h>
+#include <atomic>
 
 /**
 * This class defines the abstract class stPageManager. All
@@ -43,6 +45,15 @@ class stPageManager{
 
    public:
 
+      /**
+      * This is de default constructor of this class.
+      */
+      stPageManager(){
+         this->ReadCount = 0;
+         this->WriteCount = 0;
+         this->StoresPages = true;
+      }//end stPageManager
+
       /**
       * This is de default destructor of this class.
       */
@@ -161,6 +172,14 @@ class stPageManager{
       */
       virtual void DisposePage(stPage * page) = 0;
 
+      /**
+      * Writes all pending changes to the storage. Page managers which delay
+      * writes (the header page, for instance) must override this method. The
+      * default implementation does nothing.
+      */
+      virtual void Flush(){
+      }//end Flush
+
       /**
       * Restarts the statistics.
       *
@@ -218,13 +237,24 @@ class stPageManager{
 
    protected:
 
+      /**
+      * If true, the reads and writes of this page manager are also counted
+      * by the PAGEREADS and PAGEWRITES counters of stStatistics. A page
+      * manager over another one (a cache, for instance) sets it to false,
+      * since the page manager below counts the pages it really reads.
+      */
+      bool StoresPages;
+
       /**
       * This method updates the read counter.
       *
       * @param count The number o reads to add to the counter.
       */
       void UpdateReadCounter(u_int32_t count = 1){
-         ReadCount += count;
+         ReadCount.fetch_add(count, std::memory_order_relaxed);
+         if (StoresPages){
+            stStatistics::Add(stStatistics::PAGEREADS, count);
+         }//end if
       }//end UpdateReadCounter
       
       /**
@@ -233,7 +263,10 @@ class stPageManager{
       * @param count The number o writes to add to the counter.
       */
       void UpdateWriteCounter(u_int32_t count = 1){
-         WriteCount += count;
+         WriteCount.fetch_add(count, std::memory_order_relaxed);
+         if (StoresPages){
+            stStatistics::Add(stStatistics::PAGEWRITES, count);
+         }//end if
       }//end UpdateWriteCounter
 
    private:
@@ -243,9 +276,10 @@ class stPageManager{
       * statistics.
       *
       * @warning Each implementation of Page Manager must update this value
-      * when necessary.
+      * when necessary. It is atomic because the pages may be read by many
+      * threads at once.
       */
-      long int ReadCount;
+      std::atomic<long int> ReadCount;
 
       /**
       * Number of writes. This value is used to compute
@@ -254,7 +288,7 @@ class stPageManager{
       * @warning Each implementation of Page Manager must update this value when
       * necessary.
       */
-      long int WriteCount;
+      std::atomic<long int> WriteCount;
       
 };//end stPageManager
 
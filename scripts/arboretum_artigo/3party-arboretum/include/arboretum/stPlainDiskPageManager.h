@@ -29,6 +29,7 @@
 #include <arboretum/stPageManager.h>
 #include <arboretum/stUtil.h>
 #include <arboretum/stCommonIO.h>
+#include <mutex>
 
 //==============================================================================
 // stPlainDiskPageManager
@@ -42,6 +43,11 @@
 * operations are performed without chaching pages. As an additional feature, it
 * is possible to disable the system I/O cache in some operational systems.
 *
+* <p>Pages are read with pread(), so the file offset is not shared and many
+* threads may call GetPage() and ReleasePage() at once (the page instance
+* cache is guarded by a mutex). The methods that change the file must not
+* run concurrently with any other method.
+*
 * @version 1.0
 * @author Fabio Jun Takada Chino (chino@icmc.usp.br)
 * @author Marcos Rodrigues Vieira (mrvieira@icmc.usp.br)
@@ -255,6 +261,27 @@ class stPlainDiskPageManager: public stPageManager{
       * page will not use the cache because it has a different size.
       */
       stPageInstanceCache * pageInstanceCache;
+
+      /**
+      * Guards pageInstanceCache.
+      */
+      std::mutex pageInstanceCacheMutex;
+
+      /**
+      * Gets a page instance from pageInstanceCache.
+      */
+      stPage * GetPageInstance(){
+         std::lock_guard<std::mutex> lock(pageInstanceCacheMutex);
+         return pageInstanceCache->Get();
+      }//end GetPageInstance
+
+      /**
+      * Puts a page instance back into pageInstanceCache.
+      */
+      void PutPageInstance(stPage * page){
+         std::lock_guard<std::mutex> lock(pageInstanceCacheMutex);
+         pageInstanceCache->Put(page);
+      }//end PutPageInstance
       
       /**
       * File descriptor.
@@ -296,8 +323,8 @@ class stPlainDiskPageManager: public stPageManager{
       * @param pageid The page id.
       * @return The offset of the given page id.
       */
-      u_int32_t PageID2Offset(u_int32_t pageid){
-         return pageid * header->PageSize;
+      off_t PageID2Offset(u_int32_t pageid){
+         return (off_t) pageid * header->PageSize;
       }//end PageID2Offset
       
 };//end stPlainDiskPageManager
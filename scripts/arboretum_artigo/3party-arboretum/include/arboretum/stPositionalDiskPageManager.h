@@ -0,0 +1,339 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the class stPositionalDiskPageManager.
+*
+* @version 1.0
+*/
+#ifndef __STPOSITIONALDISKPAGEMANAGER_H
+#define __STPOSITIONALDISKPAGEMANAGER_H
+
+#include <stdexcept>
+
+#include <arboretum/stPageManager.h>
+#include <arboretum/stUtil.h>
+#include <arboretum/stCommonIO.h>
+#include <mutex>
+
+//==============================================================================
+// stPositionalDiskPageManager
+//------------------------------------------------------------------------------
+/**
+* This class implements a disk page manager based on positional I/O (pread()
+* and pwrite()). The files are the same of stPlainDiskPageManager, so a file
+* may be created by one and opened by the other (or by stMMapPageManager).
+*
+* <p>Unlike stPlainDiskPageManager, the header page is kept in memory and is
+* only written by Flush() or by the destructor. GetNewPage(), DisposePage()
+* and WriteHeaderPage() just mark it as modified. The file is not consistent
+* between those calls.
+*
+* <p>All I/O operations are checked. Short reads and writes are resumed and
+* failures raise std::logic_error.
+*
+* <p>The read and write counters are updated as stPlainDiskPageManager does
+* (GetHeaderPage() counts a read even though the header is in memory), so
+* both page managers report the same statistics for the same tree.
+*
+* <p>Many threads may call GetPage() and ReleasePage() at once. The methods
+* that change the file must not run concurrently with any other method.
+*
+* @version 1.0
+* @see stPageManager
+* @see stPlainDiskPageManager
+* @ingroup storage
+*/
+class stPositionalDiskPageManager: public stPageManager{
+   public:
+      /**
+      * Creates a new instance of this class. This constructor will create a new
+      * file with the given name.
+      *
+      * @param fName The file name.
+      * @param pagesize Size of each page in file. This value must be larger
+      * or equal than 64.
+      * @exception std::logic_error If the file can not be created.
+      */
+      stPositionalDiskPageManager(const char * fName, u_int32_t pagesize);
+
+      /**
+      * Creates a new instance of this class. This constructor will open an
+      * existing file.
+      *
+      * @param fName The file name.
+      * @exception std::logic_error If the file can not be opened or the file is
+      * not a valid disk page manager file.
+      */
+      stPositionalDiskPageManager(const char * fName);
+
+      /**
+      * Writes the header page if it was modified, disposes this page manager
+      * and free all allocated resources.
+      */
+      virtual ~stPositionalDiskPageManager();
+
+      /**
+      * This method will checks if this page manager is empty.
+      * If this method returns true, the stSlimTree will create a
+      * new tree otherwise it will continue to use the existing tree.
+      *
+      * @return True if the page manager is empty or false otherwise.
+      */
+      virtual bool IsEmpty();
+
+      /**
+      * Returns the header page. The header page is kept in memory, so this
+      * method does not read the file.
+      *
+      * @return The header page.
+      * @see WriteHeaderPage()
+      * @see ReleasePage()
+      */
+      virtual stPage * GetHeaderPage();
+
+      /**
+      * Returns the page with the given page ID. This method will
+      * return a valid page for reading/writing. Use WritePage() to
+      * write this page.
+      *
+      * <P>The returning instance of stPage will be locked to prevent
+      * its reuse by this page manager. Use ReleasePage() to unlock
+      * this instance.
+      *
+      * @param pageid The desired page id.
+      * @return The page or NULL for an invalid page ID.
+      * @exception std::logic_error If the page can not be read.
+      * @see WritePage()
+      * @see ReleasePage()
+      */
+      virtual stPage * GetPage(u_int32_t pageid);
+
+      /**
+      * Releases this instace for reuse by this page manager.
+      *
+      * @param page The locked page.
+      * @see GetPage()
+      * @see GetHeaderPage()
+      */
+      virtual void ReleasePage(stPage * page);
+
+      /**
+      * Allocates a new page for use. As GetPage() and
+      * GetHeaderPage(), the returning instance will be
+      * locked to prevent reuse by this page manager.
+      *
+      * <P>To dispose this page (make it free), use DisposePage().
+      *
+      * @return A new page.
+      * @see ReleasePage()
+      * @see WritePage()
+      * @see DisposePage()
+      */
+      virtual stPage * GetNewPage();
+
+      /**
+      * Writes the given page to the disk. This method
+      * will write the page but will not release it. Use
+      * ReleasePage() to do it.
+      *
+      * @param page The page to be written.
+      * @exception std::logic_error If the page can not be written.
+      * @see ReleasePage()
+      */
+      virtual void WritePage(stPage * page);
+
+      /**
+      * Marks the header page as modified. It will be written by Flush() or
+      * by the destructor.
+      *
+      * @param headerpage The header page.
+      * @see Flush()
+      */
+      virtual void WriteHeaderPage(stPage * headerpage);
+
+      /**
+      * Disposes the given page. This method will make the page
+      * available (not allocated) for the next calls of GetNewPage().
+      *
+      * <P>Since this page will not be used anymore, this method will
+      * release the lock for this page instance.
+      *
+      * @param page The page to be disposed.
+      * @see GetNewPage()
+      */
+      virtual void DisposePage(stPage * page);
+
+      /**
+      * Writes the header page if it was modified.
+      *
+      * @exception std::logic_error If the header can not be written.
+      */
+      virtual void Flush();
+
+      /**
+      * Returns the minimum size of a page. The size of the header page is
+      * always ignored since it may be smaller than others.
+      */
+      virtual u_int32_t GetMinimumPageSize(){
+         return header->PageSize;
+      }//end GetMinimumPageSize
+
+      /**
+      * Returns the number of pages.
+      */
+      virtual u_int32_t GetPageCount() {
+         return header->PageCount;
+      }//end GetPageCount
+
+   private:
+      #pragma pack(1)
+      /**
+      * The header of the file. It is the header of stPlainDiskPageManager.
+      */
+      struct tHeader{
+         /**
+         * Magic header. Always "DPM1".
+         */
+         char Magic[4];
+
+         /**
+         * Size of each page in bytes.
+         */
+         u_int32_t PageSize;
+
+         /**
+         * Number of pages allocated including deleted ones and the header pages.
+         * In other words, it is the id of last allocated page.
+         */
+         u_int32_t PageCount;
+
+         /**
+         * Number of used pages.
+         */
+         u_int32_t UsedPages;
+
+         /**
+         * The page ID of the first available page.
+         */
+         u_int32_t Available;
+      };//end tHeader
+      #pragma pack()
+
+      /**
+      * Type of the instance cache used by this disk page manager.
+      */
+      typedef stInstanceCache <stPage, stPageAllocator> stPageInstanceCache;
+
+      /**
+      * The page instance cache used by this disk page manager. The header
+      * page will not use the cache because it has a different size.
+      */
+      stPageInstanceCache * pageInstanceCache;
+
+      /**
+      * Guards pageInstanceCache.
+      */
+      std::mutex pageInstanceCacheMutex;
+
+      /**
+      * Gets a page instance from pageInstanceCache.
+      */
+      stPage * GetPageInstance(){
+         std::lock_guard<std::mutex> lock(pageInstanceCacheMutex);
+         return pageInstanceCache->Get();
+      }//end GetPageInstance
+
+      /**
+      * Puts a page instance back into pageInstanceCache.
+      */
+      void PutPageInstance(stPage * page){
+         std::lock_guard<std::mutex> lock(pageInstanceCacheMutex);
+         pageInstanceCache->Put(page);
+      }//end PutPageInstance
+
+      /**
+      * File descriptor.
+      */
+      int fd;
+
+      /**
+      * The header of this instance. It points to the headerPage's
+      * internal buffer.
+      */
+      tHeader * header;
+
+      /**
+      * The header page. It is written only by Flush().
+      */
+      stLockablePage * headerPage;
+
+      /**
+      * If true, headerPage must be written to the file.
+      */
+      bool headerUpdate;
+
+      /**
+      * Creates the header for an empty file.
+      *
+      * @param header the pointer to the header.
+      * @param pagesize the size of the page.
+      */
+      void NewHeader(tHeader * header, u_int32_t pagesize);
+
+      /**
+      * Validates a header.
+      *
+      * @param header The header.
+      * @return True for a valid header of false otherwise.
+      */
+      bool IsValidHeader(tHeader * header);
+
+      /**
+      * Reads n bytes at the given offset. Interrupted and short reads are
+      * resumed.
+      *
+      * @param buff The destination.
+      * @param n The number of bytes.
+      * @param offset The file offset.
+      * @return False if the file can not be read or ends before n bytes.
+      */
+      bool ReadAt(void * buff, size_t n, off_t offset);
+
+      /**
+      * Writes n bytes at the given offset. Interrupted and short writes are
+      * resumed.
+      *
+      * @param buff The source.
+      * @param n The number of bytes.
+      * @param offset The file offset.
+      * @return False if the file can not be written.
+      */
+      bool WriteAt(const void * buff, size_t n, off_t offset);
+
+      /**
+      * Converts a page ID to the file offset.
+      *
+      * @param pageid The page id.
+      * @return The offset of the given page id.
+      */
+      off_t PageID2Offset(u_int32_t pageid){
+         return (off_t) pageid * header->PageSize;
+      }//end PageID2Offset
+
+};//end stPositionalDiskPageManager
+
+#endif //__STPOSITIONALDISKPAGEMANAGER_H
@@ -0,0 +1,139 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the structure stQueryStats.
+*
+* @version 1.0
+*/
+#ifndef __STQUERYSTATS_H
+#define __STQUERYSTATS_H
+
+#include <arboretum/stUtil.h>
+
+#include <vector>
+
+//==============================================================================
+// stQueryStats
+//------------------------------------------------------------------------------
+/**
+* Execution statistics of a single query. The query methods that accept a
+* stQueryStats reset it and fill it while they run, so, unlike the counters
+* of the metric evaluator and of the page manager, it is not shared with the
+* other queries of the process and may be used by concurrent queries (one
+* instance per query).
+*
+* <p>An entry of a node is either cut by the parent distance test (the
+* triangle inequality with the distance to the representative, without any
+* distance calculation) or its distance to the query is calculated and it is
+* then cut by the covering test (the covering radius of a subtree or the
+* radius of the query for an object) or accepted. In a tree with global
+* pivots, an object that passes the parent distance test may still be cut by
+* its field distances before its distance is calculated.
+*
+* @version 1.0
+* @ingroup struct
+*/
+struct stQueryStats{
+   /**
+   * Wall time of the query, in microseconds.
+   */
+   double Time;
+
+   /**
+   * Distance calculations, as counted by stStatistics in the thread that
+   * ran the query.
+   */
+   u_int64_t DistanceCount;
+
+   /**
+   * Node pages read.
+   */
+   u_int64_t PageReads;
+
+   /**
+   * Nodes visited at each level. The root is at level 0.
+   */
+   std::vector <u_int32_t> NodesPerLevel;
+
+   /**
+   * Entries cut by the parent distance test.
+   */
+   u_int64_t ParentPruned;
+
+   /**
+   * Entries cut by the covering test.
+   */
+   u_int64_t CoveringPruned;
+
+   /**
+   * Objects cut by the field distances to the global pivots.
+   */
+   u_int64_t PivotPruned;
+
+   /**
+   * Largest number of nodes waiting in the priority queue of the query. It
+   * is 0 for queries without a queue.
+   */
+   u_int32_t QueuePeak;
+
+   /**
+   * Creates an empty instance.
+   */
+   stQueryStats(){
+      Reset();
+   }//end stQueryStats
+
+   /**
+   * Clears all statistics.
+   */
+   void Reset(){
+      Time = 0;
+      DistanceCount = 0;
+      PageReads = 0;
+      NodesPerLevel.clear();
+      ParentPruned = 0;
+      CoveringPruned = 0;
+      PivotPruned = 0;
+      QueuePeak = 0;
+   }//end Reset
+
+   /**
+   * Records the read of a node.
+   *
+   * @param level The level of the node.
+   */
+   void AddNode(u_int32_t level){
+      if (level >= NodesPerLevel.size()){
+         NodesPerLevel.resize(level + 1, 0);
+      }//end if
+      NodesPerLevel[level]++;
+      PageReads++;
+   }//end AddNode
+
+   /**
+   * Records the size of the priority queue.
+   *
+   * @param size The number of nodes in the queue.
+   */
+   void UpdateQueuePeak(u_int32_t size){
+      if (size > QueuePeak){
+         QueuePeak = size;
+      }//end if
+   }//end UpdateQueuePeak
+};//end stQueryStats
+
+#endif //__STQUERYSTATS_H
@@ -132,7 +132,7 @@ bool stSlimMemLeafNode< ObjectType >::Add(ObjectType * obj, double distance){
    // Update # of Entries
    this->numEntries++; // One more!
    // Update the usedSize
-   this->usedSize += obj->GetSerializedSize() + stSlimLeafNode::GetLeafEntryOverhead();
+   this->usedSize += obj->GetSerializedSize() + srcLeafNode->GetEntryOverhead();
 
    return true;
 }//end stSlimMemLeafNode::Add()
@@ -162,7 +162,7 @@ ObjectType * stSlimMemLeafNode< ObjectType >::Remove(u_int32_t idx){
    this->numEntries--; // One less!
    // Update the usedSize
    this->usedSize -= (returnObject->GetSerializedSize() +
-                      stSlimLeafNode::GetLeafEntryOverhead());
+                      srcLeafNode->GetEntryOverhead());
    // return the removed entry.
    return returnObject;
 }//end stSlimMemLeafNode::Remove
@@ -184,7 +184,7 @@ ObjectType * stSlimMemLeafNode< ObjectType >::PopObject(){
    this->numEntries--; // One less!
    // Update the usedSize
    this->usedSize -= (returnObject->GetSerializedSize() +
-                      stSlimLeafNode::GetLeafEntryOverhead());
+                      srcLeafNode->GetEntryOverhead());
    // return the removed entry.
    return returnObject;
 }//end stSlimMemLeafNode::PopObject
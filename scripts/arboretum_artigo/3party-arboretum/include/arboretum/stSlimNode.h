@@ -75,7 +75,13 @@ class stSlimNode{
          /**
          * ID of a leaf node.
          */
-         LEAF = 0x464C // In little endian "LF"
+         LEAF = 0x464C, // In little endian "LF"
+
+         /**
+         * ID of a leaf node with field distances. The low byte holds the
+         * number of fields. GetNodeType() reports these nodes as LEAF.
+         */
+         FIELDLEAF = 0x5000
       };//end stSlimNodeType
       
 
@@ -92,6 +98,9 @@ class stSlimNode{
       * @see stNodeType
       */
       u_int16_t GetNodeType(){
+         if ((Header->Type & 0xFF00) == FIELDLEAF){
+            return LEAF;
+         }//end if
          return Header->Type;
       }//end GetNodeType
 
@@ -494,7 +503,8 @@ class stSlimIndexNode: public stSlimNode{
 * @image html leafnode.png "Leaf node structure"
 *
 * <P>The <b>Header</b> holds the information about the node itself.
-*     - Type: Type of this node. It is always stSlimNode::LEAF (0x464C).
+*     - Type: Type of this node. It is stSlimNode::LEAF (0x464C), or
+*       stSlimNode::FIELDLEAF plus the number of fields.
 *     - Occupation: Number of entries in this node.
 *
 * <P>The <b>Entry</b> holds the information of the link to the other node.
@@ -504,6 +514,12 @@ class stSlimIndexNode: public stSlimNode{
 * <P>The <b>Object</b> is an array of bytes that holds the information required
 * to rebuild the original object.
 *
+* <P>A node created with fields keeps, right before each object, the
+* distances of the object to the global pivots of the tree (its field
+* distances, as in the DF-Tree). AddEntry() sets them to -1 and the tree
+* fills them before the node is written. They are part of the object area,
+* so GetObject() and GetObjectSize() do not see them.
+*
 * @version 1.0
 * @author Fabio Jun Takada Chino (chino@icmc.usp.br)
 * @author Marcos Rodrigues Vieira (mrvieira@icmc.usp.br)
@@ -549,8 +565,10 @@ class stSlimLeafNode: public stSlimNode{
       *
       * @param page The page that hold the data of this node.
       * @param create The operation to be performed.
+      * @param fields The number of field distances of each entry of a new
+      * node (up to 255). Default 0.
       */
-      stSlimLeafNode(stPage * page, bool create = false);
+      stSlimLeafNode(stPage * page, bool create = false, u_int32_t fields = 0);
 
       /**
       * Returns the reference of the desired leaf entry. You may use this method to
@@ -673,11 +691,56 @@ class stSlimLeafNode: public stSlimNode{
       
       /**
       * Returns the overhead of each leaf node entry in bytes.
+      *
+      * @param fields The number of field distances of each entry.
       */
-      static u_int32_t GetLeafEntryOverhead(){
-         return sizeof(stSlimLeafEntry);
+      static u_int32_t GetLeafEntryOverhead(u_int32_t fields = 0){
+         return sizeof(stSlimLeafEntry) + (fields * sizeof(double));
       }//end GetLeafEntryOverhead()
 
+      /**
+      * Returns the overhead of each entry of this node in bytes.
+      */
+      u_int32_t GetEntryOverhead(){
+         return GetLeafEntryOverhead(Fields);
+      }//end GetEntryOverhead
+
+      /**
+      * Returns the number of field distances of each entry.
+      */
+      u_int32_t GetNumberOfFields(){
+         return Fields;
+      }//end GetNumberOfFields
+
+      /**
+      * Returns a field distance of an entry. They are -1 until the tree
+      * fills them. The fields are not aligned in the page, so they are
+      * copied.
+      *
+      * @param idx The idx of the entry.
+      * @param field The field, less than GetNumberOfFields().
+      * @return The field distance.
+      */
+      double GetFieldDistance(u_int32_t idx, u_int32_t field){
+         double distance;
+
+         memcpy(&distance, Page->GetData() + Entries[idx].Offset +
+                field * sizeof(double), sizeof(distance));
+         return distance;
+      }//end GetFieldDistance
+
+      /**
+      * Sets a field distance of an entry.
+      *
+      * @param idx The idx of the entry.
+      * @param field The field, less than GetNumberOfFields().
+      * @param distance The field distance.
+      */
+      void SetFieldDistance(u_int32_t idx, u_int32_t field, double distance){
+         memcpy(Page->GetData() + Entries[idx].Offset + field * sizeof(double),
+                &distance, sizeof(distance));
+      }//end SetFieldDistance
+
       /**
       * Returns the amount of the free space in this node.
       */
@@ -689,6 +752,11 @@ class stSlimLeafNode: public stSlimNode{
       */
       stSlimLeafEntry * Entries;
 
+      /**
+      * Number of field distances of each entry.
+      */
+      u_int32_t Fields;
+
 
 };//end stSlimLeafNode
 
@@ -837,7 +905,7 @@ class stSlimMemLeafNode{
          int entrySize;
 
          // Does it fit ?
-         entrySize = obj->GetSerializedSize() + stSlimLeafNode::GetLeafEntryOverhead();
+         entrySize = obj->GetSerializedSize() + srcLeafNode->GetEntryOverhead();
          if (entrySize + this->usedSize > this->maximumSize){
             // No, it doesn't.
             return false;
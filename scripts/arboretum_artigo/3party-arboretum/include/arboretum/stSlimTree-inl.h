@@ -389,7 +389,6 @@ stSlimMSTSplitter<ObjectType, EvaluatorType>::stSlimMSTSplitter(
    N = Node->GetNumberOfEntries();
 
    // Dynamic fields
-   Cluster = new tCluster[N];
    ObjectCluster = new int[N];
 
    // Matrix
@@ -404,10 +403,6 @@ stSlimMSTSplitter<ObjectType, EvaluatorType>::~stSlimMSTSplitter(){
       delete Node;
 	  Node = 0;
    }//end if
-   if (Cluster != 0){
-      delete[] Cluster;
-	  Cluster = 0;
-   }//end if
    if (ObjectCluster != 0){
       delete[] ObjectCluster;
 	  ObjectCluster = 0;
@@ -418,20 +413,74 @@ stSlimMSTSplitter<ObjectType, EvaluatorType>::~stSlimMSTSplitter(){
 template <class ObjectType, class EvaluatorType>
 int stSlimMSTSplitter<ObjectType, EvaluatorType>::BuildDistanceMatrix(
       EvaluatorType * metricEvaluator){
-   int i;
-   int j;
+   std::vector <EvaluatorType> evaluators;
+   std::vector <stTaskPool::tTask> tasks;
+   u_int64_t distanceCount;
+   u_int32_t nThreads;
+   int i, j, ib, jb;
+   int iEnd, jEnd;
+
+   nThreads = 1;
+   if (N >= MSTPARALLELMATRIX){
+      nThreads = std::thread::hardware_concurrency();
+   }//end if
 
-   for (i = 0; i < N; i++){
-      DMat[i][i] = 0;
-      for (j = 0; j < i; j++){
-         DMat[i][j] = metricEvaluator->GetDistance(*Node->GetObject(i),
-                                                   *Node->GetObject(j));
-         DMat[j][i] = DMat[i][j];
+   // Lower triangle.
+   if (nThreads > 1){
+      stTaskPool pool(nThreads);
+
+      // A copy of the evaluator for each task.
+      distanceCount = metricEvaluator->GetDistanceCount();
+      evaluators.assign(nThreads, *metricEvaluator);
+      for (i = 0; i < (int) nThreads; i++){
+         tasks.push_back([this, &evaluators, i, nThreads](u_int32_t){
+            BuildDistanceRows(&evaluators[i], i, nThreads);
+         });
+      }//end for
+      pool.Run(tasks);
+      for (i = 0; i < (int) nThreads; i++){
+         metricEvaluator->MergeDistanceCount(
+               evaluators[i].GetDistanceCount() - distanceCount);
+      }//end for
+   }else{
+      BuildDistanceRows(metricEvaluator, 0, 1);
+   }//end if
+
+   // Upper triangle, copied by blocks.
+   for (ib = 0; ib < N; ib += MSTMATRIXBLOCK){
+      iEnd = std::min(ib + MSTMATRIXBLOCK, N);
+      for (jb = 0; jb <= ib; jb += MSTMATRIXBLOCK){
+         for (i = ib; i < iEnd; i++){
+            jEnd = std::min(jb + MSTMATRIXBLOCK, i);
+            for (j = jb; j < jEnd; j++){
+               DMat[j][i] = DMat[i][j];
+            }//end for
+         }//end for
+      }//end for
+      for (i = ib; i < iEnd; i++){
+         DMat[i][i] = 0;
       }//end for
    }//end for
-   return ((1 - N) * N) / 2;
+   return ((N - 1) * N) / 2;
 }//end stSlimMSTSplitter<ObjectType, EvaluatorType>::BuildDistanceMatrix
 
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void stSlimMSTSplitter<ObjectType, EvaluatorType>::BuildDistanceRows(
+      EvaluatorType * metricEvaluator, int first, int step){
+   std::vector <ObjectType *> objects(N);
+   int i;
+
+   for (i = 0; i < N; i++){
+      objects[i] = Node->GetObject(i);
+   }//end for
+
+   // Row i holds the distances to the objects before it.
+   for (i = first; i < N; i += step){
+      GetDistances(metricEvaluator, objects[i], objects.data(), i, DMat[i], 0);
+   }//end for
+}//end stSlimMSTSplitter<ObjectType, EvaluatorType>::BuildDistanceRows
+
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 int stSlimMSTSplitter<ObjectType, EvaluatorType>::FindCenter(int clus){
@@ -460,155 +509,87 @@ int stSlimMSTSplitter<ObjectType, EvaluatorType>::FindCenter(int clus){
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void stSlimMSTSplitter<ObjectType, EvaluatorType>::PerformMST(){
-   int i, j, k, cc, iBig, iBigOpposite, a, b , c;
-   bool linksOk, flag;
+   std::vector <double> minDist(N, MAXDOUBLE);
+   std::vector <int> parent(N, -1);
+   std::vector <int> order;
+   std::vector <int> size(N, 1);
+   std::vector <bool> inTree(N, false);
+   double * row;
    double big;
-
-   // Insert each object in its own cluster.
-   cc = N;
-   for (i = 0; i < N; i++){
-      Cluster[i].Size = 1;
-      Cluster[i].State = ALIVE;
-      ObjectCluster[i] = i; // Add Object
-   }//end for
-
-   // Perform it until it reaches 2 clusters.
-   while (cc > 2){
-      // Find the minimum distance between a cluster and its nearest
-      // neighbour (connections).
-      for (i = 0; i < N; i++){
-         if (Cluster[i].State != DEAD){
-            Cluster[i].MinDist = MAXDOUBLE;
-         }//end if
-      }//end for
+   int minOccupation;
+   int i, k, next, cut, balance, bigBalance;
+   bool fits, bigFits, better;
+
+   // Prim on the dense matrix, from object 0.
+   next = 0;
+   minDist[0] = 0;
+   while (next >= 0){
+      k = next;
+      inTree[k] = true;
+      order.push_back(k);
+
+      // Update the links to the tree and find the nearest object.
+      row = DMat[k];
+      next = -1;
       for (i = 0; i < N; i++){
-         k = ObjectCluster[i];
-         // Locate the nearest
-         for (j = 0; j < N; j++){
-            if (ObjectCluster[j] != k){
-               if (Cluster[k].MinDist > DMat[i][j]){
-                  Cluster[k].MinDist = DMat[i][j];
-                  Cluster[k].Src = i;
-                  Cluster[k].Dst = j;
-               }//end if
+         if (!inTree[i]){
+            if (row[i] < minDist[i]){
+               minDist[i] = row[i];
+               parent[i] = k;
+            }//end if
+            if ((next < 0) || (minDist[i] < minDist[next])){
+               next = i;
             }//end if
-         }//end for
-      }//end for
-      linksOk = true;
-
-      // Find the largest connection. It will also locate the oposite objects
-      big = -1.0;
-      iBig = 0;
-      for (i = 1; i < N; i++){
-         if ((Cluster[i].State != DEAD) && (big < Cluster[i].MinDist)){
-            big = Cluster[i].MinDist;
-            iBig = i;
-         }//end if
-      }//end for
-
-      // Locate the iBigOpposite.
-      iBigOpposite = iBig;
-      for (i = 0; i < N; i++){
-         if ((Cluster[i].State != DEAD) && (Cluster[i].Src == Cluster[iBig].Dst) &&
-               (Cluster[i].Dst == Cluster[iBig].Src)){
-            iBigOpposite = i;
-         }//end if
-      }//end for
-
-      // Join clusters
-      i = 0;
-      while ((i < N) && (cc > 2)) {
-         if ((i != iBig) && (i != iBigOpposite) && (Cluster[i].State != DEAD)){
-            // Join cluster i and its nearest cluster.
-            k = ObjectCluster[Cluster[i].Dst];
-            flag = true;
-
-            // Change the cluster of all objects of the dropped one to
-            // the remaining one.
-            for (j = 0; j < N; j++){
-               if ((ObjectCluster[j] == k) &&
-                     (ObjectCluster[j] != ObjectCluster[Cluster[i].Src])){
-                  if ((cc == 3) && (flag)){
-                     if (!linksOk){
-                        // Force update.
-                        i = j = N;
-                     }else{
-                        a = ObjectCluster[Cluster[iBig].Src];
-                        b = ObjectCluster[Cluster[iBig].Dst];
-                        c = k;
-                        if ((c == a) || (c == b)){
-                           c = ObjectCluster[Cluster[i].Src];
-                        }//end if
-
-                        if ((ObjectCluster[Cluster[c].Src] == a) ||
-                              (ObjectCluster[Cluster[c].Dst] == a)){
-                           if (Cluster[b].Size > Cluster[c].Size){
-                              // Join C and A
-                              JoinClusters(c, a);
-                           }else{
-                              // Join B and A
-                              JoinClusters(b , a);
-                           }//end if
-                        }else{
-                           if (Cluster[a].Size > Cluster[c].Size){
-                              // Join C and B
-                              JoinClusters(c, b);
-                           }else{
-                              // Join A and B
-                              JoinClusters(a, b);
-                           }//end if
-                        }//end if
-                        i = j = N;
-                        cc--;
-                     }//end if
-                  }else{
-                     Cluster[k].State = DEATH_SENTENCE;
-                     ObjectCluster[j] = ObjectCluster[Cluster[i].Src];
-                     if (flag){
-                        Cluster[ObjectCluster[Cluster[i].Src]].Size +=
-                              Cluster[k].Size;
-                        cc--;
-                        flag = false;
-                        linksOk = false;
-                     }//end if
-                  }//end if
-               }//end if
-            }//end for
-         }//end if
-         // Update i for the next loop
-         i++;
-      }//end while
-
-      // All clusters that are destiny of an edge has gone, integrated
-      // into another one.
-      for (i = 0; i < N; i++){
-         if (Cluster[i].State == DEATH_SENTENCE){
-            Cluster[i].State = DEAD;
          }//end if
       }//end for
    }//end while
 
-   // Locate the name of the 2 clusters.
-   Cluster0 = -1;
-   Cluster1 = -1;
-   for (i = 0; i < N; i++){
-      if (Cluster[i].State == ALIVE){
-         if (Cluster0 == -1){
-            Cluster0 = i;
-         }else if (Cluster1 == -1){
-            Cluster1 = i;
-         }//end if
+   // Size of the subtree of each object.
+   for (i = N - 1; i > 0; i--){
+      size[parent[order[i]]] += size[order[i]];
+   }//end for
+
+   // Cut the edge between an object and its parent. The longest edge that
+   // leaves the minimum occupation in both clusters is chosen. Ties (and
+   // edges that do not fit) are decided by balance.
+   minOccupation = Node->GetMinOccupation();
+   cut = order[1];
+   big = -1.0;
+   bigFits = false;
+   bigBalance = -1;
+   for (i = 1; i < N; i++){
+      k = order[i];
+      balance = std::min(size[k], N - size[k]);
+      fits = balance >= minOccupation;
+      if (fits != bigFits){
+         better = fits;
+      }else if (fits){
+         better = (minDist[k] > big) ||
+               ((minDist[k] == big) && (balance > bigBalance));
+      }else{
+         better = (balance > bigBalance) ||
+               ((balance == bigBalance) && (minDist[k] > big));
+      }//end if
+      if (better){
+         cut = k;
+         big = minDist[k];
+         bigFits = fits;
+         bigBalance = balance;
       }//end if
    }//end for
 
-   #ifdef __stDEBUG__
-   // Linking missing objects
-   for (i = 0; i < N; i++){
-      if ((ObjectCluster[i] != Cluster0) && (ObjectCluster[i] != Cluster1)){
-         throw std::logic_error("At least on object has no cluster.");
+   // The subtree of cut is the cluster 1. Parents come first in order.
+   Cluster0 = 0;
+   Cluster1 = 1;
+   ObjectCluster[order[0]] = Cluster0;
+   for (i = 1; i < N; i++){
+      k = order[i];
+      if (k == cut){
+         ObjectCluster[k] = Cluster1;
+      }else{
+         ObjectCluster[k] = ObjectCluster[parent[k]];
       }//end if
    }//end for
-   #endif //__stDEBUG__
 
    // Representatives
    Node->SetRepresentative(FindCenter(Cluster0), FindCenter(Cluster1));
@@ -767,20 +748,6 @@ int stSlimMSTSplitter<ObjectType, EvaluatorType>::Distribute(
    return dCount;
 }//end stSlimMSTSplitter<ObjectType, EvaluatorType>::Distribute
 
-//------------------------------------------------------------------------------
-template <class ObjectType, class EvaluatorType>
-void stSlimMSTSplitter<ObjectType, EvaluatorType>::JoinClusters(
-      int cluster1, int cluster2){
-   int i;
-
-   for (i = 0; i < N; i++){
-      if (ObjectCluster[i] == cluster2){
-         ObjectCluster[i] = cluster1;
-      }//end if
-   }//end for
-   Cluster[cluster1].Size += Cluster[cluster2].Size;
-   Cluster[cluster2].State = DEATH_SENTENCE;
-}//end stSlimMSTSplitter<ObjectType, EvaluatorType>::JoinClusters
 
 
 //==============================================================================
@@ -797,16 +764,24 @@ tmpl_stSlimTree::stSlimTree(stPageManager * pageman):
 
    // Initialize fields
    Header = NULL;
+   PivotHeader = NULL;
    HeaderPage = NULL;
+   Batching = false;
+   MinDistortion = 1;
+   MaxDistortion = 1;
 
    // Load header.
    LoadHeader();
 
    this->maxQueue = 0;
+   this->sumOperationsQueue = 0;
 
    // Will I create or load the tree ?
    if (tMetricTree::myPageManager->IsEmpty()){
       DefaultHeader();
+   }else{
+      CheckHeader();
+      LoadPivots();
    }//end if
 
    this->plotSplitSequence = 0;
@@ -824,7 +799,11 @@ tmpl_stSlimTree::stSlimTree(stPageManager * pageman, EvaluatorType * metricEval)
 
    // Initialize fields
    Header = NULL;
+   PivotHeader = NULL;
    HeaderPage = NULL;
+   Batching = false;
+   MinDistortion = 1;
+   MaxDistortion = 1;
 
    // Load header.
    LoadHeader();
@@ -832,6 +811,9 @@ tmpl_stSlimTree::stSlimTree(stPageManager * pageman, EvaluatorType * metricEval)
    // Will I create or load the tree ?
    if (tMetricTree::myPageManager->IsEmpty()){
       DefaultHeader();
+   }else{
+      CheckHeader();
+      LoadPivots();
    }//end if
 
    // Visualization support
@@ -847,6 +829,11 @@ tmpl_stSlimTree::~stSlimTree(){
    // Flus header page.
    FlushHeader();
 
+   // Release the pivots.
+   for (u_int32_t i = 0; i < Pivots.size(); i++){
+      delete Pivots[i];
+   }//end for
+
    // Visualization support
    #ifdef __stMAMVIEW__
    delete MAMViewer;
@@ -875,6 +862,8 @@ void tmpl_stSlimTree::DefaultHeader(){
    Header->Height = 0;
    Header->ObjectCount = 0;
    Header->NodeCount = 0;
+   PivotHeader->PivotCount = 0;
+   PivotHeader->PivotPageID = 0;
 
    // Notify modifications
    HeaderUpdate = true;
@@ -890,7 +879,7 @@ void tmpl_stSlimTree::LoadHeader(){
 
    // Load and set the header.
    HeaderPage = tMetricTree::myPageManager->GetHeaderPage();
-   if (HeaderPage->GetPageSize() < sizeof(stSlimHeader)){
+   if (HeaderPage->GetPageSize() < sizeof(stSlimHeader) + sizeof(stSlimPivotHeader)){
       #ifdef __stDEBUG__
          cout << "The page size is too small. Increase it!\n";
       #endif //__stDEBUG__
@@ -898,9 +887,26 @@ void tmpl_stSlimTree::LoadHeader(){
    }//end if
 
    Header = (stSlimHeader *) HeaderPage->GetData();
+   PivotHeader = (stSlimPivotHeader *) (HeaderPage->GetData() +
+         HeaderPage->GetPageSize() - sizeof(stSlimPivotHeader));
    HeaderUpdate = false;
 }//end stSlimTree<ObjectType, EvaluatorType>::LoadHeader
 
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::CheckHeader(){
+
+   if ((memcmp(Header->Magic, "SLIM", sizeof(Header->Magic)) != 0) &&
+         (memcmp(Header->Magic, "SL-2", sizeof(Header->Magic)) != 0)){
+      // The constructor does not finish, so the destructor will not run.
+      tMetricTree::myPageManager->ReleasePage(HeaderPage);
+      HeaderPage = NULL;
+      Header = NULL;
+      PivotHeader = NULL;
+      throw std::logic_error("The file is not a Slim-Tree.");
+   }//end if
+}//end stSlimTree<ObjectType, EvaluatorType>::CheckHeader
+
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void tmpl_stSlimTree::FlushHeader(){
@@ -914,6 +920,187 @@ void tmpl_stSlimTree::FlushHeader(){
    }//end if
 }//end stSlimTree<ObjectType, EvaluatorType>::FlushHeader
 
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::SetPivots(ObjectType ** pivots, u_int32_t n){
+   stPage * page;
+   u_int32_t offset = 0;
+   u_int32_t size;
+   u_int32_t i;
+
+   if ((this->GetRoot() != 0) || (!Pivots.empty())){
+      throw std::logic_error("The pivots must be set on an empty tree.");
+   }//end if
+   if (n > 0xFF){
+      throw std::logic_error("Too many pivots.");
+   }//end if
+   if (n == 0){
+      return;
+   }//end if
+
+   // Each pivot is stored as its size and its serialized form.
+   page = tMetricTree::myPageManager->GetNewPage();
+   page->Clear();
+   for (i = 0; i < n; i++){
+      size = pivots[i]->GetSerializedSize();
+      if (offset + sizeof(size) + size > page->GetPageSize()){
+         tMetricTree::myPageManager->DisposePage(page);
+         throw std::logic_error("The pivots do not fit in a page.");
+      }//end if
+      memcpy(page->GetData() + offset, &size, sizeof(size));
+      memcpy(page->GetData() + offset + sizeof(size), pivots[i]->Serialize(), size);
+      offset += sizeof(size) + size;
+   }//end for
+   tMetricTree::myPageManager->WritePage(page);
+   PivotHeader->PivotPageID = page->GetPageID();
+   PivotHeader->PivotCount = n;
+   // Only the trees with pivots need the new layout.
+   Header->Magic[2] = '-';
+   Header->Magic[3] = '2';
+   HeaderUpdate = true;
+   tMetricTree::myPageManager->ReleasePage(page);
+
+   for (i = 0; i < n; i++){
+      Pivots.push_back((ObjectType *) pivots[i]->Clone());
+   }//end for
+   WriteHeader();
+}//end stSlimTree<ObjectType, EvaluatorType>::SetPivots
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::FindPivots(ObjectType ** objects, u_int32_t size,
+                                 u_int32_t n){
+   std::vector <ObjectType *> pivots;
+   std::vector <bool> isPivot(size, false);
+   double distance, error, bestError, edge;
+   u_int32_t i, j, best1, best2, best, steps;
+
+   if (size < n){
+      throw std::logic_error("The sample has less objects than pivots.");
+   }//end if
+   if (n == 0){
+      return;
+   }//end if
+
+   // The first two pivots are a pair of far apart objects.
+   best1 = 0;
+   best2 = 0;
+   bestError = 0;
+   for (steps = 0; steps < 5; steps++){
+      for (i = 0; i < size; i++){
+         distance = this->myMetricEvaluator->GetDistance(*objects[i], *objects[best1]);
+         if (distance > bestError){
+            best2 = i;
+            bestError = distance;
+         }//end if
+      }//end for
+      for (i = 0; i < size; i++){
+         distance = this->myMetricEvaluator->GetDistance(*objects[i], *objects[best2]);
+         if (distance > bestError){
+            best1 = i;
+            bestError = distance;
+         }//end if
+      }//end for
+   }//end for
+   pivots.push_back(objects[best1]);
+   isPivot[best1] = true;
+   if ((n > 1) && (!isPivot[best2])){
+      pivots.push_back(objects[best2]);
+      isPivot[best2] = true;
+   }//end if
+
+   // The others are the objects whose distances to the pivots found so far
+   // are the closest to the distance between the first two.
+   edge = bestError;
+   while (pivots.size() < n){
+      best = size;
+      bestError = MAXDOUBLE;
+      for (i = 0; i < size; i++){
+         if (!isPivot[i]){
+            error = 0;
+            for (j = 0; j < pivots.size(); j++){
+               error += fabs(edge -
+                     this->myMetricEvaluator->GetDistance(*pivots[j], *objects[i]));
+            }//end for
+            if (error < bestError){
+               best = i;
+               bestError = error;
+            }//end if
+         }//end if
+      }//end for
+      pivots.push_back(objects[best]);
+      isPivot[best] = true;
+   }//end while
+
+   SetPivots(pivots.data(), n);
+}//end stSlimTree<ObjectType, EvaluatorType>::FindPivots
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::LoadPivots(){
+   stPage * page;
+   ObjectType * pivot;
+   u_int32_t offset = 0;
+   u_int32_t size;
+
+   // A "SLIM" tree has no pivot fields.
+   if ((memcmp(Header->Magic, "SL-2", sizeof(Header->Magic)) != 0) ||
+         (PivotHeader->PivotCount == 0)){
+      return;
+   }//end if
+   page = tMetricTree::myPageManager->GetPage(PivotHeader->PivotPageID);
+   for (u_int32_t i = 0; i < PivotHeader->PivotCount; i++){
+      memcpy(&size, page->GetData() + offset, sizeof(size));
+      pivot = new ObjectType();
+      pivot->Unserialize(page->GetData() + offset + sizeof(size), size);
+      Pivots.push_back(pivot);
+      offset += sizeof(size) + size;
+   }//end for
+   tMetricTree::myPageManager->ReleasePage(page);
+}//end stSlimTree<ObjectType, EvaluatorType>::LoadPivots
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::GetQueryFields(ObjectType * sample,
+                                     std::vector <double> & fields){
+
+   fields.resize(Pivots.size());
+   for (u_int32_t i = 0; i < Pivots.size(); i++){
+      fields[i] = this->myMetricEvaluator->GetDistance(*Pivots[i], *sample);
+   }//end for
+}//end stSlimTree<ObjectType, EvaluatorType>::GetQueryFields
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::UpdateFieldDistances(stPage * page, EvaluatorType * evaluator){
+   stSlimNode * node;
+   stSlimLeafNode * leafNode;
+   ObjectType tmpObj;
+   u_int32_t idx, i;
+
+   if (Pivots.empty()){
+      return;
+   }//end if
+   node = stSlimNode::CreateNode(page);
+   if ((node != NULL) && (node->GetNodeType() == stSlimNode::LEAF)){
+      leafNode = (stSlimLeafNode *) node;
+      if (leafNode->GetNumberOfFields() == Pivots.size()){
+         for (idx = 0; idx < leafNode->GetNumberOfEntries(); idx++){
+            // New entries have negative fields.
+            if (leafNode->GetFieldDistance(idx, 0) < 0){
+               LoadObject(tmpObj, leafNode->GetObject(idx),
+                          leafNode->GetObjectSize(idx));
+               for (i = 0; i < Pivots.size(); i++){
+                  leafNode->SetFieldDistance(idx, i,
+                        evaluator->GetDistance(*Pivots[i], tmpObj));
+               }//end for
+            }//end if
+         }//end for
+      }//end if
+   }//end if
+   delete node;
+}//end stSlimTree<ObjectType, EvaluatorType>::UpdateFieldDistances
+
 //------------------------------------------------------------------------------
 #ifdef __stFRACTALQUERY__
 template <class ObjectType, class EvaluatorType>
@@ -930,6 +1117,92 @@ void tmpl_stSlimTree::ResetFractalStatistics(){
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 bool tmpl_stSlimTree::Add(ObjectType *newObj){
+
+   if (!InsertObject(newObj)){
+      // The new object was not inserted.
+      return false;
+   }//end if
+
+   // Update object count.
+   UpdateObjectCounter(1);
+
+   // Report the modification.
+   HeaderUpdate = true;
+   // Ok. The new object was inserted. Return success!
+   return true;
+}//end stSlimTree<ObjectType, EvaluatorType>::Add
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+u_int32_t tmpl_stSlimTree::AddBatch(ObjectType ** objects, u_int32_t n,
+      bool groupBySubtree, bool writeHeader){
+   std::vector <std::pair <int, u_int32_t> > order;
+   stPage * rootPage;
+   stSlimNode * rootNode;
+   u_int32_t added;
+   u_int32_t i;
+
+   Batching = true;
+   added = 0;
+   try{
+      // The insertion order.
+      for (i = 0; i < n; i++){
+         order.push_back(std::make_pair(0, i));
+      }//end for
+      if (groupBySubtree && (this->GetRoot() != 0)){
+         rootPage = GetNodePage(this->GetRoot());
+         rootNode = stSlimNode::CreateNode(rootPage);
+         if (rootNode->GetNodeType() == stSlimNode::INDEX){
+            for (i = 0; i < n; i++){
+               order[i].first = ChooseSubTree((stSlimIndexNode *) rootNode,
+                                              objects[i]);
+            }//end for
+            // Ties keep the given order.
+            std::sort(order.begin(), order.end());
+         }//end if
+         delete rootNode;
+         ReleaseNodePage(rootPage);
+      }//end if
+
+      for (i = 0; i < n; i++){
+         if (InsertObject(objects[order[i].second])){
+            added++;
+         }//end if
+      }//end for
+   }catch (...){
+      UpdateObjectCounter(added);
+      FlushBatch();
+      throw;
+   }//end try
+
+   // Update object count.
+   UpdateObjectCounter(added);
+   FlushBatch();
+   if (writeHeader){
+      WriteHeader();
+   }//end if
+
+   return added;
+}//end stSlimTree<ObjectType, EvaluatorType>::AddBatch
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::FlushBatch(){
+   typename std::map <u_int32_t, tBatchPage>::iterator i;
+
+   for (i = BatchPages.begin(); i != BatchPages.end(); i++){
+      if (i->second.Dirty){
+         WriteTreePage(i->second.Page);
+      }//end if
+      tMetricTree::myPageManager->ReleasePage(i->second.Page);
+   }//end for
+   BatchPages.clear();
+   Batching = false;
+}//end stSlimTree<ObjectType, EvaluatorType>::FlushBatch
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+bool tmpl_stSlimTree::InsertObject(ObjectType *newObj){
    stSubtreeInfo promo1;
    stSubtreeInfo promo2;
    int insertIdx;
@@ -938,7 +1211,7 @@ bool tmpl_stSlimTree::Add(ObjectType *newObj){
    if (this->GetRoot() == 0){
       // No! We shall create the new node.
       stPage * auxPage  = this->NewPage();
-      stSlimLeafNode * leafNode = new stSlimLeafNode(auxPage, true);
+      stSlimLeafNode * leafNode = CreateLeafNode(auxPage);
       this->SetRoot(auxPage->GetPageID());
 
       // Insert the new object.
@@ -961,11 +1234,11 @@ bool tmpl_stSlimTree::Add(ObjectType *newObj){
          // Update the Height
          Header->Height++;
          // Write the root node.
-         tMetricTree::myPageManager->WritePage(auxPage);
+         WriteNodePage(auxPage);
       }//end if
       delete leafNode;
 	  leafNode = 0;
-      delete auxPage;
+      ReleaseNodePage(auxPage);
 	  auxPage = 0;
    }else{
       // Let's continue our search for the grail!
@@ -981,14 +1254,9 @@ bool tmpl_stSlimTree::Add(ObjectType *newObj){
       }//end if
    }//end if
 
-   // Update object count.
-   UpdateObjectCounter(1);
-
-   // Report the modification.
-   HeaderUpdate = true;
-   // Ok. The new object was inserted. Return success!
+   // Ok. The new object was inserted.
    return true;
-}//end stSlimTree<ObjectType, EvaluatorType>::Add
+}//end stSlimTree<ObjectType, EvaluatorType>::InsertObject
 
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
@@ -1214,12 +1482,12 @@ void tmpl_stSlimTree::AddNewRoot(
    // Update tree
    Header->Height++;
    SetRoot(newRoot->GetPage()->GetPageID());
-   tMetricTree::myPageManager->WritePage(newPage);
+   WriteNodePage(newPage);
 
    // Dispose page
    delete newRoot;
    newRoot = 0;
-   tMetricTree::myPageManager->ReleasePage(newPage);
+   ReleaseNodePage(newPage);
 }//end SlimTree::AddNewRoot
 
 //------------------------------------------------------------------------------
@@ -1241,7 +1509,7 @@ int tmpl_stSlimTree::InsertRecursive(
    ObjectType * subRep;    // Subtree representative.
 
    // Read node...
-   currPage = tMetricTree::myPageManager->GetPage(currNodeID);
+   currPage = GetNodePage(currNodeID);
    currNode = stSlimNode::CreateNode(currPage);
 
    // What shall I do ?
@@ -1329,11 +1597,11 @@ int tmpl_stSlimTree::InsertRecursive(
                      repObj, promo1, promo2);
 
                // Write nodes
-               tMetricTree::myPageManager->WritePage(newPage);
+               WriteNodePage(newPage);
                // Clean home.
                delete newIndexNode;
 			   newIndexNode = 0;
-               tMetricTree::myPageManager->ReleasePage(newPage);
+               ReleaseNodePage(newPage);
                result = PROMOTION; //Report split.
             }//end if
             break;
@@ -1382,11 +1650,11 @@ int tmpl_stSlimTree::InsertRecursive(
                         repObj, promo1, promo2);
 
                   // Write nodes
-                  tMetricTree::myPageManager->WritePage(newPage);
+                  WriteNodePage(newPage);
                   // Clean home.
                   delete newIndexNode;
 				  newIndexNode = 0;
-                  tMetricTree::myPageManager->ReleasePage(newPage);
+                  ReleaseNodePage(newPage);
                   result = PROMOTION; //Report split.
                }//end if
             }else{
@@ -1490,11 +1758,11 @@ int tmpl_stSlimTree::InsertRecursive(
                            repObj, promo1, promo2);
 
                      // Write nodes
-                     tMetricTree::myPageManager->WritePage(newPage);
+                     WriteNodePage(newPage);
                      // Clean home.
                      delete newIndexNode;
 					 newIndexNode = 0;
-                     tMetricTree::myPageManager->ReleasePage(newPage);
+                     ReleaseNodePage(newPage);
                      result = PROMOTION; //Report split.
                   }//end if
                }else{
@@ -1510,11 +1778,11 @@ int tmpl_stSlimTree::InsertRecursive(
                         repObj, promo1, promo2);
 
                   // Write nodes
-                  tMetricTree::myPageManager->WritePage(newPage);
+                  WriteNodePage(newPage);
                   // Clean home.
                   delete newIndexNode;
 				  newIndexNode = 0;
-                  tMetricTree::myPageManager->ReleasePage(newPage);
+                  ReleaseNodePage(newPage);
                   result = PROMOTION; //Report split.
                }//end if
             }//end if
@@ -1543,7 +1811,7 @@ int tmpl_stSlimTree::InsertRecursive(
          leafNode->GetLeafEntry(insertIdx).Distance = dist;
 
          // Write node.
-         tMetricTree::myPageManager->WritePage(currPage);
+         WriteNodePage(currPage);
 
          // Returning values
          promo1.Rep = NULL;
@@ -1555,29 +1823,29 @@ int tmpl_stSlimTree::InsertRecursive(
          // Split it!
          // New node.
          newPage = this->NewPage();
-         newLeafNode = new stSlimLeafNode(newPage, true);
+         newLeafNode = CreateLeafNode(newPage);
 
          // Split!
          SplitLeaf(leafNode, newLeafNode, (ObjectType *)newObj->Clone(),
                    repObj, promo1, promo2);
 
          // Write node.
-         tMetricTree::myPageManager->WritePage(newPage);
+         WriteNodePage(newPage);
          // Clean home.
          delete newLeafNode;
 		 newLeafNode = 0;
-         tMetricTree::myPageManager->ReleasePage(newPage);
+         ReleaseNodePage(newPage);
 		 newPage = 0;
          result = PROMOTION; //Report split.
       }//end if
    }//end if
 
    // Write node.
-   tMetricTree::myPageManager->WritePage(currPage);
+   WriteNodePage(currPage);
    // Clean home
    delete currNode;
    currNode = 0;
-   tMetricTree::myPageManager->ReleasePage(currPage);
+   ReleaseNodePage(currPage);
    currPage = 0;
    return result;
 }//end stSlimTree<ObjectType, EvaluatorType>::InsertRecursive
@@ -1641,8 +1909,8 @@ void tmpl_stSlimTree::MinMaxPromote(tLogicNode * node) {
       delete indexNode2;
 	  indexNode2 = 0;
    }else{//it is a Leaf node
-      stSlimLeafNode * leafNode1 = new stSlimLeafNode(newPage1, true);
-      stSlimLeafNode * leafNode2 = new stSlimLeafNode(newPage2, true);
+      stSlimLeafNode * leafNode1 = CreateLeafNode(newPage1);
+      stSlimLeafNode * leafNode2 = CreateLeafNode(newPage2);
 
       for (i = 0; i < numberOfEntries; i++) {
          for (j = i + 1; j < numberOfEntries; j++) {
@@ -3445,7 +3713,7 @@ stResult<ObjectType> * tmpl_stSlimTree::AggregateRangeQuery(
          stSlimIndexNode * indexNode = (stSlimIndexNode *)currNode;
          for (idx = 0; idx < indexNode->GetNumberOfEntries(); idx++) {
             tmpObj.Unserialize(indexNode->GetObject(idx), indexNode->GetObjectSize(idx));
-            distance = AggregateDistanceToSlimNode(numerator, denominator, sampleList, sampleSize, &tmpObj, indexNode->GetIndexEntry(idx).Radius, weights);
+            distance = AggregateDistanceToSlimNode(numerator, denominator, sampleList, sampleSize, &tmpObj, ScaleRadius(indexNode->GetIndexEntry(idx).Radius), weights);
 
             // test if this subtree qualifies.
             if (distance <= range) {
@@ -3494,7 +3762,7 @@ void tmpl_stSlimTree::AggregateRangeQuery(u_int32_t pageID,
          // For each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
                tmpObj.Unserialize(indexNode->GetObject(idx), indexNode->GetObjectSize(idx));
-               distance = AggregateDistanceToSlimNode(numerator, denominator, sampleList, sampleSize, &tmpObj, indexNode->GetIndexEntry(idx).Radius, weights);
+               distance = AggregateDistanceToSlimNode(numerator, denominator, sampleList, sampleSize, &tmpObj, ScaleRadius(indexNode->GetIndexEntry(idx).Radius), weights);
 
                // is this a qualified subtree?
                if (distance <= range) {
@@ -3568,13 +3836,13 @@ stResult<ObjectType> * tmpl_stSlimTree::AggregateNearestQuery(
                tmpObj.Unserialize(indexNode->GetObject(idx),indexNode->GetObjectSize(idx));
 
                // Evaluate distance
-               distance = AggregateDistanceToSlimNode(numerator, denominator, sampleList, sampleSize, &tmpObj, indexNode->GetIndexEntry(idx).Radius, weights);
+               distance = AggregateDistanceToSlimNode(numerator, denominator, sampleList, sampleSize, &tmpObj, ScaleRadius(indexNode->GetIndexEntry(idx).Radius), weights);
 
                if (distance <= rangeK) {
                //if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius){
                   // Yes! I'm qualified! Put it in the queue.
                   pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-                  pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+                  pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
                   queue->Add(distance, pqTmpValue);
                }//end if
             //}//end if
@@ -3682,9 +3950,9 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::ForwardRangeQueryWithoutPriority(
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
             // test external qualifies.
-            if ( ((distance - indexNode->GetIndexEntry(idx).Radius) <= external ) &&
+            if ( ((distance - ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= external ) &&
                   // test internal qualifies.
-                  (( distance + indexNode->GetIndexEntry(idx).Radius) >= internalRadius) ) {
+                  (( distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internalRadius) ) {
                // Yes! Analyze this subtree.
                this->ForwardRangeQueryWithoutPriority(indexNode->GetIndexEntry(idx).PageID, result,
                                 sample, nObj, internalRadius, external, distance, oid);
@@ -3758,11 +4026,11 @@ void tmpl_stSlimTree::ForwardRangeQueryWithoutPriority(
 
             // use of the triangle inequality to cut a subtree
             // test external qualifies.
-            if ( ( (distanceRepres - indexNode->GetIndexEntry(idx).Distance -
-                    indexNode->GetIndexEntry(idx).Radius ) <= externalRadius ) &&
+            if ( ( (distanceRepres - ScaleRadius(indexNode->GetIndexEntry(idx).Distance) -
+                    ScaleRadius(indexNode->GetIndexEntry(idx).Radius) ) <= externalRadius ) &&
                   // test internal qualifies.
-                  ( (distanceRepres + indexNode->GetIndexEntry(idx).Distance +
-                    indexNode->GetIndexEntry(idx).Radius ) >= internalRadius) ){
+                  ( (distanceRepres + ScaleRadius(indexNode->GetIndexEntry(idx).Distance) +
+                    ScaleRadius(indexNode->GetIndexEntry(idx).Radius) ) >= internalRadius) ){
 
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
@@ -3770,9 +4038,9 @@ void tmpl_stSlimTree::ForwardRangeQueryWithoutPriority(
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                // test external qualifies.
-               if ( (( distance - indexNode->GetIndexEntry(idx).Radius) <= externalRadius) &&
+               if ( (( distance - ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= externalRadius) &&
                      // test internal qualifies.
-                     ((distance + indexNode->GetIndexEntry(idx).Radius) >= internalRadius) ) {
+                     ((distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internalRadius) ) {
                   // Yes! Analyze it!
                   this->ForwardRangeQueryWithoutPriority(indexNode->GetIndexEntry(idx).PageID, result,
                                     sample, nObj, internalRadius, externalRadius, distance, oid);
@@ -3790,9 +4058,9 @@ void tmpl_stSlimTree::ForwardRangeQueryWithoutPriority(
 
             // use of the triangle inequality to cut a subtree
             // test external qualifies.
-             if ( ((distanceRepres - leafNode->GetLeafEntry(idx).Distance) <= externalRadius) &&
+             if ( ((distanceRepres - ScaleRadius(leafNode->GetLeafEntry(idx).Distance)) <= externalRadius) &&
                   // test internal qualifies.
-                  ((distanceRepres + leafNode->GetLeafEntry(idx).Distance) >= internalRadius) ){
+                  ((distanceRepres + ScaleRadius(leafNode->GetLeafEntry(idx).Distance)) >= internalRadius) ){
 
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -3830,8 +4098,9 @@ template <class ObjectType, class EvaluatorType>
 stResultPaged<ObjectType> * tmpl_stSlimTree::ForwardRangeQuery(
         ObjectType * sample, u_int32_t nObj,
         double internalRadius, double externalRadius, long oid){
+   tQueryContext & context = GetQueryContext();
 
-   tDynamicPriorityQueue * queue;
+   tQueryQueue * queue;
    u_int32_t idx;
    stPage * currPage;
    stSlimNode * currNode;
@@ -3856,8 +4125,10 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::ForwardRangeQuery(
       pqCurrValue.PageID = this->GetRoot();
       pqCurrValue.Radius = 0;
 
-      // Create the Global Priority Queue
-      queue = new tDynamicPriorityQueue(STARTVALUEQUEUE, INCREMENTVALUEQUEUE);
+      // The Global Priority Queue of this thread is reused.
+      queue = &context.Queue;
+      queue->Clear();
+      queue->Reserve(STARTVALUEQUEUE);
 
       // Let's search
       while (pqCurrValue.PageID != 0){
@@ -3874,11 +4145,11 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::ForwardRangeQuery(
             for (idx = 0; idx < numberOfEntries; idx++) {
                // use of the triangle inequality to cut a subtree
                // test external qualifies.
-               if (  ((distanceRepres - indexNode->GetIndexEntry(idx).Distance -
-                       indexNode->GetIndexEntry(idx).Radius) <= externalRadius ) &&
+               if (  ((distanceRepres - ScaleRadius(indexNode->GetIndexEntry(idx).Distance) -
+                       ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= externalRadius ) &&
                      // test internal qualifies.
-                     ((distanceRepres + indexNode->GetIndexEntry(idx).Distance +
-                       indexNode->GetIndexEntry(idx).Radius) >= internalRadius) ){
+                     ((distanceRepres + ScaleRadius(indexNode->GetIndexEntry(idx).Distance) +
+                       ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internalRadius) ){
                   // Rebuild the object
                   tmpObj.Unserialize(indexNode->GetObject(idx),
                                      indexNode->GetObjectSize(idx));
@@ -3886,14 +4157,14 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::ForwardRangeQuery(
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
 
                   // test external qualifies.
-                  if (  ((distance - indexNode->GetIndexEntry(idx).Radius) <= externalRadius) &&
+                  if (  ((distance - ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= externalRadius) &&
                         // test internal qualifies.
-                        ((distance + indexNode->GetIndexEntry(idx).Radius) >= internalRadius) ) {
+                        ((distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internalRadius) ) {
 
                      // Yes! I'm qualified! Put it in the queue.
                      pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-                     pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
-                     queue->Add(distance, pqTmpValue);
+                     pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
+                     queue->Push(distance, pqTmpValue);
                   }//end if
                }//end if
             }//end for
@@ -3906,9 +4177,9 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::ForwardRangeQuery(
             for (idx = 0; idx < numberOfEntries; idx++) {
                // use of the triangle inequality to cut a subtree
                // test external qualifies.
-                if ( ((distanceRepres - leafNode->GetLeafEntry(idx).Distance) <= externalRadius ) &&
+                if ( ((distanceRepres - ScaleRadius(leafNode->GetLeafEntry(idx).Distance)) <= externalRadius ) &&
                      // test internal qualifies.
-                     ((distanceRepres + leafNode->GetLeafEntry(idx).Distance) >= internalRadius ) ){
+                     ((distanceRepres + ScaleRadius(leafNode->GetLeafEntry(idx).Distance)) >= internalRadius ) ){
                   // Rebuild the object
                   tmpObj.Unserialize(leafNode->GetObject(idx),
                                      leafNode->GetObjectSize(idx));
@@ -3963,10 +4234,6 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::ForwardRangeQuery(
             }//end if
          }while (!stop);
       }// end while
-      // Release the Global Priority Queue
-      delete queue;
-	  queue = 0;
-
    }// end if
 
    return result;
@@ -4010,9 +4277,9 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::BackwardRangeQueryWithoutPriority(
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
             // test external qualifies.
-            if ( ((distance - indexNode->GetIndexEntry(idx).Radius) <= externalRadius ) &&
+            if ( ((distance - ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= externalRadius ) &&
                  // test internal qualifies.
-                 ((distance + indexNode->GetIndexEntry(idx).Radius) >= internal) ) {
+                 ((distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internal) ) {
                // Yes! Analyze this subtree.
                this->BackwardRangeQueryWithoutPriority(indexNode->GetIndexEntry(idx).PageID, result,
                                 sample, nObj, internal, externalRadius, distance, oid);
@@ -4086,11 +4353,11 @@ void tmpl_stSlimTree::BackwardRangeQueryWithoutPriority(
 
             // use of the triangle inequality to cut a subtree
             // test external qualifies.
-            if ( (( distanceRepres - indexNode->GetIndexEntry(idx).Distance -
-                    indexNode->GetIndexEntry(idx).Radius) <= externalRadius) &&
+            if ( (( distanceRepres - ScaleRadius(indexNode->GetIndexEntry(idx).Distance) -
+                    ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= externalRadius) &&
                   // test internal qualifies.
-                  ((distanceRepres + indexNode->GetIndexEntry(idx).Distance +
-                    indexNode->GetIndexEntry(idx).Radius) >= internalRadius) ){
+                  ((distanceRepres + ScaleRadius(indexNode->GetIndexEntry(idx).Distance) +
+                    ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internalRadius) ){
 
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
@@ -4098,9 +4365,9 @@ void tmpl_stSlimTree::BackwardRangeQueryWithoutPriority(
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                // test external qualifies.
-               if (  ((distance - indexNode->GetIndexEntry(idx).Radius) <= externalRadius) &&
+               if (  ((distance - ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= externalRadius) &&
                      // test internal qualifies.
-                     ((distance + indexNode->GetIndexEntry(idx).Radius) >= internalRadius) ) {
+                     ((distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internalRadius) ) {
                   // Yes! Analyze it!
                   this->BackwardRangeQueryWithoutPriority(indexNode->GetIndexEntry(idx).PageID, result,
                                     sample, nObj, internalRadius, externalRadius, distance, oid);
@@ -4118,9 +4385,9 @@ void tmpl_stSlimTree::BackwardRangeQueryWithoutPriority(
 
             // use of the triangle inequality to cut a subtree
             // test external qualifies.
-             if ( ((distanceRepres - leafNode->GetLeafEntry(idx).Distance) <= externalRadius) &&
+             if ( ((distanceRepres - ScaleRadius(leafNode->GetLeafEntry(idx).Distance)) <= externalRadius) &&
                   // test internal qualifies.
-                  ((distanceRepres + leafNode->GetLeafEntry(idx).Distance) >= internalRadius) ){
+                  ((distanceRepres + ScaleRadius(leafNode->GetLeafEntry(idx).Distance)) >= internalRadius) ){
 
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -4201,11 +4468,11 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::BackwardRangeQuery(
             for (idx = 0; idx < numberOfEntries; idx++) {
                // use of the triangle inequality to cut a subtree
                // test external qualifies.
-               if (  ((distanceRepres - indexNode->GetIndexEntry(idx).Distance -
-                     indexNode->GetIndexEntry(idx).Radius) <= externalRadius) &&
+               if (  ((distanceRepres - ScaleRadius(indexNode->GetIndexEntry(idx).Distance) -
+                     ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= externalRadius) &&
                      // test internal qualifies.
-                     ((distanceRepres + indexNode->GetIndexEntry(idx).Distance +
-                     indexNode->GetIndexEntry(idx).Radius) >= internalRadius) ){
+                     ((distanceRepres + ScaleRadius(indexNode->GetIndexEntry(idx).Distance) +
+                     ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internalRadius) ){
                   // Rebuild the object
                   tmpObj.Unserialize(indexNode->GetObject(idx),
                                      indexNode->GetObjectSize(idx));
@@ -4213,12 +4480,12 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::BackwardRangeQuery(
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
 
                   // test external qualifies.
-                  if (  ((distance - indexNode->GetIndexEntry(idx).Radius) <= externalRadius) &&
+                  if (  ((distance - ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) <= externalRadius) &&
                         // test internal qualifies.
-                        ((distance + indexNode->GetIndexEntry(idx).Radius) >= internalRadius) ) {
+                        ((distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) >= internalRadius) ) {
                      // Yes! I'm qualified! Put it in the queue.
                      pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-                     pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+                     pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
                      queue->Add(distance, pqTmpValue);
                   }//end if
                }//end if
@@ -4232,9 +4499,9 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::BackwardRangeQuery(
             for (idx = 0; idx < numberOfEntries; idx++) {
                // use of the triangle inequality to cut a subtree
                // test external qualifies.
-               if (  ((distanceRepres - leafNode->GetLeafEntry(idx).Distance) <= externalRadius) &&
+               if (  ((distanceRepres - ScaleRadius(leafNode->GetLeafEntry(idx).Distance)) <= externalRadius) &&
                      // test internal qualifies.
-                     ((distanceRepres + leafNode->GetLeafEntry(idx).Distance) >= internalRadius) ){
+                     ((distanceRepres + ScaleRadius(leafNode->GetLeafEntry(idx).Distance)) >= internalRadius) ){
                   // Rebuild the object
                   tmpObj.Unserialize(leafNode->GetObject(idx),
                                      leafNode->GetObjectSize(idx));
@@ -4301,12 +4568,14 @@ stResultPaged<ObjectType> * tmpl_stSlimTree::BackwardRangeQuery(
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
-            ObjectType * sample, double range){
+            ObjectType * sample, double range, stQueryStats * stats){
+   tQueryContext & context = GetQueryContext();
    tResult * result = new tResult();  // Create result
+   tQueryStart start;
    stPage * currPage;
    stSlimNode * currNode;
    ObjectType tmpObj;
-   u_int32_t idx, numberOfEntries;
+   u_int32_t idx, block, numberOfEntries;
    double distance;
    #ifdef __stMAMVIEW__
       stMessageString title;
@@ -4315,6 +4584,8 @@ stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
 
    // Set the information.
    result->SetQueryInfo((ObjectType*) sample->Clone(), RANGEQUERY, -1, range, false);
+   BeginQueryStats(stats, start);
+   GetQueryFields(sample, context.Fields);
 
    // Visualization support
    #ifdef __stMAMVIEW__
@@ -4332,8 +4603,7 @@ stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
       // Read node...
       currPage = tMetricTree::myPageManager->GetPage(this->GetRoot());
       currNode = stSlimNode::CreateNode(currPage);
-
-
+      CountNodeRead(stats, 0);
 
       // Is it an Index node?
       if (currNode->GetNodeType() == stSlimNode::INDEX){
@@ -4363,15 +4633,18 @@ stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
          // For each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // Rebuild the object
-            tmpObj.Unserialize(indexNode->GetObject(idx),
+            LoadObject(tmpObj, indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+            distance = this->GetBoundedDistance(tmpObj, *sample,
+                  range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius));
             // test if this subtree qualifies.
-            if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
+            if (distance <= range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Yes! Analyze this subtree.
                this->RangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
-                                sample, range, distance);
+                                sample, range, distance, 1, stats);
+            }else{
+               CountCoveringPruned(stats);
             }//end if
          }//end for
          
@@ -4394,19 +4667,35 @@ stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
          
-         // For each entry...
-         for (idx = 0; idx < numberOfEntries; idx++) {
-            // Rebuild the object
-            tmpObj.Unserialize(leafNode->GetObject(idx),
-                               leafNode->GetObjectSize(idx));
-            // Evaluate distance
-            distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
-            // is it a object that qualified?
-            if (distance <= range){
-               // Yes! Put it in the result set.
-               result->AddPair((ObjectType*) tmpObj.Clone(), distance);
-            }//end if
-         }//end for
+         // For each block of entries...
+         idx = 0;
+         while (idx < numberOfEntries){
+            context.BlockEntries.clear();
+            while ((idx < numberOfEntries) && (context.BlockEntries.size() < DISTANCEBLOCK)){
+               // use of the global pivots.
+               if (FieldLowerBound(leafNode, idx, context.Fields) > range){
+                  CountPivotPruned(stats);
+               }else{
+                  // Rebuild the object
+                  LoadObject(*AddBlockEntry(context, idx), leafNode->GetObject(idx),
+                                                  leafNode->GetObjectSize(idx));
+               }//end if
+               idx++;
+            }//end while
+            // Evaluate their distances at once.
+            EvaluateBlock(context, sample, range);
+
+            for (block = 0; block < context.BlockEntries.size(); block++){
+               distance = context.BlockDistances[block];
+               // is it a object that qualified?
+               if (distance <= range){
+                  // Yes! Put it in the result set.
+                  result->AddPair((ObjectType*) context.BlockObjects[block]->Clone(), distance);
+               }else{
+                  CountCoveringPruned(stats);
+               }//end if
+            }//end for
+         }//end while
       }//end else
 
       // Free it all
@@ -4428,40 +4717,203 @@ stResult<ObjectType> * tmpl_stSlimTree::RangeQuery(
       MAMViewer->EndFrame();
       MAMViewer->EndAnimation();
    #endif //__stMAMVIEW__
+   EndQueryStats(stats, start);
    return result;
 }//end stSlimTree<ObjectType, EvaluatorType>::RangeQuery
 
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
-void tmpl_stSlimTree::RangeQuery(
-         u_int32_t pageID, tResult * result, ObjectType * sample,
-         double range, double distanceRepres){
+void tmpl_stSlimTree::RangeQuery(ObjectType ** samples, u_int32_t n,
+         double range, tResult ** results, stQueryStats * stats){
+   std::vector <stQueryVisit> level;
+   std::vector <stQueryVisit> nextLevel;
+   stQueryVisit visit;
    stPage * currPage;
    stSlimNode * currNode;
-   ObjectType tmpObj;
-   double distance;
-   u_int32_t idx;
-   u_int32_t numberOfEntries;
-   #ifdef __stMAMVIEW__
-      stMessageString comment;
-   #endif //__stMAMVIEW__
+   ObjectType entry;
+   std::vector <std::vector <double> > fields(n);
+   std::vector <u_int32_t> active;
+   std::vector <ObjectType *> activeSamples;
+   std::vector <double> distances;
+   double bound;
+   u_int32_t idx, numberOfEntries;
+   u_int32_t first, last, i, j;
+   tQueryStart start;
 
-   // Let's search
-   if (pageID != 0){
-      // Read node...
-      currPage = tMetricTree::myPageManager->GetPage(pageID);
-      currNode = stSlimNode::CreateNode(currPage);
-      // Is it an Index node?
-      if (currNode->GetNodeType() == stSlimNode::INDEX) {
-         // Get Index node
-         stSlimIndexNode * indexNode = (stSlimIndexNode *)currNode;
-         numberOfEntries = indexNode->GetNumberOfEntries();
+   // Set the information.
+   for (i = 0; i < n; i++){
+      results[i] = new tResult();
+      results[i]->SetQueryInfo((ObjectType*) samples[i]->Clone(), RANGEQUERY,
+                               -1, range, false);
+   }//end for
+   BeginQueryStats(stats, start);
+   for (i = 0; i < n; i++){
+      GetQueryFields(samples[i], fields[i]);
+   }//end for
 
-         // Visualization support
-         #ifdef __stMAMVIEW__
-            MAMViewer->LevelUp();
-            comment.Clear();
-            comment.Append("Entering in the index node ");
+   // All queries start at the root.
+   if (this->GetRoot() != 0){
+      visit.PageID = this->GetRoot();
+      visit.Level = 0;
+      visit.DistanceRepres = 0;
+      for (i = 0; i < n; i++){
+         visit.Query = i;
+         level.push_back(visit);
+      }//end for
+   }//end if
+
+   // A node has a single parent, so all visits of a node are in the same level.
+   while (!level.empty()){
+      std::sort(level.begin(), level.end());
+      nextLevel.clear();
+      for (first = 0; first < level.size(); first = last){
+         // The visits of this node.
+         last = first + 1;
+         while ((last < level.size()) && (level[last].PageID == level[first].PageID)){
+            last++;
+         }//end while
+
+         // Read node...
+         currPage = tMetricTree::myPageManager->GetPage(level[first].PageID);
+         currNode = stSlimNode::CreateNode(currPage);
+         CountNodeRead(stats, level[first].Level);
+
+         // Is it an Index node?
+         if (currNode->GetNodeType() == stSlimNode::INDEX){
+            // Get Index node
+            stSlimIndexNode * indexNode = (stSlimIndexNode *)currNode;
+            numberOfEntries = indexNode->GetNumberOfEntries();
+
+            // For each entry...
+            for (idx = 0; idx < numberOfEntries; idx++){
+               bound = range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
+               // ...the queries that may reach this subtree.
+               active.clear();
+               activeSamples.clear();
+               for (i = first; i < last; i++){
+                  // use of the triangle inequality to cut a subtree
+                  if (ParentLowerBound(level[i].DistanceRepres,
+                        indexNode->GetIndexEntry(idx).Distance) <= bound){
+                     active.push_back(i);
+                     activeSamples.push_back(samples[level[i].Query]);
+                  }else{
+                     CountParentPruned(stats);
+                  }//end if
+               }//end for
+               if (active.empty()){
+                  continue;
+               }//end if
+
+               // Rebuild the object and evaluate it against these queries.
+               LoadObject(entry, indexNode->GetObject(idx),
+                                 indexNode->GetObjectSize(idx));
+               distances.resize(active.size());
+               this->GetBoundedDistances(entry, activeSamples.data(),
+                     active.size(), distances.data(), bound);
+               for (j = 0; j < active.size(); j++){
+                  // is this a qualified subtree?
+                  if (distances[j] <= bound){
+                     visit.PageID = indexNode->GetIndexEntry(idx).PageID;
+                     visit.Query = level[active[j]].Query;
+                     visit.Level = level[active[j]].Level + 1;
+                     visit.DistanceRepres = distances[j];
+                     nextLevel.push_back(visit);
+                  }else{
+                     CountCoveringPruned(stats);
+                  }//end if
+               }//end for
+            }//end for
+         }else{
+            // No, it is a leaf node. Get it.
+            stSlimLeafNode * leafNode = (stSlimLeafNode *)currNode;
+            numberOfEntries = leafNode->GetNumberOfEntries();
+
+            // For each entry...
+            for (idx = 0; idx < numberOfEntries; idx++){
+               // ...the queries that may reach this object.
+               active.clear();
+               activeSamples.clear();
+               for (i = first; i < last; i++){
+                  // use of the triangle inequality and of the global pivots
+                  // to cut an object
+                  if (ParentLowerBound(level[i].DistanceRepres,
+                        leafNode->GetLeafEntry(idx).Distance) > range){
+                     CountParentPruned(stats);
+                  }else if (FieldLowerBound(leafNode, idx,
+                        fields[level[i].Query]) > range){
+                     CountPivotPruned(stats);
+                  }else{
+                     active.push_back(i);
+                     activeSamples.push_back(samples[level[i].Query]);
+                  }//end if
+               }//end for
+               if (active.empty()){
+                  continue;
+               }//end if
+
+               // Rebuild the object and evaluate it against these queries.
+               LoadObject(entry, leafNode->GetObject(idx),
+                                 leafNode->GetObjectSize(idx));
+               distances.resize(active.size());
+               this->GetBoundedDistances(entry, activeSamples.data(),
+                     active.size(), distances.data(), range);
+               for (j = 0; j < active.size(); j++){
+                  // is it a object that qualified?
+                  if (distances[j] <= range){
+                     // Yes! Put it in the result set.
+                     results[level[active[j]].Query]->AddPair(
+                           (ObjectType*) entry.Clone(), distances[j]);
+                  }else{
+                     CountCoveringPruned(stats);
+                  }//end if
+               }//end for
+            }//end for
+         }//end if
+
+         // Free it all
+         delete currNode;
+         currNode = 0;
+         tMetricTree::myPageManager->ReleasePage(currPage);
+      }//end for
+      level.swap(nextLevel);
+   }//end while
+   EndQueryStats(stats, start);
+}//end stSlimTree<ObjectType, EvaluatorType>::RangeQuery
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::RangeQuery(
+         u_int32_t pageID, tResult * result, ObjectType * sample,
+         double range, double distanceRepres, u_int32_t level,
+         stQueryStats * stats){
+   tQueryContext & context = GetQueryContext();
+   stPage * currPage;
+   stSlimNode * currNode;
+   ObjectType tmpObj;
+   double distance;
+   u_int32_t idx, block;
+   u_int32_t numberOfEntries;
+   #ifdef __stMAMVIEW__
+      stMessageString comment;
+   #endif //__stMAMVIEW__
+
+   // Let's search
+   if (pageID != 0){
+      // Read node...
+      currPage = tMetricTree::myPageManager->GetPage(pageID);
+      currNode = stSlimNode::CreateNode(currPage);
+      CountNodeRead(stats, level);
+      // Is it an Index node?
+      if (currNode->GetNodeType() == stSlimNode::INDEX) {
+         // Get Index node
+         stSlimIndexNode * indexNode = (stSlimIndexNode *)currNode;
+         numberOfEntries = indexNode->GetNumberOfEntries();
+
+         // Visualization support
+         #ifdef __stMAMVIEW__
+            MAMViewer->LevelUp();
+            comment.Clear();
+            comment.Append("Entering in the index node ");
             comment.Append((int) pageID);
             comment.Append(" at level ");
             comment.Append((int)  MAMViewer->GetLevel());
@@ -4482,18 +4934,19 @@ void tmpl_stSlimTree::RangeQuery(
          // For each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // use of the triangle inequality to cut a subtree
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      range + indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
-               tmpObj.Unserialize(indexNode->GetObject(idx),
+               LoadObject(tmpObj, indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+               distance = this->GetBoundedDistance(tmpObj, *sample,
+                     range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius));
                // is this a qualified subtree?
-               if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
+               if (distance <= range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                   // Yes! Analyze it!
                   this->RangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
-                                    sample, range, distance);
+                                    sample, range, distance, level + 1, stats);
                   #ifdef __stMAMVIEW__
                      comment.Clear();
                      comment.Append("Returning to the index node ");
@@ -4504,7 +4957,11 @@ void tmpl_stSlimTree::RangeQuery(
                      MAMViewer->EnableNode(pageID);
                      MAMViewer->EndFrame();
                   #endif //__stMAMVIEW__
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
+            }else{
+               CountParentPruned(stats);
             }//end if
          }//end for
 
@@ -4535,23 +4992,39 @@ void tmpl_stSlimTree::RangeQuery(
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
          
-         // for each entry...
-         for (idx = 0; idx < numberOfEntries; idx++) {
-            // use of the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
-                      range){
-               // Rebuild the object
-               tmpObj.Unserialize(leafNode->GetObject(idx),
-                                  leafNode->GetObjectSize(idx));
-               // No, it is not a representative. Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+         // for each block of entries...
+         idx = 0;
+         while (idx < numberOfEntries){
+            context.BlockEntries.clear();
+            while ((idx < numberOfEntries) && (context.BlockEntries.size() < DISTANCEBLOCK)){
+               // use of the triangle inequality.
+               if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) >
+                         range){
+                  CountParentPruned(stats);
+               }else if (FieldLowerBound(leafNode, idx, context.Fields) > range){
+                  // Cut by the global pivots.
+                  CountPivotPruned(stats);
+               }else{
+                  // Rebuild the object
+                  LoadObject(*AddBlockEntry(context, idx), leafNode->GetObject(idx),
+                                                  leafNode->GetObjectSize(idx));
+               }//end if
+               idx++;
+            }//end while
+            // Evaluate their distances at once.
+            EvaluateBlock(context, sample, range);
+
+            for (block = 0; block < context.BlockEntries.size(); block++){
+               distance = context.BlockDistances[block];
                // Is this a qualified object?
                if (distance <= range){
                   // Yes! Put it in the result set.
-                  result->AddPair((ObjectType*) tmpObj.Clone(), distance);
+                  result->AddPair((ObjectType*) context.BlockObjects[block]->Clone(), distance);
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
-            }//end if
-         }//end for
+            }//end for
+         }//end while
 
          #ifdef __stMAMVIEW__
             comment.Clear();
@@ -4609,7 +5082,7 @@ stResult<ObjectType> * tmpl_stSlimTree::ReversedRangeQuery(
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
             // test if this subtree qualifies.
-            if (distance + indexNode->GetIndexEntry(idx).Radius >= range){
+            if (distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius) >= range){
                // Yes! Analyze this subtree.
                this->ReversedRangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
                                         sample, range, distance);
@@ -4671,15 +5144,15 @@ void tmpl_stSlimTree::ReversedRangeQuery(
          // For each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if (distanceRepres + indexNode->GetIndexEntry(idx).Distance +
-                indexNode->GetIndexEntry(idx).Radius >= range){
+            if (distanceRepres + ScaleRadius(indexNode->GetIndexEntry(idx).Distance) +
+                ScaleRadius(indexNode->GetIndexEntry(idx).Radius) >= range){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                // is this a qualified subtree?
-               if (distance + indexNode->GetIndexEntry(idx).Radius >= range){
+               if (distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius) >= range){
                   // Yes! Analyze it!
                   this->ReversedRangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
                                            sample, range, distance);
@@ -4694,7 +5167,7 @@ void tmpl_stSlimTree::ReversedRangeQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if (distanceRepres + leafNode->GetLeafEntry(idx).Distance >= range){
+            if (distanceRepres + ScaleRadius(leafNode->GetLeafEntry(idx).Distance) >= range){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
@@ -4756,10 +5229,10 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalNearestQuery(
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
             // Is this a qualified subtree?
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius){
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Yes! Put it in the queue.
                queue->Add(distance, idx);
-               this->sumOperationsQueue++;  // Update the statistics for the queue
+               this->UpdateQueueStatistics();  // Update the statistics for the queue
             }//end if
          }//end for
 
@@ -4768,9 +5241,9 @@ stResult<ObjectType> * tmpl_stSlimTree::LocalNearestQuery(
             
          // Search...
          while (queue->Get(distance, pid)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Will qualify ?
-            if (distance <= rangeK + indexNode->GetIndexEntry(pid).Radius){
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(pid).Radius)){
                // Yes! Analyze it recursively.
                this->LocalNearestQuery(indexNode->GetIndexEntry(pid).PageID, result,
                                        sample, rangeK, k, distance);
@@ -4845,18 +5318,18 @@ void tmpl_stSlimTree::LocalNearestQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      rangeK + indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                // Is it a qualified subtree?
-               if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius){
+               if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                   // Yes! Put it in the queue.
                   queue->Add(distance, idx);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end if
             }//end if
          }//end for
@@ -4865,9 +5338,9 @@ void tmpl_stSlimTree::LocalNearestQuery(
             this->maxQueue = queue->GetSize();
          // Search...
          while (queue->Get(distance, pid)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Will qualify ?
-            if (distance <= rangeK + indexNode->GetIndexEntry(pid).Radius){
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(pid).Radius)){
                // Yes! Analyze it.
                this->LocalNearestQuery(indexNode->GetIndexEntry(pid).PageID, result,
                                   sample, rangeK, k, distance);
@@ -4885,13 +5358,13 @@ void tmpl_stSlimTree::LocalNearestQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
                       rangeK){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
                // is it a Representative?
-               if (leafNode->GetLeafEntry(idx).Distance != 0) {
+               if (ScaleRadius(leafNode->GetLeafEntry(idx).Distance) != 0) {
                   // No, it is not a representative. Evaluate distance
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                }else{
@@ -4973,8 +5446,8 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
             distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
             // Put the Node in the Queue.
             globalQueue->Add(tmpObj.Clone(), indexNode->GetIndexEntry(idx).PageID, distance,
-                             indexNode->GetIndexEntry(idx).Radius, tGenericEntry::NODE);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+                             ScaleRadius(indexNode->GetIndexEntry(idx).Radius), tGenericEntry::NODE);
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
          }//end for
       }else{
          // No, it is a leaf node. Get it.
@@ -5010,7 +5483,7 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
 
       do{
          entryNode = globalQueue->Get();
-         this->sumOperationsQueue++;  // Update the statistics for the queue
+         this->UpdateQueueStatistics();  // Update the statistics for the queue
          // Read node...
          currPage = tMetricTree::myPageManager->GetPage(entryNode->GetPageID());
          currNode = stSlimNode::CreateNode(currPage);
@@ -5024,8 +5497,8 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
             // Put the Children in the global priority queue.
             for (idx = 0; idx < numberOfEntries; idx++) {
                // try to cut this subtree with the triangle inequality.
-               if ( fabs(entryNode->GetDistanceRepQuery() - indexNode->GetIndexEntry(idx).Distance) <=
-                         rangeK + indexNode->GetIndexEntry(idx).Radius){
+               if ( ParentLowerBound(entryNode->GetDistanceRepQuery(), indexNode->GetIndexEntry(idx).Distance) <=
+                         rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                   // Rebuild the object
                   tmpObj.Unserialize(indexNode->GetObject(idx),
                                      indexNode->GetObjectSize(idx));
@@ -5033,9 +5506,9 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                   // add in the priority queue.
                   globalQueue->Add(tmpObj.Clone(), indexNode->GetIndexEntry(idx).PageID,
-                                   distance, indexNode->GetIndexEntry(idx).Radius,
+                                   distance, ScaleRadius(indexNode->GetIndexEntry(idx).Radius),
                                    tGenericEntry::NODE);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end if
             }//end for
          }else{
@@ -5045,7 +5518,7 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
             // for each entry...
             for (idx = 0; idx < numberOfEntries; idx++) {
                // try to cut this object with the triangle inequality.
-               if ( fabs(entryNode->GetDistanceRepQuery() - leafNode->GetLeafEntry(idx).Distance) <=
+               if ( ParentLowerBound(entryNode->GetDistanceRepQuery(), leafNode->GetLeafEntry(idx).Distance) <=
                          rangeK){
                   // Rebuild the object
                   tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -5089,8 +5562,9 @@ void stSlimTree<ObjectType, EvaluatorType>::ListNearestQuery(tResult * result,
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::NearestQuery(
-      ObjectType * sample, u_int32_t k, bool tie){
+      ObjectType * sample, u_int32_t k, bool tie, stQueryStats * stats){
    tResult * result = new tResult();  // Create result
+   tQueryStart start;
    #ifdef __stMAMVIEW__
       stMessageString title;
       stMessageString comment;
@@ -5098,6 +5572,7 @@ stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::NearestQuery(
 
    // Set information for this query
    result->SetQueryInfo((ObjectType*) sample->Clone(), KNEARESTQUERY, k, MAXDOUBLE, tie);
+   BeginQueryStats(stats, start);
 
    #ifdef __stMAMVIEW__
       MAMViewer->SetQueryInfo(k, 0);
@@ -5111,7 +5586,7 @@ stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::NearestQuery(
 
    // Let's search
    if (this->GetRoot() != 0){
-      this->NearestQuery(result, sample, MAXDOUBLE, k);
+      this->NearestQuery(result, sample, MAXDOUBLE, k, stats);
    }//end if
 
    // Visualization support
@@ -5128,15 +5603,227 @@ stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::NearestQuery(
       MAMViewer->EndAnimation();
    #endif //__stMAMVIEW__
 
+   EndQueryStats(stats, start);
    return result;
 }//end stSlimTree<ObjectType, EvaluatorType>::NearestQuery
 
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(ObjectType ** samples,
+         u_int32_t n, u_int32_t k, tResult ** results, bool tie,
+         stQueryStats * stats){
+   tQueryContext & context = GetQueryContext();
+   std::vector <double> rangeK(n, MAXDOUBLE);
+   std::vector <stQueryVisit> round;
+   stQueryVisit visit;
+   stPage * currPage;
+   stSlimNode * currNode;
+   ObjectType entry;
+   std::vector <std::vector <double> > fields(n);
+   std::vector <u_int32_t> active;
+   std::vector <ObjectType *> activeSamples;
+   std::vector <double> distances;
+   double distance, bound;
+   bool stop;
+   stQueryPriorityQueueValue pqCurrValue;
+   stQueryPriorityQueueValue pqTmpValue;
+   u_int32_t idx, numberOfEntries;
+   u_int32_t first, last, i, j, q;
+   tQueryStart start;
+
+   // Set information for these queries
+   for (q = 0; q < n; q++){
+      results[q] = new tResult();
+      results[q]->SetQueryInfo((ObjectType*) samples[q]->Clone(), KNEARESTQUERY,
+                               k, MAXDOUBLE, tie);
+   }//end for
+   BeginQueryStats(stats, start);
+   for (q = 0; q < n; q++){
+      GetQueryFields(samples[q], fields[q]);
+   }//end for
+   if (context.BatchTopK.size() < n){
+      context.BatchTopK.resize(n);
+      context.BatchQueues.resize(n);
+   }//end if
+   for (q = 0; q < n; q++){
+      context.BatchTopK[q].Reset(k, tie);
+      context.BatchQueues[q].Clear();
+      context.BatchQueues[q].Reserve(STARTVALUEQUEUE);
+   }//end for
+
+   // All queries start at the root.
+   if (this->GetRoot() != 0){
+      visit.PageID = this->GetRoot();
+      visit.Level = 0;
+      visit.DistanceRepres = 0;
+      for (q = 0; q < n; q++){
+         visit.Query = q;
+         round.push_back(visit);
+      }//end for
+   }//end if
+
+   // Each round visits the next node of each query.
+   while (!round.empty()){
+      std::sort(round.begin(), round.end());
+      for (first = 0; first < round.size(); first = last){
+         // The visits of this node.
+         last = first + 1;
+         while ((last < round.size()) && (round[last].PageID == round[first].PageID)){
+            last++;
+         }//end while
+
+         // Read node...
+         currPage = tMetricTree::myPageManager->GetPage(round[first].PageID);
+         currNode = stSlimNode::CreateNode(currPage);
+         CountNodeRead(stats, round[first].Level);
+         // Is it a Index node?
+         if (currNode->GetNodeType() == stSlimNode::INDEX) {
+            // Get Index node
+            stSlimIndexNode * indexNode = (stSlimIndexNode *)currNode;
+            numberOfEntries = indexNode->GetNumberOfEntries();
+
+            // for each entry...
+            for (idx = 0; idx < numberOfEntries; idx++) {
+               // ...the queries that may reach this subtree.
+               active.clear();
+               activeSamples.clear();
+               bound = 0;
+               for (i = first; i < last; i++){
+                  q = round[i].Query;
+                  // try to cut this subtree with the triangle inequality.
+                  if (ParentLowerBound(round[i].DistanceRepres,
+                        indexNode->GetIndexEntry(idx).Distance) <=
+                        rangeK[q] + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
+                     active.push_back(i);
+                     activeSamples.push_back(samples[q]);
+                     bound = std::max(bound, rangeK[q] +
+                           ScaleRadius(indexNode->GetIndexEntry(idx).Radius));
+                  }else{
+                     CountParentPruned(stats);
+                  }//end if
+               }//end for
+               if (active.empty()){
+                  continue;
+               }//end if
+
+               // Rebuild the object and evaluate it against these queries.
+               LoadObject(entry, indexNode->GetObject(idx),
+                                 indexNode->GetObjectSize(idx));
+               distances.resize(active.size());
+               this->GetBoundedDistances(entry, activeSamples.data(),
+                     active.size(), distances.data(), bound);
+               for (j = 0; j < active.size(); j++){
+                  q = round[active[j]].Query;
+                  if (distances[j] <= rangeK[q] + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
+                     // Yes! I'm qualified! Put it in the queue.
+                     pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
+                     pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
+                     pqTmpValue.Level = round[active[j]].Level + 1;
+                     context.BatchQueues[q].Push(distances[j], pqTmpValue);
+                     this->UpdateQueueStatistics();  // Update the statistics for the queue
+                  }else{
+                     CountCoveringPruned(stats);
+                  }//end if
+               }//end for
+            }//end for
+         }else{
+            // No, it is a leaf node. Get it.
+            stSlimLeafNode * leafNode = (stSlimLeafNode *)currNode;
+            numberOfEntries = leafNode->GetNumberOfEntries();
+
+            // for each entry...
+            for (idx = 0; idx < numberOfEntries; idx++) {
+               // ...the queries that may want this object.
+               active.clear();
+               activeSamples.clear();
+               bound = 0;
+               for (i = first; i < last; i++){
+                  q = round[i].Query;
+                  // try to cut this object with the triangle inequality and
+                  // with the global pivots.
+                  if (ParentLowerBound(round[i].DistanceRepres,
+                        leafNode->GetLeafEntry(idx).Distance) > rangeK[q]){
+                     CountParentPruned(stats);
+                  }else if (FieldLowerBound(leafNode, idx, fields[q]) > rangeK[q]){
+                     CountPivotPruned(stats);
+                  }else{
+                     active.push_back(i);
+                     activeSamples.push_back(samples[q]);
+                     bound = std::max(bound, rangeK[q]);
+                  }//end if
+               }//end for
+               if (active.empty()){
+                  continue;
+               }//end if
+
+               // Rebuild the object and evaluate it against these queries.
+               LoadObject(entry, leafNode->GetObject(idx),
+                                 leafNode->GetObjectSize(idx));
+               distances.resize(active.size());
+               this->GetBoundedDistances(entry, activeSamples.data(),
+                     active.size(), distances.data(), bound);
+               for (j = 0; j < active.size(); j++){
+                  q = round[active[j]].Query;
+                  //test if the object qualify
+                  if (distances[j] <= rangeK[q]){
+                     // Keep the serialized object. It is rebuilt at the end.
+                     if (context.BatchTopK[q].Add(leafNode->GetObject(idx),
+                           leafNode->GetObjectSize(idx), distances[j]) &&
+                           context.BatchTopK[q].IsFull()){
+                        //may I use this for performance?
+                        rangeK[q] = context.BatchTopK[q].GetMaximumDistance();
+                     }//end if
+                  }else{
+                     CountCoveringPruned(stats);
+                  }//end if
+               }//end for
+            }//end for
+         }//end else
+
+         // Free it all
+         delete currNode;
+         currNode = 0;
+         tMetricTree::myPageManager->ReleasePage(currPage);
+      }//end for
+
+      // Go to the next node of each query.
+      last = 0;
+      for (i = 0; i < round.size(); i++){
+         q = round[i].Query;
+         if (context.BatchQueues[q].GetSize() > this->maxQueue)
+            this->maxQueue = context.BatchQueues[q].GetSize();
+         CountQueueSize(stats, context.BatchQueues[q].GetSize());
+         stop = false;
+         while (!stop && context.BatchQueues[q].Get(distance, pqCurrValue)){
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
+            // Qualified if distance <= rangeK + radius
+            if (distance <= rangeK[q] + pqCurrValue.Radius){
+               round[last].PageID = pqCurrValue.PageID;
+               round[last].Query = q;
+               round[last].Level = pqCurrValue.Level;
+               round[last].DistanceRepres = distance;
+               last++;
+               stop = true;
+            }//end if
+         }//end while
+      }//end for
+      round.resize(last);
+   }//end while
+
+   // Build the results.
+   for (q = 0; q < n; q++){
+      context.BatchTopK[q].Materialize(results[q]);
+   }//end for
+   EndQueryStats(stats, start);
+}//end stSlimTree<ObjectType, EvaluatorType>::NearestQuery
+
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
-         ObjectType * sample, double rangeK, u_int32_t k){
-   tDynamicPriorityQueue * queue;
-   u_int32_t idx;
+         ObjectType * sample, double rangeK, u_int32_t k, stQueryStats * stats){
+   tQueryContext & context = GetQueryContext();
+   tQueryQueue * queue;
+   u_int32_t idx, block, entry;
    stPage * currPage;
    stSlimNode * currNode;
    ObjectType tmpObj;
@@ -5150,22 +5837,29 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
       stMessageString comment;
    #endif //__stMAMVIEW__   
 
+   // Distances to the global pivots
+   GetQueryFields(sample, context.Fields);
+   context.TopK.Reset(k, result->GetTie());
+
    // Root node
    pqCurrValue.PageID = this->GetRoot();
+   pqCurrValue.Level = 0;
    pqCurrValue.Radius = 0;
    #ifdef __stMAMVIEW__
       pqCurrValue.Parent = -1;
-      pqCurrValue.Level = 0;
    #endif //__stMAMVIEW__
    
-   // Create the Global Priority Queue
-   queue = new tDynamicPriorityQueue(STARTVALUEQUEUE, INCREMENTVALUEQUEUE);
+   // The Global Priority Queue of this thread is reused.
+   queue = &context.Queue;
+   queue->Clear();
+   queue->Reserve(STARTVALUEQUEUE);
 
    // Let's search
    while (pqCurrValue.PageID != 0){
       // Read node...
       currPage = tMetricTree::myPageManager->GetPage(pqCurrValue.PageID);
       currNode = stSlimNode::CreateNode(currPage);
+      CountNodeRead(stats, pqCurrValue.Level);
       // Is it a Index node?
       if (currNode->GetNodeType() == stSlimNode::INDEX) {
          // Get Index node
@@ -5195,30 +5889,44 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
          
-         // for each entry...
-         for (idx = 0; idx < numberOfEntries; idx++) {
-            // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      rangeK + indexNode->GetIndexEntry(idx).Radius){
-               // Rebuild the object
-               tmpObj.Unserialize(indexNode->GetObject(idx),
-                                  indexNode->GetObjectSize(idx));
-               // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
-
-               if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius){
-                  // Yes! I'm qualified! Put it in the queue.
-                  pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-                  pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+         // for each block of entries...
+         idx = 0;
+         while (idx < numberOfEntries){
+            // Gather the entries not cut by the triangle inequality.
+            context.BlockEntries.clear();
+            while ((idx < numberOfEntries) && (context.BlockEntries.size() < DISTANCEBLOCK)){
+               if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                         rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
+                  // Rebuild the object
+                  LoadObject(*AddBlockEntry(context, idx), indexNode->GetObject(idx),
+                                                  indexNode->GetObjectSize(idx));
+               }else{
+                  CountParentPruned(stats);
+               }//end if
+               idx++;
+            }//end while
+            // Evaluate their distances at once.
+            EvaluateBlock(context, sample, rangeK + GetBlockRadius(context, indexNode));
+
+            for (block = 0; block < context.BlockEntries.size(); block++){
+               entry = context.BlockEntries[block];
+               distance = context.BlockDistances[block];
+               if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(entry).Radius)){
+                  // Yes! I'm qualified! Put it in the queue. The children
+                  // of this node are ordered at once by the next Get().
+                  pqTmpValue.PageID = indexNode->GetIndexEntry(entry).PageID;
+                  pqTmpValue.Level = pqCurrValue.Level + 1;
+                  pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(entry).Radius);
                   #ifdef __stMAMVIEW__
                      pqTmpValue.Parent = pqCurrValue.Parent;
-                     pqTmpValue.Level = pqCurrValue.Level + 1;
                   #endif //__stMAMVIEW__                     
-                  queue->Add(distance, pqTmpValue);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  queue->Push(distance, pqTmpValue);
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
-            }//end if
-         }//end for
+            }//end for
+         }//end while
       }else{ 
          // No, it is a leaf node. Get it.
          stSlimLeafNode * leafNode = (stSlimLeafNode *)currNode;
@@ -5243,32 +5951,46 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
             MAMViewer->EndFrame();
          #endif //__stMAMVIEW__
 
-         // for each entry...
-         for (idx = 0; idx < numberOfEntries; idx++) {
-            // try to cut this object with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
-                      rangeK){
-               // Rebuild the object
-               tmpObj.Unserialize(leafNode->GetObject(idx),
-                                  leafNode->GetObjectSize(idx));
-               // When this entry is a representative, it does not need to evaluate
-               // a distance, because distanceRepres is iqual to distance.
-               // Evaluate distance
-               distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
+         // for each block of entries...
+         idx = 0;
+         while (idx < numberOfEntries){
+            // Gather the entries not cut by the triangle inequality. The
+            // entries of a block are tested against the same rangeK.
+            context.BlockEntries.clear();
+            while ((idx < numberOfEntries) && (context.BlockEntries.size() < DISTANCEBLOCK)){
+               if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) >
+                         rangeK){
+                  CountParentPruned(stats);
+               }else if (FieldLowerBound(leafNode, idx, context.Fields) > rangeK){
+                  // Cut by the global pivots.
+                  CountPivotPruned(stats);
+               }else{
+                  // Rebuild the object
+                  LoadObject(*AddBlockEntry(context, idx), leafNode->GetObject(idx),
+                                                  leafNode->GetObjectSize(idx));
+               }//end if
+               idx++;
+            }//end while
+            // Evaluate their distances at once. Those larger than rangeK
+            // may be left unfinished.
+            EvaluateBlock(context, sample, rangeK);
+
+            for (block = 0; block < context.BlockEntries.size(); block++){
+               entry = context.BlockEntries[block];
+               distance = context.BlockDistances[block];
                //test if the object qualify
                if (distance <= rangeK){
-                  // Add the object.
-                  result->AddPair((ObjectType*) tmpObj.Clone(), distance);
-                  // there is more than k elements?
-                  if (result->GetNumOfEntries() >= k){
-                     //cut if there is more than k elements
-                     result->Cut(k);
+                  // Keep the serialized object. It is rebuilt at the end.
+                  if (context.TopK.Add(leafNode->GetObject(entry), leafNode->GetObjectSize(entry),
+                                       distance) && context.TopK.IsFull()){
                      //may I use this for performance?
-                     rangeK = result->GetMaximumDistance();
+                     rangeK = context.TopK.GetMaximumDistance();
                   }//end if
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
-            }//end if
-         }//end for
+            }//end for
+         }//end while
 
          #ifdef __stMAMVIEW__
             comment.Clear();
@@ -5293,11 +6015,12 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
 
       if (queue->GetSize() > this->maxQueue)
          this->maxQueue = queue->GetSize();
+      CountQueueSize(stats, queue->GetSize());
       // Go to next node
       stop = false;
       do{
          if (queue->Get(distance, pqCurrValue)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Qualified if distance <= rangeK + radius
             if (distance <= rangeK + pqCurrValue.Radius){
                // Yes, get the pageID and the distance from the representative
@@ -5315,32 +6038,34 @@ void stSlimTree<ObjectType, EvaluatorType>::NearestQuery(tResult * result,
       }while (!stop);
    }// end while
 
-   // Release the Global Priority Queue
-   delete queue;
-   queue = 0;
+   // Build the result.
+   context.TopK.Materialize(result);
 }//end stSlimTree<ObjectType, EvaluatorType>::NearestQuery
 
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(
-      ObjectType * sample, u_int32_t k, bool tie){
+      ObjectType * sample, u_int32_t k, bool tie, stQueryStats * stats){
    tResult * result = new tResult();  // Create result
+   tQueryStart start;
 
    // Set information for this query
    result->SetQueryInfo(sample->Clone(), KFARTHESTQUERY, k, MAXDOUBLE, tie);
+   BeginQueryStats(stats, start);
 
    // Let's search
    if (this->GetRoot() != 0){
-      this->FarthestQuery(result, sample, 0.0, k);
+      this->FarthestQuery(result, sample, 0.0, k, stats);
    }//end if
 
+   EndQueryStats(stats, start);
    return result;
 }//end stSlimTree<ObjectType, EvaluatorType>::FarthestQuery
 
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
-         ObjectType * sample, double rangeK, u_int32_t k){
+         ObjectType * sample, double rangeK, u_int32_t k, stQueryStats * stats){
    tDynamicReversedPriorityQueue * queue;
    u_int32_t idx;
    stPage * currPage;
@@ -5356,6 +6081,7 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
    // Root node
    pqCurrValue.PageID = this->GetRoot();
    pqCurrValue.Radius = 0;
+   pqCurrValue.Level = 0;
    
    // Create the Global Priority Queue
    queue = new tDynamicReversedPriorityQueue(STARTVALUEQUEUE, INCREMENTVALUEQUEUE);
@@ -5365,6 +6091,7 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
       // Read node...
       currPage = tMetricTree::myPageManager->GetPage(pqCurrValue.PageID);
       currNode = stSlimNode::CreateNode(currPage);
+      CountNodeRead(stats, pqCurrValue.Level);
       // Is it a Index node?
       if (currNode->GetNodeType() == stSlimNode::INDEX) {
          // Get Index node
@@ -5374,21 +6101,26 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if (distanceRepres + indexNode->GetIndexEntry(idx).Distance +
-                indexNode->GetIndexEntry(idx).Radius >= rangeK){
+            if (distanceRepres + ScaleRadius(indexNode->GetIndexEntry(idx).Distance) +
+                ScaleRadius(indexNode->GetIndexEntry(idx).Radius) >= rangeK){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
 
-               if (distance + indexNode->GetIndexEntry(idx).Radius >= rangeK){
+               if (distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius) >= rangeK){
                   // Yes! I'm qualified! Put it in the queue.
                   pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-                  pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+                  pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
+                  pqTmpValue.Level = pqCurrValue.Level + 1;
                   queue->Add(distance, pqTmpValue);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
+            }else{
+               CountParentPruned(stats);
             }//end if
          }//end for
       }else{
@@ -5399,7 +6131,7 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this object with the triangle inequality.
-            if (distanceRepres + leafNode->GetLeafEntry(idx).Distance >= rangeK){
+            if (distanceRepres + ScaleRadius(leafNode->GetLeafEntry(idx).Distance) >= rangeK){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
@@ -5418,7 +6150,11 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
                      //may I use this for performance?
                      rangeK = result->GetMinimumDistance();
                   }//end if
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
+            }else{
+               CountParentPruned(stats);
             }//end if
          }//end for
 
@@ -5430,10 +6166,11 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
       tMetricTree::myPageManager->ReleasePage(currPage);
 
       // Go to next node
+      CountQueueSize(stats, queue->GetSize());
       stop = false;
       do{
          if (queue->Get(distance, pqCurrValue)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Qualified if distance <= rangeK + radius
             if (distance + pqCurrValue.Radius >= rangeK){
                // Yes, get the pageID and the distance from the representative
@@ -5459,23 +6196,26 @@ void stSlimTree<ObjectType, EvaluatorType>::FarthestQuery(tResult * result,
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 stResult<ObjectType> * stSlimTree<ObjectType, EvaluatorType>::PointQuery(
-      ObjectType * sample){
+      ObjectType * sample, stQueryStats * stats){
    tResult * result = new tResult();  // Create result
+   tQueryStart start;
 
    // Set information for this query
    result->SetQueryInfo((ObjectType*) sample->Clone(), POINTQUERY);
+   BeginQueryStats(stats, start);
    // Let's search
    if (this->GetRoot() != 0){
-      this->PointQuery(result, sample);
+      this->PointQuery(result, sample, stats);
    }//end if
 
+   EndQueryStats(stats, start);
    return result;
 }//end stSlimTree<ObjectType, EvaluatorType>::PointQuery
 
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void stSlimTree<ObjectType, EvaluatorType>::PointQuery(
-         tResult * result, ObjectType * sample){
+         tResult * result, ObjectType * sample, stQueryStats * stats){
    tDynamicPriorityQueue * queue;
    u_int32_t idx;
    stPage * currPage;
@@ -5492,6 +6232,7 @@ void stSlimTree<ObjectType, EvaluatorType>::PointQuery(
    // Root node
    pqCurrValue.PageID = this->GetRoot();
    pqCurrValue.Radius = 0;
+   pqCurrValue.Level = 0;
    
    // Create the Global Priority Queue
    queue = new tDynamicPriorityQueue(STARTVALUEQUEUE, INCREMENTVALUEQUEUE);
@@ -5501,6 +6242,7 @@ void stSlimTree<ObjectType, EvaluatorType>::PointQuery(
       // Read node...
       currPage = tMetricTree::myPageManager->GetPage(pqCurrValue.PageID);
       currNode = stSlimNode::CreateNode(currPage);
+      CountNodeRead(stats, pqCurrValue.Level);
       // Is it a Index node?        
       if (currNode->GetNodeType() == stSlimNode::INDEX) {
          // Get Index node
@@ -5509,21 +6251,26 @@ void stSlimTree<ObjectType, EvaluatorType>::PointQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
 
-               if (distance <= indexNode->GetIndexEntry(idx).Radius){
+               if (distance <= ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                   // Yes! I'm qualified! Put it in the queue.
                   pqTMPValue.PageID =  indexNode->GetIndexEntry(idx).PageID;
-                  pqTMPValue.Radius =  indexNode->GetIndexEntry(idx).Radius;
+                  pqTMPValue.Radius =  ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
+                  pqTMPValue.Level = pqCurrValue.Level + 1;
                   queue->Add(distance, pqTMPValue);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
+            }else{
+               CountParentPruned(stats);
             }//end if
          }//end for
       }else{ 
@@ -5532,8 +6279,9 @@ void stSlimTree<ObjectType, EvaluatorType>::PointQuery(
          numberOfEntries = leafNode->GetNumberOfEntries();
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
-            // use of the triangle inequality
-            if ( distanceRepres == leafNode->GetLeafEntry(idx).Distance){
+            // use of the triangle inequality: an object at distance 0 is
+            // as far from the representative as the query.
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) == 0){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
@@ -5547,7 +6295,11 @@ void stSlimTree<ObjectType, EvaluatorType>::PointQuery(
                   result->AddPair((ObjectType*) tmpObj.Clone(), distance);
                   // Stop the query because the object was found!
                   find = true;
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
+            }else{
+               CountParentPruned(stats);
             }//end if
          }//end for
       }//end else
@@ -5560,10 +6312,11 @@ void stSlimTree<ObjectType, EvaluatorType>::PointQuery(
       // Go to next node.
       if (!find){
          // Search... and feed query
+         CountQueueSize(stats, queue->GetSize());
          stop = false;
          do{
             if (queue->Get(distance, pqCurrValue)){
-               this->sumOperationsQueue++;  // Update the statistics for the queue
+               this->UpdateQueueStatistics();  // Update the statistics for the queue
                // Qualified if distance <= rangeK + radius
                if (distance <= pqCurrValue.Radius){
                   // Yes, get the pageID and the distance from the representative
@@ -5619,7 +6372,7 @@ stResult<ObjectType> * tmpl_stSlimTree::EstimateNearestQuery(
    // Let's search
    if (this->GetRoot() != 0){
       // Call the nearest query with the estimated radius.
-      this->NearestQuery(result, sample, estimatedRadius, k);
+      this->NearestQuery(result, sample, estimatedRadius, k, NULL);
       
       // Get the number of objects returned by the NearestQuery.
       returnedNroObjects = result->GetNumOfEntries();
@@ -5668,15 +6421,21 @@ stResult<ObjectType> * tmpl_stSlimTree::EstimateNearestQuery(
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 stResult<ObjectType> * tmpl_stSlimTree::KAndRangeQuery(
-      ObjectType * sample, double range, u_int32_t k, bool tie){
+      ObjectType * sample, double range, u_int32_t k, bool tie,
+      stQueryStats * stats){
+   tQueryContext & context = GetQueryContext();
 
    tResult * result = new tResult();  // Create result
+   tQueryStart start;
 
    result->SetQueryInfo((ObjectType*) sample->Clone(), KANDRANGEQUERY, k, range, tie);
+   BeginQueryStats(stats, start);
+   GetQueryFields(sample, context.Fields);
    // Let's search
    if (this->GetRoot() != 0){
-      this->KAndRangeQuery(result, sample, range, k);
+      this->KAndRangeQuery(result, sample, range, k, stats);
    }//end if
+   EndQueryStats(stats, start);
    // return the result
    return result;
 }//end stSlimTree<ObjectType, EvaluatorType>::KAndRangeQuery
@@ -5684,8 +6443,10 @@ stResult<ObjectType> * tmpl_stSlimTree::KAndRangeQuery(
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void tmpl_stSlimTree::KAndRangeQuery(
-         tResult * result, ObjectType * sample, double range, u_int32_t k){
-   tDynamicPriorityQueue * queue;
+         tResult * result, ObjectType * sample, double range, u_int32_t k,
+         stQueryStats * stats){
+   tQueryContext & context = GetQueryContext();
+   tQueryQueue * queue;
    u_int32_t idx;
    stPage * currPage;
    stSlimNode * currNode;
@@ -5699,16 +6460,20 @@ void tmpl_stSlimTree::KAndRangeQuery(
 
    // Root node
    pqCurrValue.PageID = this->GetRoot();
+   pqCurrValue.Level = 0;
    pqCurrValue.Radius = 0;
 
-   // Create the Global Priority Queue
-   queue = new tDynamicPriorityQueue(STARTVALUEQUEUE, INCREMENTVALUEQUEUE);
+   // The Global Priority Queue of this thread is reused.
+   queue = &context.Queue;
+   queue->Clear();
+   queue->Reserve(STARTVALUEQUEUE);
 
    // Let's search
    while (pqCurrValue.PageID != 0){
       // Read node...
       currPage = tMetricTree::myPageManager->GetPage(pqCurrValue.PageID);
       currNode = stSlimNode::CreateNode(currPage);
+      CountNodeRead(stats, pqCurrValue.Level);
       // Is it a Index node?
       if (currNode->GetNodeType() == stSlimNode::INDEX) {
          // Get Index node
@@ -5717,21 +6482,26 @@ void tmpl_stSlimTree::KAndRangeQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      range + indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
-               tmpObj.Unserialize(indexNode->GetObject(idx),
+               LoadObject(tmpObj, indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                // test if this subtree qualifies.
-               if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
+               if (distance <= range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                   // Yes! I'm qualified! Put it in the queue.
                   pqTMPValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-                  pqTMPValue.Radius = indexNode->GetIndexEntry(idx).Radius;
-                  queue->Add(distance, pqTMPValue);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  pqTMPValue.Level = pqCurrValue.Level + 1;
+                  pqTMPValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
+                  queue->Push(distance, pqTMPValue);
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
+            }else{
+               CountParentPruned(stats);
             }//end if
          }//end for
 
@@ -5742,13 +6512,18 @@ void tmpl_stSlimTree::KAndRangeQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this object with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) >
                       range){
+               CountParentPruned(stats);
+            }else if (FieldLowerBound(leafNode, idx, context.Fields) > range){
+               // Cut by the global pivots.
+               CountPivotPruned(stats);
+            }else{
                // Rebuild the object
-               tmpObj.Unserialize(leafNode->GetObject(idx),
+               LoadObject(tmpObj, leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
                // is it a Representative?
-               if (leafNode->GetLeafEntry(idx).Distance != 0) {
+               if (ScaleRadius(leafNode->GetLeafEntry(idx).Distance) != 0) {
                   // No, it is not a representative. Evaluate distance
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                }else{
@@ -5768,8 +6543,12 @@ void tmpl_stSlimTree::KAndRangeQuery(
                         result->Cut(k);
                         //may I use this for performance?
                         range = result->GetMaximumDistance();
+                     }else{
+                        CountCoveringPruned(stats);
                      }//end if
                   }//end if
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
             }//end if
          }//end for
@@ -5779,12 +6558,13 @@ void tmpl_stSlimTree::KAndRangeQuery(
       delete currNode;
 	  currNode = 0;
       tMetricTree::myPageManager->ReleasePage(currPage);
+      CountQueueSize(stats, queue->GetSize());
 
       // Next node
       stop = false;
       do{
          if (queue->Get(distance, pqCurrValue)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Qualified if distance <= rangeK + radius
             if (distance <= range + pqCurrValue.Radius){
                // Yes, get the pageID and the distance from the representative
@@ -5801,23 +6581,23 @@ void tmpl_stSlimTree::KAndRangeQuery(
          }//end if
       }while (!stop);
    }// end while
-
-   // Release the Global Priority Queue
-   delete queue;
-   queue = 0;
 }//end stSlimTree<ObjectType, EvaluatorType>::KAndRangeQuery
 
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 stResult<ObjectType> * tmpl_stSlimTree::KOrRangeQuery(
-            ObjectType * sample, double range, u_int32_t k, bool tie){
+            ObjectType * sample, double range, u_int32_t k, bool tie,
+            stQueryStats * stats){
    tResult * result = new tResult();  // Create result
+   tQueryStart start;
 
    result->SetQueryInfo((ObjectType*) sample->Clone(), KORRANGEQUERY, k, range, tie);
+   BeginQueryStats(stats, start);
    // Let's search
    if (this->GetRoot() != 0){
-      this->KOrRangeQuery(result, sample, range, k);
+      this->KOrRangeQuery(result, sample, range, k, stats);
    }//end if
+   EndQueryStats(stats, start);
    // Return the result.
    return result;
 }//end stSlimTree<ObjectType, EvaluatorType>::KOrRangeQuery
@@ -5825,9 +6605,11 @@ stResult<ObjectType> * tmpl_stSlimTree::KOrRangeQuery(
 //------------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
 void tmpl_stSlimTree::KOrRangeQuery(
-      tResult * result, ObjectType * sample, double range, u_int32_t k){
+      tResult * result, ObjectType * sample, double range, u_int32_t k,
+      stQueryStats * stats){
+   tQueryContext & context = GetQueryContext();
       
-   tDynamicPriorityQueue * queue;
+   tQueryQueue * queue;
    u_int32_t idx;
    stPage * currPage;
    stSlimNode * currNode;
@@ -5842,16 +6624,20 @@ void tmpl_stSlimTree::KOrRangeQuery(
 
    // Root node
    pqCurrValue.PageID = this->GetRoot();
+   pqCurrValue.Level = 0;
    pqCurrValue.Radius = 0;
    
-   // Create the Global Priority Queue
-   queue = new tDynamicPriorityQueue(STARTVALUEQUEUE, INCREMENTVALUEQUEUE);
+   // The Global Priority Queue of this thread is reused.
+   queue = &context.Queue;
+   queue->Clear();
+   queue->Reserve(STARTVALUEQUEUE);
 
    // Let's search
    while (pqCurrValue.PageID != 0){
       // Read node...
       currPage = tMetricTree::myPageManager->GetPage(pqCurrValue.PageID);
       currNode = stSlimNode::CreateNode(currPage);
+      CountNodeRead(stats, pqCurrValue.Level);
       // Is it a Index node?
       if (currNode->GetNodeType() == stSlimNode::INDEX) {
          // Get Index node
@@ -5860,21 +6646,26 @@ void tmpl_stSlimTree::KOrRangeQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      distanceK + indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      distanceK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                // test if this subtree qualifies.
-               if (distance <= distanceK + indexNode->GetIndexEntry(idx).Radius){
+               if (distance <= distanceK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                   // Yes! I'm qualified! Put it in the queue.
                   pqTMPValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-                  pqTMPValue.Radius = indexNode->GetIndexEntry(idx).Radius;
-                  queue->Add(distance, pqTMPValue);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  pqTMPValue.Level = pqCurrValue.Level + 1;
+                  pqTMPValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
+                  queue->Push(distance, pqTMPValue);
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
+            }else{
+               CountParentPruned(stats);
             }//end if
          }//end for
 
@@ -5885,13 +6676,13 @@ void tmpl_stSlimTree::KOrRangeQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this object with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
                       distanceK){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
                // is it a Representative?
-               if (leafNode->GetLeafEntry(idx).Distance != 0) {
+               if (ScaleRadius(leafNode->GetLeafEntry(idx).Distance) != 0) {
                   // No, it is not a representative. Evaluate distance
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                }else{
@@ -5913,7 +6704,11 @@ void tmpl_stSlimTree::KOrRangeQuery(
                            distanceK = result->GetMaximumDistance();
                      }//end if
                   }//end if
+               }else{
+                  CountCoveringPruned(stats);
                }//end if
+            }else{
+               CountParentPruned(stats);
             }//end if
          }//end for
       }//end else
@@ -5922,12 +6717,13 @@ void tmpl_stSlimTree::KOrRangeQuery(
       delete currNode;
 	  currNode = 0;
       tMetricTree::myPageManager->ReleasePage(currPage);
+      CountQueueSize(stats, queue->GetSize());
 
       // Next node...
       stop = false;
       do{
          if (queue->Get(distance, pqCurrValue)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Qualified if distance <= rangeK + radius
             if (distance <= distanceK + pqCurrValue.Radius){
                // Yes, get the pageID and the distance from the representative
@@ -5944,10 +6740,6 @@ void tmpl_stSlimTree::KOrRangeQuery(
          }//end if
       }while (!stop);
    }// end while
-
-   // Release the Global Priority Queue
-   delete queue;
-   queue = 0;
 }//end stSlimTree<ObjectType, EvaluatorType>::KOrRangeQuery
 
 //------------------------------------------------------------------------------
@@ -6001,28 +6793,28 @@ void tmpl_stSlimTree::RingQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      outRange + indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      outRange + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
 
-               if ((distance <= outRange + indexNode->GetIndexEntry(idx).Radius) &&
-                   (distance + indexNode->GetIndexEntry(idx).Radius > inRange)){
+               if ((distance <= outRange + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) &&
+                   (distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius) > inRange)){
                   // Yes! I'm qualified !
                   queue->Add(distance, idx);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end if
             }//end if
          }//end for
 
          while (queue->Get(distance, pid)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Will qualify ?
-            if ((distance <= outRange + indexNode->GetIndexEntry(pid).Radius) &&
-                (distance + indexNode->GetIndexEntry(pid).Radius > inRange)){
+            if ((distance <= outRange + ScaleRadius(indexNode->GetIndexEntry(pid).Radius)) &&
+                (distance + ScaleRadius(indexNode->GetIndexEntry(pid).Radius) > inRange)){
 
                // Yes! I'm qualified !
                this->RingQuery(indexNode->GetIndexEntry(pid).PageID, result,
@@ -6041,13 +6833,13 @@ void tmpl_stSlimTree::RingQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this object with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
                       outRange){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
                // is it a Representative?
-               if (leafNode->GetLeafEntry(idx).Distance != 0) {
+               if (ScaleRadius(leafNode->GetLeafEntry(idx).Distance) != 0) {
                   // No, it is not a representative. Evaluate distance
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                }else{
@@ -6125,28 +6917,28 @@ void tmpl_stSlimTree::LocalKRingQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // use of the triangle inequality to cut a subtree
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      outRange + indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      outRange + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
 
-               if ((distance <= outRange + indexNode->GetIndexEntry(idx).Radius) &&
-                   (distance + indexNode->GetIndexEntry(idx).Radius > inRange)){
+               if ((distance <= outRange + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) &&
+                   (distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius) > inRange)){
                   // Yes! I'm qualified !
                   queue->Add(distance, idx);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end if
             }//end if
          }//end for
 
          while (queue->Get(distance, pid)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Will qualify ?
-            if ((distance <= outRange + indexNode->GetIndexEntry(pid).Radius) &&
-                (distance + indexNode->GetIndexEntry(pid).Radius > inRange)){
+            if ((distance <= outRange + ScaleRadius(indexNode->GetIndexEntry(pid).Radius)) &&
+                (distance + ScaleRadius(indexNode->GetIndexEntry(pid).Radius) > inRange)){
 
                // Yes! I'm qualified !
                this->LocalKRingQuery(indexNode->GetIndexEntry(pid).PageID, result,
@@ -6165,13 +6957,13 @@ void tmpl_stSlimTree::LocalKRingQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this object with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
                       outRange){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
                // is it a Representative?
-               if (leafNode->GetLeafEntry(idx).Distance != 0) {
+               if (ScaleRadius(leafNode->GetLeafEntry(idx).Distance) != 0) {
                   // No, it is not a representative. Evaluate distance
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                }else{
@@ -6326,21 +7118,21 @@ void stSlimTree<ObjectType, EvaluatorType>::KRingQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      outRange + indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      outRange + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
 
-               if ((distance <= outRange + indexNode->GetIndexEntry(idx).Radius) &&
-                   (distance + indexNode->GetIndexEntry(idx).Radius > inRange)){
+               if ((distance <= outRange + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) &&
+                   (distance + ScaleRadius(indexNode->GetIndexEntry(idx).Radius) > inRange)){
                   // Yes! I'm qualified! Put it in the queue.
                   pqTMPValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-                  pqTMPValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+                  pqTMPValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
                   queue->Add(distance, pqTMPValue);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end if
             }//end if
          }//end for
@@ -6352,13 +7144,13 @@ void stSlimTree<ObjectType, EvaluatorType>::KRingQuery(
          // for each entry...
          for (idx = 0; idx < numberOfEntries; idx++) {
             // try to cut this object with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
                       outRange){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
                // is it a Representative?
-               if (leafNode->GetLeafEntry(idx).Distance != 0) {
+               if (ScaleRadius(leafNode->GetLeafEntry(idx).Distance) != 0) {
                   // No, it is not a representative. Evaluate distance
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                }else{
@@ -6392,7 +7184,7 @@ void stSlimTree<ObjectType, EvaluatorType>::KRingQuery(
       stop = false;
       do{
          if (queue->Get(distance, pqCurrValue)){
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             // Qualified if distance <= outRange + radius && distance + radius > inRange
             if ((distance <= outRange + pqCurrValue.Radius) &&
                   (distance + pqCurrValue.Radius > inRange)){
@@ -6471,8 +7263,8 @@ void stSlimTree<ObjectType, EvaluatorType>::InitializeIncrementalNearestQuery(
             distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
             // Put the Node in the Queue.
             globalQueue->Add(tmpObj.Clone(), indexNode->GetIndexEntry(idx).PageID, distance,
-                             indexNode->GetIndexEntry(idx).Radius, NODE);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+                             ScaleRadius(indexNode->GetIndexEntry(idx).Radius), NODE);
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
          }//end for
       }else{ 
          // No, it is a leaf node. Get it.
@@ -6487,7 +7279,7 @@ void stSlimTree<ObjectType, EvaluatorType>::InitializeIncrementalNearestQuery(
             distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
             // Put the Objects in the Queue.
             globalQueue->Add(tmpObj.Clone(), distance, OBJECT);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
          }//end for
       }//end if
 
@@ -6516,7 +7308,7 @@ void stSlimTree<ObjectType, EvaluatorType>::IncrementalNearestQuery(
 
    do{
       entryNode = globalQueue->Get();
-      this->sumOperationsQueue++;  // Update the statistics for the queue
+      this->UpdateQueueStatistics();  // Update the statistics for the queue
       
       switch (entryNode->GetType()){
          case NODE:
@@ -6536,9 +7328,11 @@ void stSlimTree<ObjectType, EvaluatorType>::IncrementalNearestQuery(
                   tmpObj.Unserialize(indexNode->GetObject(idx),
                                      indexNode->GetObjectSize(idx));
                   globalQueue->Add(tmpObj.Clone(), indexNode->GetIndexEntry(idx).PageID,
-                                   entryNode->GetDistanceRepQuery(), indexNode->GetIndexEntry(idx).Distance,
-                                   indexNode->GetIndexEntry(idx).Radius, APPROXIMATENODE);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                                   entryNode->GetDistanceRepQuery(),
+                                   QueueParentDistance(entryNode->GetDistanceRepQuery(),
+                                         indexNode->GetIndexEntry(idx).Distance),
+                                   ScaleRadius(indexNode->GetIndexEntry(idx).Radius), APPROXIMATENODE);
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end for
             }else{
                // No, it is a leaf node. Get it.
@@ -6549,9 +7343,11 @@ void stSlimTree<ObjectType, EvaluatorType>::IncrementalNearestQuery(
                   // Rebuild the object
                   tmpObj.Unserialize(leafNode->GetObject(idx),
                                      leafNode->GetObjectSize(idx));
-                  globalQueue->Add(tmpObj.Clone(), leafNode->GetLeafEntry(idx).Distance,
+                  globalQueue->Add(tmpObj.Clone(),
+                                   QueueParentDistance(entryNode->GetDistanceRepQuery(),
+                                         leafNode->GetLeafEntry(idx).Distance),
                                    entryNode->GetDistanceRepQuery(), APPROXIMATEOBJECT);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end for
             }//end if
             //Free it all
@@ -6560,17 +7356,17 @@ void stSlimTree<ObjectType, EvaluatorType>::IncrementalNearestQuery(
             tMetricTree::myPageManager->ReleasePage(currPage);
             break;
          case APPROXIMATENODE :
-            distance = this->myMetricEvaluator->GetDistance(entryNode->GetObject(), sample);
+            distance = this->myMetricEvaluator->GetDistance(*entryNode->GetObject(), *sample);
             globalQueue->Add(entryNode->GetObject(), entryNode->GetPageID(), distance,
                              entryNode->GetRadius(), NODE);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             //this entry does not has the object! 
             entryNode->SetMine(false);
             break;
          case APPROXIMATEOBJECT :
-            distance = this->myMetricEvaluator->GetDistance(entryNode->GetObject(), sample);
+            distance = this->myMetricEvaluator->GetDistance(*entryNode->GetObject(), *sample);
             globalQueue->Add(entryNode->GetObject(), distance, OBJECT);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             //this entry does not has the object!
             entryNode->SetMine(false);
             break;
@@ -6652,8 +7448,8 @@ void stSlimTree<ObjectType, EvaluatorType>::InitializeIncrementalNearestQuery(
             // Put the Node in the Queue.
             globalQueue->Add(tmpObj.Clone(), indexNode->GetIndexEntry(idx).PageID,
                              distance, 0, 0,
-                             indexNode->GetIndexEntry(idx).Radius, 0, NODE);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+                             ScaleRadius(indexNode->GetIndexEntry(idx).Radius), 0, NODE);
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
          }//end for
       }else{ 
          // No, it is a leaf node. Get it.
@@ -6670,7 +7466,7 @@ void stSlimTree<ObjectType, EvaluatorType>::InitializeIncrementalNearestQuery(
             globalQueue->Add(tmpObj.Clone(), -1,
                              distance, 0, 0,
                              0, 0, OBJECT);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
          }//end for
       }//end if
       if (globalQueue->GetSize() > this->maxQueue)
@@ -6706,7 +7502,7 @@ void stSlimTree<ObjectType, EvaluatorType>::IncrementalNearestQuery(
    while (!stop && globalQueue->Get(object, pageID,
                                     distanceQuery, distanceRep, distanceRepQuery,
                                     radius, height, type)){
-      this->sumOperationsQueue++;  // Update the statistics for the queue
+      this->UpdateQueueStatistics();  // Update the statistics for the queue
       
       switch (type){
          case NODE:
@@ -6727,10 +7523,11 @@ void stSlimTree<ObjectType, EvaluatorType>::IncrementalNearestQuery(
                                      indexNode->GetObjectSize(idx));
 
                   globalQueue->Add(tmpObj.Clone(), indexNode->GetIndexEntry(idx).PageID,
-                                   0, indexNode->GetIndexEntry(idx).Distance, distanceQuery,
-                                   indexNode->GetIndexEntry(idx).Radius, height+1,
+                                   0, QueueParentDistance(distanceQuery,
+                                         indexNode->GetIndexEntry(idx).Distance), distanceQuery,
+                                   ScaleRadius(indexNode->GetIndexEntry(idx).Radius), height+1,
                                    APPROXIMATENODE);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end for
             }else{
                // No, it is a leaf node. Get it.
@@ -6743,9 +7540,10 @@ void stSlimTree<ObjectType, EvaluatorType>::IncrementalNearestQuery(
                                      leafNode->GetObjectSize(idx));
 
                   globalQueue->Add(tmpObj.Clone(), -1,
-                                   0, leafNode->GetLeafEntry(idx).Distance, distanceQuery,
+                                   0, QueueParentDistance(distanceQuery,
+                                         leafNode->GetLeafEntry(idx).Distance), distanceQuery,
                                    0, height + 1, APPROXIMATEOBJECT);
-                  this->sumOperationsQueue++;  // Update the statistics for the queue
+                  this->UpdateQueueStatistics();  // Update the statistics for the queue
                }//end for
             }//end if
             //Free it all
@@ -6754,18 +7552,18 @@ void stSlimTree<ObjectType, EvaluatorType>::IncrementalNearestQuery(
             tMetricTree::myPageManager->ReleasePage(currPage);
             break;//end NODE
          case APPROXIMATENODE :
-            distance = this->myMetricEvaluator->GetDistance(object, sample);
+            distance = this->myMetricEvaluator->GetDistance(*object, *sample);
             globalQueue->Add(object, pageID,
                              distance, distanceRep, distanceRepQuery,
                              radius, height, NODE);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             break;//end APPROXIMATENODE
          case APPROXIMATEOBJECT :
-            distance = this->myMetricEvaluator->GetDistance(object, sample);
+            distance = this->myMetricEvaluator->GetDistance(*object, *sample);
             globalQueue->Add(object, -1,
                              distance, 0, 0,
                              0, height, OBJECT);
-            this->sumOperationsQueue++;  // Update the statistics for the queue
+            this->UpdateQueueStatistics();  // Update the statistics for the queue
             break;//end APPROXIMATEOBJECT
          case OBJECT :
             // Add the object.
@@ -6828,15 +7626,15 @@ void stSlimTree<ObjectType, EvaluatorType>::LazyRangeQuery(
 
          for (idx = 0; (idx < numberOfEntries) && !stop; idx++) {
             // try to cut this subtree with the triangle inequality.
-            if ( fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-                      range + indexNode->GetIndexEntry(idx).Radius){
+            if ( ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+                      range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                // Rebuild the object
                tmpObj.Unserialize(indexNode->GetObject(idx),
                                   indexNode->GetObjectSize(idx));
                // Evaluate distance
                distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
 
-               if (distance <= range + indexNode->GetIndexEntry(idx).Radius){
+               if (distance <= range + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)){
                   // Yes! I'm qualified !
                   this->LazyRangeQuery(indexNode->GetIndexEntry(idx).PageID, result,
                                        sample, range, k, distance, stop);
@@ -6850,13 +7648,13 @@ void stSlimTree<ObjectType, EvaluatorType>::LazyRangeQuery(
 
          for (idx = 0; (idx < numberOfEntries) && !stop; idx++) {
             // try to cut this object with the triangle inequality.
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
                       range){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(idx),
                                   leafNode->GetObjectSize(idx));
 
-               if (leafNode->GetLeafEntry(idx).Distance != 0) {// is it a Representative?
+               if (ScaleRadius(leafNode->GetLeafEntry(idx).Distance) != 0) {// is it a Representative?
                   // No, it is not a representative. Evaluate distance
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                }else{
@@ -6935,7 +7733,7 @@ void tmpl_stSlimTree::AproximateNearestQuery(
 
          //Exist the node?
          if (tpath[idx] < numberOfEntries){
-            if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance)<=
+            if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance)<=
                       rangeK + indexNode->GetIndexEntry(tpath[idx]).Radius){
                tmpObj.Unserialize(indexNode->GetObject(tpath[idx]),
                                   indexNode->GetObjectSize(tpath[idx]));
@@ -6961,13 +7759,13 @@ void tmpl_stSlimTree::AproximateNearestQuery(
          //search in the leaf node
          for (int i = 0; i < numberOfEntries; i++) {
             // use of the triangle inequality
-            if ( fabs(distanceRepres - leafNode->GetLeafEntry(i).Distance) <=
+            if ( ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(i).Distance) <=
                       rangeK){
                // Rebuild the object
                tmpObj.Unserialize(leafNode->GetObject(i),
                                   leafNode->GetObjectSize(i));
                // is it a Representative?
-               if (leafNode->GetLeafEntry(i).Distance != 0) {
+               if (ScaleRadius(leafNode->GetLeafEntry(i).Distance) != 0) {
                   // No, it is not a representative. Evaluate distance
                   distance = this->myMetricEvaluator->GetDistance(tmpObj, *sample);
                }else{
@@ -8074,7 +8872,7 @@ double tmpl_stSlimTree::SlimDownRecursive(u_int32_t pageID, int level){
       // Write me and get the garbage.
       delete currNode;
 	  currNode = 0;
-      tMetricTree::myPageManager->WritePage(currPage);
+      WriteTreePage(currPage);
       tMetricTree::myPageManager->ReleasePage(currPage);
       return radius;
    }else{
@@ -8170,7 +8968,7 @@ double tmpl_stSlimTree::SlimDown(u_int32_t pageID){
             tmpPage = leafNode->GetPage();
             delete leafNode;
 			leafNode = 0;
-            tMetricTree::myPageManager->WritePage(tmpPage);
+            WriteTreePage(tmpPage);
             tMetricTree::myPageManager->ReleasePage(tmpPage);
          }else{
             // Empty node
@@ -8200,7 +8998,7 @@ double tmpl_stSlimTree::SlimDown(u_int32_t pageID){
       // Write me and get the garbage.
       delete currNode;
 	  currNode = 0;
-      tMetricTree::myPageManager->WritePage(currPage);
+      WriteTreePage(currPage);
       tMetricTree::myPageManager->ReleasePage(currPage);
       return radius;
    }else{
@@ -8316,7 +9114,7 @@ template <class ObjectType, class EvaluatorType>
 int tmpl_stSlimTree::BulkLoadSimple(ObjectType **objects, u_int32_t numObj, double leafNodeOccupancy, stPage *& auxPage, int currObj) {
 
    auxPage  = this->NewPage();
-   stSlimLeafNode * leafNode = new stSlimLeafNode(auxPage, true);
+   stSlimLeafNode * leafNode = CreateLeafNode(auxPage);
 
    ObjectType *newObj; // Object
    u_int32_t insertIdx; // Insertion index
@@ -8329,7 +9127,7 @@ int tmpl_stSlimTree::BulkLoadSimple(ObjectType **objects, u_int32_t numObj, doub
    u_int32_t numObjNode = 0;
 
    // While has space
-   while((leafNode->GetFree()*leafNodeOccupancy>newObjSize+sizeof(stSlimLeafNode::stSlimLeafEntry))&&(currObj<numObj)) {
+   while((leafNode->GetFree()*leafNodeOccupancy>newObjSize+stSlimLeafNode::GetLeafEntryOverhead(Pivots.size()))&&(currObj<numObj)) {
 
       #ifdef __stPRINTMSG__
          cout << endl << "Inserting the following object #: " << currObj << endl;
@@ -8384,6 +9182,7 @@ int tmpl_stSlimTree::BulkLoadSampled(ObjectType **objects, u_int32_t numObj, dou
    stSlimLeafNode ** sampleNode = new stSlimLeafNode * [numOfSamples]; // @todo: delete this
    stPage ** samplePage  = new stPage * [numOfSamples]; // @todo: delete this
 
+   ObjectType *newObj; // Object
    u_int32_t insertIdx; // Insertion index
 
    #ifdef __stDEBUG__
@@ -8404,7 +9203,7 @@ int tmpl_stSlimTree::BulkLoadSampled(ObjectType **objects, u_int32_t numObj, dou
       newObjSize = newObj->GetSerializedSize();
       // Insert the new object.
       samplePage[i] = this->NewPage();
-      sampleNode[i] = new SlimLeafNode(samplePage[i],true); // @todo: Change this to work
+      sampleNode[i] = CreateLeafNode(samplePage[i]); // @todo: Change this to work
       insertIdx = sampleNode[i]->AddEntry(newObjSize,
                                           newObj->Serialize());
 
@@ -8434,7 +9233,7 @@ int tmpl_stSlimTree::BulkLoadSampled(ObjectType **objects, u_int32_t numObj, dou
       for(int i=0;i<numOfSamples;i++) {
          rep.Unserialize(sampleNode[i]->GetObject(0), // Rep is always the first element in this case
                             sampleNode[i]->GetObjectSize(0));
-         double distance = this->myMetricEvaluator->GetDistance(newObj, &rep);
+         double distance = this->myMetricEvaluator->GetDistance(*newObj, rep);
          if(distance < minDist) {
             distance = minDist;
             sampleIdx = i;
@@ -8442,14 +9241,14 @@ int tmpl_stSlimTree::BulkLoadSampled(ObjectType **objects, u_int32_t numObj, dou
       }
 
       newObjSize = newObj->GetSerializedSize();
-      insertIdx = sampleNode[i]->AddEntry(newObjSize,
+      insertIdx = sampleNode[sampleIdx]->AddEntry(newObjSize,
                                           newObj->Serialize());
       currObj++;
 
-      if(sampleNode[i]->GetFree()*leafNodeOccupancy<=newObjSize+sizeof(stSlimLeafNode::stSlimLeafEntry)) { // no space for other object with the same size
-         auxPage = samplePage[i];
-         delete sampleNode[i];
-		 sampleNode[i] = 0;
+      if(sampleNode[sampleIdx]->GetFree()*leafNodeOccupancy<=newObjSize+stSlimLeafNode::GetLeafEntryOverhead(Pivots.size())) { // no space for other object with the same size
+         auxPage = samplePage[sampleIdx];
+         delete sampleNode[sampleIdx];
+		 sampleNode[sampleIdx] = 0;
          //Choose another - @todo: Change this to get random
          //@TODO!!!!!!!
          return currObj;
@@ -8463,7 +9262,7 @@ int tmpl_stSlimTree::BulkLoadSampled(ObjectType **objects, u_int32_t numObj, dou
          #endif //__stPRINTMSG__
 
          // Insert the new object.
-         insertIdx = leafNode->AddEntry(newObj->GetSerializedSize(),
+         insertIdx = sampleNode[sampleIdx]->AddEntry(newObj->GetSerializedSize(),
                                         newObj->Serialize());
 
          #ifdef __stPRINTMSG__
@@ -8503,7 +9302,7 @@ int tmpl_stSlimTree::BulkLoadSampled(ObjectType **objects, u_int32_t numObj, dou
 template <class ObjectType, class EvaluatorType>
 bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, double leafNodeOccupancy, double indexNodeOccupancy, enum tBulkMethod method){
    if(method == bulkRANDOM) {
-      randomize();
+      srand(time(NULL));
    }
 
    int currObj = 0;  // Number of current object
@@ -8649,10 +9448,10 @@ bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, do
       sub1.NObjects = 0;
 
       // Write the node.
-      tMetricTree::myPageManager->WritePage(auxPage);
+      WriteTreePage(auxPage);
       delete leafNode;
 	  leafNode = 0;
-      delete auxPage;
+      tMetricTree::myPageManager->ReleasePage(auxPage);
 	  auxPage = 0;
 
       BulkInsert(sub1, sub, indexNodeOccupancy, method);
@@ -8702,7 +9501,7 @@ bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, do
       fatherNode->GetIndexEntry(repIdx).NEntries = currNode->GetTotalObjectCount(); // Update the number of objects
 
       // Write the current page (node).
-      tMetricTree::myPageManager->WritePage(stackPage);
+      WriteTreePage(stackPage);
       // Write the current page (node). // @TODO: Optimize this... disk access
       //tMetricTree::myPageManager->WritePage(fatherPage);
 
@@ -8710,7 +9509,7 @@ bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, do
 	  currNode = 0;
       delete fatherNode;
 	  fatherNode = 0;
-      delete stackPage;
+      tMetricTree::myPageManager->ReleasePage(stackPage);
 	  stackPage = 0;
 
 
@@ -8720,9 +9519,9 @@ bool tmpl_stSlimTree::BulkLoadOrdered(ObjectType **objects, u_int32_t numObj, do
    if(!this->rightPathEntries.empty()) {
         stPage * stackPage = this->rightPathEntries.top();
          // Write the current page (node).
-        tMetricTree::myPageManager->WritePage(stackPage);
+        WriteTreePage(stackPage);
         //cout << "\nNode " << stackPage->GetPageID() << endl;
-        delete stackPage;
+        tMetricTree::myPageManager->ReleasePage(stackPage);
 		stackPage = 0;
         this->rightPathEntries.pop();
    } // end if
@@ -8931,7 +9730,7 @@ bool tmpl_stSlimTree::BulkInsert(stSubtreeInfo & sub1, stSubtreeInfo & sub, doub
 
 
        // Write the current page (node).
-      tMetricTree::myPageManager->WritePage(currPage);
+      WriteTreePage(currPage);
 
 
 
@@ -8941,7 +9740,7 @@ bool tmpl_stSlimTree::BulkInsert(stSubtreeInfo & sub1, stSubtreeInfo & sub, doub
 
 
       // Clean the mess.
-      delete currPage;
+      tMetricTree::myPageManager->ReleasePage(currPage);
 	  currPage = 0;
 
       // New node
@@ -9055,7 +9854,7 @@ bool tmpl_stSlimTree::BulkLoadMemory(ObjectType **objects, u_int32_t numObj, dou
 template <class ObjectType, class EvaluatorType>
 bool tmpl_stSlimTree::BulkLoadMemory(ObjectType **objects, u_int32_t numObj, double nodeOccupancy, u_int32_t objSize, enum tBulkType type) {
 
-   vector< SampleSon<ObjectType> > objs; // objects vector
+   std::vector< SampleSon<ObjectType> > objs; // objects vector
 
    for(u_int32_t i=0;i<numObj;i++) {
       SampleSon<ObjectType> son(objects[i],0.0);
@@ -9065,6 +9864,59 @@ bool tmpl_stSlimTree::BulkLoadMemory(ObjectType **objects, u_int32_t numObj, dou
    return BulkLoadMemory(objs, nodeOccupancy, objSize, type);
 
 } //end stSlimTree<ObjectType, EvaluatorType>::BulkLoadMemory
+
+//-----------------------------------------------------------------------------
+
+template <class ObjectType, class EvaluatorType>
+bool tmpl_stSlimTree::BulkLoadMemoryParallel(ObjectType **objects, u_int32_t numObj, double nodeOccupancy, u_int32_t objSize, enum tBulkType type, u_int32_t nThreads) {
+
+   std::vector< SampleSon<ObjectType> > objs; // objects vector
+   std::vector<EvaluatorType> evaluators;
+   std::vector<EvaluatorType *> threadEvaluators;
+   std::minstd_rand generator((u_int32_t) rand());
+   stTaskPool pool(nThreads);
+   tBulkContext context;
+   stSubtreeInfo firstSub;
+   u_int64_t distanceCount;
+
+   for(u_int32_t i=0;i<numObj;i++) {
+      SampleSon<ObjectType> son(objects[i],0.0);
+      objs.push_back(son);
+   } //end for
+
+   // An evaluator for each thread.
+   distanceCount = this->myMetricEvaluator->GetDistanceCount();
+   evaluators.assign(pool.GetNumberOfThreads(), *this->myMetricEvaluator);
+   for(u_int32_t i=0;i<evaluators.size();i++) {
+      threadEvaluators.push_back(&evaluators[i]);
+   } //end for
+
+   context.Evaluator = threadEvaluators[0];
+   context.Random = &generator;
+   context.Pool = &pool;
+   context.Evaluators = &threadEvaluators;
+   context.ThreadID = 0;
+
+   bool insertLeaf = objs.size() <= (u_int32_t)(getNumLeafNodeObj(objSize)*nodeOccupancy);
+   bool ret = BulkLoadMemory(objs, -1, nodeOccupancy, objSize, firstSub, insertLeaf, type, context);
+
+   for(u_int32_t i=0;i<evaluators.size();i++) {
+      this->myMetricEvaluator->MergeDistanceCount(evaluators[i].GetDistanceCount() - distanceCount);
+   } //end for
+
+   this->SetRoot(firstSub.RootID);
+
+   // Update the Height
+   setBulkHeight(objs.size(),objSize,nodeOccupancy);
+
+   // Update object count.
+   UpdateObjectCounter(objs.size());
+
+   // Report the modification.
+   HeaderUpdate = true;
+
+   return ret;
+} //end stSlimTree<ObjectType, EvaluatorType>::BulkLoadMemoryParallel
 //-----------------------------------------------------------------------------
 // Utils
 
@@ -9106,7 +9958,7 @@ u_int32_t tmpl_stSlimTree::setBulkHeight(u_int32_t numObj,u_int32_t objSize,doub
 
 template <class ObjectType, class EvaluatorType>
 u_int32_t tmpl_stSlimTree::getNodeFreeSize() {
-   return GetPageManager()->GetMinimumPageSize() - stSlimNode::GetGlobalOverhead();
+   return this->GetPageManager()->GetMinimumPageSize() - stSlimNode::GetGlobalOverhead();
 } //end stSlimTree<ObjectType, EvaluatorType>::getNodeFreeSize
 
 template <class ObjectType, class EvaluatorType>
@@ -9118,11 +9970,11 @@ u_int32_t tmpl_stSlimTree::getNumIndexNodeObj(u_int32_t objSize) {
 template <class ObjectType, class EvaluatorType>
 u_int32_t tmpl_stSlimTree::getNumLeafNodeObj(u_int32_t objSize) {
    u_int32_t nodeFreeSize = getNodeFreeSize();
-   return ((nodeFreeSize)/(objSize + sizeof(stSlimLeafNode::stSlimLeafEntry)));
+   return ((nodeFreeSize)/(objSize + stSlimLeafNode::GetLeafEntryOverhead(Pivots.size())));
 } //end stSlimTree<ObjectType, EvaluatorType>::getNumLeafNodeObj
 
 
-bool searchIdx(int array[], u_int32_t size, u_int32_t value) {
+inline bool searchIdx(int array[], u_int32_t size, u_int32_t value) {
    u_int32_t tmpIdx = 0;
    for(;tmpIdx<size; tmpIdx++) {
       if(array[tmpIdx] == value) return true;
@@ -9132,7 +9984,7 @@ bool searchIdx(int array[], u_int32_t size, u_int32_t value) {
 
 //-----------------------------------------------------------------------------
 template <class ObjectType, class EvaluatorType>
-bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, enum tBulkType type){
+bool tmpl_stSlimTree::BulkLoadMemory(std::vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, enum tBulkType type){
 
    stSubtreeInfo firstSub;
 
@@ -9159,7 +10011,7 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, do
 //-----------------------------------------------------------------------------
 
 template <class ObjectType, class EvaluatorType>
-bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, enum tBulkType type){
+bool tmpl_stSlimTree::BulkLoadMemory(std::vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, enum tBulkType type){
 
    u_int32_t numLeafNodeObj = getNumLeafNodeObj(objSize)*nodeOccupancy;
 
@@ -9173,15 +10025,22 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, do
 //-----------------------------------------------------------------------------
 
 template <class ObjectType, class EvaluatorType>
-bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, bool insertLeaf, enum tBulkType type){
+bool tmpl_stSlimTree::BulkLoadMemory(std::vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, bool insertLeaf, enum tBulkType type){
+   tBulkContext context;
 
-   return BulkLoadMemory(objects, -1, nodeOccupancy, objSize, sub, insertLeaf, type);
+   // One thread using rand() and the evaluator of this tree.
+   context.Evaluator = this->myMetricEvaluator;
+   context.Random = NULL;
+   context.Pool = NULL;
+   context.Evaluators = NULL;
+   context.ThreadID = 0;
+   return BulkLoadMemory(objects, -1, nodeOccupancy, objSize, sub, insertLeaf, type, context);
 } //end stSlimTree<ObjectType, EvaluatorType>::BulkLoadMemory
 
 //-----------------------------------------------------------------------------
 
 template <class ObjectType, class EvaluatorType>
-bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, int father, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, bool insertLeaf, enum tBulkType type){
+bool tmpl_stSlimTree::BulkLoadMemory(std::vector< SampleSon<ObjectType> > objects, int father, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, bool insertLeaf, enum tBulkType type, tBulkContext & context){
 
    u_int32_t numIndexNodeObj = getNumIndexNodeObj(objSize)*nodeOccupancy;
    u_int32_t numLeafNodeObj = getNumLeafNodeObj(objSize)*nodeOccupancy;
@@ -9231,10 +10090,11 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, in
       #endif //__stPRINTMSG__
 
       // new leaf node
-      stPage * newPage  = this->NewPage();
-      stSlimLeafNode * leafNode = new stSlimLeafNode(newPage, true);
+      stPage * newPage  = BulkNewPage();
+      stSlimLeafNode * leafNode = CreateLeafNode(newPage);
 
-      u_int32_t repIdx = father;
+      // The root has no father: its first object is the representative.
+      u_int32_t repIdx = (father < 0) ? 0 : father;
 
       // insert all
       for(u_int32_t i=0;i<numObj;i++) {
@@ -9243,9 +10103,13 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, in
 
          u_int32_t insertIdx = leafNode->AddEntry(newObj->GetSerializedSize(),
                                                 newObj->Serialize());
-
-         // distance calculation
-         leafNode->GetLeafEntry(insertIdx).Distance = this->myMetricEvaluator->GetDistance(newObj, objects[repIdx].getObject());
+         // distance calculation. The queries take every entry of the root
+         // as its representative, at distance 0.
+         if(father < 0) {
+            leafNode->GetLeafEntry(insertIdx).Distance = 0;
+         } else {
+            leafNode->GetLeafEntry(insertIdx).Distance = context.Evaluator->GetDistance(*newObj, *objects[repIdx].getObject());
+         } //end if
 
       } //end for
 
@@ -9259,338 +10123,396 @@ bool tmpl_stSlimTree::BulkLoadMemory(vector< SampleSon<ObjectType> > objects, in
 	  leafNode = 0;
 
       // write to disk
-      tMetricTree::myPageManager->WritePage(newPage);
-      delete newPage;
+      BulkWritePage(newPage, context);
 	  newPage = 0;
 
 
    } else {
 
-      // choose samples
-      SampleSon<ObjectType> *sample = new SampleSon<ObjectType>[numObjects]; // holds sample data
-      int *sampleIdx = new int[numObjects]; // holds sample indexes
-      u_int32_t tmpIdx = 0;
-      if(father>=0) { // put the father as a sample
-         sampleIdx[0] = father;
-         sample[0] = objects[father];
-         tmpIdx = 1;
-      }
-
-      for(;tmpIdx<numObjects; tmpIdx++) {
-         sampleIdx[tmpIdx] = -1;
-      }
-
-      for(tmpIdx = 0;tmpIdx<numObjects; tmpIdx++) {
-         u_int32_t aux = rand()%numObj;
-         while(searchIdx(sampleIdx,numObjects,aux)) { // avoid duplicated samples
-            aux = rand()%numObj;
-         }
-
-         sampleIdx[tmpIdx] = aux;
-         sample[tmpIdx] = objects[aux];
-
-         #ifdef __stPRINTMSG__
-            cout << "# " << aux << " - " << numObjects << endl;
-         #endif //__stPRINTMSG__
-      } //end for
-      delete[] sampleIdx;
-	  sampleIdx = 0;
-
-      vector< vector< SampleSon<ObjectType> > > samplesVector(numObjects);
-      //vector< vector< SampleSon<ObjectType> > > samplesVector();
+      std::vector< std::vector< SampleSon<ObjectType> > > samplesVector;
+      ObjectType *uniRep = NULL;
 
+      BulkLoadPartition(objects, father, numObjects, nodeOccupancy, objSize, type, samplesVector, context);
 
-      // distribute objects
-      for(u_int32_t i=0;i<numObj;i++) {
-         int choice = -1;
-         double dist = 0.0;
-         double distOld = 0.0;
-	 for(u_int32_t j=0;j<numObjects;j++) {
-	    dist = this->myMetricEvaluator->GetDistance(sample[j].getObject(), objects[i].getObject());
-	    if((choice == -1) || (dist < distOld)) {
-	       distOld = dist;
-               choice = j;
-	    } //end if
-         } //end for
-
+      #ifdef __stPRINTMSG__
+         cout << endl << "Insert" <<endl;
+      #endif //__stPRINTMSG__
 
+      stPage * newIndexPage  = BulkNewPage();
+      stSlimIndexNode * indexNode = new stSlimIndexNode(newIndexPage, true);
 
-         SampleSon<ObjectType> son(objects[i].getObject(),distOld);
-         #ifdef __stPRINTMSG__
-            cout << "Sample #: " << choice << " Object #: " << i << " Distance: " << distOld << endl;
-         #endif //__stPRINTMSG__
+      bool insertLeaf = true; //samplesVector[0].size() <= numLeafNodeObj;
 
-	 samplesVector[choice].push_back(son); // opt
+      for(int i=0;i<samplesVector.size();i++) {
+         if(samplesVector[i].size() > numLeafNodeObj) {
+            insertLeaf = false;
+            break;
+         } //end if
       } //end for
 
-      u_int32_t numberObjBucket = numObj/numObjects;
-      u_int32_t numberObjRem = numObj - numberObjBucket*numObjects;
-
       #ifdef __stPRINTMSG__
-         cout << "Estimate number per bucket: " << numberObjBucket << " # rem: " << numberObjRem << endl;
-         u_int32_t total = 0;
+         cout << "InsertLeaf: " << insertLeaf << endl;
+         cout << "numLeafNodeObj: " << numLeafNodeObj << endl;
+         u_int32_t total3 = 0;
          for(u_int32_t i=0;i<samplesVector.size();i++) {
             cout << "Sample #: " << i << " Objects #: " << samplesVector[i].size() << endl;
-            total +=  samplesVector[i].size();
-         }
-         cout << "Total: " << total << endl;
+            total3 +=  samplesVector[i].size();
+         } //end for
+         cout << "Total: " << total3 << endl;
       #endif //__stPRINTMSG__
 
-      vector<int> candidates;
-      vector< SampleSon<ObjectType> > newObjs;
+      // Subtrees of a parallel build. Each one has its own generator, so
+      // the tree does not depend on the order the tasks run.
+      std::vector<stSubtreeInfo> subs;
+      if(context.Pool != NULL) {
+         std::vector<stTaskPool::tTask> tasks;
+         subs.resize(samplesVector.size());
+         for(u_int32_t i=0;i<samplesVector.size();i++) {
+            u_int32_t seed = BulkRandom(context);
+            tasks.push_back([this, &samplesVector, &subs, &context, i, seed,
+                  nodeOccupancy, objSize, insertLeaf, type](u_int32_t id) {
+               std::minstd_rand generator(seed);
+               tBulkContext child = context;
+               child.Evaluator = (*context.Evaluators)[id];
+               child.Random = &generator;
+               child.ThreadID = id;
+               BulkLoadMemory(samplesVector[i], 0, nodeOccupancy, objSize, subs[i], insertLeaf, type, child);
+            });
+         } //end for
+         context.Pool->Run(tasks, context.ThreadID);
+      } //end if
 
+      for(u_int32_t i=0;i<samplesVector.size();i++) {
 
+         if(context.Pool != NULL) {
+            sub = subs[i];
+         } else {
+            BulkLoadMemory(samplesVector[i], 0, nodeOccupancy, objSize, sub, insertLeaf, type, context);
+         } //end if
 
-      // redistribution phase
-      for(u_int32_t i=0;i<samplesVector.size();i++) {
+         //@TODO: To reduce memory usage and increase disk access, do the bulk and after, load the node and update the information
+         ObjectType *newIndexObj = sub.Rep;
 
-         if(type==bulkRANGE) {
+         u_int32_t insertIdx = indexNode->AddEntry(newIndexObj->GetSerializedSize(),
+                                        newIndexObj->Serialize());
 
-            if(samplesVector[i].size()<ceil((double)numberObjBucket*minNodeOccupancy)) {
-               for(u_int32_t idx=0;idx<samplesVector[i].size();idx++) {
-                  newObjs.push_back(samplesVector[i][idx]);
-               } //end for
-               samplesVector.erase(& samplesVector[i]);
-               i--;
+        indexNode->GetIndexEntry(insertIdx).Radius = sub.Radius;
+        indexNode->GetIndexEntry(insertIdx).NEntries = sub.NObjects;
+        indexNode->GetIndexEntry(insertIdx).PageID = sub.RootID;
+        if((i==father)||(father<0)) {
+           uniRep = newIndexObj;
+           indexNode->GetIndexEntry(insertIdx).Distance = 0;
+        } else {
+           indexNode->GetIndexEntry(insertIdx).Distance = context.Evaluator->GetDistance(*newIndexObj, *uniRep);
+        } //end if
 
-      #ifdef __stPRINTMSG__
-         cout << "Estimate number per bucket: " << numberObjBucket << " # rem: " << numberObjRem << endl;
-         u_int32_t total = 0;
-         for(u_int32_t i=0;i<samplesVector.size();i++) {
-            cout << "Sample #: " << i << " Objects #: " << samplesVector[i].size() << endl;
-            total +=  samplesVector[i].size();
-         }
-         cout << "Total: " << total << endl;
-      #endif //__stPRINTMSG__
-                     
-            } else {
-               candidates.push_back(i);
-            } //end if
+      } //end for
 
-         } else {
+      sub.Radius = indexNode->GetMinimumRadius();
+      sub.NObjects = indexNode->GetTotalObjectCount();
+      sub.RootID = newIndexPage->GetPageID();
+      sub.Rep =  uniRep;
 
+      // clean the mess
+      delete indexNode;
+	  indexNode = 0;
 
-            if(samplesVector[i].size()>numberObjBucket) { // need to balance
-               while(samplesVector[i].size()>numberObjBucket) {
-                  // choose the fartest
-                  u_int32_t fartest = 0;
-                  double dist = samplesVector[i][0].getDistance();
-                  for(u_int32_t idx=1;idx<samplesVector[i].size();idx++) {
-                     if(samplesVector[i][idx].getDistance()>dist) {
-                        dist = samplesVector[i][idx].getDistance();
-                        fartest = idx;
-                     } //end if
-                  } //end for
-
-                  newObjs.push_back(samplesVector[i][fartest]);
-                  samplesVector[i].erase(& samplesVector[i][fartest]);
-               } //end while
-            } else { // candidates
-               if(samplesVector[i].size()!=numberObjBucket) {
-                  candidates.push_back(i);
-               } //end if
-            } //end if
-            
-         } //end if
+      BulkWritePage(newIndexPage, context);
+	  newIndexPage = 0;
 
-      } //end for
+   } //end if
 
+   return true;
+} //end stSlimTree<ObjectType, EvaluatorType>::BulkLoadMemory
 
-      ObjectType *uniRep = NULL;
+//-----------------------------------------------------------------------------
 
-      // redistribute objects
-      for(u_int32_t i=0;i<newObjs.size();i++) {
-         int choice = -1;
-         int candidateIdx;
-         double dist = 0.0;
-         double distOld = 0.0;
-	 for(u_int32_t j=0;j<candidates.size();j++) {
-	    dist = this->myMetricEvaluator->GetDistance(sample[candidates[j]].getObject(), newObjs[i].getObject());
-	    if((choice == -1) || (dist < distOld)) {
-	       distOld = dist;
-               choice = candidates[j];
-               candidateIdx = j;
-	    } //end if
-         } //end for
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::BulkLoadPartition(std::vector< SampleSon<ObjectType> > & objects, int father, double numObjects, double nodeOccupancy, u_int32_t objSize, enum tBulkType type, std::vector< std::vector< SampleSon<ObjectType> > > & samplesVector, tBulkContext & context){
 
+   u_int32_t numObj = objects.size();
 
-         if(choice == -1) { // remaining
+   double minNodeOccupancy = 0.4; //@todo pass as parameter
 
-            for(u_int32_t j=0;j<samplesVector.size();j++) {
-               if(samplesVector[j].size()>numberObjBucket) {
-                  continue;
-               } //end if
-	       dist = this->myMetricEvaluator->GetDistance(sample[j].getObject(), newObjs[i].getObject());
-	       if((choice == -1) || (dist < distOld)) {
-	          distOld = dist;
-                  choice = j;
-	       } //end if
-            } //end for
-         } else {
-            if(samplesVector[choice].size()+1>=numberObjBucket) {
-               candidates.erase(& candidates[candidateIdx]);
-            } //end if
-         } //end if
+   // choose samples
+   SampleSon<ObjectType> *sample = new SampleSon<ObjectType>[(u_int32_t) numObjects]; // holds sample data
+   int *sampleIdx = new int[(u_int32_t) numObjects]; // holds sample indexes
+   u_int32_t tmpIdx = 0;
+   if(father>=0) { // put the father as a sample
+      sampleIdx[0] = father;
+      sample[0] = objects[father];
+      tmpIdx = 1;
+   }
 
-         SampleSon<ObjectType> son(newObjs[i].getObject(),distOld);
-         #ifdef __stPRINTMSG__
-            cout << "Sample #: " << choice << " Object #: " << i << " Distance: " << distOld << endl;
-         #endif //__stPRINTMSG__
+   for(;tmpIdx<numObjects; tmpIdx++) {
+      sampleIdx[tmpIdx] = -1;
+   }
 
-         samplesVector[choice].push_back(son); // opt
+   for(tmpIdx = 0;tmpIdx<numObjects; tmpIdx++) {
+      u_int32_t aux = BulkRandom(context)%numObj;
+      while(searchIdx(sampleIdx,numObjects,aux)) { // avoid duplicated samples
+         aux = BulkRandom(context)%numObj;
+      }
 
-      } //end for
+      sampleIdx[tmpIdx] = aux;
+      sample[tmpIdx] = objects[aux];
 
       #ifdef __stPRINTMSG__
-         cout << "Estimate number per bucket: " << numberObjBucket << endl;
-         u_int32_t total2 = 0;
-         for(u_int32_t i=0;i<samplesVector.size();i++) {
-            cout << "Sample #: " << i << " Objects #: " << samplesVector[i].size() << endl;
-            total2 +=  samplesVector[i].size();
-         } //end for
-         cout << "Total: " << total2 << endl;
+         cout << "# " << aux << " - " << numObjects << endl;
       #endif //__stPRINTMSG__
+   } //end for
+   delete[] sampleIdx;
+	  sampleIdx = 0;
 
-      // do while?
-
-      if(type==bulkRANGE) {
-         int minHeight = -1;
+   samplesVector.assign(numObjects, std::vector< SampleSon<ObjectType> >());
+
+
+   // distribute objects
+   std::vector<int> choices(numObj);
+   std::vector<double> distances(numObj);
+   if((context.Pool != NULL) && (numObj >= BULKPARALLELDISTRIBUTION)) {
+      // In blocks, each thread with its own evaluator.
+      std::vector<stTaskPool::tTask> tasks;
+      u_int32_t nBlocks = context.Pool->GetNumberOfThreads() * 4;
+      for(u_int32_t b=0;b<nBlocks;b++) {
+         tasks.push_back([this, &objects, &choices, &distances, &context,
+               sample, numObj, numObjects, nBlocks, b](u_int32_t id) {
+            BulkDistribute(objects, sample, numObjects,
+                           (u_int64_t)numObj*b/nBlocks, (u_int64_t)numObj*(b+1)/nBlocks,
+                           choices, distances, (*context.Evaluators)[id]);
+         });
+      } //end for
+      context.Pool->Run(tasks, context.ThreadID);
+   } else {
+      BulkDistribute(objects, sample, numObjects, 0, numObj, choices, distances, context.Evaluator);
+   } //end if
 
-         // minimum height - @todo: create a function
-         for(u_int32_t i=0;i<samplesVector.size();i++) {
-            u_int32_t actHeight = getBulkHeight(samplesVector[i].size(),objSize,minNodeOccupancy);
-            if((minHeight<0)||(minHeight > actHeight)) {
-               minHeight = actHeight;
-            }// end if
-         } //end for
+   for(u_int32_t i=0;i<numObj;i++) {
+      SampleSon<ObjectType> son(objects[i].getObject(),distances[i]);
+      #ifdef __stPRINTMSG__
+         cout << "Sample #: " << choices[i] << " Object #: " << i << " Distance: " << distances[i] << endl;
+      #endif //__stPRINTMSG__
 
+	 samplesVector[choices[i]].push_back(son); // opt
+   } //end for
 
+   u_int32_t numberObjBucket = numObj/numObjects;
+   u_int32_t numberObjRem = numObj - numberObjBucket*numObjects;
 
-         for(u_int32_t i=0;i<samplesVector.size();i++) {
-            u_int32_t maxHeight = getBulkHeight(samplesVector[i].size(),objSize,nodeOccupancy);
-            if(maxHeight>minHeight) { // taller subtrees
-            #ifdef __stPRINTMSG__
-                cout << endl << "Break it " << i << endl;
-            #endif //__stPRINTMSG__
-                u_int32_t numDiv = 2;
+   #ifdef __stPRINTMSG__
+      cout << "Estimate number per bucket: " << numberObjBucket << " # rem: " << numberObjRem << endl;
+      u_int32_t total = 0;
+      for(u_int32_t i=0;i<samplesVector.size();i++) {
+         cout << "Sample #: " << i << " Objects #: " << samplesVector[i].size() << endl;
+         total +=  samplesVector[i].size();
+      }
+      cout << "Total: " << total << endl;
+   #endif //__stPRINTMSG__
 
+   std::vector<int> candidates;
+   std::vector< SampleSon<ObjectType> > newObjs;
 
-                while(getBulkHeight(ceil((double)samplesVector[i].size()/(double)numDiv),objSize,nodeOccupancy)>minHeight) {
-                   numDiv++;
-                } //end while
-                u_int32_t possNumDiv = ceil((double)samplesVector[i].size()/(double)numberObjBucket);
-                if(possNumDiv>numDiv)
-                   numDiv = possNumDiv;
 
-                vector< vector< SampleSon<ObjectType> > > newSamplesVector(numDiv);
 
-                // redistribute objects
-                for(u_int32_t idx=0;idx<samplesVector[i].size();idx++) {
-                   int choice = -1;
-                   int candidateIdx;
-                   double dist = 0.0;
-                   double distOld = 0.0;
-                   for(u_int32_t j=0;j<numDiv;j++) {
+   // redistribution phase
+   for(u_int32_t i=0;i<samplesVector.size();i++) {
 
-                      dist = this->myMetricEvaluator->GetDistance(samplesVector[i][j].getObject(), samplesVector[i][idx].getObject());
-                      if((choice == -1) || (dist < distOld)) {
-                         distOld = dist;
-                         if(newSamplesVector[j].size() < numberObjBucket)
-                            choice = j;
-                      } //end if
-                   } //end for
+      if(type==bulkRANGE) {
 
-                   SampleSon<ObjectType> son(samplesVector[i][idx].getObject(),distOld);
-                   newSamplesVector[choice].push_back(son); // opt
+         if(samplesVector[i].size()<ceil((double)numberObjBucket*minNodeOccupancy)) {
+            for(u_int32_t idx=0;idx<samplesVector[i].size();idx++) {
+               newObjs.push_back(samplesVector[i][idx]);
+            } //end for
+            samplesVector.erase(samplesVector.begin() + i);
+            i--;
 
-                } //end for
+   #ifdef __stPRINTMSG__
+      cout << "Estimate number per bucket: " << numberObjBucket << " # rem: " << numberObjRem << endl;
+      u_int32_t total = 0;
+      for(u_int32_t i=0;i<samplesVector.size();i++) {
+         cout << "Sample #: " << i << " Objects #: " << samplesVector[i].size() << endl;
+         total +=  samplesVector[i].size();
+      }
+      cout << "Total: " << total << endl;
+   #endif //__stPRINTMSG__
+                  
+         } else {
+            candidates.push_back(i);
+         } //end if
 
-                samplesVector.erase(& samplesVector[i]);
+      } else {
 
-                for(u_int32_t idx=0;idx<numDiv;idx++) {
-                   samplesVector.push_back(newSamplesVector[idx]);
-                } //end for
 
-            }// end if
-         } //end for
+         if(samplesVector[i].size()>numberObjBucket) { // need to balance
+            while(samplesVector[i].size()>numberObjBucket) {
+               // choose the fartest
+               u_int32_t fartest = 0;
+               double dist = samplesVector[i][0].getDistance();
+               for(u_int32_t idx=1;idx<samplesVector[i].size();idx++) {
+                  if(samplesVector[i][idx].getDistance()>dist) {
+                     dist = samplesVector[i][idx].getDistance();
+                     fartest = idx;
+                  } //end if
+               } //end for
 
+               newObjs.push_back(samplesVector[i][fartest]);
+               samplesVector[i].erase(samplesVector[i].begin() + fartest);
+            } //end while
+         } else { // candidates
+            if(samplesVector[i].size()!=numberObjBucket) {
+               candidates.push_back(i);
+            } //end if
+         } //end if
+         
+      } //end if
 
+   } //end for
 
-      } //end if
 
+   // redistribute objects
+   for(u_int32_t i=0;i<newObjs.size();i++) {
+      int choice = -1;
+      int candidateIdx;
+      double dist = 0.0;
+      double distOld = 0.0;
+	 for(u_int32_t j=0;j<candidates.size();j++) {
+	    dist = context.Evaluator->GetDistance(*sample[candidates[j]].getObject(), *newObjs[i].getObject());
+	    if((choice == -1) || (dist < distOld)) {
+	       distOld = dist;
+            choice = candidates[j];
+            candidateIdx = j;
+	    } //end if
+      } //end for
 
 
+      if(choice == -1) { // remaining
 
+         for(u_int32_t j=0;j<samplesVector.size();j++) {
+            if(samplesVector[j].size()>numberObjBucket) {
+               continue;
+            } //end if
+	       dist = context.Evaluator->GetDistance(*sample[j].getObject(), *newObjs[i].getObject());
+	       if((choice == -1) || (dist < distOld)) {
+	          distOld = dist;
+               choice = j;
+	       } //end if
+         } //end for
+      } else {
+         if(samplesVector[choice].size()+1>=numberObjBucket) {
+            candidates.erase(candidates.begin() + candidateIdx);
+         } //end if
+      } //end if
 
+      SampleSon<ObjectType> son(newObjs[i].getObject(),distOld);
       #ifdef __stPRINTMSG__
-         cout << endl << "Insert" <<endl;
+         cout << "Sample #: " << choice << " Object #: " << i << " Distance: " << distOld << endl;
       #endif //__stPRINTMSG__
 
-      stPage * newIndexPage  = this->NewPage();
-      stSlimIndexNode * indexNode = new stSlimIndexNode(newIndexPage, true);
+      samplesVector[choice].push_back(son); // opt
 
-      bool insertLeaf = true; //samplesVector[0].size() <= numLeafNodeObj;
+   } //end for
 
-      for(int i=0;i<samplesVector.size();i++) {
-         if(samplesVector[i].size() > numLeafNodeObj) {
-            insertLeaf = false;
-            break;
-         } //end if
+   #ifdef __stPRINTMSG__
+      cout << "Estimate number per bucket: " << numberObjBucket << endl;
+      u_int32_t total2 = 0;
+      for(u_int32_t i=0;i<samplesVector.size();i++) {
+         cout << "Sample #: " << i << " Objects #: " << samplesVector[i].size() << endl;
+         total2 +=  samplesVector[i].size();
       } //end for
+      cout << "Total: " << total2 << endl;
+   #endif //__stPRINTMSG__
 
-      #ifdef __stPRINTMSG__
-         cout << "InsertLeaf: " << insertLeaf << endl;
-         cout << "numLeafNodeObj: " << numLeafNodeObj << endl;
-         u_int32_t total3 = 0;
-         for(u_int32_t i=0;i<samplesVector.size();i++) {
-            cout << "Sample #: " << i << " Objects #: " << samplesVector[i].size() << endl;
-            total3 +=  samplesVector[i].size();
-         } //end for
-         cout << "Total: " << total3 << endl;
-      #endif //__stPRINTMSG__
+   // do while?
+
+   if(type==bulkRANGE) {
+      int minHeight = -1;
 
+      // minimum height - @todo: create a function
       for(u_int32_t i=0;i<samplesVector.size();i++) {
+         u_int32_t actHeight = getBulkHeight(samplesVector[i].size(),objSize,minNodeOccupancy);
+         if((minHeight<0)||(minHeight > actHeight)) {
+            minHeight = actHeight;
+         }// end if
+      } //end for
 
-         BulkLoadMemory(samplesVector[i], 0, nodeOccupancy, objSize, sub, insertLeaf, type);
 
-         //@TODO: To reduce memory usage and increase disk access, do the bulk and after, load the node and update the information
-         ObjectType *newIndexObj = sub.Rep;
 
-         u_int32_t insertIdx = indexNode->AddEntry(newIndexObj->GetSerializedSize(),
-                                        newIndexObj->Serialize());
+      for(u_int32_t i=0;i<samplesVector.size();i++) {
+         u_int32_t maxHeight = getBulkHeight(samplesVector[i].size(),objSize,nodeOccupancy);
+         if(maxHeight>minHeight) { // taller subtrees
+         #ifdef __stPRINTMSG__
+             cout << endl << "Break it " << i << endl;
+         #endif //__stPRINTMSG__
+             u_int32_t numDiv = 2;
+
+
+             while(getBulkHeight(ceil((double)samplesVector[i].size()/(double)numDiv),objSize,nodeOccupancy)>minHeight) {
+                numDiv++;
+             } //end while
+             u_int32_t possNumDiv = ceil((double)samplesVector[i].size()/(double)numberObjBucket);
+             if(possNumDiv>numDiv)
+                numDiv = possNumDiv;
+
+             std::vector< std::vector< SampleSon<ObjectType> > > newSamplesVector(numDiv);
+
+             // redistribute objects
+             for(u_int32_t idx=0;idx<samplesVector[i].size();idx++) {
+                int choice = -1;
+                int candidateIdx;
+                double dist = 0.0;
+                double distOld = 0.0;
+                for(u_int32_t j=0;j<numDiv;j++) {
+
+                   dist = context.Evaluator->GetDistance(*samplesVector[i][j].getObject(), *samplesVector[i][idx].getObject());
+                   if((choice == -1) || (dist < distOld)) {
+                      distOld = dist;
+                      if(newSamplesVector[j].size() < numberObjBucket)
+                         choice = j;
+                   } //end if
+                } //end for
 
-        indexNode->GetIndexEntry(insertIdx).Radius = sub.Radius;
-        indexNode->GetIndexEntry(insertIdx).NEntries = sub.NObjects;
-        indexNode->GetIndexEntry(insertIdx).PageID = sub.RootID;
-        if((i==father)||(father<0)) {
-           uniRep = newIndexObj;
-           indexNode->GetIndexEntry(insertIdx).Distance = 0;
-        } else {
-           indexNode->GetIndexEntry(insertIdx).Distance = this->myMetricEvaluator->GetDistance(newIndexObj, uniRep);
-        } //end if
+                SampleSon<ObjectType> son(samplesVector[i][idx].getObject(),distOld);
+                newSamplesVector[choice].push_back(son); // opt
+
+             } //end for
+
+             samplesVector.erase(samplesVector.begin() + i);
+
+             for(u_int32_t idx=0;idx<numDiv;idx++) {
+                samplesVector.push_back(newSamplesVector[idx]);
+             } //end for
 
+         }// end if
       } //end for
 
-      sub.Radius = indexNode->GetMinimumRadius();
-      sub.NObjects = indexNode->GetTotalObjectCount();
-      sub.RootID = newIndexPage->GetPageID();
-      sub.Rep =  uniRep;
 
-      // clean the mess
-      delete indexNode;
-	  indexNode = 0;
 
-      tMetricTree::myPageManager->WritePage(newIndexPage);
-      delete newIndexPage;
-	  newIndexPage = 0;
+   } //end if
 
-      delete[] sample;
+   delete[] sample;
 	  sample = 0;
+} //end stSlimTree<ObjectType, EvaluatorType>::BulkLoadPartition
 
-   } //end if
+//-----------------------------------------------------------------------------
 
-   return true;
-} //end stSlimTree<ObjectType, EvaluatorType>::BulkLoadMemory
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTree::BulkDistribute(std::vector< SampleSon<ObjectType> > & objects, SampleSon<ObjectType> * sample, u_int32_t numObjects, u_int32_t first, u_int32_t last, std::vector<int> & choices, std::vector<double> & distances, EvaluatorType * evaluator){
+
+   for(u_int32_t i=first;i<last;i++) {
+      int choice = -1;
+      double dist = 0.0;
+      double distOld = 0.0;
+      for(u_int32_t j=0;j<numObjects;j++) {
+         dist = evaluator->GetDistance(*sample[j].getObject(), *objects[i].getObject());
+         if((choice == -1) || (dist < distOld)) {
+            distOld = dist;
+            choice = j;
+         } //end if
+      } //end for
+      choices[i] = choice;
+      distances[i] = distOld;
+   } //end for
+} //end stSlimTree<ObjectType, EvaluatorType>::BulkDistribute
 
 #endif //__BULKLOAD__
 
@@ -10015,20 +10937,20 @@ stResult<ObjectType> * tmpl_stSlimTree::preConstrainedNearestQuery(
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -10041,7 +10963,7 @@ stResult<ObjectType> * tmpl_stSlimTree::preConstrainedNearestQuery(
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -10101,7 +11023,7 @@ stResult<ObjectType> * tmpl_stSlimTree::preConstrainedNearestQuery(
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -10185,20 +11107,20 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountGreater
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -10211,7 +11133,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountGreater
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -10304,7 +11226,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountGreater
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -10387,20 +11309,20 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountLessTha
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -10413,7 +11335,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountLessTha
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -10506,7 +11428,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountLessTha
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -10588,20 +11510,20 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -10614,7 +11536,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -10799,7 +11721,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -10880,20 +11802,20 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -10906,7 +11828,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -11031,7 +11953,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -11118,20 +12040,20 @@ stResult<ObjectType> * tmpl_stSlimTree::preConstrainedNearestQuery(
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -11144,7 +12066,7 @@ stResult<ObjectType> * tmpl_stSlimTree::preConstrainedNearestQuery(
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -11191,7 +12113,7 @@ stResult<ObjectType> * tmpl_stSlimTree::preConstrainedNearestQuery(
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -11275,20 +12197,20 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountGreater
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -11301,7 +12223,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountGreater
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -11376,7 +12298,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountGreater
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -11459,20 +12381,20 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountLessTha
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -11485,7 +12407,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountLessTha
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -11560,7 +12482,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountLessTha
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -11642,20 +12564,20 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -11668,7 +12590,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -11838,7 +12760,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -11919,20 +12841,20 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -11945,7 +12867,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -12055,7 +12977,7 @@ stResult<ObjectType> * tmpl_stSlimTree::intraConstrainedNearestQueryCountDistinc
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -12139,20 +13061,20 @@ stResult<ObjectType> * tmpl_stSlimTree::BConstrainedNearestQuery(std::multiset<R
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -12165,7 +13087,7 @@ stResult<ObjectType> * tmpl_stSlimTree::BConstrainedNearestQuery(std::multiset<R
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -12232,7 +13154,7 @@ stResult<ObjectType> * tmpl_stSlimTree::BConstrainedNearestQuery(std::multiset<R
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -12316,20 +13238,20 @@ stResult<ObjectType> * tmpl_stSlimTree::BSlimIntraConstrainedNearestQueryCountGr
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -12342,7 +13264,7 @@ stResult<ObjectType> * tmpl_stSlimTree::BSlimIntraConstrainedNearestQueryCountGr
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -12423,7 +13345,7 @@ stResult<ObjectType> * tmpl_stSlimTree::BSlimIntraConstrainedNearestQueryCountGr
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
@@ -12506,20 +13428,20 @@ stResult<ObjectType> * tmpl_stSlimTree::BSlimIntraConstrainedNearestQueryCountLe
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this subtree with the triangle inequality.
-          if (fabs(distanceRepres - indexNode->GetIndexEntry(idx).Distance) <=
-              rangeK + indexNode->GetIndexEntry(idx).Radius) {
+          if (ParentLowerBound(distanceRepres, indexNode->GetIndexEntry(idx).Distance) <=
+              rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
             // Rebuild the object
             tmpObj.Unserialize(indexNode->GetObject(idx),
                                indexNode->GetObjectSize(idx));
             // Evaluate distance
             distance = this->myMetricEvaluator->GetDistance(&tmpObj, sample);
 
-            if (distance <= rangeK + indexNode->GetIndexEntry(idx).Radius) {
+            if (distance <= rangeK + ScaleRadius(indexNode->GetIndexEntry(idx).Radius)) {
               // Yes! I'm qualified! Put it in the queue.
               pqTmpValue.PageID = indexNode->GetIndexEntry(idx).PageID;
-              pqTmpValue.Radius = indexNode->GetIndexEntry(idx).Radius;
+              pqTmpValue.Radius = ScaleRadius(indexNode->GetIndexEntry(idx).Radius);
               queue->Add(distance, pqTmpValue);
-              this->sumOperationsQueue++; // Update the statistics for the queue
+              this->UpdateQueueStatistics(); // Update the statistics for the queue
             }//end if
           }//end if
         }//end for
@@ -12532,7 +13454,7 @@ stResult<ObjectType> * tmpl_stSlimTree::BSlimIntraConstrainedNearestQueryCountLe
         // for each entry...
         for (idx = 0; idx < numberOfEntries; idx++) {
           // try to cut this object with the triangle inequality.
-          if (fabs(distanceRepres - leafNode->GetLeafEntry(idx).Distance) <=
+          if (ParentLowerBound(distanceRepres, leafNode->GetLeafEntry(idx).Distance) <=
               rangeK) {
             // Rebuild the object
             tmpObj.Unserialize(leafNode->GetObject(idx),
@@ -12615,7 +13537,7 @@ stResult<ObjectType> * tmpl_stSlimTree::BSlimIntraConstrainedNearestQueryCountLe
       stop = false;
       do {
         if (queue->Get(distance, pqCurrValue)) {
-          this->sumOperationsQueue++; // Update the statistics for the queue
+          this->UpdateQueueStatistics(); // Update the statistics for the queue
           // Qualified if distance <= rangeK + radius
           if (distance <= rangeK + pqCurrValue.Radius) {
             // Yes, get the pageID and the distance from the representative
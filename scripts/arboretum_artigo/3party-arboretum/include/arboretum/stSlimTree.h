@@ -42,6 +42,10 @@
 #ifndef INCREMENTVALUEQUEUE
    #define INCREMENTVALUEQUEUE 5
 #endif //INCREMENTVALUEQUEUE
+// this is the number of entries of a node whose distances are evaluated at once
+#ifndef DISTANCEBLOCK
+   #define DISTANCEBLOCK 8
+#endif //DISTANCEBLOCK
 
 #ifdef __stFRACTALQUERY__
    #define SIZERINGCALLS 10
@@ -51,6 +55,24 @@
    #define SECUREVALUE 1.2
 #endif //SECUREVALUE
 
+// this is the number of objects from which BulkLoadMemoryParallel()
+// distributes the objects of a node among its samples in parallel
+#ifndef BULKPARALLELDISTRIBUTION
+   #define BULKPARALLELDISTRIBUTION 4096
+#endif //BULKPARALLELDISTRIBUTION
+
+// this is the number of entries from which stSlimMSTSplitter computes the
+// distance matrix of a node in parallel
+#ifndef MSTPARALLELMATRIX
+   #define MSTPARALLELMATRIX 1024
+#endif //MSTPARALLELMATRIX
+
+// this is the number of rows and columns of each block of the distance matrix
+// mirrored by stSlimMSTSplitter
+#ifndef MSTMATRIXBLOCK
+   #define MSTMATRIXBLOCK 32
+#endif //MSTMATRIXBLOCK
+
 #include <string.h>
 #include <math.h>
 //#include <values.h>
@@ -59,6 +81,19 @@
 
 #include <stack>
 #include <vector>
+#include <map>
+#include <limits>
+#include <thread>
+#include <chrono>
+#include <arboretum/stTaskPool.h>
+#include <arboretum/stQueryStats.h>
+#include <util/stStatistics.h>
+#include <arboretum/stTopKResult.h>
+
+#ifdef __BULKLOAD__
+   #include <mutex>
+   #include <random>
+#endif //__BULKLOAD__
 
 // Include disk access statistics classes
 #ifdef __stDISKACCESSSTATS__
@@ -424,6 +459,13 @@ class stSlimLogicNode{
          }//end if
       }//end SetMinOccupation
 
+      /**
+      * Returns the minimum occupation.
+      */
+      u_int32_t GetMinOccupation(){
+         return MinOccupation;
+      }//end GetMinOccupation
+
       /**
       * Returns the node type. It may assume the values stSlimNode::INDEX or
       * stSlimNode::LEAF.
@@ -552,6 +594,18 @@ class stSlimLogicNode{
 /**
 * This class template implements the SlimTree MST split algorithm.
 *
+* <P>Each row of the lower triangle of the distance matrix is computed by
+* one GetDistances() call if the metric evaluator has one, as the distance
+* functions of hermes do. The upper triangle is then mirrored by blocks of
+* MSTMATRIXBLOCK rows and columns. Nodes with at least MSTPARALLELMATRIX
+* entries have their rows computed by a stTaskPool, each thread with its own
+* copy of the metric evaluator.
+*
+* <P>The minimum spanning tree is built by the Prim algorithm on the dense
+* matrix, in O(N^2). The longest edge that leaves both clusters with the
+* minimum occupation of the node is then removed. If no edge does so, the
+* edge that gives the most balanced clusters is removed.
+*
 * @version 1.0
 * @author Fabio Jun Takada Chino (chino@icmc.sc.usp.br)
 * @todo Documentation review.
@@ -605,45 +659,6 @@ class stSlimMSTSplitter{
       */
       typedef stGenericMatrix <double> tDistanceMatrix;
 
-      /**
-      * Cluster states.
-      */
-      enum tClusterState{
-         ALIVE,
-         DEAD,
-         DEATH_SENTENCE
-      };//end tClusterState
-
-      /**
-      * Cluster information type.
-      */
-      struct tCluster{
-         /**
-         * If this cluster exists.
-         */
-         enum tClusterState State;
-
-         /**
-         * Number of objects in this cluster.
-         */
-         int Size;
-
-         /**
-         * Minimum distance to the nearest cluster.
-         */
-         double MinDist;
-
-         /**
-         * The object of this cluster that defines the minimum distance.
-         */
-         int Src;
-
-         /**
-         * The object of the nearest cluster that defines the minimum distance.
-         */
-         int Dst;
-      };
-
       /**
       * The logic node to be used as source.
       */
@@ -654,11 +669,6 @@ class stSlimMSTSplitter{
       */
       tDistanceMatrix DMat;
 
-      /**
-      * All clusters.
-      */
-      struct tCluster * Cluster;
-
       /**
       * The names of the cluster of each object
       */
@@ -696,23 +706,47 @@ class stSlimMSTSplitter{
       int BuildDistanceMatrix(EvaluatorType * metricEvaluator);
 
       /**
-      * Performs the MST algorithm. This method will split the objects in 2
-      * clusters. The result of the processing will be found at the array
-      * Cluster.
+      * Computes the rows first, first + step, first + 2 * step... of the lower
+      * triangle of the distance matrix, one GetDistances() call per row.
       *
-      * @warning DMat must be initialized.
+      * @param metricEvaluator The metric evaluator.
+      * @param first The first row.
+      * @param step The distance between 2 rows.
       */
-      void PerformMST();
+      void BuildDistanceRows(EvaluatorType * metricEvaluator, int first,
+                             int step);
 
       /**
-      * Joins 2 clusters. This method will insert custer2 into cluster1.
-      *
-      * <P>The state of cluster2 will change to DEATH_SENTENCE.
+      * Evaluates the distances between obj and n objects with the
+      * GetDistances() of the evaluator.
+      */
+      template <class Evaluator>
+      static auto GetDistances(Evaluator * metricEvaluator, ObjectType * obj,
+            ObjectType ** objects, int n, double * distances, int)
+            -> decltype(metricEvaluator->GetDistances(*obj, objects,
+                  (size_t) n, distances)){
+         metricEvaluator->GetDistances(*obj, objects, (size_t) n, distances);
+      }//end GetDistances
+
+      /**
+      * Evaluates the distances between obj and n objects one by one.
+      */
+      template <class Evaluator>
+      static void GetDistances(Evaluator * metricEvaluator, ObjectType * obj,
+            ObjectType ** objects, int n, double * distances, long){
+         for (int j = 0; j < n; j++){
+            distances[j] = metricEvaluator->GetDistance(*obj, *objects[j]);
+         }//end for
+      }//end GetDistances
+
+      /**
+      * Performs the MST algorithm. This method will split the objects in 2
+      * clusters. The result of the processing will be found at the array
+      * ObjectCluster.
       *
-      * @param cluster1 Cluster 1.
-      * @param cluster2 Cluster 2.
+      * @warning DMat must be initialized.
       */
-      void JoinClusters(int cluster1, int cluster2);
+      void PerformMST();
 
 };//end stSlimMSTSplitter
 
@@ -729,6 +763,13 @@ class stSlimMSTSplitter{
 * <P> Main modifications from original code are intent to turn it an object oriented
 * compliant code.
 *
+* <P>The scratch buffers of the queries (priority queues, k-nearest neighbor
+* candidates, distances to the global pivots and blocks of entries) belong to
+* the calling thread (see tQueryContext), so the trees of different threads
+* never share them. A single tree must still not answer queries of several
+* threads at once, since it updates its queue statistics without any lock.
+* stSlimTreeQueryPool runs queries in parallel with one tree per thread.
+*
 * @author Fabio Jun Takada Chino (chino@icmc.sc.usp.br)
 * @author Marcos Rodrigues Vieira (mrvieira@icmc.sc.usp.br)
 * @author Josiel Maimone de Figueiredo (josiel@icmc.sc.usp.br)
@@ -757,8 +798,8 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       typedef struct tSlimHeader{
          /**
          * Magic number. This is a short string that must contains the magic
-         * string "SLIM". It may be used to validate the file (this feature
-         * is not implemented yet).
+         * string "SLIM" or, if the tree has global pivots, "SL-2". A file
+         * with another one is rejected (see CheckHeader()).
          */
          char Magic[4];
       
@@ -808,6 +849,23 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
          u_int32_t NodeCount;
       }stSlimHeader;   
 
+      /**
+      * This structure holds the global pivots of a "SL-2" tree. It is kept at
+      * the end of the header page, after the user data, so the layout of the
+      * trees written before the pivots is unchanged.
+      */
+      typedef struct tSlimPivotHeader{
+         /**
+         * Number of global pivots (see SetPivots()).
+         */
+         u_int32_t PivotCount;
+
+         /**
+         * The page that holds the global pivots.
+         */
+         u_int32_t PivotPageID;
+      }stSlimPivotHeader;
+
       /**
       * These constants are used to define the choose sub tree method.
       */
@@ -890,6 +948,12 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * This is the class that abstracts an result set for simple queries.
       */
       typedef stResult <ObjectType> tResult;
+
+      /**
+      * This is the class that keeps the candidates of a running k-nearest
+      * neighbor query.
+      */
+      typedef stTopKResult <ObjectType> tTopKResult;
       
 #ifdef __stCKNNQ__
       
@@ -965,6 +1029,32 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       virtual bool Add(ObjectType * newObj);
 
+      /**
+      * Adds a batch of objects to the metric tree. The result is a valid
+      * tree, like the one built by calling Add() for each object, but the
+      * pages touched by the batch stay pinned in memory until its end, when
+      * each dirty page is written once.
+      *
+      * <P>If groupBySubtree is true, the objects are first grouped by the
+      * subtree of the root that ChooseSubTree() picks for them, so the
+      * objects that go down the same path are inserted one after another.
+      * This changes the insertion order, so the tree may differ from the one
+      * built by Add() in the given order.
+      *
+      * <P>The object counter is updated once. If writeHeader is true, the
+      * header page is also written at the end of the batch, so the tree on
+      * disk is consistent after each batch.
+      *
+      * @param objects The objects. They are not changed.
+      * @param n Number of objects.
+      * @param groupBySubtree If true, the objects are grouped by subtree.
+      * @param writeHeader If true, the header is written at the end.
+      * @return The number of objects added.
+      * @warning The tree must not be used by other threads during the batch.
+      */
+      u_int32_t AddBatch(ObjectType ** objects, u_int32_t n,
+                         bool groupBySubtree = true, bool writeHeader = true);
+
       /**
       * Returns the height of the tree.
       */
@@ -1241,14 +1331,25 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       #endif //__stDEBUG__
 
       /**
-      * Gets the maximum user data size available in this tree.
+      * Writes the header of this tree to the page manager if it was modified
+      * and flushes the page manager. Other trees opened over the same page
+      * manager (see stSlimTreeQueryPool) read the header from it.
+      */
+      void Flush(){
+         WriteHeader();
+         tMetricTree::myPageManager->Flush();
+      }//end Flush
+
+      /**
+      * Gets the maximum user data size available in this tree. The user data
+      * is kept in the free area of the header page, after the tree header.
       *
       * @see WriteUserData()
       * @see ReadUserData()
-      * @bug This feature is not implemented yet.
       */
       u_int32_t GetUserDataSize(){
-         return 0;
+         return HeaderPage->GetPageSize() - sizeof(stSlimHeader) -
+               sizeof(stSlimPivotHeader);
       }//end GetUserDataSize
 
       /**
@@ -1265,10 +1366,15 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * area.
       * @see GetUserDataSize()
       * @see ReadUserData()
-      * @bug This feature is not implemented yet.
       */
       bool WriteUserData(const unsigned char * userData, u_int32_t size){
-         return false;
+         if (size > GetUserDataSize()){
+            return false;
+         }//end if
+         memcpy(HeaderPage->GetData() + sizeof(stSlimHeader), userData, size);
+         HeaderUpdate = true;
+         WriteHeader();
+         return true;
       }//end WriteUserData
 
       /**
@@ -1277,7 +1383,7 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * <P>This feature allows users to write additional information in to the
       * free area of the header page. The available space will deppends on the
       * size of the header page (see the page manager documentation for more
-      * details).
+      * details). A tree that never had user data reads zeros.
       *
       * @param userData A pointer to the user data.
       * @param size The size of the user data.
@@ -1285,12 +1391,105 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * area.
       * @see GetUserDataSize()
       * @see WriteUserData()
-      * @bug This feature is not implemented yet.
       */
       bool ReadUserData(unsigned char * userData, u_int32_t size){
-         return false;
+         if (size > GetUserDataSize()){
+            return false;
+         }//end if
+         memcpy(userData, HeaderPage->GetData() + sizeof(stSlimHeader), size);
+         return true;
       }//end ReadUserData
 
+      /**
+      * Sets how much the current metric may differ from the metric used to
+      * build the tree. For every pair of objects it must hold that
+      * lower * d_build(a, b) <= d(a, b) <= upper * d_build(a, b).
+      *
+      * <P>The queries use these factors to rescale the covering radii and the
+      * distances to the parent stored in the nodes, so they stay exact when
+      * the metric evaluator changes (the weights of a weighted distance, for
+      * instance) without rebuilding the tree. The joins, which compare two
+      * trees, do not use them. The default is 1 and 1, which means the metric
+      * did not change.
+      *
+      * @param lower The lower factor. It must be in [0, 1].
+      * @param upper The upper factor. It must be at least 1 and may be
+      * infinite.
+      * @exception std::logic_error If a factor is out of its range.
+      * @see EuclideanDistanceWeighted::GetDistortion()
+      */
+      void SetDistortion(double lower, double upper){
+         if (!((lower >= 0) && (lower <= 1) && (upper >= 1))){
+            throw std::logic_error("Invalid distortion factors.");
+         }//end if
+         MinDistortion = lower;
+         MaxDistortion = upper;
+      }//end SetDistortion
+
+      /**
+      * Gets the lower distortion factor.
+      *
+      * @see SetDistortion()
+      */
+      double GetMinDistortion(){
+         return MinDistortion;
+      }//end GetMinDistortion
+
+      /**
+      * Gets the upper distortion factor.
+      *
+      * @see SetDistortion()
+      */
+      double GetMaxDistortion(){
+         return MaxDistortion;
+      }//end GetMaxDistortion
+
+      /**
+      * Sets the global pivots of this tree. Each leaf entry will keep its
+      * distances to the pivots (its field distances) and the range and
+      * k-nearest neighbor queries will cut an entry when
+      * max_i |d(q, p_i) - d(o, p_i)| exceeds their radius, before the
+      * distance d(q, o) is evaluated, as the Omni-family methods do. The
+      * pivots are kept in a page of this tree.
+      *
+      * <P>The field distances are subject to the distortion of the metric as
+      * the distances to the representatives are (see SetDistortion()).
+      *
+      * @param pivots The pivots. They are copied.
+      * @param n The number of pivots. It may be up to 255.
+      * @exception std::logic_error If the tree is not empty, if it has pivots
+      * already, if there are too many pivots or if they do not fit in a page.
+      */
+      void SetPivots(ObjectType ** pivots, u_int32_t n);
+
+      /**
+      * Chooses n global pivots among a sample of objects with the HF
+      * algorithm (see stOmniPivot::FindPivot()) and sets them by SetPivots().
+      *
+      * @param objects The sample of objects.
+      * @param size The number of objects in the sample.
+      * @param n The number of pivots.
+      * @exception std::logic_error If the pivots can not be set or if the
+      * sample has less than n objects.
+      */
+      void FindPivots(ObjectType ** objects, u_int32_t size, u_int32_t n);
+
+      /**
+      * Returns the number of global pivots.
+      */
+      u_int32_t GetNumberOfPivots(){
+         return Pivots.size();
+      }//end GetNumberOfPivots
+
+      /**
+      * Returns a global pivot. It must not be modified or deleted.
+      *
+      * @param idx The index of the pivot.
+      */
+      ObjectType * GetPivot(u_int32_t idx){
+         return Pivots[idx];
+      }//end GetPivot
+
       /**
       * This method will perform a Forward range query.
       * The result will be a set of pairs object/distance.
@@ -1365,11 +1564,35 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       *
       * @param sample The sample object.
       * @param range The range of the results.
+      * @param stats The statistics of this query or NULL. Default NULL.
       * @return The result or NULL if this method is not implemented.
       * @warning The instance of tResult returned must be destroied by user.
       * @see void RangeQuery()
       */
-      tResult * RangeQuery(ObjectType * sample, double range);
+      tResult * RangeQuery(ObjectType * sample, double range,
+                           stQueryStats * stats = NULL);
+
+      /**
+      * This method will perform a range query for each sample of a batch.
+      * The tree is visited level by level and the queries that reach the same
+      * node are evaluated together, so each node is read and each of its
+      * entries is unserialized once per batch, whatever the number of
+      * queries that visit it. Each entry is evaluated against the queries
+      * that the triangle inequality and the global pivots do not prune, all
+      * at once (see GetBoundedDistances()).
+      *
+      * <P>Each result holds the same pairs RangeQuery() would return.
+      *
+      * @param samples The sample objects.
+      * @param n The number of samples.
+      * @param range The range of the results.
+      * @param results The results. results[i] is the answer of samples[i] and
+      * must be destroied by user.
+      * @param stats The statistics of the whole batch or NULL. Default NULL.
+      * @see RangeQuery()
+      */
+      void RangeQuery(ObjectType ** samples, u_int32_t n, double range,
+                      tResult ** results, stQueryStats * stats = NULL);
 
       /**
       * This method will perform a reverse of range query.
@@ -1426,11 +1649,39 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param sample The sample object.
       * @param k The number of neighbors.
       * @param tie The tie list. Default false.
+      * @param stats The statistics of this query or NULL. Default NULL.
       * @return The result or NULL if this method is not implemented.
       * @warning The instance of tResult returned must be destroied by user.
       * @see void NearestQuery
       */
-      tResult * NearestQuery(ObjectType * sample, u_int32_t k, bool tie = false);
+      tResult * NearestQuery(ObjectType * sample, u_int32_t k, bool tie = false,
+                             stQueryStats * stats = NULL);
+
+      /**
+      * This method will perform a k-nearest neighbor query for each sample of
+      * a batch. Each query keeps its own priority queue and visits the same
+      * nodes, in the same order, as NearestQuery() would. The queries move in
+      * rounds of one node each, and the queries that want the same node in a
+      * round share its read: the node is read once and each entry is
+      * unserialized once and evaluated against all of them at once (see
+      * GetBoundedDistances()).
+      *
+      * <P>The upper levels are read once for the whole batch, so the gain
+      * grows with the number of queries.
+      *
+      * @param samples The sample objects.
+      * @param n The number of samples.
+      * @param k The number of neighbors.
+      * @param results The results. results[i] is the answer of samples[i] and
+      * must be destroied by user.
+      * @param tie The tie list. Default false.
+      * @param stats The statistics of the whole batch or NULL. Default NULL.
+      * The peak of the queue is that of the largest queue of a query.
+      * @see NearestQuery()
+      */
+      void NearestQuery(ObjectType ** samples, u_int32_t n, u_int32_t k,
+                        tResult ** results, bool tie = false,
+                        stQueryStats * stats = NULL);
 
       /**
       * This method will perform a K-Farthest Neighbor query using a global priority
@@ -1444,11 +1695,13 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param sample The sample object.
       * @param k The number of neighbors.
       * @param tie The tie list. Default false.
+      * @param stats The statistics of this query or NULL. Default NULL.
       * @return The result or NULL if this method is not implemented.
       * @warning The instance of tResult returned must be destroied by user.
       * @see void FarthestQuery
       */
-      tResult * FarthestQuery(ObjectType * sample, u_int32_t k, bool tie = false);
+      tResult * FarthestQuery(ObjectType * sample, u_int32_t k, bool tie = false,
+                              stQueryStats * stats = NULL);
 
       /**
       * This method will return the object in the tree that has the distance 0
@@ -1461,12 +1714,13 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * method.
       *
       * @param sample The sample object.
+      * @param stats The statistics of this query or NULL. Default NULL.
       * @return The result or NULL if this method is not implemented.
       * @warning This method return only one object that has distance 0 to the
       * query object.
       * @warning The instance of tResult returned must be destroied by user.
       */
-      tResult * PointQuery(ObjectType * sample);
+      tResult * PointQuery(ObjectType * sample, stQueryStats * stats = NULL);
 
       /**
       * This method will inicializate the parameters to perform a
@@ -1667,12 +1921,14 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param range The range of the results.
       * @param k The maximum number of results.
       * @param tie The tie list. This parameter is optional. Default false;
+      * @param stats The statistics of this query or NULL. Default NULL.
       * @warning The instance of tResult returned must be destroied by user.
       * @see void KAndRangeQuery
       * @warning This method does not work for trees with only one node.
       */
       tResult * KAndRangeQuery(ObjectType * sample, double range,
-                               u_int32_t k, bool tie = false);
+                               u_int32_t k, bool tie = false,
+                               stQueryStats * stats = NULL);
 
       /**
       * This method will perform range query with a limited number of results.
@@ -1686,13 +1942,15 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param range The range of the results.
       * @param k The maximum number of results.
       * @param tie The tie list. This parameter is optional. Default false;
+      * @param stats The statistics of this query or NULL. Default NULL.
       * @return The result or NULL if this method is not implemented.
       * @warning The instance of tResult returned must be destroied by user.
       * @see void KOrRangeQuery
       * @warning This method does not work for trees with only one node.
       */
       tResult * KOrRangeQuery(ObjectType * sample, double range,
-                              u_int32_t k, bool tie = false);
+                              u_int32_t k, bool tie = false,
+                              stQueryStats * stats = NULL);
 
       /**
       * This method will perform the disjunctive complex similarity query between
@@ -1912,10 +2170,33 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
          bool BulkLoadMemory(ObjectType **objects, u_int32_t numObj, enum tBulkType type);
          bool BulkLoadMemory(ObjectType **objects, u_int32_t numObj, double nodeOccupancy, enum tBulkType type);
          bool BulkLoadMemory(ObjectType **objects, u_int32_t numObj, double nodeOccupancy, u_int32_t objSize, enum tBulkType type);
-         bool BulkLoadMemory(vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, enum tBulkType type);
+         bool BulkLoadMemory(std::vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, enum tBulkType type);
+
+         /**
+         * Same as BulkLoadMemory(), but the tree is built by a pool of
+         * threads (see stTaskPool). The subtrees of each index node are
+         * built as independent tasks and the objects of large nodes are
+         * distributed among the samples in parallel. Each thread uses its
+         * own copy of the metric evaluator; their distance counts are added
+         * to the evaluator of this tree at the end.
+         *
+         * <P>The samples are drawn from a generator seeded with rand() once,
+         * so the tree depends on srand() only and not on the number of
+         * threads (it is not the tree built by BulkLoadMemory(), though).
+         *
+         * <P>The page manager is only called by one thread at a time, so it
+         * needs no support for concurrency.
+         *
+         * @param objects The objects to be added.
+         * @param numObj The number of objects.
+         * @param nodeOccupancy The node occupancy.
+         * @param objSize The size of the largest object.
+         * @param type The number of entries of the index nodes.
+         * @param nThreads The number of threads. If 0, the number of cores
+         * is used.
+         */
+         bool BulkLoadMemoryParallel(ObjectType **objects, u_int32_t numObj, double nodeOccupancy, u_int32_t objSize, enum tBulkType type, u_int32_t nThreads = 0);
 
-         
-         
       #endif //__BULKLOAD__
 
       /**
@@ -2091,6 +2372,12 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
 
       typedef stDynamicRReversedPriorityQueue < double, stQueryPriorityQueueValue > tDynamicReversedPriorityQueue;
 
+      /**
+      * This type is used by the priority key of the queries that reuse the
+      * queue of the tree.
+      */
+      typedef stDaryRPriorityQueue < double, stQueryPriorityQueueValue > tQueryQueue;
+
       /**
       * This enumeration defines the actions to be taken after an call of
       * InsertRecursive.
@@ -2112,6 +2399,41 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
          PROMOTION
       };//end stInsertAction
 
+      /**
+      * A node to be visited by a query of a batch.
+      */
+      struct stQueryVisit{
+         /**
+         * The node.
+         */
+         u_int32_t PageID;
+
+         /**
+         * The query.
+         */
+         u_int32_t Query;
+
+         /**
+         * The level of the node. The root is at level 0.
+         */
+         u_int32_t Level;
+
+         /**
+         * Distance between the query and the representative of the node.
+         */
+         double DistanceRepres;
+
+         /**
+         * Orders the visits by node and then by query.
+         */
+         bool operator < (const stQueryVisit & visit) const{
+            if (PageID != visit.PageID){
+               return PageID < visit.PageID;
+            }//end if
+            return Query < visit.Query;
+         }//end operator <
+      };
+
       /**
       * This structure holds a promotion data. It contains the representative
       * object, the ID of the root, the Radius and the number of objects of the subtree.
@@ -2176,9 +2498,55 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       #endif //__stFRACTALQUERY__
 
       #ifdef __BULKLOAD__
-         stack<stPage*, vector<stPage*> > rightPathEntries;
+         std::stack<stPage*, std::vector<stPage*> > rightPathEntries;
+
+         /**
+         * The state of a thread of BulkLoadMemory().
+         */
+         struct tBulkContext{
+            /**
+            * The evaluator of the thread.
+            */
+            EvaluatorType * Evaluator;
+
+            /**
+            * The generator of samples or NULL to use rand().
+            */
+            std::minstd_rand * Random;
+
+            /**
+            * The pool of a parallel build or NULL.
+            */
+            stTaskPool * Pool;
+
+            /**
+            * The evaluators of the threads of Pool, by thread ID.
+            */
+            std::vector <EvaluatorType *> * Evaluators;
+
+            /**
+            * The ID of the thread in Pool.
+            */
+            u_int32_t ThreadID;
+         };//end tBulkContext
+
+         /**
+         * Serializes the calls to the page manager during a bulk load.
+         */
+         std::mutex BulkPageMutex;
       #endif  //__BULKLOAD__
 
+      /**
+      * Distortion factors of the current metric (see SetDistortion()).
+      */
+      double MinDistortion;
+      double MaxDistortion;
+
+      /**
+      * The global pivots (see SetPivots()).
+      */
+      std::vector <ObjectType *> Pivots;
+
       /**
       * If true, the header mus be written to the page manager.
       */
@@ -2189,12 +2557,220 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       stSlimHeader * Header;
 
+      /**
+      * The pivot fields of the header. This variable points to the end of the
+      * HeaderPage and is only valid if the magic is "SL-2".
+      */
+      stSlimPivotHeader * PivotHeader;
+
       /**
       * Pointer to the header page.
       * The Slim Tree keeps this page in memory for faster access.
       */
       stPage * HeaderPage;
 
+      /**
+      * A page pinned by AddBatch().
+      */
+      struct tBatchPage{
+         /**
+         * The page.
+         */
+         stPage * Page;
+
+         /**
+         * True if the page must be written.
+         */
+         bool Dirty;
+
+         tBatchPage(){
+            Page = NULL;
+            Dirty = false;
+         }//end tBatchPage
+      };//end tBatchPage
+
+      /**
+      * True during AddBatch().
+      */
+      bool Batching;
+
+      /**
+      * The pages pinned by AddBatch(), by page ID.
+      */
+      std::map <u_int32_t, tBatchPage> BatchPages;
+
+      /**
+      * Start time and distance count of a query with statistics. It lives
+      * on the stack of the public query method, so the queries of other
+      * threads, even those sharing the metric evaluator, never touch it.
+      */
+      struct tQueryStart{
+         /**
+         * Start time of the query.
+         */
+         std::chrono::steady_clock::time_point Time;
+
+         /**
+         * DISTANCES counted by this thread before the query.
+         */
+         u_int64_t Distances;
+      };//end tQueryStart
+
+      /**
+      * Scratch buffers of the running query. They are kept between queries
+      * to reuse their memory, one set per thread (see GetQueryContext()).
+      */
+      struct tQueryContext{
+         /**
+         * Distances between the sample and the global pivots.
+         */
+         std::vector <double> Fields;
+
+         /**
+         * Candidates of a k-nearest neighbor query.
+         */
+         tTopKResult TopK;
+
+         /**
+         * Candidates of each query of a batch of k-nearest neighbor queries.
+         */
+         std::vector <tTopKResult> BatchTopK;
+
+         /**
+         * Global Priority Queue of a best-first query.
+         */
+         tQueryQueue Queue;
+
+         /**
+         * Global Priority Queue of each query of a batch of k-nearest
+         * neighbor queries.
+         */
+         std::vector <tQueryQueue> BatchQueues;
+
+         /**
+         * Entries of the node being scanned whose distances are evaluated
+         * at once: their objects, their indexes in the node and their
+         * distances (see AddBlockEntry() and EvaluateBlock()).
+         */
+         std::vector <ObjectType *> BlockObjects;
+         std::vector <u_int32_t> BlockEntries;
+         std::vector <double> BlockDistances;
+
+         ~tQueryContext(){
+            for (u_int32_t i = 0; i < BlockObjects.size(); i++){
+               delete BlockObjects[i];
+            }//end for
+         }//end ~tQueryContext
+      };//end tQueryContext
+
+      /**
+      * Returns the scratch buffers of the queries of the calling thread.
+      * Queries do not nest, so one set per thread is enough.
+      */
+      static tQueryContext & GetQueryContext(){
+         static thread_local tQueryContext context;
+
+         return context;
+      }//end GetQueryContext
+
+      /**
+      * Counts an operation on the priority queue of a query, in
+      * sumOperationsQueue and in the QUEUEOPERATIONS counter of stStatistics.
+      */
+      void UpdateQueueStatistics(){
+         this->sumOperationsQueue++;
+         stStatistics::Add(stStatistics::QUEUEOPERATIONS);
+      }//end UpdateQueueStatistics
+
+      /**
+      * Starts the statistics of a query. It must be called by the public
+      * query methods before any node is read.
+      *
+      * @param stats The statistics of the query or NULL.
+      * @param start The start of the query, for EndQueryStats().
+      */
+      static void BeginQueryStats(stQueryStats * stats, tQueryStart & start){
+         if (stats != NULL){
+            stats->Reset();
+            start.Distances = stStatistics::GetThread(stStatistics::DISTANCES);
+            start.Time = std::chrono::steady_clock::now();
+         }//end if
+      }//end BeginQueryStats
+
+      /**
+      * Ends the statistics started by BeginQueryStats(). The distances are
+      * those counted by stStatistics in the calling thread, so the query
+      * must run in a single thread.
+      *
+      * @param stats The statistics of the query or NULL.
+      * @param start The start of the query.
+      */
+      static void EndQueryStats(stQueryStats * stats, const tQueryStart & start){
+         if (stats != NULL){
+            stats->Time = std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - start.Time).count();
+            stats->DistanceCount =
+                  stStatistics::GetThread(stStatistics::DISTANCES) - start.Distances;
+         }//end if
+      }//end EndQueryStats
+
+      /**
+      * Records the read of a node by a query.
+      *
+      * @param stats The statistics of the query or NULL.
+      * @param level The level of the node.
+      */
+      static void CountNodeRead(stQueryStats * stats, u_int32_t level){
+         if (stats != NULL){
+            stats->AddNode(level);
+         }//end if
+      }//end CountNodeRead
+
+      /**
+      * Records an entry cut by the parent distance test.
+      *
+      * @param stats The statistics of the query or NULL.
+      */
+      static void CountParentPruned(stQueryStats * stats){
+         if (stats != NULL){
+            stats->ParentPruned++;
+         }//end if
+      }//end CountParentPruned
+
+      /**
+      * Records an entry cut by its field distances.
+      *
+      * @param stats The statistics of the query or NULL.
+      */
+      static void CountPivotPruned(stQueryStats * stats){
+         if (stats != NULL){
+            stats->PivotPruned++;
+         }//end if
+      }//end CountPivotPruned
+
+      /**
+      * Records an entry cut by the covering test.
+      *
+      * @param stats The statistics of the query or NULL.
+      */
+      static void CountCoveringPruned(stQueryStats * stats){
+         if (stats != NULL){
+            stats->CoveringPruned++;
+         }//end if
+      }//end CountCoveringPruned
+
+      /**
+      * Records the size of the priority queue of a query.
+      *
+      * @param stats The statistics of the query or NULL.
+      * @param size The number of nodes in the queue.
+      */
+      static void CountQueueSize(stQueryStats * stats, u_int32_t size){
+         if (stats != NULL){
+            stats->UpdateQueuePeak(size);
+         }//end if
+      }//end CountQueueSize
+
       /**
       * Sets all header's fields to default values.
       *
@@ -2210,6 +2786,91 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       void LoadHeader();
 
+      /**
+      * Checks the magic number of a header loaded from the page manager.
+      *
+      * @exception std::logic_error If the page manager holds a file of
+      * another kind of tree.
+      */
+      void CheckHeader();
+
+      /**
+      * Loads the global pivots from their page, if any.
+      */
+      void LoadPivots();
+
+      /**
+      * Evaluates the distances between a sample and the global pivots.
+      *
+      * @param sample The sample object.
+      * @param fields The distances.
+      */
+      void GetQueryFields(ObjectType * sample, std::vector <double> & fields);
+
+      /**
+      * Returns a lower bound of the distance between the query and a leaf
+      * entry given by its field distances, or 0 if the leaf has none. Each
+      * field distance is taken with the distortion as ParentLowerBound()
+      * takes the distance to the representative.
+      *
+      * @param leafNode The leaf node.
+      * @param idx The index of the entry.
+      * @param fields The distances between the query and the global pivots
+      * (see GetQueryFields()).
+      */
+      double FieldLowerBound(stSlimLeafNode * leafNode, u_int32_t idx,
+                             const std::vector <double> & fields){
+         u_int32_t n = leafNode->GetNumberOfFields();
+         double field;
+         double bound = 0;
+         double d;
+
+         if ((n == 0) || (n != fields.size())){
+            return 0;
+         }//end if
+         for (u_int32_t i = 0; i < n; i++){
+            field = leafNode->GetFieldDistance(idx, i);
+            // Fields not evaluated yet are negative.
+            if (field >= 0){
+               d = ParentLowerBound(fields[i], field);
+               if (d > bound){
+                  bound = d;
+               }//end if
+            }//end if
+         }//end for
+         return bound;
+      }//end FieldLowerBound
+
+      /**
+      * Creates a new leaf node with room for the field distances of the
+      * global pivots.
+      *
+      * @param page The page of the node.
+      */
+      stSlimLeafNode * CreateLeafNode(stPage * page){
+         return new stSlimLeafNode(page, true, Pivots.size());
+      }//end CreateLeafNode
+
+      /**
+      * Evaluates the field distances of the entries of a leaf page that do
+      * not have them yet. Index pages are not changed.
+      *
+      * @param page The page.
+      * @param evaluator The evaluator of the calling thread.
+      */
+      void UpdateFieldDistances(stPage * page, EvaluatorType * evaluator);
+
+      /**
+      * Writes a node page to the page manager after updating its field
+      * distances.
+      *
+      * @param page The page.
+      */
+      void WriteTreePage(stPage * page){
+         UpdateFieldDistances(page, this->myMetricEvaluator);
+         tMetricTree::myPageManager->WritePage(page);
+      }//end WriteTreePage
+
       /**
       * Updates the header in the file if required.
       */
@@ -2228,6 +2889,200 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       */
       void FlushHeader();
       
+      /**
+      * Rebuilds an entry of a node so its distance to the query can be
+      * evaluated. If __stOBJECTVIEW__ is defined, the object becomes a view of
+      * the node page (see stObject::UnserializeView()) and must not be used
+      * after the page is released; objects that go to the result are cloned.
+      *
+      * @param obj The object to be rebuilt.
+      * @param data The serialized object inside the node.
+      * @param size The size of the serialized object.
+      */
+      void LoadObject(ObjectType & obj, const unsigned char * data, u_int32_t size){
+         #ifdef __stOBJECTVIEW__
+            obj.UnserializeView(data, size);
+         #else
+            obj.Unserialize(data, size);
+         #endif //__stOBJECTVIEW__
+      }//end LoadObject
+
+      /**
+      * Adds an entry of a node to the block whose distances are evaluated
+      * at once (see EvaluateBlock()).
+      *
+      * @param context The scratch buffers of the query.
+      * @param idx The index of the entry in the node.
+      * @return The object that must hold the entry (see LoadObject()).
+      */
+      static ObjectType * AddBlockEntry(tQueryContext & context, u_int32_t idx){
+         if (context.BlockObjects.size() == context.BlockEntries.size()){
+            context.BlockObjects.push_back(new ObjectType());
+         }//end if
+         context.BlockEntries.push_back(idx);
+         return context.BlockObjects[context.BlockEntries.size() - 1];
+      }//end AddBlockEntry
+
+      /**
+      * Evaluates the distances between the sample and the objects of the
+      * block in context.BlockDistances, at once if the evaluator can (see
+      * GetBoundedDistances()). A distance larger than bound may be left
+      * unfinished: it is then only known to be larger than bound.
+      *
+      * @param context The scratch buffers of the query.
+      * @param sample The query object.
+      * @param bound The largest distance of any use to the caller.
+      */
+      void EvaluateBlock(tQueryContext & context, ObjectType * sample,
+                         double bound){
+         context.BlockDistances.resize(context.BlockEntries.size());
+         this->GetBoundedDistances(*sample, context.BlockObjects.data(),
+               context.BlockEntries.size(), context.BlockDistances.data(), bound);
+      }//end EvaluateBlock
+
+      /**
+      * Returns the largest covering radius of the entries of the block,
+      * under the current metric.
+      *
+      * @param context The scratch buffers of the query.
+      * @param indexNode The index node of the entries.
+      */
+      double GetBlockRadius(tQueryContext & context, stSlimIndexNode * indexNode){
+         double radius = 0;
+
+         for (u_int32_t i = 0; i < context.BlockEntries.size(); i++){
+            radius = std::max(radius, ScaleRadius(
+                  indexNode->GetIndexEntry(context.BlockEntries[i]).Radius));
+         }//end for
+         return radius;
+      }//end GetBlockRadius
+
+      /**
+      * Returns a covering radius stored in the tree under the current metric.
+      *
+      * @param radius The stored radius.
+      */
+      double ScaleRadius(double radius){
+         if (MaxDistortion == 1){
+            return radius;
+         }else if (MaxDistortion == std::numeric_limits<double>::infinity()){
+            // A radius of 0 may hide anything too.
+            return MaxDistortion;
+         }else{
+            return radius * MaxDistortion;
+         }//end if
+      }//end ScaleRadius
+
+      /**
+      * Returns a lower bound of the distance between the query and an entry
+      * using the triangle inequality. The stored distance between the entry
+      * and its representative is only known to lie in
+      * [MinDistortion * stored, MaxDistortion * stored] under the current
+      * metric. With no distortion it is |distanceRepres - stored|.
+      *
+      * @param distanceRepres Distance between the query and the representative.
+      * @param stored Distance to the representative stored in the node.
+      */
+      double ParentLowerBound(double distanceRepres, double stored){
+         double lower = stored * MinDistortion;
+         double upper = ScaleRadius(stored);
+
+         if (distanceRepres > upper){
+            return distanceRepres - upper;
+         }else if (distanceRepres < lower){
+            return lower - distanceRepres;
+         }else{
+            return 0;
+         }//end if
+      }//end ParentLowerBound
+
+      /**
+      * Returns the distance to the representative an entry of the
+      * incremental queries is queued with. Their queues take
+      * |distanceRepres - distance| as the lower bound of the distance to the
+      * entry, so it is ParentLowerBound() up to rounding. With no distortion
+      * it is the stored distance.
+      *
+      * @param distanceRepres Distance between the query and the representative.
+      * @param stored Distance to the representative stored in the node.
+      */
+      double QueueParentDistance(double distanceRepres, double stored){
+         if ((MinDistortion == 1) && (MaxDistortion == 1)){
+            return stored;
+         }//end if
+         return distanceRepres - ParentLowerBound(distanceRepres, stored);
+      }//end QueueParentDistance
+
+      /**
+      * Inserts an object without updating the object counter. It is the
+      * body of Add() and AddBatch().
+      *
+      * @param newObj The object to be added.
+      * @return True if the object was inserted.
+      */
+      bool InsertObject(ObjectType * newObj);
+
+      /**
+      * Reads a node page for an insertion. During AddBatch() the page is
+      * pinned, so the same instance is returned until the end of the batch.
+      *
+      * @param pageID The ID of the page.
+      */
+      stPage * GetNodePage(u_int32_t pageID){
+         typename std::map <u_int32_t, tBatchPage>::iterator i;
+         stPage * page;
+
+         if (Batching){
+            i = BatchPages.find(pageID);
+            if (i != BatchPages.end()){
+               return i->second.Page;
+            }//end if
+            page = tMetricTree::myPageManager->GetPage(pageID);
+            BatchPages[pageID].Page = page;
+            return page;
+         }//end if
+         return tMetricTree::myPageManager->GetPage(pageID);
+      }//end GetNodePage
+
+      /**
+      * Writes a node page changed by an insertion. During AddBatch() the page
+      * is only marked as dirty.
+      *
+      * @param page The page.
+      */
+      void WriteNodePage(stPage * page){
+         tBatchPage * batchPage;
+
+         if (Batching){
+            batchPage = &BatchPages[page->GetPageID()];
+            batchPage->Page = page;
+            batchPage->Dirty = true;
+         }else{
+            WriteTreePage(page);
+         }//end if
+      }//end WriteNodePage
+
+      /**
+      * Releases a node page used by an insertion. During AddBatch() the page
+      * stays pinned.
+      *
+      * @param page The page.
+      */
+      void ReleaseNodePage(stPage * page){
+
+         if (Batching){
+            BatchPages[page->GetPageID()].Page = page;
+         }else{
+            tMetricTree::myPageManager->ReleasePage(page);
+         }//end if
+      }//end ReleaseNodePage
+
+      /**
+      * Writes the dirty pages of the batch, releases all pinned pages and
+      * ends the batch.
+      */
+      void FlushBatch();
+
       /**
       * Creates a new empty page and updates the node counter.
       */
@@ -2536,11 +3391,14 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param sample The sample object.
       * @param range The range of the result.
       * @param distanceRepres The distance of the representative.
+      * @param level The level of the page.
+      * @param stats The statistics of the query or NULL.
       * @see tResult * RangeQuery()
       */
       void RangeQuery(u_int32_t pageID, tResult * result,
                       ObjectType * sample, double range,
-                      double distanceRepres);
+                      double distanceRepres, u_int32_t level,
+                      stQueryStats * stats);
 
       /**
       * This method will perform a reverse range query.
@@ -2597,10 +3455,11 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param sample The sample object.
       * @param rangeK The range of the results.
       * @param k The number of neighbours.
+      * @param stats The statistics of the query or NULL.
       * @see tResult * NearestQuery
       */
       void NearestQuery(tResult * result, ObjectType * sample,
-                        double rangeK, u_int32_t k);
+                        double rangeK, u_int32_t k, stQueryStats * stats);
 
 
       /**
@@ -2611,10 +3470,11 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param sample The sample object.
       * @param rangeK The range of the results.
       * @param k The number of farthest neighbours.
+      * @param stats The statistics of the query or NULL.
       * @see tResult * NearestQuery
       */
       void FarthestQuery(tResult * result, ObjectType * sample,
-                         double rangeK, u_int32_t k);
+                         double rangeK, u_int32_t k, stQueryStats * stats);
 
       /**
       * This method will return the object in the tree that has the distance 0
@@ -2627,12 +3487,14 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * method.
       *
       * @param sample The sample object.
+      * @param stats The statistics of the query or NULL.
       * @return The result or NULL if this method is not implemented.
       * @warning This method return only one object that has distance 0 to the
       * query object.
       * @see tResult * PointQuery
       */
-      void PointQuery(tResult * result, ObjectType * sample);
+      void PointQuery(tResult * result, ObjectType * sample,
+                      stQueryStats * stats);
 
       /**
       * This method will perform a range query with a limited number of results.
@@ -2647,11 +3509,12 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param sample The sample object.
       * @param range The range of the results.
       * @param k The maximum number of results.
+      * @param stats The statistics of the query or NULL.
       * @see tResult * KAndRangeQuery
       * @warning This method does not work for trees with only one node.
       */
       void KAndRangeQuery(tResult * result, ObjectType * sample,
-                          double range, u_int32_t k);
+                          double range, u_int32_t k, stQueryStats * stats);
 
       /**
       * This method will perform range query with a limited number of results.
@@ -2667,11 +3530,12 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
       * @param range The range of the results.
       * @param dk The maximum distance.
       * @param k The maximum number of results.
+      * @param stats The statistics of the query or NULL.
       * @see tResult * KOrRangeQuery
       * @warning This method does not work for trees with only one node.
       */
       void KOrRangeQuery(tResult * result, ObjectType * sample,
-                         double range, u_int32_t k);
+                         double range, u_int32_t k, stQueryStats * stats);
 
       /**
       * This method will perform a ring query.
@@ -2935,9 +3799,68 @@ class stSlimTree: public stMetricTree <ObjectType, EvaluatorType> {
          int  BulkLoadSimple (ObjectType **objects, u_int32_t numObj, double leafNodeOccupancy, stPage *& auxPage, int currObj);
          int  BulkLoadSampled(ObjectType **objects, u_int32_t numObj, double leafNodeOccupancy, stPage *& auxPage, int currObj);
 
-         bool BulkLoadMemory(vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, enum tBulkType type);
-         bool BulkLoadMemory(vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, bool insertLeaf, enum tBulkType type);
-         bool BulkLoadMemory(vector< SampleSon<ObjectType> > objects, int father, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, bool insertLeaf, enum tBulkType type);
+         bool BulkLoadMemory(std::vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, enum tBulkType type);
+         bool BulkLoadMemory(std::vector< SampleSon<ObjectType> > objects, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, bool insertLeaf, enum tBulkType type);
+         bool BulkLoadMemory(std::vector< SampleSon<ObjectType> > objects, int father, double nodeOccupancy, u_int32_t objSize, stSubtreeInfo & sub, bool insertLeaf, enum tBulkType type, tBulkContext & context);
+
+         /**
+         * Chooses the samples of an index node and distributes the objects
+         * among them. Used by BulkLoadMemory().
+         *
+         * @param objects The objects of the node.
+         * @param father The index of the representative of the node or -1.
+         * @param numObjects The number of samples.
+         * @param nodeOccupancy The node occupancy.
+         * @param objSize The size of the largest object.
+         * @param type The number of entries of the index nodes.
+         * @param samplesVector Receives the objects of each subtree.
+         * @param context The state of the calling thread.
+         */
+         void BulkLoadPartition(std::vector< SampleSon<ObjectType> > & objects, int father, double numObjects, double nodeOccupancy, u_int32_t objSize, enum tBulkType type, std::vector< std::vector< SampleSon<ObjectType> > > & samplesVector, tBulkContext & context);
+
+         /**
+         * Finds the nearest sample of the objects in [first, last). Used by
+         * BulkLoadPartition().
+         *
+         * @param objects The objects of the node.
+         * @param sample The samples.
+         * @param numObjects The number of samples.
+         * @param first The first object.
+         * @param last The object after the last one.
+         * @param choices Receives the nearest sample of each object.
+         * @param distances Receives the distance to the nearest sample.
+         * @param evaluator The evaluator of the calling thread.
+         */
+         void BulkDistribute(std::vector< SampleSon<ObjectType> > & objects, SampleSon<ObjectType> * sample, u_int32_t numObjects, u_int32_t first, u_int32_t last, std::vector<int> & choices, std::vector<double> & distances, EvaluatorType * evaluator);
+
+         /**
+         * Returns a random number for BulkLoadMemory().
+         */
+         u_int32_t BulkRandom(tBulkContext & context){
+            return (context.Random == NULL) ? rand() : (*context.Random)();
+         }//end BulkRandom
+
+         /**
+         * NewPage() for BulkLoadMemory(). It may be called by many threads.
+         */
+         stPage * BulkNewPage(){
+            std::lock_guard<std::mutex> lock(BulkPageMutex);
+            return this->NewPage();
+         }//end BulkNewPage
+
+         /**
+         * Writes and releases a page for BulkLoadMemory(). It may be called
+         * by many threads.
+         *
+         * @param page The page.
+         * @param context The context of the calling thread.
+         */
+         void BulkWritePage(stPage * page, tBulkContext & context){
+            UpdateFieldDistances(page, context.Evaluator);
+            std::lock_guard<std::mutex> lock(BulkPageMutex);
+            tMetricTree::myPageManager->WritePage(page);
+            tMetricTree::myPageManager->ReleasePage(page);
+         }//end BulkWritePage
 
          /**
          * Utilities
@@ -0,0 +1,178 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file is the implementation of stSlimTreeFeedbackSession methods.
+*
+* @version 1.0
+*/
+
+#include <algorithm>
+
+// This macro will be used to replace the declaration of
+//       stSlimTreeFeedbackSession<ObjectType, EvaluatorType>
+#define tmpl_stSlimTreeFeedbackSession stSlimTreeFeedbackSession<ObjectType, EvaluatorType>
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+tmpl_stSlimTreeFeedbackSession::stSlimTreeFeedbackSession(tSlimTree * tree,
+      u_int32_t poolSize){
+
+   Tree = tree;
+   PoolSize = poolSize;
+   Sample = NULL;
+   Pool = NULL;
+   Radius = 0;
+   PoolHits = 0;
+   Fetches = 0;
+}//end stSlimTreeFeedbackSession<ObjectType, EvaluatorType>::stSlimTreeFeedbackSession
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+tmpl_stSlimTreeFeedbackSession::~stSlimTreeFeedbackSession(){
+
+   Clear();
+}//end stSlimTreeFeedbackSession<ObjectType, EvaluatorType>::~stSlimTreeFeedbackSession
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+stResult<ObjectType> * tmpl_stSlimTreeFeedbackSession::NearestQuery(
+      ObjectType * sample, u_int32_t k){
+
+   Clear();
+   Sample = (ObjectType *) sample->Clone();
+   Fetch(k);
+   Rank(k);
+   return BuildResult(k);
+}//end stSlimTreeFeedbackSession<ObjectType, EvaluatorType>::NearestQuery
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+stResult<ObjectType> * tmpl_stSlimTreeFeedbackSession::NearestQuery(u_int32_t k){
+
+   if (Sample == NULL){
+      throw std::logic_error("No feedback session was started.");
+   }//end if
+
+   if (Rank(k)){
+      PoolHits++;
+   }else{
+      // The pool may miss a better object.
+      Fetch(k);
+      Rank(k);
+   }//end if
+   return BuildResult(k);
+}//end stSlimTreeFeedbackSession<ObjectType, EvaluatorType>::NearestQuery
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTreeFeedbackSession::Clear(){
+
+   if (Pool != NULL){
+      delete Pool;
+      Pool = NULL;
+   }//end if
+   if (Sample != NULL){
+      delete Sample;
+      Sample = NULL;
+   }//end if
+   Candidates.clear();
+   Evaluator.ClearFeedbackCandidates();
+}//end stSlimTreeFeedbackSession<ObjectType, EvaluatorType>::Clear
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTreeFeedbackSession::Fetch(u_int32_t k){
+   u_int32_t size = std::max(PoolSize, k);
+   std::vector<double> weights = Tree->GetMetricEvaluator()->GetWeights();
+
+   if (Pool != NULL){
+      delete Pool;
+   }//end if
+   Pool = Tree->NearestQuery(Sample, size);
+   Fetches++;
+
+   Candidates.clear();
+   for (u_int32_t i = 0; i < Pool->GetNumOfEntries(); i++){
+      Candidates.push_back((ObjectType *) (*Pool)[i].GetObject());
+   }//end for
+   if (Candidates.size() < size){
+      // The pool holds the whole tree.
+      Radius = INFINITY;
+   }else{
+      Radius = Pool->GetMaximumDistance();
+   }//end if
+
+   // The candidates are recorded with the weights used to fetch them.
+   if (!weights.empty()){
+      Evaluator.SetWeights(weights);
+   }//end if
+   Evaluator.SetFeedbackCandidates(*Sample, Candidates.data(), Candidates.size());
+}//end stSlimTreeFeedbackSession<ObjectType, EvaluatorType>::Fetch
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+bool tmpl_stSlimTreeFeedbackSession::Rank(u_int32_t k){
+   u_int32_t n = Candidates.size();
+   u_int32_t count = std::min(n, k);
+   std::vector<double> weights = Tree->GetMetricEvaluator()->GetWeights();
+   double lower;
+   double upper;
+
+   if (!weights.empty()){
+      Evaluator.SetWeights(weights);
+   }//end if
+   Distances.resize(n);
+   Evaluator.GetFeedbackDistances(Distances.data());
+
+   Order.resize(n);
+   for (u_int32_t i = 0; i < n; i++){
+      Order[i] = i;
+   }//end for
+   // Ties keep the order of the pool.
+   std::partial_sort(Order.begin(), Order.begin() + count, Order.end(),
+         [this](u_int32_t a, u_int32_t b){
+            return (Distances[a] < Distances[b]) ||
+                   ((Distances[a] == Distances[b]) && (a < b));
+         });
+
+   if (Radius == INFINITY){
+      return true;
+   }//end if
+   if (count < k){
+      return false;
+   }//end if
+   if (k == 0){
+      return true;
+   }//end if
+   Evaluator.GetFeedbackDistortion(lower, upper);
+   return Distances[Order[k - 1]] <= lower * Radius;
+}//end stSlimTreeFeedbackSession<ObjectType, EvaluatorType>::Rank
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+stResult<ObjectType> * tmpl_stSlimTreeFeedbackSession::BuildResult(u_int32_t k){
+   u_int32_t count = std::min((u_int32_t) Candidates.size(), k);
+   tResult * result = new tResult();
+
+   result->SetQueryInfo((ObjectType *) Sample->Clone(), KNEARESTQUERY, k,
+                        MAXDOUBLE, false);
+   for (u_int32_t i = 0; i < count; i++){
+      result->AddPair((ObjectType *) Candidates[Order[i]]->Clone(),
+                      Distances[Order[i]]);
+   }//end for
+   return result;
+}//end stSlimTreeFeedbackSession<ObjectType, EvaluatorType>::BuildResult
@@ -0,0 +1,222 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the class stSlimTreeFeedbackSession.
+*
+* @version 1.0
+*/
+
+#ifndef __STSLIMTREEFEEDBACKSESSION_H
+#define __STSLIMTREEFEEDBACKSESSION_H
+
+#include <arboretum/stSlimTree.h>
+
+#include <vector>
+#include <stdexcept>
+
+//=============================================================================
+// Class template stSlimTreeFeedbackSession
+//-----------------------------------------------------------------------------
+/**
+* This class answers the k-nearest neighbor queries of a relevance feedback
+* session, where the same query object is asked again and again while only
+* the weights of the metric change.
+*
+* <P>The first query of a session fetches a pool of candidates larger than k
+* from the tree. The metric evaluator of the session keeps the per-dimension
+* squared differences between the query and the candidates, so the next
+* rounds rank the pool under the new weights of the tree with a single
+* matrix-vector product instead of a search.
+*
+* <P>The answer of a round is exact. Let r be the distance of the farthest
+* candidate under the weights used to fetch the pool and lower the distortion
+* factor between those weights and the current ones. Every object outside the
+* pool is at least lower * r away from the query, so the k best candidates
+* are the answer if the k-th of them is not farther than that. Otherwise, the
+* pool is fetched again from the tree under the current weights.
+*
+* <P>EvaluatorType must provide the feedback methods of
+* EuclideanDistanceWeighted. The weights and the distortion of the tree must
+* be set as for any other query, since the pool is fetched by
+* tSlimTree::NearestQuery().
+*
+* @version 1.0
+* @ingroup slim
+*/
+template <class ObjectType, class EvaluatorType>
+class stSlimTreeFeedbackSession{
+   public:
+      /**
+      * This is the type of the Slim-Tree used by this session.
+      */
+      typedef stSlimTree <ObjectType, EvaluatorType> tSlimTree;
+
+      /**
+      * This is the type of the results.
+      */
+      typedef stResult <ObjectType> tResult;
+
+      /**
+      * Creates a new session.
+      *
+      * @param tree The tree to be queried. It is not owned by this session.
+      * @param poolSize The number of candidates fetched from the tree. It is
+      * raised to k if a query asks for more objects.
+      */
+      stSlimTreeFeedbackSession(tSlimTree * tree, u_int32_t poolSize);
+
+      /**
+      * Disposes all resources.
+      */
+      ~stSlimTreeFeedbackSession();
+
+      /**
+      * Starts a new session: fetches the pool of sample from the tree and
+      * returns its k nearest neighbours.
+      *
+      * @param sample The query object. It is copied.
+      * @param k The number of neighbours.
+      * @return The result. It must be disposed by the caller.
+      */
+      tResult * NearestQuery(ObjectType * sample, u_int32_t k);
+
+      /**
+      * Returns the k nearest neighbours of the sample of the session under
+      * the current weights of the tree. The pool is used when it is enough
+      * to answer the query exactly, otherwise it is fetched again.
+      *
+      * @param k The number of neighbours.
+      * @return The result. It must be disposed by the caller.
+      * @exception logic_error If no session was started.
+      */
+      tResult * NearestQuery(u_int32_t k);
+
+      /**
+      * Ends the session.
+      */
+      void Clear();
+
+      /**
+      * Returns the number of candidates of the pool.
+      */
+      u_int32_t GetNumberOfCandidates(){
+         return Candidates.size();
+      }//end GetNumberOfCandidates
+
+      /**
+      * Returns the number of queries answered from the pool since the last
+      * call of ResetStatistics().
+      */
+      u_int32_t GetPoolHitCount(){
+         return PoolHits;
+      }//end GetPoolHitCount
+
+      /**
+      * Returns the number of times the pool was fetched from the tree since
+      * the last call of ResetStatistics().
+      */
+      u_int32_t GetFetchCount(){
+         return Fetches;
+      }//end GetFetchCount
+
+      /**
+      * Resets the statistics of this session.
+      */
+      void ResetStatistics(){
+         PoolHits = 0;
+         Fetches = 0;
+      }//end ResetStatistics
+
+   private:
+      /**
+      * The tree to be queried.
+      */
+      tSlimTree * Tree;
+
+      /**
+      * Number of candidates fetched from the tree.
+      */
+      u_int32_t PoolSize;
+
+      /**
+      * The query object of the session.
+      */
+      ObjectType * Sample;
+
+      /**
+      * The last result fetched from the tree. It owns the candidates.
+      */
+      tResult * Pool;
+
+      /**
+      * The candidates of the pool.
+      */
+      std::vector <ObjectType *> Candidates;
+
+      /**
+      * Every object outside the pool is at least this far from Sample under
+      * the weights used to fetch the pool.
+      */
+      double Radius;
+
+      /**
+      * Keeps the squared differences of the candidates.
+      */
+      EvaluatorType Evaluator;
+
+      /**
+      * Distances and order of the candidates under the current weights.
+      */
+      std::vector <double> Distances;
+      std::vector <u_int32_t> Order;
+
+      /**
+      * Statistics.
+      */
+      u_int32_t PoolHits;
+      u_int32_t Fetches;
+
+      /**
+      * Fetches the pool of Sample from the tree under the current weights.
+      *
+      * @param k The number of neighbours of the query being answered.
+      */
+      void Fetch(u_int32_t k);
+
+      /**
+      * Ranks the candidates under the current weights of the tree.
+      *
+      * @param k The number of neighbours.
+      * @return True if the k best candidates are the exact answer.
+      */
+      bool Rank(u_int32_t k);
+
+      /**
+      * Builds the result with the k best candidates ranked by Rank().
+      *
+      * @param k The number of neighbours.
+      */
+      tResult * BuildResult(u_int32_t k);
+
+      // Copies are not allowed.
+      stSlimTreeFeedbackSession(const stSlimTreeFeedbackSession &);
+      stSlimTreeFeedbackSession & operator = (const stSlimTreeFeedbackSession &);
+};//end stSlimTreeFeedbackSession
+
+#include "stSlimTreeFeedbackSession-inl.h"
+
+#endif //__STSLIMTREEFEEDBACKSESSION_H
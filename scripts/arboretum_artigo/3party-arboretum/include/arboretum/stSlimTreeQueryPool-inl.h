@@ -0,0 +1,213 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file is the implementation of stSlimTreeQueryPool methods.
+*
+* @version 1.0
+*/
+
+// This macro will be used to replace the declaration of
+//       stSlimTreeQueryPool<ObjectType, EvaluatorType>
+#define tmpl_stSlimTreeQueryPool stSlimTreeQueryPool<ObjectType, EvaluatorType>
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+tmpl_stSlimTreeQueryPool::stSlimTreeQueryPool(tSlimTree * tree, u_int32_t nThreads){
+
+   Tree = tree;
+   Batch = 0;
+   Running = 0;
+   Stop = false;
+   Samples = NULL;
+   NSamples = 0;
+   Results = NULL;
+   Stats = NULL;
+   Next = 0;
+
+   if (nThreads == 0){
+      nThreads = std::thread::hardware_concurrency();
+      if (nThreads == 0){
+         nThreads = 1;
+      }//end if
+   }//end if
+
+   // The trees of the threads read the header from the page manager.
+   Tree->Flush();
+   for (u_int32_t i = 0; i < nThreads; i++){
+      Trees.push_back(new tSlimTree(Tree->GetPageManager()));
+      DistanceCounts.push_back(0);
+   }//end for
+   for (u_int32_t i = 0; i < nThreads; i++){
+      Threads.push_back(std::thread(&tmpl_stSlimTreeQueryPool::Work, this, i));
+   }//end for
+}//end stSlimTreeQueryPool<ObjectType, EvaluatorType>::stSlimTreeQueryPool
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+tmpl_stSlimTreeQueryPool::~stSlimTreeQueryPool(){
+
+   {
+      std::lock_guard<std::mutex> lock(Mutex);
+      Stop = true;
+   }
+   Start.notify_all();
+   for (u_int32_t i = 0; i < Threads.size(); i++){
+      Threads[i].join();
+   }//end for
+   for (u_int32_t i = 0; i < Trees.size(); i++){
+      delete Trees[i];
+   }//end for
+}//end stSlimTreeQueryPool<ObjectType, EvaluatorType>::~stSlimTreeQueryPool
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTreeQueryPool::NearestQuery(ObjectType ** samples, u_int32_t n,
+      u_int32_t k, tResult ** results, bool tie, const tPrepare & prepare,
+      stQueryStats * stats){
+
+   Type = qtNEAREST;
+   Samples = samples;
+   NSamples = n;
+   K = k;
+   Tie = tie;
+   Results = results;
+   Prepare = prepare;
+   Stats = stats;
+   RunBatch();
+}//end stSlimTreeQueryPool<ObjectType, EvaluatorType>::NearestQuery
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTreeQueryPool::RangeQuery(ObjectType ** samples, u_int32_t n,
+      double range, tResult ** results, const tPrepare & prepare,
+      stQueryStats * stats){
+
+   Type = qtRANGE;
+   Samples = samples;
+   NSamples = n;
+   Range = range;
+   Results = results;
+   Prepare = prepare;
+   Stats = stats;
+   RunBatch();
+}//end stSlimTreeQueryPool<ObjectType, EvaluatorType>::RangeQuery
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+u_int64_t tmpl_stSlimTreeQueryPool::GetDistanceCount(){
+   u_int64_t count = 0;
+
+   for (u_int32_t i = 0; i < DistanceCounts.size(); i++){
+      count += DistanceCounts[i];
+   }//end for
+   return count;
+}//end stSlimTreeQueryPool<ObjectType, EvaluatorType>::GetDistanceCount
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTreeQueryPool::ResetStatistics(){
+
+   for (u_int32_t i = 0; i < DistanceCounts.size(); i++){
+      DistanceCounts[i] = 0;
+   }//end for
+}//end stSlimTreeQueryPool<ObjectType, EvaluatorType>::ResetStatistics
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTreeQueryPool::RunBatch(){
+   EvaluatorType * evaluator;
+
+   for (u_int32_t i = 0; i < NSamples; i++){
+      Results[i] = NULL;
+   }//end for
+
+   // The threads are idle, so their trees may be updated.
+   for (u_int32_t i = 0; i < Trees.size(); i++){
+      evaluator = Trees[i]->GetMetricEvaluator();
+      *evaluator = *Tree->GetMetricEvaluator();
+      evaluator->ResetStatistics();
+      Trees[i]->SetDistortion(Tree->GetMinDistortion(), Tree->GetMaxDistortion());
+   }//end for
+
+   std::unique_lock<std::mutex> lock(Mutex);
+   Next = 0;
+   Error = nullptr;
+   Running = Trees.size();
+   Batch++;
+   Start.notify_all();
+   Done.wait(lock, [this]{ return Running == 0; });
+   lock.unlock();
+
+   for (u_int32_t i = 0; i < Trees.size(); i++){
+      DistanceCounts[i] += Trees[i]->GetMetricEvaluator()->GetDistanceCount();
+   }//end for
+
+   if (Error){
+      // Do not return partial answers.
+      for (u_int32_t i = 0; i < NSamples; i++){
+         delete Results[i];
+         Results[i] = NULL;
+      }//end for
+      Prepare = nullptr;
+      std::rethrow_exception(Error);
+   }//end if
+   Prepare = nullptr;
+}//end stSlimTreeQueryPool<ObjectType, EvaluatorType>::RunBatch
+
+//------------------------------------------------------------------------------
+template <class ObjectType, class EvaluatorType>
+void tmpl_stSlimTreeQueryPool::Work(u_int32_t id){
+   tSlimTree * tree = Trees[id];
+   u_int64_t batch = 0;
+   u_int32_t idx;
+   stQueryStats * stats;
+
+   std::unique_lock<std::mutex> lock(Mutex);
+   while (true){
+      Start.wait(lock, [this, &batch]{ return Stop || (Batch != batch); });
+      if (Stop){
+         return;
+      }//end if
+      batch = Batch;
+      lock.unlock();
+
+      try{
+         for (idx = Next++; idx < NSamples; idx = Next++){
+            if (Prepare){
+               Prepare(idx, tree);
+            }//end if
+            stats = (Stats != NULL) ? &Stats[idx] : NULL;
+            if (Type == qtNEAREST){
+               Results[idx] = tree->NearestQuery(Samples[idx], K, Tie, stats);
+            }else{
+               Results[idx] = tree->RangeQuery(Samples[idx], Range, stats);
+            }//end if
+         }//end for
+         lock.lock();
+      }catch (...){
+         lock.lock();
+         if (!Error){
+            Error = std::current_exception();
+         }//end if
+      }//end try
+
+      Running--;
+      if (Running == 0){
+         Done.notify_all();
+      }//end if
+   }//end while
+}//end stSlimTreeQueryPool<ObjectType, EvaluatorType>::Work
@@ -0,0 +1,263 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the class stSlimTreeQueryPool.
+*
+* @version 1.0
+*/
+
+#ifndef __STSLIMTREEQUERYPOOL_H
+#define __STSLIMTREEQUERYPOOL_H
+
+#include <arboretum/stSlimTree.h>
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <functional>
+
+//=============================================================================
+// Class template stSlimTreeQueryPool
+//-----------------------------------------------------------------------------
+/**
+* This class runs batches of queries on a Slim-Tree with a pool of threads.
+*
+* <P>Each thread owns a stSlimTree opened over the page manager of the given
+* tree, with its own copy of the metric evaluator. These trees share the
+* nodes and the header page of the given tree, so they always see its current
+* root, but never change them. Before each batch, the weights, build weights
+* and distortion factors of the given tree are copied to every thread, so a
+* batch always answers the queries as the given tree would.
+*
+* <P>The page manager must allow concurrent reads (see
+* stPlainDiskPageManager). The given tree must not be modified while a batch
+* is running.
+*
+* <P>The distance statistics are kept per thread. The disk accesses are
+* counted by the page manager as usual. The statistics of each query may be
+* collected in a stQueryStats as well.
+*
+* @version 1.0
+* @ingroup slim
+*/
+template <class ObjectType, class EvaluatorType>
+class stSlimTreeQueryPool{
+   public:
+      /**
+      * This is the type of the Slim-Tree used by this pool.
+      */
+      typedef stSlimTree <ObjectType, EvaluatorType> tSlimTree;
+
+      /**
+      * This is the type of the results.
+      */
+      typedef stResult <ObjectType> tResult;
+
+      /**
+      * This is the type of the function that prepares the tree of a thread
+      * before each query of a batch. It receives the index of the query and
+      * the tree, whose evaluator and distortion it may change (to use other
+      * weights in each query, for instance).
+      */
+      typedef std::function <void (u_int32_t, tSlimTree *)> tPrepare;
+
+      /**
+      * Creates a new pool. The header of the tree is written to its page
+      * manager before the threads open their own trees.
+      *
+      * @param tree The tree to be queried. It is not owned by this pool.
+      * @param nThreads The number of threads. If 0, the number of cores is
+      * used.
+      */
+      stSlimTreeQueryPool(tSlimTree * tree, u_int32_t nThreads = 0);
+
+      /**
+      * Stops the threads and disposes all resources.
+      */
+      ~stSlimTreeQueryPool();
+
+      /**
+      * Returns the number of threads of this pool.
+      */
+      u_int32_t GetNumberOfThreads(){
+         return Trees.size();
+      }//end GetNumberOfThreads
+
+      /**
+      * Performs a k-nearest neighbor query for each sample. This method
+      * returns when all queries are done.
+      *
+      * @param samples The query objects.
+      * @param n The number of query objects.
+      * @param k The number of neighbours.
+      * @param results The results. results[i] is the answer of samples[i] and
+      * must be disposed by the caller.
+      * @param tie The tie list. Default false.
+      * @param prepare Called before each query. Default none.
+      * @param stats The statistics of the queries or NULL. If not NULL,
+      * stats[i] receives the statistics of samples[i]. Default NULL.
+      * @see tSlimTree::NearestQuery()
+      */
+      void NearestQuery(ObjectType ** samples, u_int32_t n, u_int32_t k,
+                        tResult ** results, bool tie = false,
+                        const tPrepare & prepare = tPrepare(),
+                        stQueryStats * stats = NULL);
+
+      /**
+      * Performs a range query for each sample. This method returns when all
+      * queries are done.
+      *
+      * @param samples The query objects.
+      * @param n The number of query objects.
+      * @param range The range of the queries.
+      * @param results The results. results[i] is the answer of samples[i] and
+      * must be disposed by the caller.
+      * @param prepare Called before each query. Default none.
+      * @param stats The statistics of the queries or NULL. If not NULL,
+      * stats[i] receives the statistics of samples[i]. Default NULL.
+      * @see tSlimTree::RangeQuery()
+      */
+      void RangeQuery(ObjectType ** samples, u_int32_t n, double range,
+                      tResult ** results, const tPrepare & prepare = tPrepare(),
+                      stQueryStats * stats = NULL);
+
+      /**
+      * Returns the number of distance calculations performed by all threads
+      * since the last call of ResetStatistics().
+      */
+      u_int64_t GetDistanceCount();
+
+      /**
+      * Returns the number of distance calculations performed by a thread
+      * since the last call of ResetStatistics().
+      *
+      * @param id The thread.
+      */
+      u_int64_t GetDistanceCount(u_int32_t id){
+         return DistanceCounts[id];
+      }//end GetDistanceCount
+
+      /**
+      * Resets the distance statistics of all threads.
+      */
+      void ResetStatistics();
+
+   private:
+      /**
+      * Kinds of query.
+      */
+      enum tQueryType{
+         qtNEAREST,
+         qtRANGE
+      };//end tQueryType
+
+      /**
+      * The tree to be queried.
+      */
+      tSlimTree * Tree;
+
+      /**
+      * The trees of the threads.
+      */
+      std::vector <tSlimTree *> Trees;
+
+      /**
+      * The threads.
+      */
+      std::vector <std::thread> Threads;
+
+      /**
+      * Distance calculations of each thread.
+      */
+      std::vector <u_int64_t> DistanceCounts;
+
+      /**
+      * Guards the fields below.
+      */
+      std::mutex Mutex;
+
+      /**
+      * Signals the threads that a batch started or the pool stopped.
+      */
+      std::condition_variable Start;
+
+      /**
+      * Signals the caller that the batch is done.
+      */
+      std::condition_variable Done;
+
+      /**
+      * Number of the current batch.
+      */
+      u_int64_t Batch;
+
+      /**
+      * Number of threads still working on the current batch.
+      */
+      u_int32_t Running;
+
+      /**
+      * If true, the threads must stop.
+      */
+      bool Stop;
+
+      /**
+      * The current batch.
+      */
+      tQueryType Type;
+      ObjectType ** Samples;
+      u_int32_t NSamples;
+      u_int32_t K;
+      double Range;
+      bool Tie;
+      tResult ** Results;
+      tPrepare Prepare;
+      stQueryStats * Stats;
+
+      /**
+      * Index of the next query of the current batch.
+      */
+      std::atomic <u_int32_t> Next;
+
+      /**
+      * The first error raised by the current batch.
+      */
+      std::exception_ptr Error;
+
+      /**
+      * Runs the current batch and waits for it.
+      */
+      void RunBatch();
+
+      /**
+      * Main loop of a thread.
+      *
+      * @param id The thread.
+      */
+      void Work(u_int32_t id);
+
+      // Copies are not allowed.
+      stSlimTreeQueryPool(const stSlimTreeQueryPool &);
+      stSlimTreeQueryPool & operator = (const stSlimTreeQueryPool &);
+};//end stSlimTreeQueryPool
+
+#include "stSlimTreeQueryPool-inl.h"
+
+#endif //__STSLIMTREEQUERYPOOL_H
@@ -0,0 +1,175 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the class stTaskPool.
+*
+* @version 1.0
+*/
+#ifndef __STTASKPOOL_H
+#define __STTASKPOOL_H
+
+#include <arboretum/stUtil.h>
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+
+//==============================================================================
+// stTaskPool
+//------------------------------------------------------------------------------
+/**
+* This class runs groups of tasks on a pool of threads. It is meant for divide
+* and conquer algorithms (like the bulk load of a tree), whose tasks create
+* and wait for other tasks.
+*
+* <p>Run() never blocks a thread while there is work to do: the thread that
+* waits for a group runs the pending tasks, of any group, until its own group
+* is done. So tasks may call Run() without exhausting the pool, and the
+* calling thread is one of the threads of the pool.
+*
+* <p>The pending tasks form a stack, so each thread takes the newest task,
+* which keeps the depth first order of the sequential algorithm and bounds
+* the number of pending tasks.
+*
+* <p>Each task receives the ID of the thread that runs it, from 0 (the thread
+* that created the pool) to GetNumberOfThreads() - 1. A task may use it to
+* pick resources that belong to a thread, like a copy of a metric evaluator.
+*
+* @version 1.0
+* @ingroup struct
+*/
+class stTaskPool{
+   public:
+      /**
+      * Type of the tasks. The parameter is the ID of the thread.
+      */
+      typedef std::function <void (u_int32_t)> tTask;
+
+      /**
+      * Creates a new pool.
+      *
+      * @param nThreads The number of threads, including the one which calls
+      * Run(). If 0, the number of cores is used.
+      */
+      stTaskPool(u_int32_t nThreads = 0);
+
+      /**
+      * Stops the threads. There must be no running group.
+      */
+      ~stTaskPool();
+
+      /**
+      * Returns the number of threads of this pool.
+      */
+      u_int32_t GetNumberOfThreads(){
+         return Threads.size() + 1;
+      }//end GetNumberOfThreads
+
+      /**
+      * Runs the given tasks and returns when all of them are done. The
+      * calling thread runs tasks meanwhile.
+      *
+      * @param tasks The tasks. They must stay valid until this method
+      * returns.
+      * @param id The ID of the calling thread: 0 outside the tasks or the
+      * ID received by the calling task.
+      * @exception Rethrows the first exception raised by a task, after all
+      * tasks of the group are done.
+      */
+      void Run(std::vector <tTask> & tasks, u_int32_t id = 0);
+
+   private:
+      /**
+      * A group of tasks given to Run().
+      */
+      struct tGroup{
+         /**
+         * Number of tasks not done yet.
+         */
+         u_int32_t Pending;
+
+         /**
+         * The first exception raised by a task.
+         */
+         std::exception_ptr Error;
+      };//end tGroup
+
+      /**
+      * A pending task.
+      */
+      struct tItem{
+         /**
+         * The task.
+         */
+         tTask * Task;
+
+         /**
+         * The group of the task.
+         */
+         tGroup * Group;
+      };//end tItem
+
+      /**
+      * The threads, without the one that created this pool.
+      */
+      std::vector <std::thread> Threads;
+
+      /**
+      * The pending tasks. The newest is the last.
+      */
+      std::deque <tItem> Pending;
+
+      /**
+      * Guards the fields below and the groups.
+      */
+      std::mutex Mutex;
+
+      /**
+      * Signals new tasks, finished tasks and the end of this pool.
+      */
+      std::condition_variable Changed;
+
+      /**
+      * Tells the threads to stop.
+      */
+      bool Stop;
+
+      /**
+      * Runs a task and marks it done in its group.
+      *
+      * @param item The task.
+      * @param id The ID of the calling thread.
+      */
+      void Execute(tItem item, u_int32_t id);
+
+      /**
+      * The loop of the threads.
+      *
+      * @param id The ID of the thread.
+      */
+      void Work(u_int32_t id);
+
+      // Copies are not allowed.
+      stTaskPool(const stTaskPool &);
+      stTaskPool & operator = (const stTaskPool &);
+};//end stTaskPool
+
+#endif //__STTASKPOOL_H
@@ -0,0 +1,119 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file is the implementation of stTopKResult methods.
+*
+* @version 1.0
+*/
+
+#include <algorithm>
+#include <string.h>
+
+// This macro will be used to replace the declaration of
+//       stTopKResult<ObjectType>
+#define tmpl_stTopKResult stTopKResult<ObjectType>
+
+//------------------------------------------------------------------------------
+template <class ObjectType>
+void tmpl_stTopKResult::Reset(u_int32_t k, bool tie){
+   u_int32_t i;
+
+   K = k;
+   Tie = tie;
+   Heap.clear();
+   Free.clear();
+   for (i = Slots.size(); i > 0; i--){
+      Free.push_back(i - 1);
+   }//end for
+}//end stTopKResult<ObjectType>::Reset
+
+//------------------------------------------------------------------------------
+template <class ObjectType>
+u_int32_t tmpl_stTopKResult::Pop(){
+   u_int32_t slot = Heap[0];
+
+   std::pop_heap(Heap.begin(), Heap.end(), GetLess());
+   Heap.pop_back();
+   return slot;
+}//end stTopKResult<ObjectType>::Pop
+
+//------------------------------------------------------------------------------
+template <class ObjectType>
+bool tmpl_stTopKResult::Add(const unsigned char * data, u_int32_t size,
+                            double distance){
+   u_int32_t slot;
+
+   if (K == 0){
+      return false;
+   }//end if
+   if (IsFull()){
+      if ((distance > GetMaximumDistance()) ||
+            ((distance == GetMaximumDistance()) && (!Tie))){
+         return false;
+      }//end if
+   }//end if
+
+   // Take a free slot.
+   if (Free.empty()){
+      Free.push_back(Slots.size());
+      Slots.resize(Slots.size() + 1);
+   }//end if
+   slot = Free.back();
+   Free.pop_back();
+   Slots[slot].Distance = distance;
+   Slots[slot].Data.resize(size);
+   memcpy(Slots[slot].Data.data(), data, size);
+   Heap.push_back(slot);
+   std::push_heap(Heap.begin(), Heap.end(), GetLess());
+
+   if (Heap.size() > K){
+      if (!Tie){
+         Free.push_back(Pop());
+      }else{
+         // The farthest candidates go only if k others are left.
+         double max = GetMaximumDistance();
+         Order.clear();
+         while ((!Heap.empty()) && (GetMaximumDistance() == max)){
+            Order.push_back(Pop());
+         }//end while
+         if (Heap.size() >= K){
+            Free.insert(Free.end(), Order.begin(), Order.end());
+         }else{
+            for (u_int32_t i = 0; i < Order.size(); i++){
+               Heap.push_back(Order[i]);
+               std::push_heap(Heap.begin(), Heap.end(), GetLess());
+            }//end for
+         }//end if
+      }//end if
+   }//end if
+   return true;
+}//end stTopKResult<ObjectType>::Add
+
+//------------------------------------------------------------------------------
+template <class ObjectType>
+void tmpl_stTopKResult::Materialize(tResult * result){
+   ObjectType * obj;
+
+   Order.assign(Heap.begin(), Heap.end());
+   std::sort_heap(Order.begin(), Order.end(), GetLess());
+   // AddPair() inserts at the front, so the farthest pairs go first.
+   for (u_int32_t i = Order.size(); i > 0; i--){
+      obj = new ObjectType();
+      obj->Unserialize(Slots[Order[i - 1]].Data.data(), Slots[Order[i - 1]].Data.size());
+      result->AddPair(obj, Slots[Order[i - 1]].Distance);
+   }//end for
+}//end stTopKResult<ObjectType>::Materialize
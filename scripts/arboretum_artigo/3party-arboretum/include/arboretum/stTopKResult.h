@@ -0,0 +1,195 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the class stTopKResult.
+*
+* @version 1.0
+*/
+#ifndef __STTOPKRESULT_H
+#define __STTOPKRESULT_H
+
+#include <arboretum/stResult.h>
+
+#include <vector>
+
+//=============================================================================
+// Class template stTopKResult
+//-----------------------------------------------------------------------------
+/**
+* This class keeps the k nearest objects found by a running k-nearest
+* neighbor query.
+*
+* <P>stResult keeps each pair in a node of a multiset, with a clone of its
+* object, and a query adds a pair and cuts the result for every object that
+* qualifies, so large values of k pay one clone, one pair and one node for
+* each of them. This class keeps the candidates in a max-heap of fixed
+* capacity instead. A candidate is the serialized object, copied from the
+* node page into a slot of the heap, since the page is released before the
+* query ends. The slots and their buffers are reused by the next candidates
+* and by the next queries (see Reset()), so a query allocates nothing once
+* the buffers have grown. The objects are only rebuilt by Materialize(), at
+* the end of the query.
+*
+* <P>With the tie list, the objects as far as the k-th one are kept too, as
+* stResult::Cut() does.
+*
+* @version 1.0
+* @ingroup struct
+* @see stResult
+*/
+template <class ObjectType>
+class stTopKResult{
+   public:
+      /**
+      * This is the type of the results.
+      */
+      typedef stResult <ObjectType> tResult;
+
+      /**
+      * Creates a new empty container.
+      *
+      * @param k The number of neighbours.
+      * @param tie The tie list.
+      */
+      stTopKResult(u_int32_t k = 0, bool tie = false){
+         Reset(k, tie);
+      }//end stTopKResult
+
+      /**
+      * Removes all candidates and sets the parameters of the next query.
+      * The buffers are kept.
+      *
+      * @param k The number of neighbours.
+      * @param tie The tie list.
+      */
+      void Reset(u_int32_t k, bool tie);
+
+      /**
+      * Returns the number of candidates.
+      */
+      u_int32_t GetNumOfEntries(){
+         return Heap.size();
+      }//end GetNumOfEntries
+
+      /**
+      * Returns true if there are at least k candidates.
+      */
+      bool IsFull(){
+         return Heap.size() >= K;
+      }//end IsFull
+
+      /**
+      * Returns the distance of the farthest candidate or a negative value if
+      * there is none.
+      */
+      double GetMaximumDistance(){
+         return Heap.empty() ? -1 : Slots[Heap[0]].Distance;
+      }//end GetMaximumDistance
+
+      /**
+      * Adds a candidate if it is among the k nearest ones found so far.
+      *
+      * @param data The serialized object. It is copied.
+      * @param size The size of the serialized object.
+      * @param distance The distance from the sample.
+      * @return True if the candidate was kept.
+      */
+      bool Add(const unsigned char * data, u_int32_t size, double distance);
+
+      /**
+      * Rebuilds the objects of the candidates and adds them to a result, in
+      * ascending order of distance. The candidates are kept.
+      *
+      * @param result The result.
+      */
+      void Materialize(tResult * result);
+
+   private:
+      /**
+      * A candidate.
+      */
+      struct tSlot{
+         /**
+         * The distance from the sample.
+         */
+         double Distance;
+
+         /**
+         * The serialized object. Its capacity is kept between candidates.
+         */
+         std::vector <unsigned char> Data;
+      };//end tSlot
+
+      /**
+      * The number of neighbours.
+      */
+      u_int32_t K;
+
+      /**
+      * The tie list.
+      */
+      bool Tie;
+
+      /**
+      * All slots ever used.
+      */
+      std::vector <tSlot> Slots;
+
+      /**
+      * Max-heap of the indexes of the slots of the candidates, by distance.
+      */
+      std::vector <u_int32_t> Heap;
+
+      /**
+      * Indexes of the slots not in use.
+      */
+      std::vector <u_int32_t> Free;
+
+      /**
+      * Buffer of Materialize() and of the tie list.
+      */
+      std::vector <u_int32_t> Order;
+
+      /**
+      * Compares two slots by distance. Used by the heap operations.
+      */
+      struct tLess{
+         const std::vector <tSlot> * Slots;
+
+         bool operator () (u_int32_t a, u_int32_t b) const{
+            return (*Slots)[a].Distance < (*Slots)[b].Distance;
+         }//end operator ()
+      };//end tLess
+
+      /**
+      * Returns the comparison of the heap operations.
+      */
+      tLess GetLess(){
+         tLess less;
+         less.Slots = &Slots;
+         return less;
+      }//end GetLess
+
+      /**
+      * Removes the farthest candidate from the heap and returns its slot.
+      */
+      u_int32_t Pop();
+};//end stTopKResult
+
+#include "stTopKResult-inl.h"
+
+#endif //__STTOPKRESULT_H
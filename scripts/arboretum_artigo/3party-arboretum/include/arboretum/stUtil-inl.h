@@ -331,6 +331,127 @@ void stDynamicRReversedPriorityQueue < TKey, TValue >::Resize(){
    this->maxSize += increment;
 }//end stDynamicRReversedPriorityQueue::Resize
 
+//----------------------------------------------------------------------------
+// template class stDaryRPriorityQueue
+//----------------------------------------------------------------------------
+template < class TKey, class TValue, int Arity >
+bool stDaryRPriorityQueue < TKey, TValue, Arity >::Get(
+   TKey & key, TValue & value){
+
+   if (ordered < (int)keys.size()){
+      Heapify();
+   }//end if
+   if (keys.empty()){
+      // Empty!
+      return false;
+   }//end if
+
+   // Remove first and reinsert last.
+   key = keys[0];
+   value = values[0];
+   keys[0] = keys.back();
+   values[0] = values.back();
+   keys.pop_back();
+   values.pop_back();
+   ordered = keys.size();
+   if (!keys.empty()){
+      SiftDown(0);
+   }//end if
+   return true;
+}//end stDaryRPriorityQueue::Get
+
+//----------------------------------------------------------------------------
+template < class TKey, class TValue, int Arity >
+void stDaryRPriorityQueue < TKey, TValue, Arity >::Add(
+   const TKey & key, const TValue & value){
+
+   if (ordered < (int)keys.size()){
+      Heapify();
+   }//end if
+   Push(key, value);
+   ordered = keys.size();
+   SiftUp(ordered - 1);
+}//end stDaryRPriorityQueue::Add
+
+//----------------------------------------------------------------------------
+template < class TKey, class TValue, int Arity >
+void stDaryRPriorityQueue < TKey, TValue, Arity >::Heapify(){
+   int size = keys.size();
+   int first, last, i;
+
+   if (size - ordered == 1){
+      SiftUp(ordered);
+   }else if (size - ordered > 1){
+      // Sift down every ancestor of the new entries, a level at a time,
+      // from the deepest one. A subtree is a heap once all of its own
+      // ancestors of new entries are done.
+      first = ordered;
+      last = size - 1;
+      while (last > 0){
+         first = (first > 0) ? (first - 1) / Arity : 0;
+         last = (last - 1) / Arity;
+         for (i = last; i >= first; i--){
+            SiftDown(i);
+         }//end for
+      }//end while
+   }//end if
+   ordered = size;
+}//end stDaryRPriorityQueue::Heapify
+
+//----------------------------------------------------------------------------
+template < class TKey, class TValue, int Arity >
+void stDaryRPriorityQueue < TKey, TValue, Arity >::SiftDown(int parent){
+   int size = keys.size();
+   TKey key = keys[parent];
+   TValue value = values[parent];
+   int child, first, last, c;
+
+   first = (parent * Arity) + 1;
+   while (first < size){
+      // The child with the smaller key.
+      last = (first + Arity < size) ? first + Arity : size;
+      child = first;
+      for (c = first + 1; c < last; c++){
+         if (keys[c] < keys[child]){
+            child = c;
+         }//end if
+      }//end for
+      if (!(keys[child] < key)){
+         break;
+      }//end if
+      // Move child up
+      keys[parent] = keys[child];
+      values[parent] = values[child];
+      parent = child;
+      first = (parent * Arity) + 1;
+   }//end while
+   // Put it in place.
+   keys[parent] = key;
+   values[parent] = value;
+}//end stDaryRPriorityQueue::SiftDown
+
+//----------------------------------------------------------------------------
+template < class TKey, class TValue, int Arity >
+void stDaryRPriorityQueue < TKey, TValue, Arity >::SiftUp(int child){
+   TKey key = keys[child];
+   TValue value = values[child];
+   int parent;
+
+   while (child > 0){
+      parent = (child - 1) / Arity;
+      if (!(key < keys[parent])){
+         break;
+      }//end if
+      // Move parent down.
+      keys[child] = keys[parent];
+      values[child] = values[parent];
+      child = parent;
+   }//end while
+   // Put it in place.
+   keys[child] = key;
+   values[child] = value;
+}//end stDaryRPriorityQueue::SiftUp
+
 //----------------------------------------------------------------------------
 // Class template stInstanceCache
 //----------------------------------------------------------------------------
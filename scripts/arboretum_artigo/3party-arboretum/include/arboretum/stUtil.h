@@ -27,6 +27,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <string>
+#include <vector>
 
 //----------------------------------------------------------------------------
 // Debug tools
@@ -834,6 +835,141 @@ class stDynamicRReversedPriorityQueue{
       
 };//end stDynamicRReversedPriorityQueue
 
+//----------------------------------------------------------------------------
+// template class stDaryRPriorityQueue
+//----------------------------------------------------------------------------
+/**
+* This class template implements a dynamic generic reverse priority queue as a
+* d-ary heap. In other words, the priority of an entry grows in reverse
+* proportion to its key value.
+*
+* <p>The template parameter TKey must support the = and @< operators and
+* TValue must support = operator. Arity is the number of children of each
+* entry of the heap.
+*
+* <p>Unlike stDynamicRPriorityQueue, the keys and the values are kept in two
+* arrays, so the comparisons of a sift step read only the keys, and the heap
+* has 4 children per entry by default, so it is half as deep. The capacity
+* doubles when required and Clear() keeps it, so a queue owned by a tree or
+* by a thread can be reused by all of its queries without allocations.
+*
+* <p>Push() appends an entry without ordering it. The entries pushed are
+* ordered at once by the next call to Heapify(), Add() or Get(), which costs
+* less than adding them one by one when many entries arrive together, such
+* as the qualifying children of an index node.
+*
+* @version 1.0
+* @ingroup util
+* @see stDynamicRPriorityQueue
+*/
+template <class TKey, class TValue, int Arity = 4>
+class stDaryRPriorityQueue{
+
+   public:
+
+      /**
+      * Creates a new reverse priority queue.
+      *
+      * @param initialSize Initial capacity of this queue.
+      */
+      stDaryRPriorityQueue(int initialSize = 0){
+         ordered = 0;
+         Reserve(initialSize);
+      }//end stDaryRPriorityQueue
+
+      /**
+      * Ensures the capacity of this queue.
+      *
+      * @param size The number of entries.
+      */
+      void Reserve(int size){
+         keys.reserve(size);
+         values.reserve(size);
+      }//end Reserve
+
+      /**
+      * Removes all entries. The capacity is kept.
+      */
+      void Clear(){
+         keys.clear();
+         values.clear();
+         ordered = 0;
+      }//end Clear
+
+      /**
+      * Gets the next pair key/value with the minimum key value. This pair
+      * is removed from the queue.
+      *
+      * @retval key The key value.
+      * @retval value The value.
+      * @return True for success or false it the queue is empty.
+      */
+      bool Get(TKey & key, TValue & value);
+
+      /**
+      * Adds a new entry to the queue.
+      *
+      * @param key The key to be inserted.
+      * @param value The value to be inserted.
+      */
+      void Add(const TKey & key, const TValue & value);
+
+      /**
+      * Appends a new entry to the queue. It is only ordered by the next call
+      * to Heapify(), Add() or Get().
+      *
+      * @param key The key to be inserted.
+      * @param value The value to be inserted.
+      */
+      void Push(const TKey & key, const TValue & value){
+         keys.push_back(key);
+         values.push_back(value);
+      }//end Push
+
+      /**
+      * Orders the entries appended by Push().
+      */
+      void Heapify();
+
+      /**
+      * Returns the size of this queue.
+      */
+      int GetSize(){
+         return keys.size();
+      }//end GetSize
+
+   private:
+
+      /**
+      * The keys of the heap.
+      */
+      std::vector <TKey> keys;
+
+      /**
+      * The values of the heap, in the same positions of their keys.
+      */
+      std::vector <TValue> values;
+
+      /**
+      * Number of entries that form the heap. The others were pushed.
+      */
+      int ordered;
+
+      /**
+      * Moves an entry down until its children have greater keys.
+      *
+      * @param parent The id of the entry.
+      */
+      void SiftDown(int parent);
+
+      /**
+      * Moves an entry up until its parent has a smaller key.
+      *
+      * @param child The id of the entry.
+      */
+      void SiftUp(int child);
+};//end stDaryRPriorityQueue
+
 //----------------------------------------------------------------------------
 // Global Query Priority Queue
 //----------------------------------------------------------------------------
@@ -856,6 +992,11 @@ typedef struct stQueryPriorityQueueValue{
    */
    u_int32_t PageID;
 
+   /**
+   * Level of this node. The root is at level 0.
+   */
+   int Level;
+
    /**
    * Radius of the node.
    */
@@ -866,11 +1007,6 @@ typedef struct stQueryPriorityQueueValue{
       * Parent of this node.
       */
       u_int32_t Parent;
-   
-      /**
-      * Level of this node.
-      */
-      int Level;  
    #endif //__stMAMVIEW__
    
    /**
@@ -881,10 +1017,10 @@ typedef struct stQueryPriorityQueueValue{
    const stQueryPriorityQueueValue & operator = (const stQueryPriorityQueueValue & v){
       
       this->PageID = v.PageID;
+      this->Level = v.Level;
       this->Radius = v.Radius;
       #ifdef __stMAMVIEW__
          this->Parent = v.Parent;
-         this->Level = v.Level;
       #endif //__stMAMVIEW__
       return *this;
    }//end operator =
@@ -63,3 +63,29 @@ double BrayCurtisDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType
 
     return d;
 }
+
+/**
+* Calculates the Bray Curtis distances between a query and many feature vectors.
+* If the objects expose their features through data(), the distances are
+* evaluated by OneToManyKernel, several objects at once. They are the same
+* values getDistance() returns.
+*
+* @param query: The query feature vector.
+* @param objects: The feature vectors.
+* @param n: Number of feature vectors.
+* @param distances: The n distances.
+* @throw Exception If the computation is not possible.
+*/
+template <class ObjectType>
+void BrayCurtisDistance<ObjectType>::getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances) throw (std::length_error){
+
+    if (!spans.Set(query, objects, n)){
+        DistanceFunction<ObjectType>::getDistances(query, objects, n, distances);
+        return;
+    }
+
+    OneToManyKernel::BrayCurtis(spans.GetQuery(), spans.GetObjects(), n, spans.GetDimension(), distances);
+
+    // Statistic support
+    this->updateDistanceCount(n);
+}
@@ -23,6 +23,7 @@
 #define CANBERRADISTANCE_H
 
 #include "DistanceFunction.h"
+#include "OneToManyKernel.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -43,6 +44,13 @@ class CanberraDistance : public DistanceFunction <ObjectType>{
 
         double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
         double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        void getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances) throw (std::length_error);
+
+    private:
+        /**
+        * Spans of the last getDistances().
+        */
+        FeatureSpans<ObjectType> spans;
 };
 
 #include "CanberraDistance-inl.h"
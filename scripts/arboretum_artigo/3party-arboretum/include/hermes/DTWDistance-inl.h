@@ -79,3 +79,74 @@ double DTWDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2)
     return d;
 }
 
+/**
+* @deprecated Use getDistance(ObjectType &obj1, ObjectType &obj2, double bound) instead.
+*
+* @copydoc getDistance(ObjectType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType>
+double DTWDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error){
+
+    return getDistance(obj1, obj2, bound);
+}
+
+/**
+* Calculates the Dynamic Time Warping distance between two feature vectors
+* when it is not larger than bound. The matrix is computed one row at a
+* time. Every warping path crosses each row and never decreases, so the
+* computation stops once the smallest value of a row exceeds bound^2.
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector.
+* @param bound: The bound.
+* @throw Exception If the computation is not possible.
+* @return The DTW distance between feature vector 1 and feature vector 2 if it
+* is not larger than bound. Otherwise a value larger than bound.
+*/
+template <class ObjectType>
+double DTWDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error){
+
+    // Rows of the matrix. They belong to the calling thread, so the
+    // evaluator may be shared by threads.
+    static thread_local std::vector<double> previous;
+    static thread_local std::vector<double> current;
+    size_t rows = obj1.size();
+    size_t cols = obj2.size();
+    double limit = EarlyAbandonKernel::GetLimit(bound * bound, 0);
+    double rowMin;
+
+    if ((rows == 0) || (cols == 0)){
+        return getDistance(obj1, obj2);
+    }
+    if (bound < 0){
+        limit = -1;
+    }
+
+    // Statistic support
+    this->updateDistanceCount();
+
+    previous.resize(cols);
+    current.resize(cols);
+
+    // Initialize first row
+    current[0] = pow(obj1[0] - obj2[0], 2.0);
+    for (size_t j = 1; j < cols; j++)
+        current[j] = pow(obj1[0] - obj2[j], 2.0) + current[j-1];
+
+    // Execute the recurrence
+    for (size_t i = 1; i < rows; i++) {
+        rowMin = current[0];
+        for (size_t j = 1; j < cols; j++)
+            rowMin = fmin(rowMin, current[j]);
+        if (rowMin > limit)
+            return sqrt(rowMin);
+
+        previous.swap(current);
+        current[0] = pow(obj1[i] - obj2[0], 2.0) + previous[0];
+        for (size_t j = 1; j < cols; j++) {
+            current[j] = pow(obj1[i] - obj2[j], 2.0) + fmin(previous[j-1], fmin(current[j-1], previous[j]));
+        }
+    }
+
+    return sqrt(current[cols-1]);
+}
@@ -25,7 +25,9 @@
 #define DTWDISTANCE_HPP
 
 #include "DistanceFunction.h"
+#include "EarlyAbandonKernel.h"
 #include <cmath>
+#include <vector>
 
 /**
 * Class to obtain the Dynamic Time Warping Distance
@@ -43,6 +45,8 @@ class DTWDistance : public DistanceFunction <ObjectType>{
 
         double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
         double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error);
+        double getDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error);
 };
 
 #include "DTWDistance-inl.h"
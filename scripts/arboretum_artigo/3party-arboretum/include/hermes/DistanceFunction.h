@@ -116,6 +116,9 @@
 * @see DistanceFunctionStatistics
 */
 
+#include <util/stStatistics.h>
+
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 
@@ -124,9 +127,11 @@ class DistanceFunction{
 
     protected:
         /**
-        * The distance counter itself.
+        * The distance counter itself. It may be updated by threads sharing
+        * the evaluator. The threads of a build work on copies and merge their
+        * counts (see mergeDistanceCount()).
         */
-        u_int32_t distCount;
+        std::atomic<u_int64_t> distCount;
 
     public:
 
@@ -134,10 +139,19 @@ class DistanceFunction{
         * Constructor.
         * @param d Internal statistics of distance function.
         */
-        DistanceFunction(u_int32_t d = 0){
+        DistanceFunction(u_int64_t d = 0){
             distCount = d;
         }
 
+        /**
+        * Copy constructor. The copy starts with the statistics of evaluator.
+        *
+        * @param evaluator The evaluator to be copied.
+        */
+        DistanceFunction(const DistanceFunction& evaluator){
+            distCount = evaluator.getDistanceCount();
+        }
+
         /**
         * Destroy instance.
         */
@@ -161,6 +175,86 @@ class DistanceFunction{
         */
         virtual double getDistance(ObjectType & obj1, ObjectType & obj2) = 0;
 
+        /**
+        * @copydoc getDistance(ObjectType & obj1, ObjectType & obj2, double bound) .
+        */
+        double GetDistance(ObjectType & obj1, ObjectType & obj2, double bound){
+            return getDistance(obj1, obj2, bound);
+        }
+
+        /**
+        * This method calculates the distance between 2 objects when it is
+        * not larger than bound, and counts one distance. A metric tree
+        * passes the radius an object must be within to be of any use, so
+        * the distance functions may stop as soon as they know the distance
+        * is larger.
+        *
+        * <p>This implementation returns getDistance(). The Lp distance
+        * functions override it.
+        *
+        * @param obj1 Object 1.
+        * @param obj2 Object 2.
+        * @param bound The bound.
+        * @return The distance between the objects if it is not larger than
+        * bound. Otherwise any value larger than bound.
+        */
+        virtual double getDistance(ObjectType & obj1, ObjectType & obj2, double bound){
+            return getDistance(obj1, obj2);
+        }
+
+        /**
+        * @copydoc getDistances(ObjectType & query, ObjectType ** objects, size_t n, double * distances) .
+        */
+        void GetDistances(ObjectType & query, ObjectType ** objects, size_t n, double * distances){
+
+            getDistances(query, objects, n, distances);
+        }
+
+        /**
+        * This method calculates the distances between a query and many
+        * objects, as n calls to getDistance() would, and counts n distances.
+        *
+        * <p>This implementation calls getDistance() for each object. The
+        * distance functions that can evaluate many objects at once, with
+        * SIMD instructions for instance, override it.
+        *
+        * @param query The query object.
+        * @param objects The objects.
+        * @param n Number of objects.
+        * @param distances The n distances, in the order of the objects.
+        */
+        virtual void getDistances(ObjectType & query, ObjectType ** objects, size_t n, double * distances){
+
+            for (size_t i = 0; i < n; i++){
+                distances[i] = getDistance(query, *objects[i]);
+            }
+        }
+
+        /**
+        * @copydoc getDistances(ObjectType & query, ObjectType ** objects, size_t n, double * distances, double bound) .
+        */
+        void GetDistances(ObjectType & query, ObjectType ** objects, size_t n, double * distances, double bound){
+            getDistances(query, objects, n, distances, bound);
+        }
+
+        /**
+        * This method calculates the distances between a query and many
+        * objects, as n calls to getDistance(query, objects[i], bound) would,
+        * and counts n distances.
+        *
+        * <p>This implementation returns the distances of getDistances().
+        *
+        * @param query The query object.
+        * @param objects The objects.
+        * @param n Number of objects.
+        * @param distances The n distances, in the order of the objects. Each
+        * one is exact if it is not larger than bound.
+        * @param bound The bound.
+        */
+        virtual void getDistances(ObjectType & query, ObjectType ** objects, size_t n, double * distances, double bound){
+            getDistances(query, objects, n, distances);
+        }
+
         /**
         * Overload on operator to set statistics on a new operator.
         *
@@ -193,7 +287,7 @@ class DistanceFunction{
         /**
         * @copydoc getDistanceCount() .
         */
-        u_int32_t GetDistanceCount() {
+        u_int64_t GetDistanceCount() const{
 
             return getDistanceCount();
         }
@@ -203,8 +297,8 @@ class DistanceFunction{
         * @deprecated use getDistanceCount() instead.
         * @return Returns the number of distances performed.
         */
-        u_int32_t getDistanceCount() {
-            return distCount;
+        u_int64_t getDistanceCount() const{
+            return distCount.load(std::memory_order_relaxed);
         }
 
         /**
@@ -216,14 +310,58 @@ class DistanceFunction{
         }
 
         /**
-        * Updates the distance counter by adding 1.
+        * Updates the distance counter, and the DISTANCES counter of
+        * stStatistics, by adding 1.
         * @deprecated use updateDistanceCount() instead.
         */
         void updateDistanceCount(){
 
-            distCount++;
+            addDistanceCount(1);
+            stStatistics::Add(stStatistics::DISTANCES);
+        }
+
+        /**
+        * @copydoc updateDistanceCount(u_int64_t n) .
+        */
+        void UpdateDistanceCount(u_int64_t n){
+
+            updateDistanceCount(n);
+        }
+
+        /**
+        * Updates the distance counter, and the DISTANCES counter of
+        * stStatistics, by adding n distances performed by this evaluator.
+        */
+        void updateDistanceCount(u_int64_t n){
+
+            addDistanceCount(n);
+            stStatistics::Add(stStatistics::DISTANCES, n);
+        }
+
+        /**
+        * @copydoc mergeDistanceCount(u_int64_t n) .
+        */
+        void MergeDistanceCount(u_int64_t n){
+
+            mergeDistanceCount(n);
+        }
+
+        /**
+        * Updates the distance counter by adding n distances performed by a
+        * copy of this evaluator. They are already in stStatistics.
+        */
+        void mergeDistanceCount(u_int64_t n){
+
+            addDistanceCount(n);
         }
 
-   
+    private:
+        /**
+        * Adds n to the distance counter.
+        */
+        void addDistanceCount(u_int64_t n){
+
+            distCount.fetch_add(n, std::memory_order_relaxed);
+        }
 };//end DistanceFunction
 #endif //__DistanceFunction_H
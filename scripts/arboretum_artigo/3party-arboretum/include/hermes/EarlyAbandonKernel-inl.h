@@ -0,0 +1,371 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <algorithm>
+
+/**
+* Constructor. The dimensions are visited in index order.
+*/
+inline EarlyAbandonKernel::EarlyAbandonKernel(){
+}
+
+/**
+* Sets the order in which the dimensions are visited: by decreasing
+* weights[i] * variances[i]. Ties keep the index order.
+*
+* @param weights The n weights or NULL if every weight is 1.
+* @param variances The n variances of the features or NULL if they are
+* unknown.
+* @param n Number of dimensions.
+*/
+inline void EarlyAbandonKernel::SetOrder(const double * weights,
+        const double * variances, size_t n){
+    std::vector <double> key(n);
+
+    order.clear();
+    groups.clear();
+    if ((weights == NULL) && (variances == NULL)){
+        return;
+    }
+    for (size_t i = 0; i < n; i++){
+        key[i] = ((weights == NULL) ? 1.0 : weights[i]) *
+                 ((variances == NULL) ? 1.0 : variances[i]);
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&key](size_t a, size_t b){ return key[a] > key[b]; });
+
+    // The vector path visits groups of 4 dimensions, ordered by their
+    // summed keys.
+    groups.clear();
+    for (size_t i = 0; i + 4 <= n; i += 4){
+        key[i] = key[i] + key[i + 1] + key[i + 2] + key[i + 3];
+        groups.push_back(i);
+    }
+    std::stable_sort(groups.begin(), groups.end(),
+                     [&key](size_t a, size_t b){ return key[a] > key[b]; });
+
+    // The index order needs no second pass over the terms.
+    for (size_t i = 0; i < n; i++){
+        if (order[i] != i){
+            return;
+        }
+    }
+    order.clear();
+    groups.clear();
+}
+
+/**
+* Euclidean distance, as computed by EuclideanDistance::getDistance() or, with
+* weights, EuclideanDistanceWeighted::getDistance().
+*
+* @param q The first span.
+* @param x The second span.
+* @param w The dim weights or NULL if every weight is 1.
+* @param dim Number of dimensions.
+* @param bound The bound.
+* @return The distance if it is not larger than bound. Otherwise a value
+* larger than bound.
+*/
+inline double EarlyAbandonKernel::Euclidean(const double * q, const double * x,
+        const double * w, size_t dim, double bound){
+    double limit = GetLimit(bound * bound, dim);
+
+    if (bound < 0){
+        limit = -1;
+    }
+    return sqrt(Euclidean2(q, x, (w == NULL) ? GetOnes(dim) : w, dim, limit));
+}
+
+/**
+* Euclidean distances between a query and many objects, with the same
+* values as Euclidean(q, x[j], w, dim, bound).
+*
+* @param q The query span.
+* @param x The object spans.
+* @param w The dim weights or NULL if every weight is 1.
+* @param n Number of objects.
+* @param dim Number of dimensions.
+* @param bound The bound.
+* @param out The n distances.
+*/
+inline void EarlyAbandonKernel::Euclidean(const double * q, const double * const * x,
+        const double * w, size_t n, size_t dim, double bound, double * out){
+    double limit = GetLimit(bound * bound, dim);
+    size_t j = 0;
+
+    if (bound < 0){
+        limit = -1;
+    }else if (limit == HUGE_VAL){
+        // Nothing to abandon.
+        if (w == NULL){
+            OneToManyKernel::Euclidean(q, x, n, dim, out);
+        }else{
+            OneToManyKernel::WeightedEuclidean(q, x, w, n, dim, out);
+        }
+        return;
+    }
+    if (w == NULL){
+        // (tmp * tmp) * 1 is tmp * tmp.
+        w = GetOnes(dim);
+    }
+    #ifdef HERMES_X86_SIMD
+    if (OneToManyKernel::UseAVX2()){
+        j = EuclideanAVX2(q, x, w, n, dim, limit, out);
+    }
+    #endif
+    for (; j < n; j++){
+        out[j] = sqrt(Euclidean2(q, x[j], w, dim, limit));
+    }
+}
+
+/**
+* Manhattan distance, as computed by ManhattanDistance::getDistance().
+*
+* @param q The first span.
+* @param x The second span.
+* @param dim Number of dimensions.
+* @param bound The bound.
+* @return The distance if it is not larger than bound. Otherwise a value
+* larger than bound.
+*/
+HERMES_NO_FP_CONTRACT
+inline double EarlyAbandonKernel::Manhattan(const double * q, const double * x,
+        size_t dim, double bound){
+    double limit = GetLimit(bound, dim);
+    const size_t * o = (limit == HUGE_VAL) ? NULL : GetOrder(dim);
+    double d = 0;
+    double tmp;
+    double * t;
+    size_t i;
+
+    if (o == NULL){
+        for (i = 0; i < dim; i++){
+            tmp = fabs(q[i] - x[i]);
+            d = d + tmp;
+            if (d > limit){
+                return d;
+            }
+        }
+        return d;
+    }
+
+    t = GetTerms(dim);
+    for (size_t k = 0; k < dim; k++){
+        i = o[k];
+        tmp = fabs(q[i] - x[i]);
+        t[i] = tmp;
+        d = d + tmp;
+        if (d > limit){
+            return d;
+        }
+    }
+    d = 0;
+    for (i = 0; i < dim; i++){
+        d = d + t[i];
+    }
+    return d;
+}
+
+/**
+* Manhattan distances between a query and many objects, with the same
+* values as Manhattan(q, x[j], dim, bound).
+*
+* @param q The query span.
+* @param x The object spans.
+* @param n Number of objects.
+* @param dim Number of dimensions.
+* @param bound The bound.
+* @param out The n distances.
+*/
+inline void EarlyAbandonKernel::Manhattan(const double * q, const double * const * x,
+        size_t n, size_t dim, double bound, double * out){
+    if (GetLimit(bound, dim) == HUGE_VAL){
+        // Nothing to abandon.
+        OneToManyKernel::Manhattan(q, x, n, dim, out);
+        return;
+    }
+    for (size_t j = 0; j < n; j++){
+        out[j] = Manhattan(q, x[j], dim, bound);
+    }
+}
+
+/**
+* Returns the value a partial sum of dim non-negative terms must exceed to
+* prove that the full sum, added in any order, exceeds bound. It is
+* HUGE_VAL if nothing can be abandoned and -1 if bound is negative.
+*
+* @param bound The bound of the full sum.
+* @param dim Number of terms.
+*/
+inline double EarlyAbandonKernel::GetLimit(double bound, size_t dim){
+    if (bound < 0){
+        return -1;
+    }else if (!(bound < HUGE_VAL)){
+        return HUGE_VAL;
+    }
+    return bound * (1 + (2 * dim + 4) * DBL_EPSILON);
+}
+
+/**
+* Returns the order of the dimensions or NULL for the index order. An order
+* set for another number of dimensions is not used.
+*/
+inline const size_t * EarlyAbandonKernel::GetOrder(size_t dim){
+    return (order.size() == dim) ? order.data() : NULL;
+}
+
+/**
+* Returns a buffer of the calling thread for 4 terms per dimension.
+*/
+inline double * EarlyAbandonKernel::GetTerms(size_t dim){
+    static thread_local std::vector <double> terms;
+
+    if (terms.size() < 4 * dim){
+        terms.resize(4 * dim);
+    }
+    return terms.data();
+}
+
+/**
+* Returns dim weights of 1, in a buffer of the calling thread.
+*/
+inline const double * EarlyAbandonKernel::GetOnes(size_t dim){
+    static thread_local std::vector <double> ones;
+
+    if (ones.size() < dim){
+        ones.assign(dim, 1.0);
+    }
+    return ones.data();
+}
+
+/**
+* Returns the squared Euclidean distance, or a partial sum larger than limit.
+*/
+HERMES_NO_FP_CONTRACT
+inline double EarlyAbandonKernel::Euclidean2(const double * q, const double * x,
+        const double * w, size_t dim, double limit){
+    const size_t * o = (limit == HUGE_VAL) ? NULL : GetOrder(dim);
+    double d = 0;
+    double tmp;
+    double * t;
+    size_t i;
+
+    if (o == NULL){
+        for (i = 0; i < dim; i++){
+            tmp = q[i] - x[i];
+            tmp = tmp * tmp;
+            tmp = tmp * w[i];
+            d = d + tmp;
+            if (d > limit){
+                return d;
+            }
+        }
+        return d;
+    }
+
+    t = GetTerms(dim);
+    for (size_t k = 0; k < dim; k++){
+        i = o[k];
+        tmp = q[i] - x[i];
+        tmp = tmp * tmp;
+        tmp = tmp * w[i];
+        t[i] = tmp;
+        d = d + tmp;
+        if (d > limit){
+            return d;
+        }
+    }
+    d = 0;
+    for (i = 0; i < dim; i++){
+        d = d + t[i];
+    }
+    return d;
+}
+
+#ifdef HERMES_X86_SIMD
+/**
+* Computes the Euclidean distances of the first objects, 4 at a time, and
+* returns how many were computed. A group is abandoned only when the partial
+* sums of its 4 lanes exceed limit. They are tested every 4 dimensions. With
+* an order set, the dimensions are visited by groups of 4 consecutive ones,
+* so the objects are still read 4 doubles at a time; the last dim % 4
+* dimensions are only added if nothing was abandoned.
+*/
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline size_t EarlyAbandonKernel::EuclideanAVX2(const double * q, const double * const * x,
+        const double * w, size_t n, size_t dim, double limit, double * out){
+    const size_t * o = GetOrder(dim);
+    double * t = (o == NULL) ? NULL : GetTerms(dim);
+    const __m256d lim = _mm256_set1_pd(limit);
+    size_t i, j, k;
+    __m256d v[4];
+    __m256d d, tmp;
+    bool abandoned;
+
+    for (j = 0; j + 4 <= n; j += 4){
+        d = _mm256_setzero_pd();
+        abandoned = false;
+        if (o == NULL){
+            // Index order: d is the distance unless it is abandoned.
+            for (i = 0; (i + 4 <= dim) && !abandoned; i += 4){
+                OneToManyLoad4x4(x + j, i, v);
+                for (k = 0; k < 4; k++){
+                    tmp = _mm256_sub_pd(_mm256_set1_pd(q[i + k]), v[k]);
+                    tmp = _mm256_mul_pd(tmp, tmp);
+                    tmp = _mm256_mul_pd(tmp, _mm256_set1_pd(w[i + k]));
+                    d = _mm256_add_pd(d, tmp);
+                }
+                abandoned = (_mm256_movemask_pd(_mm256_cmp_pd(d, lim, _CMP_GT_OQ)) == 0xF);
+            }
+            for (; (i < dim) && !abandoned; i++){
+                OneToManyLoad4x1(x + j, i, v);
+                tmp = _mm256_sub_pd(_mm256_set1_pd(q[i]), v[0]);
+                tmp = _mm256_mul_pd(tmp, tmp);
+                tmp = _mm256_mul_pd(tmp, _mm256_set1_pd(w[i]));
+                d = _mm256_add_pd(d, tmp);
+            }
+        }else{
+            // Keep the terms to add them again in index order.
+            for (k = 0; (k < groups.size()) && !abandoned; k++){
+                i = groups[k];
+                OneToManyLoad4x4(x + j, i, v);
+                for (size_t l = 0; l < 4; l++){
+                    tmp = _mm256_sub_pd(_mm256_set1_pd(q[i + l]), v[l]);
+                    tmp = _mm256_mul_pd(tmp, tmp);
+                    tmp = _mm256_mul_pd(tmp, _mm256_set1_pd(w[i + l]));
+                    _mm256_storeu_pd(t + 4 * (i + l), tmp);
+                    d = _mm256_add_pd(d, tmp);
+                }
+                abandoned = (_mm256_movemask_pd(_mm256_cmp_pd(d, lim, _CMP_GT_OQ)) == 0xF);
+            }
+            if (!abandoned){
+                d = _mm256_setzero_pd();
+                for (i = 0; i < 4 * groups.size(); i++){
+                    d = _mm256_add_pd(d, _mm256_loadu_pd(t + 4 * i));
+                }
+                for (; i < dim; i++){
+                    OneToManyLoad4x1(x + j, i, v);
+                    tmp = _mm256_sub_pd(_mm256_set1_pd(q[i]), v[0]);
+                    tmp = _mm256_mul_pd(tmp, tmp);
+                    tmp = _mm256_mul_pd(tmp, _mm256_set1_pd(w[i]));
+                    d = _mm256_add_pd(d, tmp);
+                }
+            }
+        }
+        _mm256_storeu_pd(out + j, _mm256_sqrt_pd(d));
+    }
+    return j;
+}
+#endif
@@ -0,0 +1,100 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the early-abandon kernels used by the bounded
+* getDistance() and getDistances() of the Lp distance functions.
+*
+* @version 1.0
+* @date 10-17-2026
+*/
+#ifndef EARLYABANDONKERNEL_H
+#define EARLYABANDONKERNEL_H
+
+#include "OneToManyKernel.h"
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/**
+* Evaluates Lp distances that may stop as soon as they are known to exceed a
+* bound.
+*
+* <p>The terms are accumulated in a dimension order where the dimensions
+* with the largest expected contribution (weight times variance, see
+* SetOrder()) come first, so the partial sum passes the bound early. When it
+* does, the partial sum, which is already larger than the bound, is
+* returned. Otherwise the terms kept on the way are added again in index
+* order, so the distance has exactly the same bits as getDistance(). With no
+* order set, the dimensions are visited in index order and the running sum is
+* already the distance.
+*
+* <p>Only SetOrder() changes the kernel: the buffers of the distances belong
+* to the calling thread, so a kernel may be shared by threads.
+*
+* <p>The partial sum and the full sum are rounded differently, so the bound
+* is widened by a few ulps per dimension before it is compared: an abandoned
+* distance is always larger than the bound.
+*
+* @brief Early-abandon Lp kernels.
+* @version 1.0.
+*/
+class EarlyAbandonKernel{
+    public:
+        EarlyAbandonKernel();
+
+        void SetOrder(const double * weights, const double * variances, size_t n);
+
+        double Euclidean(const double * q, const double * x, const double * w,
+                         size_t dim, double bound);
+        void Euclidean(const double * q, const double * const * x, const double * w,
+                       size_t n, size_t dim, double bound, double * out);
+        double Manhattan(const double * q, const double * x, size_t dim, double bound);
+        void Manhattan(const double * q, const double * const * x, size_t n,
+                       size_t dim, double bound, double * out);
+
+        static double GetLimit(double bound, size_t dim);
+
+    private:
+        /**
+        * Dimensions in the order they are accumulated. Empty means index
+        * order.
+        */
+        std::vector <size_t> order;
+
+        /**
+        * First dimensions of the groups of 4 dimensions in the order they are
+        * accumulated by the vector path. Empty means index order.
+        */
+        std::vector <size_t> groups;
+
+        const size_t * GetOrder(size_t dim);
+        static double * GetTerms(size_t dim);
+        static const double * GetOnes(size_t dim);
+
+        double Euclidean2(const double * q, const double * x, const double * w,
+                          size_t dim, double limit);
+
+        #ifdef HERMES_X86_SIMD
+        size_t EuclideanAVX2(const double * q, const double * const * x,
+                             const double * w, size_t n, size_t dim,
+                             double limit, double * out);
+        #endif
+};
+
+#include "EarlyAbandonKernel-inl.h"
+#endif // EARLYABANDONKERNEL_H
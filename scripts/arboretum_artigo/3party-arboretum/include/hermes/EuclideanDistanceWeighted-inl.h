@@ -20,6 +20,11 @@ using namespace std;
 
 template <class ObjectType>
 EuclideanDistanceWeighted<ObjectType>::EuclideanDistanceWeighted(){
+
+    dimension = 0;
+    buildDimension = 0;
+    feedbackSize = 0;
+    feedbackDimension = 0;
 }
 
 /**
@@ -53,44 +58,158 @@ double EuclideanDistanceWeighted<ObjectType>::GetDistance(ObjectType &obj1, Obje
 template <class ObjectType>
 double EuclideanDistanceWeighted<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error){
 
-    weights = GetWeights();
-    if(weights.empty() && obj1.size() > 0){
-        weights.clear();
-        for (size_t i = 0; i < obj1.size(); i++)
-        {
-            weights.push_back(1);
-        }   
+    size_t n = obj1.size();
+    double d;
+
+    if (obj2.size() != n || (kernel.GetSize() != 0 && kernel.GetSize() < n)){
+        throw std::length_error("The feature vectors do not have the same size.");
+    }
+
+    if (kernel.GetSize() == 0){
+        // No weights: every dimension has weight 1.
+        const double * x = obj2.data();
+        OneToManyKernel::Euclidean(obj1.data(), &x, 1, n, &d);
+    }else{
+        d = sqrt(kernel.Distance2(obj1.data(), obj2.data(), n));
     }
 
-    if (obj1.size() != obj2.size() && obj1.size() != weights.size()){
+    // Statistic support
+    this->updateDistanceCount();
+
+    return d;
+}
+
+/**
+* Calculates the weighted Euclidean distances between a query and many
+* feature vectors. They are evaluated by OneToManyKernel, several objects at
+* once, and are the same values getDistance() returns.
+*
+* @param query: The query feature vector.
+* @param objects: The feature vectors.
+* @param n: Number of feature vectors.
+* @param distances: The n distances.
+* @throw Exception If the computation is not possible.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances) throw (std::length_error){
+
+    // The spans of each thread, so the evaluator may be shared.
+    static thread_local FeatureSpans<ObjectType> spans;
+    size_t dim = query.size();
+
+    if (kernel.GetSize() != 0 && kernel.GetSize() < dim){
         throw std::length_error("The feature vectors do not have the same size.");
     }
 
-    double d = 0;
-    double tmp = 0;
+    spans.Set(query, objects, n);
+    if (kernel.GetSize() == 0){
+        // No weights: every dimension has weight 1.
+        OneToManyKernel::Euclidean(spans.GetQuery(), spans.GetObjects(),
+                                   n, dim, distances);
+    }else{
+        OneToManyKernel::WeightedEuclidean(spans.GetQuery(), spans.GetObjects(),
+                                           kernel.GetWeights(), n, dim, distances);
+    }
 
-    for (size_t i = 0; i < obj1.size(); i++){
-        //tmp = obj1[i] - obj2[i];
-        tmp = obj1.GetFeatures()[i] - obj2.GetFeatures()[i];
-        //cout << "W: " << weights[i] << " ";
+    // Statistic support
+    this->updateDistanceCount(n);
+}
+
+/**
+* @deprecated Use getDistance(ObjectType &obj1, ObjectType &obj2, double bound) instead.
+*
+* @copydoc getDistance(ObjectType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType>
+double EuclideanDistanceWeighted<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error){
+
+    return getDistance(obj1, obj2, bound);
+}
+
+/**
+* Calculates the weighted Euclidean distance between two feature vectors when
+* it is not larger than bound. The sum stops as soon as it exceeds bound
+* (see EarlyAbandonKernel).
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector.
+* @param bound: The bound.
+* @throw Exception If the computation is not possible.
+* @return The weighted Euclidean distance between feature vector 1 and
+* feature vector 2 if it is not larger than bound. Otherwise a value larger
+* than bound.
+*/
+template <class ObjectType>
+double EuclideanDistanceWeighted<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error){
 
-        d = d + ((tmp * tmp) * weights[i]);
+    size_t n = obj1.size();
 
+    if (obj2.size() != n || (kernel.GetSize() != 0 && kernel.GetSize() < n)){
+        throw std::length_error("The feature vectors do not have the same size.");
     }
-    //cout << "" << endl;
+
+    // With no weights, every dimension has weight 1.
+    double d = abandon.Euclidean(obj1.data(), obj2.data(),
+                                 (kernel.GetSize() == 0) ? NULL : kernel.GetWeights(),
+                                 n, bound);
 
     // Statistic support
     this->updateDistanceCount();
 
-    return sqrt(d);
+    return d;
 }
 
+/**
+* Calculates the weighted Euclidean distances between a query and many
+* feature vectors, as getDistance(query, objects[i], bound) does.
+*
+* @param query: The query feature vector.
+* @param objects: The feature vectors.
+* @param n: Number of feature vectors.
+* @param distances: The n distances.
+* @param bound: The bound.
+* @throw Exception If the computation is not possible.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances, double bound) throw (std::length_error){
+
+    // The spans of each thread, so the evaluator may be shared.
+    static thread_local FeatureSpans<ObjectType> spans;
+    size_t dim = query.size();
+
+    if (kernel.GetSize() != 0 && kernel.GetSize() < dim){
+        throw std::length_error("The feature vectors do not have the same size.");
+    }
+
+    spans.Set(query, objects, n);
+    // With no weights, every dimension has weight 1.
+    abandon.Euclidean(spans.GetQuery(), spans.GetObjects(),
+                      (kernel.GetSize() == 0) ? NULL : kernel.GetWeights(),
+                      n, dim, bound, distances);
+
+    // Statistic support
+    this->updateDistanceCount(n);
+}
+
+/**
+* Sets the weights of the distances. They must cover every feature of the
+* objects compared. Until they are set, every weight is 1.
+*
+* <p>The distances only read the evaluator, so it may be shared by threads
+* as long as the weights are not changed while distances are evaluated.
+*
+* @param weights The weights.
+* @throw std::length_error If weights is empty.
+*/
 template <class ObjectType>
 void EuclideanDistanceWeighted<ObjectType>::SetWeights(vector<double> weights) throw (std::length_error){
     if(weights.size() == 0 || weights.empty())
         throw std::length_error("The weight vectors cant be zero");
 
-    this->weights = weights; 
+    this->weights = weights;
+    dimension = weights.size();
+    kernel.SetWeights(this->weights.data(), this->weights.size());
+    UpdateOrder();
 }
 
 template <class ObjectType>
@@ -98,3 +217,247 @@ vector<double> EuclideanDistanceWeighted<ObjectType>::GetWeights() throw (std::l
     return weights;
 }
 
+/**
+* Sets the variances of the features. The bounded distances visit the
+* dimensions of largest weight times variance first.
+*
+* @param variances The variance of each feature. An empty vector means they
+* are unknown.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::SetVariances(vector<double> variances){
+
+    this->variances = variances;
+    UpdateOrder();
+}
+
+/**
+* Orders the dimensions of the bounded distances by weight times variance.
+* Variances of another number of features are not used.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::UpdateOrder(){
+
+    if (weights.empty()){
+        abandon.SetOrder(NULL, variances.empty() ? NULL : variances.data(),
+                         variances.size());
+    }else if (variances.size() == weights.size()){
+        abandon.SetOrder(weights.data(), variances.data(), weights.size());
+    }else{
+        abandon.SetOrder(weights.data(), NULL, weights.size());
+    }
+}
+
+/**
+* Sets the weights used to compute the distances stored in the tree.
+*
+* @param weights The build weights. An empty vector means every weight is 1.
+* @param dimension The number of features of the objects in the tree, or 0
+* if it is unknown. The weights of other features do not change the
+* distances, so GetDistortion() ignores them.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::SetBuildWeights(vector<double> weights, size_t dimension){
+
+    buildWeights = weights;
+    buildDimension = dimension;
+}
+
+template <class ObjectType>
+vector<double> EuclideanDistanceWeighted<ObjectType>::GetBuildWeights(){
+
+    return buildWeights;
+}
+
+template <class ObjectType>
+size_t EuclideanDistanceWeighted<ObjectType>::GetBuildDimension(){
+
+    return buildDimension;
+}
+
+/**
+* Returns the factors that bound a distance under the current weights by the
+* same distance under the build weights:
+* lower * d_build <= d_current <= upper * d_build.
+*
+* <p>Only the features of the objects in the tree are considered (see
+* SetBuildWeights()). If their number is unknown, the dimensions covered by
+* the current weights, or by the build weights if no weights were set, are
+* considered. A missing weight is 1. A dimension with build weight 0 and
+* current weight greater than 0 makes upper infinite, since nothing is known
+* about it. Unless the weights are the same, the factors are widened by a few
+* ulps to cover the rounding of the stored distances. lower is at most 1 and
+* upper at least 1, as stSlimTree::SetDistortion() requires.
+*
+* @param lower The lower factor.
+* @param upper The upper factor.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::GetDistortion(double & lower, double & upper){
+
+    size_t n = buildDimension;
+
+    if (n == 0){
+        n = dimension;
+    }
+    if (n == 0){
+        n = max(weights.size(), buildWeights.size());
+    }
+    GetDistortion(buildWeights, weights, n, lower, upper);
+}
+
+/**
+* Keeps the squared differences between a query and a set of candidates under
+* every dimension, so their distances may be computed again for any weights
+* by GetFeedbackDistances(). The current weights are recorded as well (see
+* GetFeedbackDistortion()). The previous candidates are discarded.
+*
+* <p>No distance is evaluated, so the distance count does not change.
+*
+* @param query The query object.
+* @param candidates The candidates.
+* @param n Number of candidates.
+* @throw std::length_error If a candidate and the query do not have the same
+* size.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::SetFeedbackCandidates(
+        ObjectType & query, ObjectType ** candidates, size_t n) throw (std::length_error){
+
+    size_t dim = query.size();
+    const double * q = query.data();
+    const double * x;
+    double tmp;
+
+    for (size_t j = 0; j < n; j++){
+        if (candidates[j]->size() != dim){
+            throw std::length_error("The feature vectors do not have the same size.");
+        }
+    }
+
+    feedbackTerms.resize(dim * n);
+    for (size_t j = 0; j < n; j++){
+        x = candidates[j]->data();
+        for (size_t i = 0; i < dim; i++){
+            tmp = q[i] - x[i];
+            feedbackTerms[i * n + j] = tmp * tmp;
+        }
+    }
+    feedbackSize = n;
+    feedbackDimension = dim;
+    feedbackWeights = weights;
+}
+
+/**
+* Discards the feedback candidates.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::ClearFeedbackCandidates(){
+
+    feedbackTerms.clear();
+    feedbackSize = 0;
+    feedbackDimension = 0;
+    feedbackWeights.clear();
+}
+
+/**
+* Returns the number of feedback candidates.
+*/
+template <class ObjectType>
+size_t EuclideanDistanceWeighted<ObjectType>::GetFeedbackSize(){
+
+    return feedbackSize;
+}
+
+/**
+* Computes the distances between the feedback query and each of its
+* candidates under the current weights. A missing weight is 1.
+*
+* <p>Each distance adds the same terms in the same order as getDistance(), so
+* it is the value getDistance() would return for the same objects. The
+* distance count does not change.
+*
+* @param distances The distances, in the order of the candidates. It must
+* hold GetFeedbackSize() values.
+*/
+template <class ObjectType>
+HERMES_NO_FP_CONTRACT
+void EuclideanDistanceWeighted<ObjectType>::GetFeedbackDistances(double * distances){
+
+    size_t n = feedbackSize;
+    const double * terms = feedbackTerms.data();
+    double w;
+
+    for (size_t j = 0; j < n; j++){
+        distances[j] = 0;
+    }
+    // One row of terms per dimension: the inner loop is a plain axpy over
+    // the candidates.
+    for (size_t i = 0; i < feedbackDimension; i++){
+        w = (i < weights.size()) ? weights[i] : 1;
+        for (size_t j = 0; j < n; j++){
+            distances[j] = distances[j] + (terms[j] * w);
+        }
+        terms += n;
+    }
+    for (size_t j = 0; j < n; j++){
+        distances[j] = sqrt(distances[j]);
+    }
+}
+
+/**
+* Returns the factors that bound a distance under the current weights by the
+* same distance under the weights in use when the feedback candidates were
+* set: lower * d_feedback <= d_current <= upper * d_feedback. The rules are
+* those of GetDistortion().
+*
+* @param lower The lower factor.
+* @param upper The upper factor.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::GetFeedbackDistortion(double & lower, double & upper){
+
+    GetDistortion(feedbackWeights, weights, feedbackDimension, lower, upper);
+}
+
+/**
+* Returns the factors that bound a distance under the weights to by the same
+* distance under the weights from, considering the first n dimensions.
+*
+* @param from The reference weights.
+* @param to The new weights.
+* @param n Number of dimensions.
+* @param lower The lower factor.
+* @param upper The upper factor.
+*/
+template <class ObjectType>
+void EuclideanDistanceWeighted<ObjectType>::GetDistortion(const vector<double> & from,
+        const vector<double> & to, size_t n, double & lower, double & upper){
+
+    double minRatio = INFINITY;
+    double maxRatio = 0;
+    double b, w, ratio;
+
+    for (size_t i = 0; i < n; i++){
+        b = (i < from.size()) ? from[i] : 1;
+        w = (i < to.size()) ? to[i] : 1;
+        if (b == 0){
+            if (w != 0){
+                // The stored distances ignore this dimension.
+                maxRatio = INFINITY;
+            }
+            continue;
+        }
+        ratio = w / b;
+        minRatio = min(minRatio, ratio);
+        maxRatio = max(maxRatio, ratio);
+    }
+    if (minRatio == INFINITY){
+        // No dimension with a build weight.
+        minRatio = 1;
+        maxRatio = max(maxRatio, 1.0);
+    }
+
+    lower = (minRatio >= 1) ? 1 : sqrt(minRatio) * (1 - 1e-12);
+    upper = (maxRatio <= 1) ? 1 : sqrt(maxRatio) * (1 + 1e-12);
+}
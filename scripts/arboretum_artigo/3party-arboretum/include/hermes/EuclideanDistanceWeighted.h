@@ -25,15 +25,38 @@
 #define EUCLIDEANDISTANCEWEIGHTED_H
 
 #include "DistanceFunction.h"
+#include "WeightedEuclideanKernel.h"
+#include "OneToManyKernel.h"
+#include "EarlyAbandonKernel.h"
 #include <cmath>
 #include <vector>
 #include <stdexcept>
 using namespace std;
 
 /**
-* Class to obtain the Euclidean (or geometric) Distance
+* Class to obtain the weighted Euclidean (or geometric) Distance
 *
-* @brief L2 distance class.
+* <p>The objects must expose their features as a contiguous span through
+* data() and size(). The weights live in a WeightedEuclideanKernel, so no
+* vector is copied while a distance is evaluated.
+*
+* <p>A tree stores distances computed with the weights in use when it was
+* built. If the weights change later, those distances are still valid up to a
+* factor: for every pair of objects
+* sqrt(min(w[i]/b[i])) * d_b <= d_w <= sqrt(max(w[i]/b[i])) * d_b, where b are
+* the build weights. GetDistortion() returns these factors, so a tree may
+* rescale its radii instead of being rebuilt.
+*
+* <p>For relevance feedback, the evaluator may also keep the per-dimension
+* squared differences (q[i] - x[i])^2 between a query and a set of candidates
+* (see SetFeedbackCandidates()). The distances of all candidates under new
+* weights are then a single matrix-vector product (see
+* GetFeedbackDistances()) instead of a new search.
+*
+* <p>The bounded distances visit the dimensions by decreasing weight times
+* variance (see SetVariances()) and stop once the sum exceeds the bound.
+*
+* @brief Weighted L2 distance class.
 * @author 006.
 * @version 1.0.
 */
@@ -47,8 +70,86 @@ class EuclideanDistanceWeighted : public DistanceFunction <ObjectType>{
 
         double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
         double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        void getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances) throw (std::length_error);
+        double GetDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error);
+        double getDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error);
+        void getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances, double bound) throw (std::length_error);
         void SetWeights(vector<double> weights) throw (std::length_error);
         vector<double> GetWeights() throw (std::length_error);
+        void SetVariances(vector<double> variances);
+
+        void SetBuildWeights(vector<double> weights, size_t dimension = 0);
+        vector<double> GetBuildWeights();
+        size_t GetBuildDimension();
+        void GetDistortion(double & lower, double & upper);
+
+        void SetFeedbackCandidates(ObjectType & query, ObjectType ** candidates,
+                                   size_t n) throw (std::length_error);
+        void ClearFeedbackCandidates();
+        size_t GetFeedbackSize();
+        void GetFeedbackDistances(double * distances);
+        void GetFeedbackDistortion(double & lower, double & upper);
+
+    private:
+        /**
+        * Aligned copy of weights used to evaluate the distances.
+        */
+        WeightedEuclideanKernel kernel;
+
+        /**
+        * Kernel of the bounded distances. Its dimensions are ordered by
+        * weight times variance.
+        */
+        EarlyAbandonKernel abandon;
+
+        /**
+        * Variances of the features. Empty if they are unknown.
+        */
+        vector<double> variances;
+
+        /**
+        * Weights used to compute the distances stored in the tree. Empty means
+        * every weight is 1.
+        */
+        vector<double> buildWeights;
+
+        /**
+        * Number of features of the objects in the tree, 0 if it is unknown.
+        */
+        size_t buildDimension;
+
+        /**
+        * Number of dimensions of the weights, 0 until they are set.
+        */
+        size_t dimension;
+
+        /**
+        * Squared differences between the feedback query and its candidates,
+        * dimension-major: the term of dimension i of candidate j is
+        * feedbackTerms[i * feedbackSize + j].
+        */
+        vector<double> feedbackTerms;
+
+        /**
+        * Number of feedback candidates.
+        */
+        size_t feedbackSize;
+
+        /**
+        * Number of dimensions of the feedback candidates.
+        */
+        size_t feedbackDimension;
+
+        /**
+        * Weights in use when the feedback candidates were set.
+        */
+        vector<double> feedbackWeights;
+
+        void UpdateOrder();
+
+        static void GetDistortion(const vector<double> & from,
+                                  const vector<double> & to, size_t n,
+                                  double & lower, double & upper);
 };
 
 #include "EuclideanDistanceWeighted-inl.h"
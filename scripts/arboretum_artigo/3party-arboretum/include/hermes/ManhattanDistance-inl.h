@@ -67,3 +67,106 @@ double ManhattanDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &
 
     return d;
 }
+
+/**
+* Calculates the Manhattan distances between a query and many feature vectors.
+* If the objects expose their features through data(), the distances are
+* evaluated by OneToManyKernel, several objects at once. They are the same
+* values getDistance() returns.
+*
+* @param query: The query feature vector.
+* @param objects: The feature vectors.
+* @param n: Number of feature vectors.
+* @param distances: The n distances.
+* @throw Exception If the computation is not possible.
+*/
+template <class ObjectType>
+void ManhattanDistance<ObjectType>::getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances) throw (std::length_error){
+
+    if (!spans.Set(query, objects, n)){
+        DistanceFunction<ObjectType>::getDistances(query, objects, n, distances);
+        return;
+    }
+
+    OneToManyKernel::Manhattan(spans.GetQuery(), spans.GetObjects(), n, spans.GetDimension(), distances);
+
+    // Statistic support
+    this->updateDistanceCount(n);
+}
+
+/**
+* @deprecated Use getDistance(ObjectType &obj1, ObjectType &obj2, double bound) instead.
+*
+* @copydoc getDistance(ObjectType &obj1, ObjectType &obj2, double bound) .
+*/
+template <class ObjectType>
+double ManhattanDistance<ObjectType>::GetDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error){
+
+    return getDistance(obj1, obj2, bound);
+}
+
+/**
+* Calculates the Manhattan distance between two feature vectors when it is not
+* larger than bound. If the objects expose their features through data(),
+* the sum stops as soon as it exceeds bound (see EarlyAbandonKernel).
+*
+* @param obj1: The first feature vector.
+* @param obj2: The second feature vector.
+* @param bound: The bound.
+* @throw Exception If the computation is not possible.
+* @return The Manhattan distance between feature vector 1 and feature vector 2 if
+* it is not larger than bound. Otherwise a value larger than bound.
+*/
+template <class ObjectType>
+double ManhattanDistance<ObjectType>::getDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error){
+
+    ObjectType * obj = &obj2;
+
+    if (!spans.Set(obj1, &obj, 1)){
+        return getDistance(obj1, obj2);
+    }
+
+    double d = abandon.Manhattan(spans.GetQuery(), spans.GetObjects()[0], spans.GetDimension(), bound);
+
+    // Statistic support
+    this->updateDistanceCount();
+
+    return d;
+}
+
+/**
+* Calculates the Manhattan distances between a query and many feature vectors,
+* as getDistance(query, objects[i], bound) does.
+*
+* @param query: The query feature vector.
+* @param objects: The feature vectors.
+* @param n: Number of feature vectors.
+* @param distances: The n distances.
+* @param bound: The bound.
+* @throw Exception If the computation is not possible.
+*/
+template <class ObjectType>
+void ManhattanDistance<ObjectType>::getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances, double bound) throw (std::length_error){
+
+    if (!spans.Set(query, objects, n)){
+        DistanceFunction<ObjectType>::getDistances(query, objects, n, distances, bound);
+        return;
+    }
+
+    abandon.Manhattan(spans.GetQuery(), spans.GetObjects(), n, spans.GetDimension(), bound, distances);
+
+    // Statistic support
+    this->updateDistanceCount(n);
+}
+
+/**
+* Sets the variances of the features. The bounded distances visit the
+* dimensions of largest variance first.
+*
+* @param variances: The variance of each feature.
+*/
+template <class ObjectType>
+void ManhattanDistance<ObjectType>::SetVariances(const std::vector<double> & variances){
+
+    abandon.SetOrder(NULL, variances.data(), variances.size());
+}
@@ -24,8 +24,11 @@
 #define MANHATTANDISTANCE_H
 
 #include "DistanceFunction.h"
+#include "OneToManyKernel.h"
+#include "EarlyAbandonKernel.h"
 #include <cmath>
 #include <stdexcept>
+#include <vector>
 
 /**
 * Class to obtain the Manhattan (or L1) Distance
@@ -43,6 +46,23 @@ class ManhattanDistance : public DistanceFunction<ObjectType> {
 
         double GetDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
         double getDistance(ObjectType &obj1, ObjectType &obj2) throw (std::length_error);
+        void getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances) throw (std::length_error);
+
+        double GetDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error);
+        double getDistance(ObjectType &obj1, ObjectType &obj2, double bound) throw (std::length_error);
+        void getDistances(ObjectType &query, ObjectType **objects, size_t n, double *distances, double bound) throw (std::length_error);
+        void SetVariances(const std::vector<double> & variances);
+
+    private:
+        /**
+        * Spans of the last getDistances().
+        */
+        FeatureSpans<ObjectType> spans;
+
+        /**
+        * Kernel of the bounded distances.
+        */
+        EarlyAbandonKernel abandon;
 };
 
 
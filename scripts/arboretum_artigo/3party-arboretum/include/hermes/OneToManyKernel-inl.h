@@ -0,0 +1,520 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifdef HERMES_X86_SIMD
+/**
+* Loads 4 dimensions, from i on, of 4 objects: v[k] holds dimension i + k of
+* each object, one object per lane.
+*/
+__attribute__((target("avx2")))
+static inline void OneToManyLoad4x4(const double * const * x, size_t i, __m256d * v){
+    __m256d r0 = _mm256_loadu_pd(x[0] + i);
+    __m256d r1 = _mm256_loadu_pd(x[1] + i);
+    __m256d r2 = _mm256_loadu_pd(x[2] + i);
+    __m256d r3 = _mm256_loadu_pd(x[3] + i);
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    v[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+    v[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+    v[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+    v[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+/**
+* Loads dimension i of 4 objects, one object per lane.
+*/
+__attribute__((target("avx2")))
+static inline void OneToManyLoad4x1(const double * const * x, size_t i, __m256d * v){
+    *v = _mm256_set_pd(x[3][i], x[2][i], x[1][i], x[0][i]);
+}
+#endif
+
+/**
+* Euclidean distances, as computed by EuclideanDistance::getDistance().
+*
+* @param q The query span.
+* @param x The object spans.
+* @param n Number of objects.
+* @param dim Number of dimensions.
+* @param out The n distances.
+*/
+inline void OneToManyKernel::Euclidean(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    size_t j = 0;
+    #ifdef HERMES_X86_SIMD
+    if (UseAVX2()){
+        j = EuclideanAVX2(q, x, n, dim, out);
+    }
+    #endif
+    for (; j < n; j++){
+        out[j] = EuclideanScalar(q, x[j], dim);
+    }
+}
+
+/**
+* Weighted Euclidean distances, as computed by
+* EuclideanDistanceWeighted::getDistance().
+*
+* @param q The query span.
+* @param x The object spans.
+* @param w The dim weights.
+* @param n Number of objects.
+* @param dim Number of dimensions.
+* @param out The n distances.
+*/
+inline void OneToManyKernel::WeightedEuclidean(const double * q, const double * const * x,
+        const double * w, size_t n, size_t dim, double * out){
+    size_t j = 0;
+    #ifdef HERMES_X86_SIMD
+    if (UseAVX2()){
+        j = WeightedEuclideanAVX2(q, x, w, n, dim, out);
+    }
+    #endif
+    for (; j < n; j++){
+        out[j] = WeightedEuclideanScalar(q, x[j], w, dim);
+    }
+}
+
+/**
+* Manhattan distances, as computed by ManhattanDistance::getDistance().
+*
+* @param q The query span.
+* @param x The object spans.
+* @param n Number of objects.
+* @param dim Number of dimensions.
+* @param out The n distances.
+*/
+inline void OneToManyKernel::Manhattan(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    size_t j = 0;
+    #ifdef HERMES_X86_SIMD
+    if (UseAVX2()){
+        j = ManhattanAVX2(q, x, n, dim, out);
+    }
+    #endif
+    for (; j < n; j++){
+        out[j] = ManhattanScalar(q, x[j], dim);
+    }
+}
+
+/**
+* Chebyshev distances, as computed by ChebyshevDistance::getDistance().
+*
+* @param q The query span.
+* @param x The object spans.
+* @param n Number of objects.
+* @param dim Number of dimensions.
+* @param out The n distances.
+*/
+inline void OneToManyKernel::Chebyshev(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    size_t j = 0;
+    #ifdef HERMES_X86_SIMD
+    if (UseAVX2()){
+        j = ChebyshevAVX2(q, x, n, dim, out);
+    }
+    #endif
+    for (; j < n; j++){
+        out[j] = ChebyshevScalar(q, x[j], dim);
+    }
+}
+
+/**
+* Canberra distances, as computed by CanberraDistance::getDistance().
+*
+* @param q The query span.
+* @param x The object spans.
+* @param n Number of objects.
+* @param dim Number of dimensions.
+* @param out The n distances.
+*/
+inline void OneToManyKernel::Canberra(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    size_t j = 0;
+    #ifdef HERMES_X86_SIMD
+    if (UseAVX2()){
+        j = CanberraAVX2(q, x, n, dim, out);
+    }
+    #endif
+    for (; j < n; j++){
+        out[j] = CanberraScalar(q, x[j], dim);
+    }
+}
+
+/**
+* Bray-Curtis distances, as computed by BrayCurtisDistance::getDistance().
+*
+* @param q The query span.
+* @param x The object spans.
+* @param n Number of objects.
+* @param dim Number of dimensions.
+* @param out The n distances.
+*/
+inline void OneToManyKernel::BrayCurtis(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    size_t j = 0;
+    #ifdef HERMES_X86_SIMD
+    if (UseAVX2()){
+        j = BrayCurtisAVX2(q, x, n, dim, out);
+    }
+    #endif
+    for (; j < n; j++){
+        out[j] = BrayCurtisScalar(q, x[j], dim);
+    }
+}
+
+/**
+* Returns the name of the implementation selected for this CPU.
+*/
+inline const char * OneToManyKernel::GetImplementationName(){
+    return UseAVX2() ? "avx2" : "scalar";
+}
+
+/**
+* Returns true if the running CPU supports AVX2. It is checked only once per
+* process.
+*/
+inline bool OneToManyKernel::UseAVX2(){
+    #ifdef HERMES_X86_SIMD
+    static const bool avx2 = [](){
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+    #else
+    return false;
+    #endif
+}
+
+/**
+* Scalar loops. They are the loops of the distance functions: the AVX2
+* implementations must return the same bits.
+*/
+HERMES_NO_FP_CONTRACT
+inline double OneToManyKernel::EuclideanScalar(const double * q, const double * x, size_t dim){
+    double d = 0;
+    double tmp;
+    for (size_t i = 0; i < dim; i++){
+        tmp = q[i] - x[i];
+        d = d + (tmp * tmp);
+    }
+    return sqrt(d);
+}
+
+HERMES_NO_FP_CONTRACT
+inline double OneToManyKernel::WeightedEuclideanScalar(const double * q, const double * x,
+        const double * w, size_t dim){
+    double d = 0;
+    double tmp;
+    for (size_t i = 0; i < dim; i++){
+        tmp = q[i] - x[i];
+        d = d + ((tmp * tmp) * w[i]);
+    }
+    return sqrt(d);
+}
+
+HERMES_NO_FP_CONTRACT
+inline double OneToManyKernel::ManhattanScalar(const double * q, const double * x, size_t dim){
+    double d = 0;
+    for (size_t i = 0; i < dim; i++){
+        d = d + fabs(q[i] - x[i]);
+    }
+    return d;
+}
+
+HERMES_NO_FP_CONTRACT
+inline double OneToManyKernel::ChebyshevScalar(const double * q, const double * x, size_t dim){
+    double d = 0;
+    double tmp;
+    for (size_t i = 0; i < dim; i++){
+        tmp = fabs(q[i] - x[i]);
+        if (tmp > d){
+            d = tmp;
+        }
+    }
+    return d;
+}
+
+HERMES_NO_FP_CONTRACT
+inline double OneToManyKernel::CanberraScalar(const double * q, const double * x, size_t dim){
+    double d = 0;
+    double den;
+    for (size_t i = 0; i < dim; i++){
+        den = sqrt(q[i] * q[i]) + sqrt(x[i] * x[i]);
+        if (den == 0.0){
+            den = 1.0;
+        }
+        d = d + (sqrt((q[i] - x[i]) * (q[i] - x[i])) / den);
+    }
+    return d;
+}
+
+HERMES_NO_FP_CONTRACT
+inline double OneToManyKernel::BrayCurtisScalar(const double * q, const double * x, size_t dim){
+    double d = 0;
+    double den;
+    for (size_t i = 0; i < dim; i++){
+        den = q[i] + x[i];
+        if (!(den == 0.0)){
+            d = d + (fabs(q[i] - x[i]) / den);
+        }
+    }
+    return d;
+}
+
+#ifdef HERMES_X86_SIMD
+/**
+* AVX2 implementations. Each one computes the distances of the first objects,
+* 4 at a time, and returns how many were computed. The terms are those of the
+* scalar loops and are added in index order in each lane.
+*/
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline size_t OneToManyKernel::EuclideanAVX2(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    size_t i, j;
+    __m256d v[4];
+    __m256d d, tmp;
+    for (j = 0; j + 4 <= n; j += 4){
+        d = _mm256_setzero_pd();
+        for (i = 0; i + 4 <= dim; i += 4){
+            OneToManyLoad4x4(x + j, i, v);
+            for (int k = 0; k < 4; k++){
+                tmp = _mm256_sub_pd(_mm256_set1_pd(q[i + k]), v[k]);
+                d = _mm256_add_pd(d, _mm256_mul_pd(tmp, tmp));
+            }
+        }
+        for (; i < dim; i++){
+            OneToManyLoad4x1(x + j, i, v);
+            tmp = _mm256_sub_pd(_mm256_set1_pd(q[i]), v[0]);
+            d = _mm256_add_pd(d, _mm256_mul_pd(tmp, tmp));
+        }
+        _mm256_storeu_pd(out + j, _mm256_sqrt_pd(d));
+    }
+    return j;
+}
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline size_t OneToManyKernel::WeightedEuclideanAVX2(const double * q, const double * const * x,
+        const double * w, size_t n, size_t dim, double * out){
+    size_t i, j;
+    __m256d v[4];
+    __m256d d, tmp;
+    for (j = 0; j + 4 <= n; j += 4){
+        d = _mm256_setzero_pd();
+        for (i = 0; i + 4 <= dim; i += 4){
+            OneToManyLoad4x4(x + j, i, v);
+            for (int k = 0; k < 4; k++){
+                tmp = _mm256_sub_pd(_mm256_set1_pd(q[i + k]), v[k]);
+                d = _mm256_add_pd(d, _mm256_mul_pd(_mm256_mul_pd(tmp, tmp),
+                                                   _mm256_set1_pd(w[i + k])));
+            }
+        }
+        for (; i < dim; i++){
+            OneToManyLoad4x1(x + j, i, v);
+            tmp = _mm256_sub_pd(_mm256_set1_pd(q[i]), v[0]);
+            d = _mm256_add_pd(d, _mm256_mul_pd(_mm256_mul_pd(tmp, tmp),
+                                               _mm256_set1_pd(w[i])));
+        }
+        _mm256_storeu_pd(out + j, _mm256_sqrt_pd(d));
+    }
+    return j;
+}
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline size_t OneToManyKernel::ManhattanAVX2(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    size_t i, j;
+    __m256d v[4];
+    __m256d d;
+    for (j = 0; j + 4 <= n; j += 4){
+        d = _mm256_setzero_pd();
+        for (i = 0; i + 4 <= dim; i += 4){
+            OneToManyLoad4x4(x + j, i, v);
+            for (int k = 0; k < 4; k++){
+                d = _mm256_add_pd(d, _mm256_andnot_pd(sign,
+                        _mm256_sub_pd(_mm256_set1_pd(q[i + k]), v[k])));
+            }
+        }
+        for (; i < dim; i++){
+            OneToManyLoad4x1(x + j, i, v);
+            d = _mm256_add_pd(d, _mm256_andnot_pd(sign,
+                    _mm256_sub_pd(_mm256_set1_pd(q[i]), v[0])));
+        }
+        _mm256_storeu_pd(out + j, d);
+    }
+    return j;
+}
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline size_t OneToManyKernel::ChebyshevAVX2(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    size_t i, j;
+    __m256d v[4];
+    __m256d d;
+    // max(tmp, d) is (tmp > d) ? tmp : d, as the scalar loop.
+    for (j = 0; j + 4 <= n; j += 4){
+        d = _mm256_setzero_pd();
+        for (i = 0; i + 4 <= dim; i += 4){
+            OneToManyLoad4x4(x + j, i, v);
+            for (int k = 0; k < 4; k++){
+                d = _mm256_max_pd(_mm256_andnot_pd(sign,
+                        _mm256_sub_pd(_mm256_set1_pd(q[i + k]), v[k])), d);
+            }
+        }
+        for (; i < dim; i++){
+            OneToManyLoad4x1(x + j, i, v);
+            d = _mm256_max_pd(_mm256_andnot_pd(sign,
+                    _mm256_sub_pd(_mm256_set1_pd(q[i]), v[0])), d);
+        }
+        _mm256_storeu_pd(out + j, d);
+    }
+    return j;
+}
+
+/**
+* Term of the Canberra distance: |a - b| / (|a| + |b|), with 1 for a 0
+* denominator. The absolute values are sqrt(x * x), as in the scalar loop.
+*/
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+static inline __m256d OneToManyCanberraTerm(__m256d a, __m256d b){
+    __m256d den = _mm256_add_pd(_mm256_sqrt_pd(_mm256_mul_pd(a, a)),
+                                _mm256_sqrt_pd(_mm256_mul_pd(b, b)));
+    __m256d tmp = _mm256_sub_pd(a, b);
+    den = _mm256_blendv_pd(den, _mm256_set1_pd(1.0),
+                           _mm256_cmp_pd(den, _mm256_setzero_pd(), _CMP_EQ_OQ));
+    return _mm256_div_pd(_mm256_sqrt_pd(_mm256_mul_pd(tmp, tmp)), den);
+}
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline size_t OneToManyKernel::CanberraAVX2(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    size_t i, j;
+    __m256d v[4];
+    __m256d d;
+    for (j = 0; j + 4 <= n; j += 4){
+        d = _mm256_setzero_pd();
+        for (i = 0; i + 4 <= dim; i += 4){
+            OneToManyLoad4x4(x + j, i, v);
+            for (int k = 0; k < 4; k++){
+                d = _mm256_add_pd(d, OneToManyCanberraTerm(_mm256_set1_pd(q[i + k]), v[k]));
+            }
+        }
+        for (; i < dim; i++){
+            OneToManyLoad4x1(x + j, i, v);
+            d = _mm256_add_pd(d, OneToManyCanberraTerm(_mm256_set1_pd(q[i]), v[0]));
+        }
+        _mm256_storeu_pd(out + j, d);
+    }
+    return j;
+}
+
+/**
+* Term of the Bray-Curtis distance: |a - b| / (a + b), or +0 for a 0
+* denominator. Adding +0 leaves the sum unchanged, since it is never -0, so
+* it is the same as skipping the term.
+*/
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+static inline __m256d OneToManyBrayCurtisTerm(__m256d a, __m256d b){
+    __m256d den = _mm256_add_pd(a, b);
+    __m256d tmp = _mm256_div_pd(_mm256_andnot_pd(_mm256_set1_pd(-0.0),
+                                                 _mm256_sub_pd(a, b)), den);
+    return _mm256_and_pd(tmp, _mm256_cmp_pd(den, _mm256_setzero_pd(), _CMP_NEQ_UQ));
+}
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline size_t OneToManyKernel::BrayCurtisAVX2(const double * q, const double * const * x,
+        size_t n, size_t dim, double * out){
+    size_t i, j;
+    __m256d v[4];
+    __m256d d;
+    for (j = 0; j + 4 <= n; j += 4){
+        d = _mm256_setzero_pd();
+        for (i = 0; i + 4 <= dim; i += 4){
+            OneToManyLoad4x4(x + j, i, v);
+            for (int k = 0; k < 4; k++){
+                d = _mm256_add_pd(d, OneToManyBrayCurtisTerm(_mm256_set1_pd(q[i + k]), v[k]));
+            }
+        }
+        for (; i < dim; i++){
+            OneToManyLoad4x1(x + j, i, v);
+            d = _mm256_add_pd(d, OneToManyBrayCurtisTerm(_mm256_set1_pd(q[i]), v[0]));
+        }
+        _mm256_storeu_pd(out + j, d);
+    }
+    return j;
+}
+#endif
+
+/**
+* Constructor.
+*/
+template <class ObjectType>
+FeatureSpans<ObjectType>::FeatureSpans(){
+    query = NULL;
+    dimension = 0;
+}
+
+/**
+* Collects the spans of a query and of many objects.
+*
+* @param query The query.
+* @param objects The objects.
+* @param n Number of objects.
+* @throw std::length_error If an object and the query do not have the same
+* size.
+* @return False if ObjectType does not expose its features as a span. No span
+* is collected then.
+*/
+template <class ObjectType>
+bool FeatureSpans<ObjectType>::Set(ObjectType & query, ObjectType ** objects,
+        size_t n) throw (std::length_error){
+
+    if (!GetSpan(query, this->query, 0)){
+        return false;
+    }
+    dimension = query.size();
+    this->objects.resize(n);
+    for (size_t j = 0; j < n; j++){
+        if (objects[j]->size() != dimension){
+            throw std::length_error("The feature vectors do not have the same size.");
+        }
+        GetSpan(*objects[j], this->objects[j], 0);
+    }
+    return true;
+}
+
+/**
+* Gets the span of an object that has a data() method.
+*/
+template <class ObjectType>
+template <class T>
+typename std::enable_if<std::is_convertible<
+        decltype(std::declval<T &>().data()), const double *>::value, bool>::type
+        FeatureSpans<ObjectType>::GetSpan(T & obj, const double *& span, int){
+    span = obj.data();
+    return true;
+}
+
+/**
+* Fails for an object with no data() method.
+*/
+template <class ObjectType>
+template <class T>
+bool FeatureSpans<ObjectType>::GetSpan(T & obj, const double *& span, long){
+    return false;
+}
@@ -0,0 +1,177 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the one-to-many kernels used by the getDistances() of the
+* distance functions.
+*
+* @version 1.0
+* @date 10-17-2026
+*/
+#ifndef ONETOMANYKERNEL_H
+#define ONETOMANYKERNEL_H
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #ifndef HERMES_X86_SIMD
+        #define HERMES_X86_SIMD
+    #endif
+    #include <immintrin.h>
+#endif
+
+/**
+* Compiles a function without contracting a multiplication and an addition
+* into an FMA, even under -march=native. The scalar loops that must round
+* like the vector paths use it.
+*/
+#ifndef HERMES_NO_FP_CONTRACT
+    #if defined(__GNUC__) && !defined(__clang__)
+        #define HERMES_NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+    #else
+        #define HERMES_NO_FP_CONTRACT
+    #endif
+#endif
+
+/**
+* Evaluates the distances between one query and many objects, all given as
+* contiguous double spans of the same dimension.
+*
+* <p>The AVX2 implementations compute 4 objects at once, one per lane, going
+* through the dimensions in index order. Each lane then adds the same terms
+* in the same order as the scalar loop of the distance function, so every
+* implementation returns exactly the same bits as getDistance(). Neither the
+* scalar loops nor the AVX2 paths fuse their products into FMAs. The
+* implementation is chosen once at run time according to the CPU.
+*
+* @brief One-to-many distance kernels.
+* @version 1.0.
+*/
+class OneToManyKernel{
+    public:
+        static void Euclidean(const double * q, const double * const * x,
+                              size_t n, size_t dim, double * out);
+        static void WeightedEuclidean(const double * q, const double * const * x,
+                                      const double * w, size_t n, size_t dim,
+                                      double * out);
+        static void Manhattan(const double * q, const double * const * x,
+                              size_t n, size_t dim, double * out);
+        static void Chebyshev(const double * q, const double * const * x,
+                              size_t n, size_t dim, double * out);
+        static void Canberra(const double * q, const double * const * x,
+                             size_t n, size_t dim, double * out);
+        static void BrayCurtis(const double * q, const double * const * x,
+                               size_t n, size_t dim, double * out);
+
+        static const char * GetImplementationName();
+
+    private:
+        friend class EarlyAbandonKernel;
+
+        static bool UseAVX2();
+
+        static double EuclideanScalar(const double * q, const double * x, size_t dim);
+        static double WeightedEuclideanScalar(const double * q, const double * x,
+                                              const double * w, size_t dim);
+        static double ManhattanScalar(const double * q, const double * x, size_t dim);
+        static double ChebyshevScalar(const double * q, const double * x, size_t dim);
+        static double CanberraScalar(const double * q, const double * x, size_t dim);
+        static double BrayCurtisScalar(const double * q, const double * x, size_t dim);
+
+        #ifdef HERMES_X86_SIMD
+        static size_t EuclideanAVX2(const double * q, const double * const * x,
+                                    size_t n, size_t dim, double * out);
+        static size_t WeightedEuclideanAVX2(const double * q, const double * const * x,
+                                            const double * w, size_t n, size_t dim,
+                                            double * out);
+        static size_t ManhattanAVX2(const double * q, const double * const * x,
+                                    size_t n, size_t dim, double * out);
+        static size_t ChebyshevAVX2(const double * q, const double * const * x,
+                                    size_t n, size_t dim, double * out);
+        static size_t CanberraAVX2(const double * q, const double * const * x,
+                                   size_t n, size_t dim, double * out);
+        static size_t BrayCurtisAVX2(const double * q, const double * const * x,
+                                     size_t n, size_t dim, double * out);
+        #endif
+};
+
+/**
+* Collects the feature spans of a query and of many objects for
+* OneToManyKernel. The spans are only available if ObjectType has a data()
+* method that returns its features as contiguous doubles, as TFlatImage does.
+*
+* @brief Feature spans of a one-to-many evaluation.
+* @version 1.0.
+*/
+template <class ObjectType>
+class FeatureSpans{
+    public:
+        FeatureSpans();
+
+        bool Set(ObjectType & query, ObjectType ** objects, size_t n) throw (std::length_error);
+
+        /**
+        * Returns the span of the query.
+        */
+        const double * GetQuery() const{
+            return query;
+        }
+
+        /**
+        * Returns the spans of the objects.
+        */
+        const double * const * GetObjects() const{
+            return objects.data();
+        }
+
+        /**
+        * Returns the dimension of the spans.
+        */
+        size_t GetDimension() const{
+            return dimension;
+        }
+
+    private:
+        /**
+        * The span of the query.
+        */
+        const double * query;
+
+        /**
+        * The spans of the objects.
+        */
+        std::vector <const double *> objects;
+
+        /**
+        * The dimension of the spans.
+        */
+        size_t dimension;
+
+        template <class T>
+        static typename std::enable_if<std::is_convertible<
+                decltype(std::declval<T &>().data()), const double *>::value, bool>::type
+                GetSpan(T & obj, const double *& span, int);
+
+        template <class T>
+        static bool GetSpan(T & obj, const double *& span, long);
+};
+
+#include "OneToManyKernel-inl.h"
+#endif // ONETOMANYKERNEL_H
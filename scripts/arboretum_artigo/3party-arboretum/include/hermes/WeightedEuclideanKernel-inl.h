@@ -0,0 +1,203 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/**
+* Constructor. The kernel starts with no weights.
+*/
+inline WeightedEuclideanKernel::WeightedEuclideanKernel(){
+
+    weights = NULL;
+    size = 0;
+    distance2 = SelectImplementation();
+}
+
+/**
+* Copy constructor. The weight buffer is duplicated.
+*/
+inline WeightedEuclideanKernel::WeightedEuclideanKernel(const WeightedEuclideanKernel & kernel){
+
+    weights = NULL;
+    size = 0;
+    distance2 = kernel.distance2;
+    SetWeights(kernel.weights, kernel.size);
+}
+
+/**
+* Destructor.
+*/
+inline WeightedEuclideanKernel::~WeightedEuclideanKernel(){
+
+    free(weights);
+}
+
+/**
+* Assignment. The weight buffer is duplicated.
+*/
+inline WeightedEuclideanKernel & WeightedEuclideanKernel::operator = (const WeightedEuclideanKernel & kernel){
+
+    if (this != &kernel){
+        distance2 = kernel.distance2;
+        SetWeights(kernel.weights, kernel.size);
+    }
+    return *this;
+}
+
+/**
+* Replaces the weights. The values are copied into the aligned buffer, which is
+* only reallocated when the number of weights changes.
+*
+* @param weights The new weights (may be NULL if n is 0).
+* @param n Number of weights.
+*/
+inline void WeightedEuclideanKernel::SetWeights(const double * weights, size_t n){
+
+    if (n != this->size){
+        free(this->weights);
+        this->weights = (n > 0) ? AllocateAligned(n) : NULL;
+        this->size = n;
+    }
+    if (n > 0){
+        memcpy(this->weights, weights, sizeof(double) * n);
+    }
+}
+
+/**
+* Returns the name of the implementation selected for this CPU.
+*/
+inline const char * WeightedEuclideanKernel::GetImplementationName(){
+
+    #ifdef HERMES_X86_SIMD
+    tDistance2 impl = SelectImplementation();
+    if (impl == Distance2AVX512){
+        return "avx512";
+    }
+    if (impl == Distance2AVX2){
+        return "avx2";
+    }
+    #endif
+    return "scalar";
+}
+
+/**
+* Allocates a 64-byte aligned buffer of n doubles.
+*/
+inline double * WeightedEuclideanKernel::AllocateAligned(size_t n){
+
+    void * buffer = NULL;
+    if (posix_memalign(&buffer, 64, sizeof(double) * n) != 0){
+        throw std::bad_alloc();
+    }
+    return (double *) buffer;
+}
+
+/**
+* Chooses the best implementation supported by the running CPU. The choice is
+* made only once per process.
+*/
+inline WeightedEuclideanKernel::tDistance2 WeightedEuclideanKernel::SelectImplementation(){
+
+    #ifdef HERMES_X86_SIMD
+    static const tDistance2 impl = [](){
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")){
+            return (tDistance2) Distance2AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")){
+            return (tDistance2) Distance2AVX2;
+        }
+        return (tDistance2) Distance2Scalar;
+    }();
+    return impl;
+    #else
+    return Distance2Scalar;
+    #endif
+}
+
+/**
+* Portable implementation. This is the reference loop: all other
+* implementations must return the same bits.
+*/
+HERMES_NO_FP_CONTRACT
+inline double WeightedEuclideanKernel::Distance2Scalar(const double * a,
+        const double * b, const double * w, size_t n){
+
+    double d = 0;
+    double tmp;
+
+    for (size_t i = 0; i < n; i++){
+        tmp = a[i] - b[i];
+        d = d + ((tmp * tmp) * w[i]);
+    }
+    return d;
+}
+
+#ifdef HERMES_X86_SIMD
+/**
+* AVX2 implementation. The terms of 4 dimensions are computed at once and then
+* added to the sum in index order.
+*/
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline double WeightedEuclideanKernel::Distance2AVX2(const double * a,
+        const double * b, const double * w, size_t n){
+
+    double d = 0;
+    double tmp;
+    size_t i = 0;
+    alignas(32) double term[4];
+
+    for (; i + 4 <= n; i += 4){
+        __m256d diff = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        _mm256_store_pd(term, _mm256_mul_pd(_mm256_mul_pd(diff, diff),
+                                            _mm256_loadu_pd(w + i)));
+        d = d + term[0];
+        d = d + term[1];
+        d = d + term[2];
+        d = d + term[3];
+    }
+    for (; i < n; i++){
+        tmp = a[i] - b[i];
+        d = d + ((tmp * tmp) * w[i]);
+    }
+    return d;
+}
+
+/**
+* AVX-512 implementation. The terms of 8 dimensions are computed at once and
+* then added to the sum in index order.
+*/
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+inline double WeightedEuclideanKernel::Distance2AVX512(const double * a,
+        const double * b, const double * w, size_t n){
+
+    double d = 0;
+    double tmp;
+    size_t i = 0;
+    alignas(64) double term[8];
+
+    for (; i + 8 <= n; i += 8){
+        __m512d diff = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+        _mm512_store_pd(term, _mm512_mul_pd(_mm512_mul_pd(diff, diff),
+                                            _mm512_loadu_pd(w + i)));
+        for (int j = 0; j < 8; j++){
+            d = d + term[j];
+        }
+    }
+    for (; i < n; i++){
+        tmp = a[i] - b[i];
+        d = d + ((tmp * tmp) * w[i]);
+    }
+    return d;
+}
+#endif
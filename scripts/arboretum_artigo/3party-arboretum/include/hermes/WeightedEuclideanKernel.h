@@ -0,0 +1,138 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the weighted L2 kernel used by EuclideanDistanceWeighted.
+*
+* @version 1.0
+* @date 10-17-2026
+*/
+
+#ifndef WEIGHTEDEUCLIDEANKERNEL_H
+#define WEIGHTEDEUCLIDEANKERNEL_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #ifndef HERMES_X86_SIMD
+        #define HERMES_X86_SIMD
+    #endif
+    #include <immintrin.h>
+#endif
+
+/**
+* Compiles a function without contracting a multiplication and an addition
+* into an FMA, even under -march=native.
+*/
+#ifndef HERMES_NO_FP_CONTRACT
+    #if defined(__GNUC__) && !defined(__clang__)
+        #define HERMES_NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+    #else
+        #define HERMES_NO_FP_CONTRACT
+    #endif
+#endif
+
+/**
+* Evaluates sum(((a[i] - b[i])^2) * w[i]) over contiguous double spans.
+*
+* <p>The weights are kept in a 64-byte aligned buffer owned by the kernel.
+* The implementation (AVX-512, AVX2 or scalar) is chosen once at run time
+* according to the CPU. The vector paths compute the per-dimension terms in
+* SIMD registers but fold them in index order, and no path fuses its
+* products into FMAs, so every path returns exactly the same bits as the plain
+* scalar loop.
+*
+* @brief Weighted squared L2 kernel.
+* @version 1.0.
+*/
+class WeightedEuclideanKernel{
+
+    public:
+        /**
+        * Signature of the squared distance implementations.
+        */
+        typedef double (*tDistance2)(const double * a, const double * b,
+                                     const double * w, size_t n);
+
+        WeightedEuclideanKernel();
+        WeightedEuclideanKernel(const WeightedEuclideanKernel & kernel);
+        ~WeightedEuclideanKernel();
+
+        WeightedEuclideanKernel & operator = (const WeightedEuclideanKernel & kernel);
+
+        void SetWeights(const double * weights, size_t n);
+
+        /**
+        * Returns the aligned weight buffer or NULL if no weight was set.
+        */
+        const double * GetWeights() const{
+            return weights;
+        }
+
+        /**
+        * Returns the number of weights.
+        */
+        size_t GetSize() const{
+            return size;
+        }
+
+        /**
+        * Returns sum(((a[i] - b[i])^2) * w[i]) for i in [0, n).
+        *
+        * @param a The first feature span.
+        * @param b The second feature span.
+        * @param n Number of dimensions. It must not exceed GetSize().
+        */
+        double Distance2(const double * a, const double * b, size_t n) const{
+            return distance2(a, b, weights, n);
+        }
+
+        static const char * GetImplementationName();
+
+    private:
+        /**
+        * Aligned copy of the weights.
+        */
+        double * weights;
+
+        /**
+        * Number of weights.
+        */
+        size_t size;
+
+        /**
+        * Implementation selected for this CPU.
+        */
+        tDistance2 distance2;
+
+        static double * AllocateAligned(size_t n);
+        static tDistance2 SelectImplementation();
+
+        static double Distance2Scalar(const double * a, const double * b,
+                                      const double * w, size_t n);
+        #ifdef HERMES_X86_SIMD
+        static double Distance2AVX2(const double * a, const double * b,
+                                    const double * w, size_t n);
+        static double Distance2AVX512(const double * a, const double * b,
+                                      const double * w, size_t n);
+        #endif
+};
+
+#include "WeightedEuclideanKernel-inl.h"
+#endif // WEIGHTEDEUCLIDEANKERNEL_H
@@ -0,0 +1,337 @@
+#ifndef CSVFEATURELOADER_H
+#define CSVFEATURELOADER_H
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+* Loads CSV files of features (one object per line, the features first and
+* the name in the last column) without building a string per cell.
+*
+* <P>The file is memory mapped and split in line aligned chunks, one per
+* thread. The cells are parsed in place with strtod(), so the values are
+* the same of std::stod(). Empty lines are skipped and every other line must
+* have the same number of columns as the first one.
+*/
+class CSVFeatureLoader{
+
+    public:
+        /**
+        * The rows of a file. Features holds Rows x Columns values, row by
+        * row, so GetFeatures(i) can be given to TFlatImage as is.
+        */
+        struct FeatureSet{
+            size_t Rows;
+            size_t Columns;
+            vector<double> Features;
+            vector<size_t> NameOffsets;
+            string Names;
+
+            FeatureSet(){
+                Rows = 0;
+                Columns = 0;
+            }
+
+            const double * GetFeatures(size_t row) const{
+                return Features.data() + row * Columns;
+            }
+
+            string GetName(size_t row) const{
+                return Names.substr(NameOffsets[row], NameOffsets[row + 1] - NameOffsets[row]);
+            }
+        };
+
+        /**
+        * Called for each row with the row number (the order in the file),
+        * its features and its name (not null terminated). It is called by
+        * many threads at once, so it must be thread safe. The pointers are
+        * only valid during the call.
+        */
+        typedef function<void (size_t row, const double * features,
+            size_t columns, const char * name, size_t nameLength)> RowCallback;
+
+        /**
+        * @param nThreads The number of threads. If 0, the number of cores
+        * is used.
+        */
+        CSVFeatureLoader(unsigned int nThreads = 0){
+            this->nThreads = nThreads;
+            if (this->nThreads == 0){
+                this->nThreads = thread::hardware_concurrency();
+            }
+            if (this->nThreads == 0){
+                this->nThreads = 1;
+            }
+        }
+
+        /**
+        * Loads the whole file into a FeatureSet.
+        *
+        * @exception std::logic_error If the file can not be read or a line
+        * is malformed.
+        */
+        void Load(const string & path, FeatureSet & out){
+            vector<string> names;
+            vector<size_t> firstRow;
+
+            Parse(path, [&out](size_t rows, size_t columns){
+                    out.Rows = rows;
+                    out.Columns = columns;
+                    out.Features.resize(rows * columns);
+                    out.NameOffsets.resize(rows + 1);
+                }, [&out](size_t, size_t row, const double * features,
+                    size_t columns, const char * name, size_t nameLength, string & names){
+                    memcpy(out.Features.data() + row * columns, features, columns * sizeof(double));
+                    // Offset in the names of the chunk. Fixed below.
+                    out.NameOffsets[row] = names.size();
+                    names.append(name, nameLength);
+                }, names, firstRow);
+
+            // Join the names of the chunks.
+            out.Names.clear();
+            for (size_t c = 0; c < names.size(); c++){
+                size_t base = out.Names.size();
+                for (size_t i = firstRow[c]; i < firstRow[c + 1]; i++){
+                    out.NameOffsets[i] += base;
+                }
+                out.Names.append(names[c]);
+            }
+            out.NameOffsets[out.Rows] = out.Names.size();
+        }
+
+        /**
+        * Calls callback for each row of the file.
+        *
+        * @exception std::logic_error If the file can not be read or a line
+        * is malformed.
+        */
+        void ForEach(const string & path, const RowCallback & callback){
+            vector<string> names;
+            vector<size_t> firstRow;
+
+            Parse(path, [](size_t, size_t){ },
+                [&callback](size_t, size_t row, const double * features,
+                    size_t columns, const char * name, size_t nameLength, string &){
+                    callback(row, features, columns, name, nameLength);
+                }, names, firstRow);
+        }
+
+    private:
+        unsigned int nThreads;
+
+        typedef function<void (size_t rows, size_t columns)> StartCallback;
+        typedef function<void (size_t chunk, size_t row, const double * features,
+            size_t columns, const char * name, size_t nameLength, string & names)> ChunkCallback;
+
+        /**
+        * Maps the file, counts the rows of each chunk and then parses the
+        * chunks. start is called once, before the rows. names receives the
+        * names buffer of each chunk and firstRow the number of the first row
+        * of each chunk (and the number of rows at the end).
+        */
+        void Parse(const string & path, const StartCallback & start,
+                const ChunkCallback & row, vector<string> & names,
+                vector<size_t> & firstRow){
+            struct stat st;
+            const char * data;
+            size_t size;
+            int fd;
+
+            fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0){
+                throw logic_error("Could not open the file " + path);
+            }
+            if (fstat(fd, &st) != 0){
+                close(fd);
+                throw logic_error("Could not read the file " + path);
+            }
+            size = st.st_size;
+            if (size == 0){
+                close(fd);
+                names.clear();
+                firstRow.assign(1, 0);
+                start(0, 0);
+                return;
+            }
+            data = (const char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (data == (const char *) MAP_FAILED){
+                throw logic_error("Could not map the file " + path);
+            }
+            madvise((void *) data, size, MADV_SEQUENTIAL);
+
+            try{
+                ParseMapped(data, data + size, start, row, names, firstRow);
+            }catch (...){
+                munmap((void *) data, size);
+                throw;
+            }
+            munmap((void *) data, size);
+        }
+
+        void ParseMapped(const char * begin, const char * end,
+                const StartCallback & start, const ChunkCallback & row,
+                vector<string> & names, vector<size_t> & firstRow){
+            size_t columns = CountColumns(begin, end);
+            vector<const char *> bounds;
+            vector<exception_ptr> errors;
+            vector<thread> threads;
+
+            // Line aligned chunks.
+            size_t chunkSize = (end - begin) / nThreads + 1;
+            bounds.push_back(begin);
+            for (unsigned int i = 1; i < nThreads; i++){
+                const char * p = bounds.back() + chunkSize;
+                if (p >= end){
+                    break;
+                }
+                p = (const char *) memchr(p, '\n', end - p);
+                if (p == NULL){
+                    break;
+                }
+                bounds.push_back(p + 1);
+            }
+            bounds.push_back(end);
+            size_t nChunks = bounds.size() - 1;
+
+            // Rows of each chunk, so every row knows its number.
+            firstRow.assign(nChunks + 1, 0);
+            errors.assign(nChunks, nullptr);
+            names.assign(nChunks, string());
+            vector<size_t> counts(nChunks, 0);
+            for (size_t c = 0; c < nChunks; c++){
+                threads.push_back(thread([&, c](){
+                    counts[c] = CountRows(bounds[c], bounds[c + 1]);
+                }));
+            }
+            for (size_t c = 0; c < nChunks; c++){
+                threads[c].join();
+                firstRow[c + 1] = firstRow[c] + counts[c];
+            }
+            threads.clear();
+            start(firstRow[nChunks], columns);
+
+            for (size_t c = 0; c < nChunks; c++){
+                threads.push_back(thread([&, c](){
+                    try{
+                        ParseChunk(c, bounds[c], bounds[c + 1], firstRow[c],
+                            columns, row, names[c]);
+                    }catch (...){
+                        errors[c] = current_exception();
+                    }
+                }));
+            }
+            for (size_t c = 0; c < nChunks; c++){
+                threads[c].join();
+            }
+            for (size_t c = 0; c < nChunks; c++){
+                if (errors[c]){
+                    rethrow_exception(errors[c]);
+                }
+            }
+        }
+
+        static const char * LineEnd(const char * p, const char * end){
+            const char * e = (const char *) memchr(p, '\n', end - p);
+            return (e == NULL) ? end : e;
+        }
+
+        static bool IsBlank(const char * p, const char * e){
+            return (p == e) || ((e - p == 1) && (*p == '\r'));
+        }
+
+        static size_t CountRows(const char * p, const char * end){
+            size_t rows = 0;
+
+            while (p < end){
+                const char * e = LineEnd(p, end);
+                if (!IsBlank(p, e)){
+                    rows++;
+                }
+                p = e + 1;
+            }
+            return rows;
+        }
+
+        /**
+        * Number of features of the first line.
+        */
+        static size_t CountColumns(const char * p, const char * end){
+            size_t columns = 0;
+
+            while (p < end){
+                const char * e = LineEnd(p, end);
+                if (!IsBlank(p, e)){
+                    for (const char * q = p; q < e; q++){
+                        if (*q == ','){
+                            columns++;
+                        }
+                    }
+                    if (columns == 0){
+                        throw logic_error("The CSV file has no feature columns.");
+                    }
+                    return columns;
+                }
+                p = e + 1;
+            }
+            return 0;
+        }
+
+        static void ParseChunk(size_t chunk, const char * p, const char * end,
+                size_t row, size_t columns, const ChunkCallback & callback,
+                string & names){
+            vector<double> features(columns);
+
+            while (p < end){
+                const char * e = LineEnd(p, end);
+                if (IsBlank(p, e)){
+                    p = e + 1;
+                    continue;
+                }
+
+                const char * q = p;
+                for (size_t j = 0; j < columns; j++){
+                    // The cell ends at a comma, which also stops strtod().
+                    const char * comma = (const char *) memchr(q, ',', e - q);
+                    char * last;
+                    if (comma == NULL){
+                        throw logic_error("Missing columns in CSV row " + to_string(row + 1));
+                    }
+                    features[j] = strtod(q, &last);
+                    while ((last < comma) && ((*last == ' ') || (*last == '\t'))){
+                        last++;
+                    }
+                    if ((last == q) || (last != comma)){
+                        throw logic_error("Invalid number in CSV row " + to_string(row + 1));
+                    }
+                    q = comma + 1;
+                }
+
+                // The name is the rest of the line.
+                const char * nameEnd = e;
+                if ((nameEnd > q) && (nameEnd[-1] == '\r')){
+                    nameEnd--;
+                }
+                if (memchr(q, ',', nameEnd - q) != NULL){
+                    throw logic_error("Extra columns in CSV row " + to_string(row + 1));
+                }
+                callback(chunk, row, features.data(), columns, q, nameEnd - q, names);
+                row++;
+                p = e + 1;
+            }
+        }
+};
+#endif
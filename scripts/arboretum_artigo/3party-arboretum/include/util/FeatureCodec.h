@@ -0,0 +1,221 @@
+#ifndef FEATURECODEC_H
+#define FEATURECODEC_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+/**
+* Compact encoding of feature vectors. A vector of Dimension doubles is
+* stored as Dimension float32 values or as Dimension uint8 codes of a scalar
+* quantizer fitted to each dimension:
+* <CODE>
+* decoded[j] = Offset[j] + code[j] * Scale[j]
+* </CODE>
+*
+* <P>The codec records the largest error |x[j] - decoded[j]| of each dimension
+* over every vector it has encoded. For any vector q and weights w, the
+* weighted Euclidean distance between q and a decoded vector is then within
+* GetErrorBound(w) of the distance between q and the original vector, which
+* is what a search over decoded vectors needs to stay exact.
+*/
+class FeatureCodec{
+
+    public:
+        enum Encoding{
+            FLOAT64 = 0,
+            FLOAT32 = 1,
+            INT8 = 2
+        };
+
+        FeatureCodec(){
+            Type = FLOAT64;
+            Dimension = 0;
+        }
+
+        /**
+        * Fits the codec to a set of vectors. For INT8, the codes of each
+        * dimension span its range in the set; values outside it are clamped
+        * when encoded (and the error recorded accordingly).
+        *
+        * @param type The encoding.
+        * @param rows The vectors.
+        * @param n Number of vectors.
+        * @param dim Number of features of each vector.
+        */
+        void Train(Encoding type, const double * const * rows, size_t n, size_t dim){
+            Type = type;
+            Dimension = dim;
+            Offset.assign(dim, 0);
+            Scale.assign(dim, 0);
+            MaxError.assign(dim, 0);
+            if ((type != INT8) || (n == 0)){
+                return;
+            }
+            vector<double> upper(rows[0], rows[0] + dim);
+            memcpy(Offset.data(), rows[0], dim * sizeof(double));
+            for (size_t i = 1; i < n; i++){
+                for (size_t j = 0; j < dim; j++){
+                    Offset[j] = std::min(Offset[j], rows[i][j]);
+                    upper[j] = std::max(upper[j], rows[i][j]);
+                }
+            }
+            for (size_t j = 0; j < dim; j++){
+                Scale[j] = (upper[j] - Offset[j]) / 255;
+            }
+        }
+
+        Encoding GetType() const{
+            return Type;
+        }
+
+        size_t GetDimension() const{
+            return Dimension;
+        }
+
+        /**
+        * Returns the size in bytes of an encoded vector.
+        */
+        size_t GetCodeSize() const{
+            return Dimension * GetElementSize(Type);
+        }
+
+        /**
+        * Returns the size in bytes of each encoded feature.
+        */
+        static size_t GetElementSize(Encoding type){
+            return (type == INT8) ? 1 : ((type == FLOAT32) ? sizeof(float) : sizeof(double));
+        }
+
+        /**
+        * Encodes a vector of GetDimension() features into GetCodeSize() bytes
+        * and records its error.
+        */
+        void Encode(const double * in, uint8_t * out){
+            double decoded;
+
+            for (size_t j = 0; j < Dimension; j++){
+                if (Type == INT8){
+                    double code = (Scale[j] > 0) ? std::round((in[j] - Offset[j]) / Scale[j]) : 0;
+                    out[j] = (uint8_t) std::min(std::max(code, 0.0), 255.0);
+                    decoded = Offset[j] + out[j] * Scale[j];
+                }else if (Type == FLOAT32){
+                    float value = (float) in[j];
+                    memcpy(out + j * sizeof(float), &value, sizeof(float));
+                    decoded = value;
+                }else{
+                    memcpy(out + j * sizeof(double), in + j, sizeof(double));
+                    decoded = in[j];
+                }
+                MaxError[j] = std::max(MaxError[j], std::fabs(in[j] - decoded));
+            }
+        }
+
+        /**
+        * Decodes GetCodeSize() bytes into GetDimension() features.
+        */
+        void Decode(const uint8_t * in, double * out) const{
+            if (Type == INT8){
+                for (size_t j = 0; j < Dimension; j++){
+                    out[j] = Offset[j] + in[j] * Scale[j];
+                }
+            }else if (Type == FLOAT32){
+                for (size_t j = 0; j < Dimension; j++){
+                    float value;
+                    memcpy(&value, in + j * sizeof(float), sizeof(float));
+                    out[j] = value;
+                }
+            }else{
+                memcpy(out, in, Dimension * sizeof(double));
+            }
+        }
+
+        /**
+        * Returns the largest error of each dimension over the vectors encoded.
+        */
+        const vector<double> & GetMaxError() const{
+            return MaxError;
+        }
+
+        /**
+        * Returns the largest weighted Euclidean distance between an encoded
+        * vector and its decoded version. Missing weights count as 1.
+        *
+        * @param weights The weights of the distance.
+        */
+        double GetErrorBound(const vector<double> & weights) const{
+            double sum = 0;
+
+            for (size_t j = 0; j < Dimension; j++){
+                double w = (j < weights.size()) ? weights[j] : 1;
+                sum += w * MaxError[j] * MaxError[j];
+            }
+            return std::sqrt(sum);
+        }
+
+        /**
+        * Returns the size in bytes of the parameters written by Serialize().
+        */
+        size_t GetSerializedSize() const{
+            return 2 * sizeof(uint32_t) + 3 * Dimension * sizeof(double);
+        }
+
+        /**
+        * Writes the parameters of the codec: the encoding, the dimension and,
+        * for each dimension, the offset, the scale and the largest error.
+        *
+        * @param out GetSerializedSize() bytes.
+        */
+        void Serialize(uint8_t * out) const{
+            uint32_t header[2] = {(uint32_t) Type, (uint32_t) Dimension};
+
+            memcpy(out, header, sizeof(header));
+            out += sizeof(header);
+            memcpy(out, Offset.data(), Dimension * sizeof(double));
+            memcpy(out + Dimension * sizeof(double), Scale.data(), Dimension * sizeof(double));
+            memcpy(out + 2 * Dimension * sizeof(double), MaxError.data(), Dimension * sizeof(double));
+        }
+
+        /**
+        * Reads the parameters written by Serialize(). The codec then decodes
+        * the codes of the codec that wrote them and has the same error bound.
+        *
+        * @param in The parameters.
+        * @param size The size of the parameters in bytes.
+        * @throw std::length_error If the parameters are corrupted.
+        */
+        void Unserialize(const uint8_t * in, size_t size){
+            uint32_t header[2];
+
+            if (size < sizeof(header)){
+                throw std::length_error("The codec parameters are corrupted.");
+            }
+            memcpy(header, in, sizeof(header));
+            if ((header[0] > INT8) ||
+                    (size != 2 * sizeof(uint32_t) + 3 * (size_t) header[1] * sizeof(double))){
+                throw std::length_error("The codec parameters are corrupted.");
+            }
+            Type = (Encoding) header[0];
+            Dimension = header[1];
+            Offset.resize(Dimension);
+            Scale.resize(Dimension);
+            MaxError.resize(Dimension);
+            in += sizeof(header);
+            memcpy(Offset.data(), in, Dimension * sizeof(double));
+            memcpy(Scale.data(), in + Dimension * sizeof(double), Dimension * sizeof(double));
+            memcpy(MaxError.data(), in + 2 * Dimension * sizeof(double), Dimension * sizeof(double));
+        }
+
+    private:
+        Encoding Type;
+        size_t Dimension;
+        vector<double> Offset;
+        vector<double> Scale;
+        vector<double> MaxError;
+};
+
+#endif
@@ -0,0 +1,284 @@
+#ifndef FEATURESETFILE_H
+#define FEATURESETFILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <util/CSVFeatureLoader.h>
+
+using namespace std;
+
+/**
+* Binary file of feature vectors with names. It is read by memory mapping,
+* so opening a file costs nothing but the page faults of the rows used.
+*
+* <P>Layout (little endian, as written by the host):
+* <CODE>
+* +--------+---------+--------------------------+---------------------+-------+<BR>
+* | Header | Padding | Data[Rows][Dimension]    | NameIndex[Rows + 1] | Names |<BR>
+* +--------+---------+--------------------------+---------------------+-------+<BR>
+* </CODE>
+*
+* <P>Data starts at a multiple of 64 bytes and holds float64 or float32
+* values, row by row. NameIndex holds the uint64 offsets of each name in
+* Names (the name of row i ends where the name of row i + 1 starts).
+*/
+class FeatureSetFile{
+
+    public:
+        enum DataType{
+            FLOAT64 = 0,
+            FLOAT32 = 1
+        };
+
+        FeatureSetFile(){
+            Data = NULL;
+            DataSize = 0;
+            Head = NULL;
+        }
+
+        ~FeatureSetFile(){
+            Close();
+        }
+
+        /**
+        * Returns true if the file starts with the magic of this format.
+        */
+        static bool IsFeatureSetFile(const string & path){
+            char magic[4];
+            FILE * f = fopen(path.c_str(), "rb");
+            bool ok;
+
+            if (f == NULL){
+                return false;
+            }
+            ok = (fread(magic, 1, 4, f) == 4) && (memcmp(magic, "FSB1", 4) == 0);
+            fclose(f);
+            return ok;
+        }
+
+        /**
+        * Writes a feature set.
+        *
+        * @exception std::logic_error If the file can not be written.
+        */
+        static void Write(const string & path, const CSVFeatureLoader::FeatureSet & set,
+                DataType type = FLOAT64){
+            tHeader header;
+            size_t elemSize = (type == FLOAT32) ? sizeof(float) : sizeof(double);
+            FILE * f;
+            bool ok;
+
+            memset(&header, 0, sizeof(header));
+            memcpy(header.Magic, "FSB1", 4);
+            header.Type = type;
+            header.Dimension = set.Columns;
+            header.Rows = set.Rows;
+            header.DataOffset = Align(sizeof(tHeader), 64);
+            header.NameIndexOffset = Align(header.DataOffset + header.Rows * header.Dimension * elemSize, 8);
+            header.NamesOffset = header.NameIndexOffset + (header.Rows + 1) * sizeof(uint64_t);
+            header.FileSize = header.NamesOffset + set.Names.size();
+
+            f = fopen(path.c_str(), "wb");
+            if (f == NULL){
+                throw logic_error("Could not create the file " + path);
+            }
+            ok = (fwrite(&header, sizeof(header), 1, f) == 1) &&
+                Pad(f, header.DataOffset - sizeof(header));
+            if (type == FLOAT32){
+                vector<float> row(set.Columns);
+                for (size_t i = 0; ok && (i < set.Rows); i++){
+                    const double * features = set.GetFeatures(i);
+                    for (size_t j = 0; j < set.Columns; j++){
+                        row[j] = (float) features[j];
+                    }
+                    ok = (fwrite(row.data(), sizeof(float), row.size(), f) == row.size());
+                }
+            }else{
+                ok = ok && (fwrite(set.Features.data(), sizeof(double), set.Features.size(), f)
+                    == set.Features.size());
+            }
+            ok = ok && Pad(f, header.NameIndexOffset - (header.DataOffset + header.Rows * header.Dimension * elemSize));
+            for (size_t i = 0; ok && (i <= set.Rows); i++){
+                uint64_t offset = set.NameOffsets.empty() ? 0 : set.NameOffsets[i];
+                ok = (fwrite(&offset, sizeof(offset), 1, f) == 1);
+            }
+            ok = ok && (fwrite(set.Names.data(), 1, set.Names.size(), f) == set.Names.size());
+            ok = (fclose(f) == 0) && ok;
+            if (!ok){
+                throw logic_error("Could not write the file " + path);
+            }
+        }
+
+        /**
+        * Maps a file. The previous one, if any, is closed.
+        *
+        * @exception std::logic_error If the file can not be read or it is not
+        * a valid feature set file.
+        */
+        void Open(const string & path){
+            struct stat st;
+            void * map;
+            int fd;
+
+            Close();
+            fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0){
+                throw logic_error("Could not open the file " + path);
+            }
+            if ((fstat(fd, &st) != 0) || ((size_t) st.st_size < sizeof(tHeader))){
+                close(fd);
+                throw logic_error("Invalid feature set file " + path);
+            }
+            map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (map == MAP_FAILED){
+                throw logic_error("Could not map the file " + path);
+            }
+            Data = (const uint8_t *) map;
+            DataSize = st.st_size;
+            Head = (const tHeader *) Data;
+            if (!IsValid()){
+                Close();
+                throw logic_error("Invalid feature set file " + path);
+            }
+        }
+
+        void Close(){
+            if (Data != NULL){
+                munmap((void *) Data, DataSize);
+            }
+            Data = NULL;
+            DataSize = 0;
+            Head = NULL;
+        }
+
+        /**
+        * Returns true if a file is mapped.
+        */
+        bool IsOpen() const{
+            return Data != NULL;
+        }
+
+        size_t GetRows() const{
+            return (Head == NULL) ? 0 : Head->Rows;
+        }
+
+        size_t GetDimension() const{
+            return (Head == NULL) ? 0 : Head->Dimension;
+        }
+
+        DataType GetType() const{
+            return (DataType) Head->Type;
+        }
+
+        /**
+        * Returns the features of a row inside the mapping, or NULL if the
+        * file holds float32 values.
+        */
+        const double * GetFeatures(size_t row) const{
+            if (Head->Type != FLOAT64){
+                return NULL;
+            }
+            return (const double *)(Data + Head->DataOffset) + row * Head->Dimension;
+        }
+
+        /**
+        * Copies the features of a row as doubles, whatever the type.
+        */
+        void GetFeatures(size_t row, double * out) const{
+            if (Head->Type == FLOAT64){
+                memcpy(out, GetFeatures(row), Head->Dimension * sizeof(double));
+            }else{
+                const float * features = (const float *)(Data + Head->DataOffset) + row * Head->Dimension;
+                for (size_t j = 0; j < Head->Dimension; j++){
+                    out[j] = features[j];
+                }
+            }
+        }
+
+        /**
+        * Returns the name of a row inside the mapping (not null terminated).
+        */
+        const char * GetName(size_t row, size_t & length) const{
+            const uint64_t * index = (const uint64_t *)(Data + Head->NameIndexOffset);
+            length = index[row + 1] - index[row];
+            return (const char *)(Data + Head->NamesOffset + index[row]);
+        }
+
+        string GetName(size_t row) const{
+            size_t length;
+            const char * name = GetName(row, length);
+            return string(name, length);
+        }
+
+    private:
+        #pragma pack(1)
+        struct tHeader{
+            char Magic[4];
+            uint32_t Type;
+            uint64_t Dimension;
+            uint64_t Rows;
+            uint64_t DataOffset;
+            uint64_t NameIndexOffset;
+            uint64_t NamesOffset;
+            uint64_t FileSize;
+        };
+        #pragma pack()
+
+        const uint8_t * Data;
+        size_t DataSize;
+        const tHeader * Head;
+
+        static uint64_t Align(uint64_t offset, uint64_t alignment){
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+
+        static bool Pad(FILE * f, size_t n){
+            static const char zeros[64] = {0};
+            return (n <= sizeof(zeros)) && (fwrite(zeros, 1, n, f) == n);
+        }
+
+        bool IsValid() const{
+            size_t elemSize;
+
+            if ((memcmp(Head->Magic, "FSB1", 4) != 0) ||
+                ((Head->Type != FLOAT64) && (Head->Type != FLOAT32)) ||
+                (Head->FileSize != DataSize) || (Head->DataOffset % 64 != 0) ||
+                (Head->NameIndexOffset % 8 != 0)){
+                return false;
+            }
+            elemSize = (Head->Type == FLOAT32) ? sizeof(float) : sizeof(double);
+            if ((Head->Dimension != 0) && (Head->Rows > (DataSize / elemSize) / Head->Dimension)){
+                return false;
+            }
+            if ((Head->DataOffset + Head->Rows * Head->Dimension * elemSize > Head->NameIndexOffset) ||
+                (Head->Rows + 1 > (DataSize - Head->NameIndexOffset) / sizeof(uint64_t)) ||
+                (Head->NameIndexOffset + (Head->Rows + 1) * sizeof(uint64_t) > Head->NamesOffset) ||
+                (Head->NamesOffset > DataSize)){
+                return false;
+            }
+            // The names must be inside the file and in order.
+            const uint64_t * index = (const uint64_t *)(Data + Head->NameIndexOffset);
+            for (uint64_t i = 0; i < Head->Rows; i++){
+                if (index[i] > index[i + 1]){
+                    return false;
+                }
+            }
+            return index[Head->Rows] <= DataSize - Head->NamesOffset;
+        }
+
+        // Copies are not allowed.
+        FeatureSetFile(const FeatureSetFile &);
+        FeatureSetFile & operator = (const FeatureSetFile &);
+};
+#endif
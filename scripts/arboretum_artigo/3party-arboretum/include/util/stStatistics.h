@@ -0,0 +1,346 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file defines the class stStatistics. It is shared by hermes and
+* arboretum, so neither library includes the other to count its work.
+*
+* @version 1.0
+*/
+#ifndef __STSTATISTICS_H
+#define __STSTATISTICS_H
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstddef>
+
+//----------------------------------------------------------------------------
+// Statistics configuration
+//----------------------------------------------------------------------------
+/**
+* Number of threads that may update the counters of stStatistics without
+* atomic read-modify-write instructions. The threads above this number share
+* one more shard and update it with atomic additions.
+*/
+#ifndef STSTATISTICS_SHARDS
+   #define STSTATISTICS_SHARDS 128
+#endif //STSTATISTICS_SHARDS
+
+//==============================================================================
+// stStatistics
+//------------------------------------------------------------------------------
+/**
+* Process-wide 64-bit counters of the work done by the library: distance
+* calculations, page reads and writes, cache hits and misses and priority
+* queue operations. The distance functions, the page managers and the trees
+* update them besides their own statistics.
+*
+* <p>Each thread owns a shard of the counters, aligned to a cache line, so
+* an update is a plain load and store of a line no other thread writes. A
+* read adds the shards of all threads. The counters are never reset: to
+* measure an interval, take a snapshot before it and GetDiff() after it.
+* <CODE>
+* stStatistics::tSnapshot start = stStatistics::GetSnapshot();
+* ...
+* stStatistics::tSnapshot work = stStatistics::GetDiff(start);
+* cout << work.Get(stStatistics::DISTANCES);
+* </CODE>
+*
+* <p>Each counter read is exact for the updates that happened before it, but
+* a snapshot taken while other threads update the counters is not an atomic
+* picture of all counters.
+*
+* @version 1.0
+* @ingroup struct
+*/
+class stStatistics{
+   public:
+      /**
+      * The counters.
+      */
+      enum tCounter{
+         /**
+         * Distance calculations.
+         */
+         DISTANCES = 0,
+
+         /**
+         * Pages read by the page managers which store them. The reads
+         * served by a stCachedPageManager are CACHEHITS.
+         */
+         PAGEREADS,
+
+         /**
+         * Pages written by the page managers which store them.
+         */
+         PAGEWRITES,
+
+         /**
+         * Pages served by a stCachedPageManager without a read.
+         */
+         CACHEHITS,
+
+         /**
+         * Pages a stCachedPageManager had to read.
+         */
+         CACHEMISSES,
+
+         /**
+         * Insertions into and removals from the priority queues of the
+         * queries.
+         */
+         QUEUEOPERATIONS,
+
+         /**
+         * Number of counters.
+         */
+         COUNTERS
+      };//end tCounter
+
+      /**
+      * The values of all counters at some point, or their difference
+      * between two points.
+      */
+      class tSnapshot{
+         public:
+            /**
+            * Creates a snapshot with all values equal to 0.
+            */
+            tSnapshot(){
+               for (int i = 0; i < COUNTERS; i++){
+                  Values[i] = 0;
+               }//end for
+            }//end tSnapshot
+
+            /**
+            * Returns the value of a counter.
+            *
+            * @param counter The counter.
+            */
+            u_int64_t Get(tCounter counter) const{
+               return Values[counter];
+            }//end Get
+
+            /**
+            * Returns the increase of each counter since an earlier snapshot.
+            *
+            * @param since The earlier snapshot.
+            */
+            tSnapshot operator - (const tSnapshot & since) const{
+               tSnapshot diff;
+
+               for (int i = 0; i < COUNTERS; i++){
+                  diff.Values[i] = Values[i] - since.Values[i];
+               }//end for
+               return diff;
+            }//end operator -
+
+         private:
+            /**
+            * The values, indexed by tCounter.
+            */
+            u_int64_t Values[COUNTERS];
+
+            friend class stStatistics;
+      };//end tSnapshot
+
+      /**
+      * Adds to a counter.
+      *
+      * @param counter The counter.
+      * @param n The value to add.
+      */
+      static void Add(tCounter counter, u_int64_t n = 1){
+         tShard * shard = GetShard();
+
+         LocalValues()[counter] += n;
+
+         if (shard == GetShards() + STSTATISTICS_SHARDS){
+            shard->Values[counter].fetch_add(n, std::memory_order_relaxed);
+         }else{
+            // No other thread writes this shard.
+            shard->Values[counter].store(
+                  shard->Values[counter].load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+         }//end if
+      }//end Add
+
+      /**
+      * Returns the value of a counter, the sum of its shards.
+      *
+      * @param counter The counter.
+      */
+      static u_int64_t Get(tCounter counter){
+         tShard * shards = GetShards();
+         u_int64_t value = 0;
+
+         for (int i = 0; i <= STSTATISTICS_SHARDS; i++){
+            value += shards[i].Values[counter].load(std::memory_order_relaxed);
+         }//end for
+         return value;
+      }//end Get
+
+      /**
+      * Returns the value of a counter counted by the calling thread alone.
+      * Unlike Get(), it measures the work of a task run by one thread, such
+      * as a query, while other threads update the counters.
+      *
+      * @param counter The counter.
+      */
+      static u_int64_t GetThread(tCounter counter){
+         return LocalValues()[counter];
+      }//end GetThread
+
+      /**
+      * Returns the values of all counters.
+      */
+      static tSnapshot GetSnapshot(){
+         tSnapshot snapshot;
+
+         for (int i = 0; i < COUNTERS; i++){
+            snapshot.Values[i] = Get((tCounter) i);
+         }//end for
+         return snapshot;
+      }//end GetSnapshot
+
+      /**
+      * Returns the increase of each counter since a snapshot.
+      *
+      * @param since The snapshot taken at the start of the interval.
+      */
+      static tSnapshot GetDiff(const tSnapshot & since){
+         return GetSnapshot() - since;
+      }//end GetDiff
+
+      /**
+      * Returns the name of a counter.
+      *
+      * @param counter The counter.
+      */
+      static const char * GetName(tCounter counter){
+         static const char * names[COUNTERS] = {"Distances", "PageReads",
+               "PageWrites", "CacheHits", "CacheMisses", "QueueOperations"};
+
+         return names[counter];
+      }//end GetName
+
+   private:
+      /**
+      * The counters of a thread, or of the threads above
+      * STSTATISTICS_SHARDS. Zero-initialized as static storage.
+      */
+      struct alignas(64) tShard{
+         /**
+         * The values, indexed by tCounter.
+         */
+         std::atomic<u_int64_t> Values[COUNTERS];
+
+         /**
+         * If true, the shard belongs to a running thread.
+         */
+         std::atomic<bool> Owned;
+      };//end tShard
+
+      /**
+      * Gives the shard of a thread back when the thread ends. The values stay
+      * in the shard for the next thread that takes it.
+      */
+      struct tOwner{
+         /**
+         * The shard of the thread or NULL if it has none.
+         */
+         tShard * Shard;
+
+         tOwner(){
+            Shard = NULL;
+         }//end tOwner
+
+         ~tOwner(){
+            // The destructors of other thread_local objects may still
+            // count something.
+            LocalShard() = GetShards() + STSTATISTICS_SHARDS;
+            if (Shard != NULL){
+               Shard->Owned.store(false, std::memory_order_release);
+            }//end if
+         }//end ~tOwner
+      };//end tOwner
+
+      /**
+      * Returns the STSTATISTICS_SHARDS shards of the threads followed by the
+      * shared shard.
+      */
+      static tShard * GetShards(){
+         static tShard shards[STSTATISTICS_SHARDS + 1];
+
+         return shards;
+      }//end GetShards
+
+      /**
+      * Returns the counters of this thread, indexed by tCounter.
+      * Zero-initialized as thread storage.
+      */
+      static u_int64_t * LocalValues(){
+         static thread_local u_int64_t values[COUNTERS];
+
+         return values;
+      }//end LocalValues
+
+      /**
+      * Returns the shard of this thread, NULL until it is taken.
+      */
+      static tShard *& LocalShard(){
+         static thread_local tShard * shard = NULL;
+
+         return shard;
+      }//end LocalShard
+
+      /**
+      * Returns the shard of this thread, taking a free one or the shared
+      * shard on the first call.
+      */
+      static tShard * GetShard(){
+         tShard * shard = LocalShard();
+
+         if (shard == NULL){
+            shard = TakeShard();
+         }//end if
+         return shard;
+      }//end GetShard
+
+      /**
+      * Takes the first free shard for this thread.
+      */
+      static tShard * TakeShard(){
+         static thread_local tOwner owner;
+         tShard * shards = GetShards();
+         bool owned;
+
+         for (int i = 0; i < STSTATISTICS_SHARDS; i++){
+            owned = false;
+            if (shards[i].Owned.compare_exchange_strong(owned, true,
+                  std::memory_order_acquire)){
+               owner.Shard = shards + i;
+               LocalShard() = shards + i;
+               return shards + i;
+            }//end if
+         }//end for
+         LocalShard() = shards + STSTATISTICS_SHARDS;
+         return shards + STSTATISTICS_SHARDS;
+      }//end TakeShard
+};//end stStatistics
+
+#endif //__STSTATISTICS_H
@@ -0,0 +1,295 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file implements the stCachedPageManager.
+*
+* @version 1.0
+*/
+#include <arboretum/stCachedPageManager.h>
+
+#include <string.h>
+
+//==============================================================================
+// stCachedPageManager
+//------------------------------------------------------------------------------
+stCachedPageManager::stCachedPageManager(stPageManager * pageManager,
+      size_t cacheSize, u_int32_t nShards){
+   size_t shardSize;
+
+   this->pageManager = pageManager;
+   StoresPages = false;
+   HitCount = 0;
+   MissCount = 0;
+
+   if (nShards == 0){
+      nShards = 1;
+   }//end if
+   for (u_int32_t i = 0; i < nShards; i++){
+      shards.push_back(new tShard());
+   }//end for
+
+   // At least one page per shard.
+   shardSize = cacheSize / nShards;
+   shardCapacity = shardSize / pageManager->GetMinimumPageSize();
+   if (shardCapacity == 0){
+      shardCapacity = 1;
+   }//end if
+}//end stCachedPageManager::stCachedPageManager
+
+//------------------------------------------------------------------------------
+stCachedPageManager::~stCachedPageManager(){
+
+   // A destructor must not throw.
+   try{
+      Flush();
+   }catch (std::exception &){
+   }//end try
+
+   for (u_int32_t i = 0; i < shards.size(); i++){
+      for (std::list<tFrame *>::iterator it = shards[i]->LRU.begin();
+            it != shards[i]->LRU.end(); it++){
+         delete (*it)->Page;
+         delete *it;
+      }//end for
+      delete shards[i];
+   }//end for
+}//end stCachedPageManager::~stCachedPageManager
+
+//------------------------------------------------------------------------------
+stPage * stCachedPageManager::GetHeaderPage(){
+
+   UpdateReadCounter();
+   return pageManager->GetHeaderPage();
+}//end stCachedPageManager::GetHeaderPage
+
+//------------------------------------------------------------------------------
+void stCachedPageManager::WriteHeaderPage(stPage * headerpage){
+
+   UpdateWriteCounter();
+   pageManager->WriteHeaderPage(headerpage);
+}//end stCachedPageManager::WriteHeaderPage
+
+//------------------------------------------------------------------------------
+stPage * stCachedPageManager::GetPage(u_int32_t pageid){
+   tShard * shard = GetShard(pageid);
+   tFrame * frame;
+   stPage * page;
+   stPage * copy;
+
+   // Hit?
+   {
+      std::lock_guard<std::mutex> lock(shard->Mutex);
+      std::unordered_map<u_int32_t, tFrame *>::iterator it = shard->Frames.find(pageid);
+      if (it != shard->Frames.end()){
+         frame = it->second;
+         frame->Pins++;
+         shard->LRU.splice(shard->LRU.begin(), shard->LRU, frame->Position);
+         HitCount++;
+         stStatistics::Add(stStatistics::CACHEHITS);
+         UpdateReadCounter();
+         return frame->Page;
+      }//end if
+   }
+
+   // Miss. The shard is not locked while the page is read.
+   page = pageManager->GetPage(pageid);
+   if (page == NULL){
+      return NULL;
+   }//end if
+   copy = new stPage(page->GetPageSize(), pageid);
+   memcpy(copy->GetData(), page->GetData(), page->GetPageSize());
+   pageManager->ReleasePage(page);
+   MissCount++;
+   stStatistics::Add(stStatistics::CACHEMISSES);
+   UpdateReadCounter();
+
+   std::lock_guard<std::mutex> lock(shard->Mutex);
+   return AddFrame(shard, copy)->Page;
+}//end stCachedPageManager::GetPage
+
+//------------------------------------------------------------------------------
+void stCachedPageManager::ReleasePage(stPage * page){
+   tShard * shard;
+
+   if (page == NULL){
+      return;
+   }//end if
+
+   if (page->GetPageID() != 0){
+      shard = GetShard(page->GetPageID());
+      std::lock_guard<std::mutex> lock(shard->Mutex);
+      std::unordered_map<u_int32_t, tFrame *>::iterator it =
+            shard->Frames.find(page->GetPageID());
+      if ((it != shard->Frames.end()) && (it->second->Page == page)){
+         if (it->second->Pins > 0){
+            it->second->Pins--;
+         }//end if
+         if (shard->Frames.size() > shardCapacity){
+            Evict(shard);
+         }//end if
+         return;
+      }//end if
+   }//end if
+
+   // The header page or a page which is not cached.
+   pageManager->ReleasePage(page);
+}//end stCachedPageManager::ReleasePage
+
+//------------------------------------------------------------------------------
+stPage * stCachedPageManager::GetNewPage(){
+   tShard * shard;
+   stPage * page;
+   stPage * copy;
+
+   page = pageManager->GetNewPage();
+   if (page == NULL){
+      return NULL;
+   }//end if
+   copy = new stPage(page->GetPageSize(), page->GetPageID());
+   memcpy(copy->GetData(), page->GetData(), page->GetPageSize());
+   pageManager->ReleasePage(page);
+
+   shard = GetShard(copy->GetPageID());
+   std::lock_guard<std::mutex> lock(shard->Mutex);
+   return AddFrame(shard, copy)->Page;
+}//end stCachedPageManager::GetNewPage
+
+//------------------------------------------------------------------------------
+void stCachedPageManager::WritePage(stPage * page){
+   tShard * shard = GetShard(page->GetPageID());
+
+   UpdateWriteCounter();
+   {
+      std::lock_guard<std::mutex> lock(shard->Mutex);
+      std::unordered_map<u_int32_t, tFrame *>::iterator it =
+            shard->Frames.find(page->GetPageID());
+      if ((it != shard->Frames.end()) && (it->second->Page == page)){
+         it->second->Dirty = true;
+         return;
+      }//end if
+   }
+
+   // Not cached.
+   pageManager->WritePage(page);
+}//end stCachedPageManager::WritePage
+
+//------------------------------------------------------------------------------
+void stCachedPageManager::DisposePage(stPage * page){
+   tShard * shard = GetShard(page->GetPageID());
+   u_int32_t pageid = page->GetPageID();
+   stPage * own;
+
+   {
+      std::lock_guard<std::mutex> lock(shard->Mutex);
+      std::unordered_map<u_int32_t, tFrame *>::iterator it = shard->Frames.find(pageid);
+      if ((it == shard->Frames.end()) || (it->second->Page != page)){
+         // Not cached.
+         pageManager->DisposePage(page);
+         return;
+      }//end if
+      shard->LRU.erase(it->second->Position);
+      delete it->second;
+      shard->Frames.erase(it);
+   }
+
+   // The page manager below disposes its own instances only. The page is
+   // written first because a new page may not exist there yet.
+   pageManager->WritePage(page);
+   delete page;
+   own = pageManager->GetPage(pageid);
+   if (own != NULL){
+      pageManager->DisposePage(own);
+   }//end if
+}//end stCachedPageManager::DisposePage
+
+//------------------------------------------------------------------------------
+void stCachedPageManager::Flush(){
+
+   for (u_int32_t i = 0; i < shards.size(); i++){
+      std::lock_guard<std::mutex> lock(shards[i]->Mutex);
+      for (std::list<tFrame *>::iterator it = shards[i]->LRU.begin();
+            it != shards[i]->LRU.end(); it++){
+         WriteFrame(*it);
+      }//end for
+   }//end for
+   pageManager->Flush();
+}//end stCachedPageManager::Flush
+
+//------------------------------------------------------------------------------
+u_int32_t stCachedPageManager::GetCachedPageCount(){
+   u_int32_t count = 0;
+
+   for (u_int32_t i = 0; i < shards.size(); i++){
+      std::lock_guard<std::mutex> lock(shards[i]->Mutex);
+      count += shards[i]->Frames.size();
+   }//end for
+   return count;
+}//end stCachedPageManager::GetCachedPageCount
+
+//------------------------------------------------------------------------------
+stCachedPageManager::tFrame * stCachedPageManager::AddFrame(tShard * shard,
+      stPage * page){
+   tFrame * frame;
+
+   std::unordered_map<u_int32_t, tFrame *>::iterator it =
+         shard->Frames.find(page->GetPageID());
+   if (it != shard->Frames.end()){
+      // Another thread was faster.
+      delete page;
+      frame = it->second;
+      frame->Pins++;
+      shard->LRU.splice(shard->LRU.begin(), shard->LRU, frame->Position);
+      return frame;
+   }//end if
+
+   frame = new tFrame();
+   frame->Page = page;
+   frame->Pins = 1;
+   frame->Dirty = false;
+   shard->LRU.push_front(frame);
+   frame->Position = shard->LRU.begin();
+   shard->Frames[page->GetPageID()] = frame;
+   Evict(shard);
+   return frame;
+}//end stCachedPageManager::AddFrame
+
+//------------------------------------------------------------------------------
+void stCachedPageManager::Evict(tShard * shard){
+   std::list<tFrame *>::iterator it = shard->LRU.end();
+   tFrame * frame;
+
+   while ((shard->Frames.size() > shardCapacity) && (it != shard->LRU.begin())){
+      it--;
+      frame = *it;
+      if (frame->Pins == 0){
+         WriteFrame(frame);
+         shard->Frames.erase(frame->Page->GetPageID());
+         it = shard->LRU.erase(it);
+         delete frame->Page;
+         delete frame;
+      }//end if
+   }//end while
+}//end stCachedPageManager::Evict
+
+//------------------------------------------------------------------------------
+void stCachedPageManager::WriteFrame(tFrame * frame){
+
+   if (frame->Dirty){
+      pageManager->WritePage(frame->Page);
+      frame->Dirty = false;
+   }//end if
+}//end stCachedPageManager::WriteFrame
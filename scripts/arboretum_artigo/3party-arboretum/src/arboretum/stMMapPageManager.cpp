@@ -0,0 +1,169 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file implements the stMMapPageManager.
+*
+* @version 1.0
+*/
+#include <arboretum/stMMapPageManager.h>
+
+#include <sys/mman.h>
+
+/**
+* Number of instances in the page view cache.
+*/
+#define STMMAPPAGEMANAGER_INSTANCECACHESIZE 16
+
+//==============================================================================
+// stMMapPageManager
+//------------------------------------------------------------------------------
+stMMapPageManager::stMMapPageManager(const char * fName){
+   struct stat st;
+   void * map;
+   int fd;
+
+   // Open file
+   fd = open(fName, O_RDONLY|O_BINARY);
+   if (fd < 0){
+      throw std::logic_error("Unable to open file.");
+   }//end if
+   if ((fstat(fd, &st) != 0) || ((size_t) st.st_size < sizeof(tHeader))){
+      close(fd);
+      throw std::logic_error("invalid file.");
+   }//end if
+
+   // Map it. The mapping stays valid after the file is closed.
+   dataSize = st.st_size;
+   map = mmap(NULL, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED){
+      throw std::logic_error("Unable to map file.");
+   }//end if
+   data = (unsigned char *) map;
+
+   // Validate file
+   if ((!IsValidHeader((tHeader *) data)) ||
+         (((tHeader *) data)->PageSize > dataSize)){
+      munmap(data, dataSize);
+      throw std::logic_error("invalid file.");
+   }//end if
+
+   // Private copy of the header page.
+   this->headerPage = new stLockablePage(((tHeader *) data)->PageSize,
+         sizeof(tHeader), 0);
+   this->header = (tHeader *)(this->headerPage->GetTrueData());
+   memcpy((void *) this->headerPage->GetTrueData(), data, ((tHeader *) data)->PageSize);
+
+   // View cache
+   pageViewCache = new stPageViewCache(STMMAPPAGEMANAGER_INSTANCECACHESIZE,
+         new stPageViewAllocator(header->PageSize));
+}//end stMMapPageManager::stMMapPageManager
+
+//------------------------------------------------------------------------------
+stMMapPageManager::~stMMapPageManager(){
+
+   delete pageViewCache;
+   delete headerPage;
+   munmap(data, dataSize);
+}//end stMMapPageManager::~stMMapPageManager
+
+//------------------------------------------------------------------------------
+bool stMMapPageManager::IsEmpty(){
+
+   return header->UsedPages == 0;
+}//end stMMapPageManager::IsEmpty
+
+//------------------------------------------------------------------------------
+stPage * stMMapPageManager::GetHeaderPage(){
+
+   UpdateReadCounter();
+   return this->headerPage;
+}//end stMMapPageManager::GetHeaderPage
+
+//------------------------------------------------------------------------------
+stPage * stMMapPageManager::GetPage(u_int32_t pageid){
+   stPageView * view;
+
+   // Do not allow users to load header page from this file.
+   if ((pageid != 0) && (pageid <= header->PageCount)){
+      if (PageID2Offset(pageid) + header->PageSize > dataSize){
+         throw std::logic_error("Unable to read page.");
+      }//end if
+
+      {
+         std::lock_guard<std::mutex> lock(pageViewCacheMutex);
+         view = pageViewCache->Get();
+      }
+      view->SetView(data + PageID2Offset(pageid), pageid);
+
+      // Update Counters
+      UpdateReadCounter();
+      return view;
+   }else{
+      // Error!!!
+      #ifdef __stDEBUG__
+      throw invalid_argument("Invalid page ID.");
+      #else
+      return NULL;
+      #endif //__stDEBUG__
+   }//end if
+}//end stMMapPageManager::GetPage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::ReleasePage(stPage * page){
+
+   if (page != headerPage){
+      std::lock_guard<std::mutex> lock(pageViewCacheMutex);
+      pageViewCache->Put((stPageView *) page);
+   //}else{
+      // Do nothing because it is the header page.
+   }//end if
+}//end stMMapPageManager::ReleasePage
+
+//------------------------------------------------------------------------------
+stPage * stMMapPageManager::GetNewPage(){
+
+   throw std::logic_error("The page manager is read only.");
+}//end stMMapPageManager::GetNewPage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::WritePage(stPage *){
+
+   throw std::logic_error("The page manager is read only.");
+}//end stMMapPageManager::WritePage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::WriteHeaderPage(stPage *){
+
+   // Nothing to do. The header page is a private copy.
+}//end stMMapPageManager::WriteHeaderPage
+
+//------------------------------------------------------------------------------
+void stMMapPageManager::DisposePage(stPage *){
+
+   throw std::logic_error("The page manager is read only.");
+}//end stMMapPageManager::DisposePage
+
+//------------------------------------------------------------------------------
+bool stMMapPageManager::IsValidHeader(tHeader * header){
+
+   return (header->Magic[0] == 'D') &&
+         (header->Magic[1] == 'P') &&
+         (header->Magic[2] == 'M') &&
+         (header->Magic[3] == '1') &&
+         (header->PageSize >= sizeof(tHeader));
+}//end stMMapPageManager::IsValidHeader
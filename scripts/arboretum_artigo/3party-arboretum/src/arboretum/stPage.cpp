@@ -35,6 +35,14 @@ stPage::stPage (u_int32_t size, u_int32_t pageid){
    this->SetPageID(pageid);
 }//end stPage::stPage
 
+//------------------------------------------------------------------------------
+stPage::stPage (unsigned char * buffer, u_int32_t size, u_int32_t pageid){
+
+   this->BufferSize = size;
+   this->Buffer = buffer;
+   this->SetPageID(pageid);
+}//end stPage::stPage
+
 //------------------------------------------------------------------------------
 stPage::~stPage(){
 
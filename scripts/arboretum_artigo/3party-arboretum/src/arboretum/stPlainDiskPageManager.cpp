@@ -114,8 +114,7 @@ stPage * stPlainDiskPageManager::GetHeaderPage(){
    UpdateReadCounter();
    
    // Effective read
-   lseek(fd, 0, SEEK_SET);  
-   read(fd, (void *)this->headerPage->GetTrueData(), header->PageSize);
+   pread(fd, (void *)this->headerPage->GetTrueData(), header->PageSize, 0);
     
    return this->headerPage;
 }//end stPlainDiskPageManager::GetheaderPage
@@ -128,11 +127,10 @@ stPage * stPlainDiskPageManager::GetPage(u_int32_t pageid){
    if ((pageid != 0) && (pageid <= header->PageCount)){
       
       // Get from cache
-      myPage = pageInstanceCache->Get();
+      myPage = GetPageInstance();
       
       // Read data...
-      lseek(fd, PageID2Offset(pageid), SEEK_SET);
-      read(fd, myPage->GetData(), header->PageSize);
+      pread(fd, myPage->GetData(), header->PageSize, PageID2Offset(pageid));
       myPage->SetPageID(pageid);
    
       // Update Counters
@@ -153,7 +151,7 @@ void stPlainDiskPageManager::ReleasePage(stPage * page){
    
    // Put it back
    if (page->GetPageSize() == header->PageSize){
-      pageInstanceCache->Put(page);
+      PutPageInstance(page);
    }else if (page->GetPageID() != 0){
       delete page;
    //}else{
@@ -168,7 +166,7 @@ stPage * stPlainDiskPageManager::GetNewPage(){
    
    if (header->Available == 0){
       // Get instance from cache
-      page = pageInstanceCache->Get();
+      page = GetPageInstance();
       
       // Creating the new page
       header->PageCount++;
@@ -196,8 +194,7 @@ void stPlainDiskPageManager::WritePage(stPage * page){
    }//end if
    #endif //__stDEBUG__
 
-   lseek(fd, PageID2Offset(page->GetPageID()), SEEK_SET);
-   write(fd, page->GetData(), header->PageSize);      
+   pwrite(fd, page->GetData(), header->PageSize, PageID2Offset(page->GetPageID()));
    UpdateWriteCounter();
 }//end stPlainDiskPageManager::WritePage
 
@@ -210,8 +207,7 @@ void stPlainDiskPageManager::WriteHeaderPage(stPage * headerpage){
    }//end if
    #endif //__stDEBUG__
    
-   lseek(fd, 0, SEEK_SET);
-   write(fd, this->headerPage->GetTrueData(), header->PageSize);
+   pwrite(fd, this->headerPage->GetTrueData(), header->PageSize, 0);
    UpdateWriteCounter();
 }//end stPlainDiskPageManager::WriteHeaderPage
 
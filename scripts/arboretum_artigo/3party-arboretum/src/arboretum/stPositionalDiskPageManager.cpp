@@ -0,0 +1,311 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file implements the stPositionalDiskPageManager.
+*
+* @version 1.0
+*/
+#include <arboretum/stPositionalDiskPageManager.h>
+
+#include <errno.h>
+
+/**
+* Number of instances in the page cache.
+*/
+#define STPOSITIONALDISKPAGEMANAGER_INSTANCECACHESIZE 16
+
+//==============================================================================
+// stPositionalDiskPageManager
+//------------------------------------------------------------------------------
+stPositionalDiskPageManager::stPositionalDiskPageManager(const char * fName,
+      u_int32_t pagesize){
+
+   // Open file
+   fd = open(fName, O_CREAT|O_TRUNC|O_RDWR|O_BINARY, S_IREAD|S_IWRITE); // New file with 0 bytes
+   if (fd < 0){
+      throw std::logic_error("Unable to create file.");
+   }//end if
+
+   // Initialize fields.
+   this->headerPage = new stLockablePage(pagesize, sizeof(tHeader), 0);
+   this->header = (tHeader *)(this->headerPage->GetTrueData());
+   memset((void *) this->headerPage->GetTrueData(), 0, pagesize);
+   NewHeader(this->header, pagesize);
+   headerUpdate = true;
+
+   // Page cache
+   pageInstanceCache = new stPageInstanceCache(
+         STPOSITIONALDISKPAGEMANAGER_INSTANCECACHESIZE,
+         new stPageAllocator(pagesize));
+}//end stPositionalDiskPageManager::stPositionalDiskPageManager
+
+//------------------------------------------------------------------------------
+stPositionalDiskPageManager::stPositionalDiskPageManager(const char * fName){
+   tHeader tmpHeader;
+
+   // Open file
+   fd = open(fName, O_RDWR|O_BINARY); // Open file
+   if (fd < 0){
+      throw std::logic_error("Unable to open file.");
+   }//end if
+
+   // Validate file
+   if ((!ReadAt(&tmpHeader, sizeof(tmpHeader), 0)) ||
+         (!IsValidHeader(&tmpHeader))){
+      close(fd);
+      throw std::logic_error("invalid file.");
+   }//end if
+
+   // Load the whole header page.
+   this->headerPage = new stLockablePage(tmpHeader.PageSize, sizeof(tHeader), 0);
+   this->header = (tHeader *)(this->headerPage->GetTrueData());
+   if (!ReadAt((void *) this->headerPage->GetTrueData(), tmpHeader.PageSize, 0)){
+      delete headerPage;
+      close(fd);
+      throw std::logic_error("invalid file.");
+   }//end if
+   headerUpdate = false;
+
+   // Page cache
+   pageInstanceCache = new stPageInstanceCache(
+         STPOSITIONALDISKPAGEMANAGER_INSTANCECACHESIZE,
+         new stPageAllocator(header->PageSize));
+}//end stPositionalDiskPageManager::stPositionalDiskPageManager
+
+//------------------------------------------------------------------------------
+stPositionalDiskPageManager::~stPositionalDiskPageManager(){
+
+   // Free resources
+   delete pageInstanceCache;
+   // Save header page info. A destructor must not throw.
+   try{
+      Flush();
+   }catch (std::logic_error &){
+   }//end try
+   // Delete header page.
+   delete this->headerPage;
+   // Close file
+   close(fd);
+}//end stPositionalDiskPageManager::~stPositionalDiskPageManager
+
+//------------------------------------------------------------------------------
+bool stPositionalDiskPageManager::IsEmpty(){
+
+   return header->UsedPages == 0;
+}//end stPositionalDiskPageManager::IsEmpty
+
+//------------------------------------------------------------------------------
+stPage * stPositionalDiskPageManager::GetHeaderPage(){
+
+   // Update read count as stPlainDiskPageManager does.
+   UpdateReadCounter();
+
+   return this->headerPage;
+}//end stPositionalDiskPageManager::GetHeaderPage
+
+//------------------------------------------------------------------------------
+stPage * stPositionalDiskPageManager::GetPage(u_int32_t pageid){
+   stPage * myPage;
+
+   // Do not allow users to load header page from this file.
+   if ((pageid != 0) && (pageid <= header->PageCount)){
+
+      // Get from cache
+      myPage = GetPageInstance();
+
+      // Read data...
+      if (!ReadAt(myPage->GetData(), header->PageSize, PageID2Offset(pageid))){
+         PutPageInstance(myPage);
+         throw std::logic_error("Unable to read page.");
+      }//end if
+      myPage->SetPageID(pageid);
+
+      // Update Counters
+      UpdateReadCounter();
+      return myPage;
+   }else{
+      // Error!!!
+      #ifdef __stDEBUG__
+      throw invalid_argument("Invalid page ID.");
+      #else
+      return NULL;
+      #endif //__stDEBUG__
+   }//end if
+}//end stPositionalDiskPageManager::GetPage
+
+//------------------------------------------------------------------------------
+void stPositionalDiskPageManager::ReleasePage(stPage * page){
+
+   // Put it back
+   if (page->GetPageSize() == header->PageSize){
+      PutPageInstance(page);
+   }else if (page->GetPageID() != 0){
+      delete page;
+   //}else{
+      // Do nothing because it is the header page.
+   }//end if
+}//end stPositionalDiskPageManager::ReleasePage
+
+//------------------------------------------------------------------------------
+stPage * stPositionalDiskPageManager::GetNewPage(){
+   u_int32_t * next;
+   stPage * page;
+
+   if (header->Available == 0){
+      // Get instance from cache
+      page = GetPageInstance();
+
+      // Creating the new page
+      header->PageCount++;
+      page->SetPageID(header->PageCount);
+   }else{
+      // Remove from free list
+      page = GetPage(header->Available);
+      next = (u_int32_t *)(page->GetData());
+      header->Available = * next;
+   }//end if
+
+   // Update header
+   header->UsedPages++;
+   WriteHeaderPage(headerPage);
+
+   return page;
+}//end stPositionalDiskPageManager::GetNewPage
+
+//------------------------------------------------------------------------------
+void stPositionalDiskPageManager::WritePage(stPage * page){
+
+   #ifdef __stDEBUG__
+   if (page->GetPageID() == 0){
+      throw invalid_argument("Do not use WritePage to write header pages.");
+   }//end if
+   #endif //__stDEBUG__
+
+   if (!WriteAt(page->GetData(), header->PageSize, PageID2Offset(page->GetPageID()))){
+      throw std::logic_error("Unable to write page.");
+   }//end if
+   UpdateWriteCounter();
+}//end stPositionalDiskPageManager::WritePage
+
+//------------------------------------------------------------------------------
+void stPositionalDiskPageManager::WriteHeaderPage(stPage *){
+
+   // The header page is the one returned by GetHeaderPage(). It is written
+   // by Flush() and counted here, as stPlainDiskPageManager does.
+   headerUpdate = true;
+   UpdateWriteCounter();
+}//end stPositionalDiskPageManager::WriteHeaderPage
+
+//------------------------------------------------------------------------------
+void stPositionalDiskPageManager::DisposePage(stPage * page){
+   u_int32_t * next;
+
+   // Append to free list
+   next = (u_int32_t *)page->GetData();
+   *next = header->Available;
+   header->Available = page->GetPageID();
+   WritePage(page);
+
+   // Update header
+   header->UsedPages--;
+   WriteHeaderPage(headerPage);
+
+   // Free resources
+   ReleasePage(page);
+}//end stPositionalDiskPageManager::DisposePage
+
+//------------------------------------------------------------------------------
+void stPositionalDiskPageManager::Flush(){
+
+   if (headerUpdate){
+      if (!WriteAt(headerPage->GetTrueData(), header->PageSize, 0)){
+         throw std::logic_error("Unable to write header page.");
+      }//end if
+      headerUpdate = false;
+   }//end if
+}//end stPositionalDiskPageManager::Flush
+
+//------------------------------------------------------------------------------
+void stPositionalDiskPageManager::NewHeader(tHeader * header, u_int32_t pagesize){
+
+   // Magic header. Always "DPM1".
+   header->Magic[0] = 'D';
+   header->Magic[1] = 'P';
+   header->Magic[2] = 'M';
+   header->Magic[3] = '1';
+
+   // Organization
+   header->PageSize = pagesize;
+
+   // Page control
+   header->PageCount = 0;
+   header->UsedPages = 0;
+   header->Available = 0;
+}//end stPositionalDiskPageManager::NewHeader
+
+//------------------------------------------------------------------------------
+bool stPositionalDiskPageManager::IsValidHeader(tHeader * header){
+
+   return (header->Magic[0] == 'D') &&
+         (header->Magic[1] == 'P') &&
+         (header->Magic[2] == 'M') &&
+         (header->Magic[3] == '1') &&
+         (header->PageSize >= sizeof(tHeader));
+}//end stPositionalDiskPageManager::IsValidHeader
+
+//------------------------------------------------------------------------------
+bool stPositionalDiskPageManager::ReadAt(void * buff, size_t n, off_t offset){
+   unsigned char * p = (unsigned char *) buff;
+   ssize_t r;
+
+   while (n > 0){
+      r = pread(fd, p, n, offset);
+      if (r < 0){
+         if (errno == EINTR){
+            continue;
+         }//end if
+         return false;
+      }else if (r == 0){
+         // End of file.
+         return false;
+      }//end if
+      p += r;
+      n -= r;
+      offset += r;
+   }//end while
+   return true;
+}//end stPositionalDiskPageManager::ReadAt
+
+//------------------------------------------------------------------------------
+bool stPositionalDiskPageManager::WriteAt(const void * buff, size_t n, off_t offset){
+   const unsigned char * p = (const unsigned char *) buff;
+   ssize_t w;
+
+   while (n > 0){
+      w = pwrite(fd, p, n, offset);
+      if (w < 0){
+         if (errno == EINTR){
+            continue;
+         }//end if
+         return false;
+      }//end if
+      p += w;
+      n -= w;
+      offset += w;
+   }//end while
+   return true;
+}//end stPositionalDiskPageManager::WriteAt
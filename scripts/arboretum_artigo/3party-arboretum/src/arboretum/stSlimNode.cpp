@@ -39,6 +39,10 @@ stSlimNode * stSlimNode::CreateNode(stPage * page){
          // Create a leaf page
          return new stSlimLeafNode(page, false);
       default:
+         if ((header->Type & 0xFF00) == FIELDLEAF){
+            // Create a leaf page with field distances
+            return new stSlimLeafNode(page, false);
+         }//end if
          return 0;
    }//end switch
 }//end stSlimNode::CreateNode()
@@ -253,7 +257,7 @@ u_int32_t stSlimIndexNode::GetTotalObjectCount(){
 //------------------------------------------------------------------------------
 // class stSlimLeafNode
 //------------------------------------------------------------------------------
-stSlimLeafNode::stSlimLeafNode(stPage * page, bool create):
+stSlimLeafNode::stSlimLeafNode(stPage * page, bool create, u_int32_t fields):
       stSlimNode(page){
 
    // Attention to this manouver! It is the brain of this
@@ -265,14 +269,26 @@ stSlimLeafNode::stSlimLeafNode(stPage * page, bool create):
       #ifdef __stDEBUG__
       Page->Clear();
       #endif //__stDEBUG__
-      this->Header->Type = LEAF;
+      #ifdef __stDEBUG__
+      if (fields > 0xFF){
+         throw invalid_argument("Too many fields.");
+      }//end if
+      #endif //__stDEBUG__
+      this->Header->Type = (fields == 0) ? LEAF : (FIELDLEAF | fields);
       this->Header->Occupation = 0;
    }//end if
+   if ((this->Header->Type & 0xFF00) == FIELDLEAF){
+      Fields = this->Header->Type & 0xFF;
+   }else{
+      Fields = 0;
+   }//end if
 }//end stSlimLeafNode::stSlimLeafNode()
 
 //------------------------------------------------------------------------------
 int stSlimLeafNode::AddEntry(u_int32_t size, const unsigned char * object){
    u_int32_t entrySize;
+   u_int32_t fieldSize;
+   u_int32_t i;
 
    #ifdef __stDEBUG__
    if (size == 0){
@@ -281,7 +297,8 @@ int stSlimLeafNode::AddEntry(u_int32_t size, const unsigned char * object){
    #endif //__stDEBUG__
 
    // Does it fit ?
-   entrySize = size + sizeof(stSlimLeafEntry);
+   fieldSize = Fields * sizeof(double);
+   entrySize = size + fieldSize + sizeof(stSlimLeafEntry);
    if (entrySize > this->GetFree()){
       // No, it doesn't.
       return -1;
@@ -291,13 +308,16 @@ int stSlimLeafNode::AddEntry(u_int32_t size, const unsigned char * object){
 
    // Adding the object. Take care with these pointers or you will destroy the
    // node. The idea is to put the object of an entry in the reverse order
-   // in the data array.
+   // in the data array. The field distances come right before it.
    if (Header->Occupation == 0){
-      Entries[Header->Occupation].Offset = Page->GetPageSize() - size;
+      Entries[Header->Occupation].Offset = Page->GetPageSize() - size - fieldSize;
    }else{
-      Entries[Header->Occupation].Offset = Entries[Header->Occupation - 1].Offset - size;
+      Entries[Header->Occupation].Offset = Entries[Header->Occupation - 1].Offset - size - fieldSize;
    }//end if
-   memcpy((void *)(Page->GetData() + Entries[Header->Occupation].Offset),
+   for (i = 0; i < Fields; i++){
+      SetFieldDistance(Header->Occupation, i, -1);
+   }//end for
+   memcpy((void *)(Page->GetData() + Entries[Header->Occupation].Offset + fieldSize),
           (void *)object, size);
 
    // Update # of entries
@@ -344,7 +364,7 @@ const unsigned char * stSlimLeafNode::GetObject(u_int32_t idx){
    }//end if
    #endif //__stDEBUG__
 
-   return Page->GetData() + Entries[idx].Offset;
+   return Page->GetData() + Entries[idx].Offset + (Fields * sizeof(double));
 }//end stSlimLeafNode::GetObject()
 
 //------------------------------------------------------------------------------
@@ -357,10 +377,10 @@ u_int32_t stSlimLeafNode::GetObjectSize(u_int32_t idx){
 
    if (idx == 0){
       // First object
-      return Page->GetPageSize() - Entries[0].Offset;
+      return Page->GetPageSize() - Entries[0].Offset - (Fields * sizeof(double));
    }else{
       // Any other
-      return Entries[idx - 1].Offset - Entries[idx].Offset;
+      return Entries[idx - 1].Offset - Entries[idx].Offset - (Fields * sizeof(double));
    }//end if
 }//end stSlimLeafIndexNode::GetObjectSize()
 
@@ -386,7 +406,8 @@ void stSlimLeafNode::RemoveEntry(u_int32_t idx){
    // Do I need to move something ?
    if (idx != lastID){
       // Yes, I do.
-      rObjSize = GetObjectSize(idx);    // Save the removed object size
+      // Save the removed object size (with its field distances)
+      rObjSize = GetObjectSize(idx) + (Fields * sizeof(double));
 
       // Let's move objects first. We will use memmove() from stdlib because
       // it handles the overlap between src and dst. Remember that src is the
@@ -0,0 +1,137 @@
+/* Copyright 2003-2017 GBDI-ICMC-USP <caetano@icmc.usp.br>
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+/**
+* @file
+*
+* This file implements the stTaskPool.
+*
+* @version 1.0
+*/
+#include <arboretum/stTaskPool.h>
+
+//==============================================================================
+// stTaskPool
+//------------------------------------------------------------------------------
+stTaskPool::stTaskPool(u_int32_t nThreads){
+
+   Stop = false;
+   if (nThreads == 0){
+      nThreads = std::thread::hardware_concurrency();
+      if (nThreads == 0){
+         nThreads = 1;
+      }//end if
+   }//end if
+
+   // The caller is thread 0.
+   for (u_int32_t i = 1; i < nThreads; i++){
+      Threads.push_back(std::thread(&stTaskPool::Work, this, i));
+   }//end for
+}//end stTaskPool::stTaskPool
+
+//------------------------------------------------------------------------------
+stTaskPool::~stTaskPool(){
+
+   {
+      std::lock_guard<std::mutex> lock(Mutex);
+      Stop = true;
+   }
+   Changed.notify_all();
+   for (u_int32_t i = 0; i < Threads.size(); i++){
+      Threads[i].join();
+   }//end for
+}//end stTaskPool::~stTaskPool
+
+//------------------------------------------------------------------------------
+void stTaskPool::Run(std::vector <tTask> & tasks, u_int32_t id){
+   tGroup group;
+   tItem item;
+
+   if (tasks.empty()){
+      return;
+   }//end if
+
+   group.Pending = tasks.size();
+   {
+      std::lock_guard<std::mutex> lock(Mutex);
+      // The first task is the last to be pushed, so it runs first.
+      for (u_int32_t i = tasks.size(); i > 0; i--){
+         item.Task = &tasks[i - 1];
+         item.Group = &group;
+         Pending.push_back(item);
+      }//end for
+   }
+   Changed.notify_all();
+
+   // Help until the group is done.
+   while (true){
+      {
+         std::unique_lock<std::mutex> lock(Mutex);
+         while ((group.Pending > 0) && Pending.empty()){
+            Changed.wait(lock);
+         }//end while
+         if (group.Pending == 0){
+            break;
+         }//end if
+         item = Pending.back();
+         Pending.pop_back();
+      }
+      Execute(item, id);
+   }//end while
+
+   if (group.Error){
+      std::rethrow_exception(group.Error);
+   }//end if
+}//end stTaskPool::Run
+
+//------------------------------------------------------------------------------
+void stTaskPool::Execute(tItem item, u_int32_t id){
+   std::exception_ptr error;
+
+   try{
+      (*item.Task)(id);
+   }catch (...){
+      error = std::current_exception();
+   }//end try
+
+   // The group may be gone as soon as it is done.
+   {
+      std::lock_guard<std::mutex> lock(Mutex);
+      if (error && !item.Group->Error){
+         item.Group->Error = error;
+      }//end if
+      item.Group->Pending--;
+   }
+   Changed.notify_all();
+}//end stTaskPool::Execute
+
+//------------------------------------------------------------------------------
+void stTaskPool::Work(u_int32_t id){
+   tItem item;
+
+   while (true){
+      {
+         std::unique_lock<std::mutex> lock(Mutex);
+         while ((!Stop) && Pending.empty()){
+            Changed.wait(lock);
+         }//end while
+         if (Stop){
+            return;
+         }//end if
+         item = Pending.back();
+         Pending.pop_back();
+      }
+      Execute(item, id);
+   }//end while
+}//end stTaskPool::Work
@@ -9,6 +9,8 @@
 //---------------------------------------------------------------------------
 using namespace std;
 #include <iostream>
+#include <cerrno>
+#include <stdexcept>
 #pragma hdrstop
 #include "app.h"
 
@@ -27,17 +29,209 @@ void TApp::CreateTree(){
 //------------------------------------------------------------------------------
 void TApp::CreateDiskPageManager(){
    //for SlimTree
-   PageManager = new stPlainDiskPageManager("SlimTree.dat", 256*4);
+   DiskPageManager = new stPositionalDiskPageManager(TREEFILE, 256*4);
+   PageManager = new stCachedPageManager(DiskPageManager, CACHESIZE);
 }//end TApp::CreateDiskPageManager
 
 
+//------------------------------------------------------------------------------
 void TApp::LoadSlimTree(){
+   u_int32_t n = 0;
 
-}
+   if (SlimTree->GetUserDataSize() < sizeof(n)){
+      return;
+   }//end if
+   SlimTree->ReadUserData((unsigned char *) &n, sizeof(n));
+   if (n == 0){
+      // No weights stored.
+      return;
+   }else if (sizeof(n) + n * sizeof(double) > SlimTree->GetUserDataSize()){
+      throw std::length_error("The build weights in the tree header are corrupted.");
+   }//end if
 
+   vector<unsigned char> data(sizeof(n) + n * sizeof(double));
+   vector<double> weights(n);
+   u_int32_t dimension = 0;
+   SlimTree->ReadUserData(data.data(), data.size());
+   memcpy(weights.data(), data.data() + sizeof(n), n * sizeof(double));
+   if (data.size() + sizeof(dimension) <= SlimTree->GetUserDataSize()){
+      // The number of features follows the weights. Older trees have none.
+      data.resize(data.size() + sizeof(dimension));
+      SlimTree->ReadUserData(data.data(), data.size());
+      memcpy(&dimension, data.data() + sizeof(n) + n * sizeof(double), sizeof(dimension));
+      if (dimension > n){
+         dimension = 0;
+      }//end if
+   }//end if
+   SlimTree->GetMetricEvaluator()->SetBuildWeights(weights, dimension);
+   ChangeWeightSlimTree(weights);
+}//end TApp::LoadSlimTree
+
+//------------------------------------------------------------------------------
+void TApp::SaveBuildWeights(mySlimTree * tree){
+   vector<double> weights = tree->GetMetricEvaluator()->GetWeights();
+   u_int32_t n = weights.size();
+   u_int32_t dimension = dataObjects.empty() ? 0 : dataObjects[0]->size();
+   vector<unsigned char> data(sizeof(n) + n * sizeof(double) + sizeof(dimension));
+
+   memcpy(data.data(), &n, sizeof(n));
+   memcpy(data.data() + sizeof(n), weights.data(), n * sizeof(double));
+   memcpy(data.data() + sizeof(n) + n * sizeof(double), &dimension, sizeof(dimension));
+   if (!tree->WriteUserData(data.data(), data.size())){
+      // The tree could not be opened again with the same distances.
+      throw std::length_error("Too many weights to store in the tree header.");
+   }//end if
+   tree->GetMetricEvaluator()->SetBuildWeights(weights, dimension);
+   tree->SetDistortion(1, 1);
+}//end TApp::SaveBuildWeights
+
+//------------------------------------------------------------------------------
 void TApp::ChangeWeightSlimTree(vector<double> weights){
-   SlimTree->GetMetricEvaluator()->SetWeights(weights);
-}
+   CheckReindex();
+   SetTreeWeights(SlimTree, weights);
+}//end TApp::ChangeWeightSlimTree
+
+//------------------------------------------------------------------------------
+void TApp::SetTreeWeights(mySlimTree * tree, vector<double> & weights){
+   double lower, upper;
+
+   tree->GetMetricEvaluator()->SetWeights(weights);
+   tree->GetMetricEvaluator()->GetDistortion(lower, upper);
+   tree->SetDistortion(lower, upper);
+}//end TApp::SetTreeWeights
+
+//------------------------------------------------------------------------------
+void TApp::SetTreeVariances(mySlimTree * tree){
+   size_t n = dataObjects.size();
+   size_t dim;
+   vector<double> mean, variances;
+
+   if (n == 0){
+      return;
+   }//end if
+   dim = dataObjects[0]->size();
+   mean.assign(dim, 0);
+   variances.assign(dim, 0);
+   for (size_t j = 0; j < n; j++){
+      if (dataObjects[j]->size() != dim){
+         return;
+      }//end if
+      for (size_t i = 0; i < dim; i++){
+         mean[i] += dataObjects[j]->data()[i];
+      }//end for
+   }//end for
+   for (size_t i = 0; i < dim; i++){
+      mean[i] /= n;
+   }//end for
+   for (size_t j = 0; j < n; j++){
+      for (size_t i = 0; i < dim; i++){
+         double tmp = dataObjects[j]->data()[i] - mean[i];
+         variances[i] += tmp * tmp;
+      }//end for
+   }//end for
+   for (size_t i = 0; i < dim; i++){
+      variances[i] /= n;
+   }//end for
+   tree->GetMetricEvaluator()->SetVariances(variances);
+}//end TApp::SetTreeVariances
+
+//------------------------------------------------------------------------------
+bool TApp::StartReindex(){
+   if (IsReindexing() || dataObjects.empty()){
+      return false;
+   }//end if
+
+   ReindexDone = false;
+   ReindexError = nullptr;
+   ReindexThread = std::thread(&TApp::Reindex, this,
+         SlimTree->GetMetricEvaluator()->GetWeights());
+   return true;
+}//end TApp::StartReindex
+
+//------------------------------------------------------------------------------
+void TApp::Reindex(vector<double> weights){
+   u_int32_t objSize = 0;
+
+   try{
+      NewDiskPageManager = new stPositionalDiskPageManager(REINDEXFILE, 256*4);
+      NewPageManager = new stCachedPageManager(NewDiskPageManager, CACHESIZE);
+      NewSlimTree = new mySlimTree(NewPageManager);
+      if (!weights.empty()){
+         NewSlimTree->GetMetricEvaluator()->SetWeights(weights);
+      }//end if
+      SetTreeVariances(NewSlimTree);
+      if (SlimTree->GetNumberOfPivots() > 0){
+         vector<TFlatImage *> pivots;
+         for (u_int32_t i = 0; i < SlimTree->GetNumberOfPivots(); i++){
+            pivots.push_back(SlimTree->GetPivot(i));
+         }//end for
+         NewSlimTree->SetPivots(pivots.data(), pivots.size());
+      }//end if
+
+      for (unsigned int i = 0; i < dataObjects.size(); i++){
+         objSize = max(objSize, (u_int32_t) dataObjects[i]->GetSerializedSize());
+      }//end for
+      NewSlimTree->BulkLoadMemoryParallel(dataObjects.data(), dataObjects.size(),
+            0.7, objSize, mySlimTree::bulkFUNCTION);
+      SaveBuildWeights(NewSlimTree);
+      // The header must be on disk before REINDEXFILE replaces TREEFILE.
+      NewSlimTree->Flush();
+   }catch (...){
+      ReindexError = std::current_exception();
+   }//end try
+   ReindexDone = true;
+}//end TApp::Reindex
+
+//------------------------------------------------------------------------------
+void TApp::CheckReindex(){
+   if (ReindexDone){
+      WaitReindex();
+   }//end if
+}//end TApp::CheckReindex
+
+//------------------------------------------------------------------------------
+void TApp::WaitReindex(){
+   if (!IsReindexing()){
+      return;
+   }//end if
+   ReindexThread.join();
+   ReindexDone = false;
+
+   if (ReindexError){
+      cout << "\n Reindex failed! Keeping the current tree.";
+      delete NewSlimTree;
+      delete NewPageManager;
+      delete NewDiskPageManager;
+      remove(REINDEXFILE);
+   }else if (rename(REINDEXFILE, TREEFILE) != 0){
+      // TREEFILE still holds the current tree, so the current tree is kept.
+      // The new one is left in REINDEXFILE.
+      cout << "\n Could not replace " << TREEFILE << ": " << strerror(errno)
+           << ". Keeping the current tree.";
+      delete NewSlimTree;
+      delete NewPageManager;
+      delete NewDiskPageManager;
+   }else{
+      // The new file is complete, so TREEFILE was replaced at once. The old
+      // page manager keeps its descriptor until it is deleted.
+      vector<double> weights = SlimTree->GetMetricEvaluator()->GetWeights();
+      delete QueryPool;
+      QueryPool = NULL;
+      delete SlimTree;
+      delete PageManager;
+      delete DiskPageManager;
+      SlimTree = NewSlimTree;
+      PageManager = NewPageManager;
+      DiskPageManager = NewDiskPageManager;
+      if (!weights.empty()){
+         // The weights may have changed during the build.
+         ChangeWeightSlimTree(weights);
+      }//end if
+   }//end if
+   NewSlimTree = NULL;
+   NewPageManager = NULL;
+   NewDiskPageManager = NULL;
+}//end TApp::WaitReindex
 
 //------------------------------------------------------------------------------
 void TApp::Run(){
@@ -61,55 +255,69 @@ void TApp::Run(){
 //------------------------------------------------------------------------------
 void TApp::Done(){
 
+   WaitReindex();
+   if (this->QueryPool != NULL){
+      delete this->QueryPool;
+   }//end if
    if (this->SlimTree != NULL){
       delete this->SlimTree;
    }//end if
    if (this->PageManager != NULL){
       delete this->PageManager;
    }//end if
+   if (this->DiskPageManager != NULL){
+      delete this->DiskPageManager;
+   }//end if
 
    // delete the vetor of queries.
    for (unsigned int i = 0; i < queryObjects.size(); i++){
       delete (queryObjects.at(i));
    }//end for
+   for (unsigned int i = 0; i < dataObjects.size(); i++){
+      delete (dataObjects.at(i));
+   }//end for
+   dataObjects.clear();
 }//end TApp::Done
 
 int sizeDataset = 5000;
 //------------------------------------------------------------------------------
 void TApp::LoadTree(char * fileName){
-    TImage * image;
-
     if(SlimTree != NULL){
-        CSVToVector * csvReader = new CSVToVector();
-        vector<vector<string>> data = csvReader->GetData(fileName);
-        
-         string name;
-         vector<double> features;
-         std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-         cout << "\n PATH: " << CITYFILE;
+        vector<TFlatImage *> objects;
+        // The objects kept from an earlier load may be views of DataFile,
+        // so the objects of a later one are copies.
+        ReadObjects(fileName, objects, DataFile.IsOpen() ? NULL : &DataFile);
 
-         cout << "\n TAMANHO DATASET: " << data.size();
+         std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+         cout << "\n PATH: " << fileName;
+
+         cout << "\n TAMANHO DATASET: " << objects.size();
+
+        // The pivots must be set before the first object is added.
+        if ((PIVOTCOUNT > 0) && (SlimTree->GetNumberOfObjects() == 0) &&
+              (objects.size() >= PIVOTCOUNT)){
+            try{
+                SlimTree->FindPivots(objects.data(),
+                      std::min(objects.size(), (size_t) PIVOTSAMPLESIZE), PIVOTCOUNT);
+            }catch (std::logic_error & e){
+                cout << "\n No global pivots: " << e.what();
+            }
+        }
 
-        for(int i=0;i<data.size();i++)
+        // Each batch writes the pages it touches once.
+        for(size_t i=0;i<objects.size();i+=LOADBATCHSIZE)
         {   
-            name = data[i][data[i].size()-1];
-            features.clear();
-            for(int j=0;j<data[i].size()-1;j++)
-            {
-                features.push_back(std::stod(data[i][j]));
-            }
-            //cout<< "Index:" << name << endl;
-            //cout<< "Feature:" << features.size() << endl;
-            TImage * img = new TImage(name, features);
-            SlimTree->Add(img);
-            if(i % 5000 == 0){
-               std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
-
-               cout << "\n Index:" << i << " Time: " << (std::chrono::duration_cast<std::chrono::microseconds>(middle - begin).count()/1000000)<<"[µs]";
-            }
-            delete img;
+            u_int32_t n = std::min(objects.size() - i, (size_t) LOADBATCHSIZE);
+            SlimTree->AddBatch(&objects[i], n);
+            std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+
+            cout << "\n Index:" << i << " Time: " << (std::chrono::duration_cast<std::chrono::microseconds>(middle - begin).count()/1000000)<<"[µs]";
         }
+        // Kept to rebuild the tree.
+        dataObjects.insert(dataObjects.end(), objects.begin(), objects.end());
+        SetTreeVariances(SlimTree);
         cout << " Added " << SlimTree->GetNumberOfObjects() << " objects ";
+        SaveBuildWeights(SlimTree);
     }
     else{
         cout << "\n Zero object added!!";
@@ -120,24 +328,47 @@ void TApp::LoadTree(char * fileName){
 void TApp::LoadVectorFromFile(char * fileName){
     // clear before using.
     queryObjects.clear();
-   string name;
-   vector<double> features;
-
-    CSVToVector * csvReader = new CSVToVector();
-    vector<vector<string>> data = csvReader->GetData(fileName);
-    for(int i=0;i<data.size();i++)
-    {   
-         name = data[i][data[i].size()-1];
-        features.clear();
-        for(int j=0;j<data[i].size()-1;j++)
-        {
-            features.push_back(std::stod(data[i][j]));
-        }
-        this->queryObjects.insert(queryObjects.end(), new TImage(name, features));
-    }
+
+    ReadObjects(fileName, queryObjects);
     cout << " Added " << queryObjects.size() << " query objects ";
 }//end TApp::LoadVectorFromFile
 
+//------------------------------------------------------------------------------
+void TApp::ReadObjects(char * fileName, vector<TFlatImage *> & objects,
+      FeatureSetFile * file){
+
+   if (FeatureSetFile::IsFeatureSetFile(fileName)){
+      FeatureSetFile local;
+      size_t length;
+      const char * name;
+
+      if (file == NULL){
+         file = &local;
+      }//end if
+      file->Open(fileName);
+      vector<double> features(file->GetDimension());
+      for (size_t i = 0; i < file->GetRows(); i++){
+         TFlatImage * img;
+         name = file->GetName(i, length);
+         if ((file != &local) && (file->GetType() == FeatureSetFile::FLOAT64)){
+            // Nothing is copied until the tree serializes the object.
+            img = new TFlatImage();
+            img->SetView(name, length, file->GetFeatures(i), file->GetDimension());
+         }else{
+            file->GetFeatures(i, features.data());
+            img = new TFlatImage(string(name, length), features.data(), features.size());
+         }//end if
+         objects.push_back(img);
+      }//end for
+   }else{
+      CSVFeatureLoader::FeatureSet data;
+      CSVFeatureLoader().Load(fileName, data);
+      for (size_t i = 0; i < data.Rows; i++){
+         objects.push_back(new TFlatImage(data.GetName(i), data.GetFeatures(i), data.Columns));
+      }//end for
+   }//end if
+}//end TApp::ReadObjects
+
 //------------------------------------------------------------------------------
 void TApp::PerformQueries(){
    if (SlimTree){
@@ -148,6 +379,22 @@ void TApp::PerformQueries(){
       cout << "\nStarting Statistics for Nearest Query with SlimTree.... ";
       PerformNearestQuery();
       cout << " Ok\n";
+
+      cout << "\nStarting Statistics for Parallel Nearest Query with SlimTree.... ";
+      PerformParallelNearestQuery();
+      cout << " Ok\n";
+
+      cout << "\nStarting Statistics for Batch Nearest Query with SlimTree.... ";
+      PerformBatchNearestQuery();
+      cout << " Ok\n";
+
+      cout << "\nStarting Statistics for Relevance Feedback Query with SlimTree.... ";
+      PerformFeedbackNearestQuery();
+      cout << " Ok\n";
+
+      cout << "\nStarting Statistics for Nearest Query with compact SlimTrees.... ";
+      PerformCompactNearestQuery();
+      cout << " Ok\n";
    }//end if
 }//end TApp::PerformQuery
 
@@ -210,6 +457,8 @@ void TApp::PerformRangeQuery(){
          // is divided for queryObjects to get the everage
          cout << "\nTotal Disk Accesses: " << (double )PageManager->GetReadCount();
          cout << "\nAvg Disk Accesses: " << (double )PageManager->GetReadCount() / (double )sizePerfom;
+         cout << "\nCache Hits: " << (double )PageManager->GetHitCount();
+         cout << "\nCache Misses: " << (double )PageManager->GetMissCount();
          // is divided for queryObjects to get the everage
          // is divided for queryObjects to get the everage
          cout << "\nTotal Distance Calculations: " <<
@@ -272,6 +521,8 @@ void TApp::PerformNearestQuery(){
       // is divided for queryObjects to get the everage
       cout << "\nTotal Disk Accesses: " << (double )PageManager->GetReadCount();
       cout << "\nAvg Disk Accesses: " << (double )PageManager->GetReadCount() / (double )sizePerfom;
+      cout << "\nCache Hits: " << (double )PageManager->GetHitCount();
+      cout << "\nCache Misses: " << (double )PageManager->GetMissCount();
       // is divided for queryObjects to get the everage
       cout << "\nTotal Distance Calculations: " <<
          (double )SlimTree->GetMetricEvaluator()->GetDistanceCount();
@@ -280,8 +531,191 @@ void TApp::PerformNearestQuery(){
    }//end if
 }//end TApp::PerformNearestQuery
 
-void TApp::KNNSearch(TImage * image, int k, bool  weighted){
+//------------------------------------------------------------------------------
+void TApp::PerformParallelNearestQuery(){
+   bool enableWeight = true;
+   unsigned int size = min((unsigned int) sizePerfom, (unsigned int) queryObjects.size());
+   vector<vector<double> > weights(size);
+   vector<myResult *> results(size);
+   vector<stQueryStats> stats(size);
+   double maxTime = 0;
+   double sumTime = 0;
+
+   if (SlimTree){
+      CheckReindex();
+      if (QueryPool == NULL){
+         QueryPool = new myQueryPool(SlimTree);
+      }//end if
+
+      // Random weights for each query, as in PerformNearestQuery().
+      if (enableWeight == true){
+         for (unsigned int i = 0; i < size; i++){
+            for(int j=0; j < 50; j++){
+               weights[i].push_back(fRand());
+            }
+         }//end for
+      }//end if
+
+      PageManager->ResetStatistics();
+      QueryPool->ResetStatistics();
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      if (enableWeight == true){
+         QueryPool->NearestQuery(queryObjects.data(), size, 15, results.data(), false,
+               [&weights](u_int32_t i, mySlimTree * tree){
+                  SetTreeWeights(tree, weights[i]);
+               }, stats.data());
+      }else{
+         QueryPool->NearestQuery(queryObjects.data(), size, 15, results.data(), false,
+               myQueryPool::tPrepare(), stats.data());
+      }//end if
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      for (unsigned int i = 0; i < size; i++){
+         delete results[i];
+         sumTime += stats[i].Time;
+         maxTime = max(maxTime, stats[i].Time);
+      }//end for
+
+      cout << "\nThreads: " << QueryPool->GetNumberOfThreads();
+      cout << "\nTotal Time: " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()<<"[µs]";
+      cout << "\nAvg Query Time: " << sumTime / (double )size <<"[µs]";
+      cout << "\nMax Query Time: " << maxTime <<"[µs]";
+      cout << "\nTotal Disk Accesses: " << (double )PageManager->GetReadCount();
+      cout << "\nAvg Disk Accesses: " << (double )PageManager->GetReadCount() / (double )size;
+      cout << "\nCache Hits: " << (double )PageManager->GetHitCount();
+      cout << "\nCache Misses: " << (double )PageManager->GetMissCount();
+      cout << "\nTotal Distance Calculations: " << (double )QueryPool->GetDistanceCount();
+      cout << "\nAvg Distance Calculations: " <<
+         (double )QueryPool->GetDistanceCount() / (double )size;
+   }//end if
+}//end TApp::PerformParallelNearestQuery
+
+//------------------------------------------------------------------------------
+void TApp::PerformBatchNearestQuery(){
+   bool enableWeight = true;
+   unsigned int size = min((unsigned int) sizePerfom, (unsigned int) queryObjects.size());
+   vector<double> weights;
+   vector<myResult *> results(size);
+
+   if (SlimTree){
+      if (enableWeight == true){
+         for(int j=0; j < 50; j++){
+            weights.push_back(fRand());
+         }
+         ChangeWeightSlimTree(weights);
+      }//end if
+
+      PageManager->ResetStatistics();
+      SlimTree->GetMetricEvaluator()->ResetStatistics();
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      SlimTree->NearestQuery(queryObjects.data(), size, 15, results.data());
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      for (unsigned int i = 0; i < size; i++){
+         delete results[i];
+      }//end for
+
+      cout << "\nTotal Time: " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()<<"[µs]";
+      cout << "\nTotal Disk Accesses: " << (double )PageManager->GetReadCount();
+      cout << "\nAvg Disk Accesses: " << (double )PageManager->GetReadCount() / (double )size;
+      cout << "\nCache Hits: " << (double )PageManager->GetHitCount();
+      cout << "\nCache Misses: " << (double )PageManager->GetMissCount();
+      cout << "\nTotal Distance Calculations: " <<
+         (double )SlimTree->GetMetricEvaluator()->GetDistanceCount();
+      cout << "\nAvg Distance Calculations: " <<
+         (double )SlimTree->GetMetricEvaluator()->GetDistanceCount() / (double )size;
+   }//end if
+}//end TApp::PerformBatchNearestQuery
+
+//------------------------------------------------------------------------------
+void TApp::PerformFeedbackNearestQuery(){
+   unsigned int size = min((unsigned int) sizePerfom, (unsigned int) queryObjects.size());
+   vector<double> weights;
+   myResult * result;
+
+   if (SlimTree){
+      CheckReindex();
+      myFeedbackSession session(SlimTree, FEEDBACKPOOLSIZE);
+
+      PageManager->ResetStatistics();
+      SlimTree->GetMetricEvaluator()->ResetStatistics();
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      for (unsigned int i = 0; i < size; i++){
+         weights.clear();
+         for(int j=0; j < 50; j++){
+            weights.push_back(fRand());
+         }
+         ChangeWeightSlimTree(weights);
+         result = session.NearestQuery(queryObjects[i], 15);
+         delete result;
+
+         // Each round of feedback moves every weight by up to 20%.
+         for (int round = 0; round < FEEDBACKROUNDS; round++){
+            for (size_t j = 0; j < weights.size(); j++){
+               weights[j] *= 0.8 + (0.4 * fRand());
+            }
+            ChangeWeightSlimTree(weights);
+            result = session.NearestQuery(15);
+            delete result;
+         }//end for
+      }//end for
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      cout << "\nTotal Time: " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()<<"[µs]";
+      cout << "\nRounds answered by the pool: " << session.GetPoolHitCount();
+      cout << "\nPools fetched from the tree: " << session.GetFetchCount();
+      cout << "\nTotal Disk Accesses: " << (double )PageManager->GetReadCount();
+      cout << "\nTotal Distance Calculations: " <<
+         (double )SlimTree->GetMetricEvaluator()->GetDistanceCount();
+   }//end if
+}//end TApp::PerformFeedbackNearestQuery
+
+//------------------------------------------------------------------------------
+void TApp::PerformCompactNearestQuery(){
+   unsigned int size = min((unsigned int) sizePerfom, (unsigned int) queryObjects.size());
+   FeatureCodec::Encoding encodings[2] = {FeatureCodec::FLOAT32, FeatureCodec::INT8};
+   const char * names[2] = {"float32", "int8"};
+   vector<double> weights;
+   myResult * result;
+
+   if (dataObjects.empty()){
+      return;
+   }//end if
+   for (int e = 0; e < 2; e++){
+      stPositionalDiskPageManager diskPageManager(COMPACTTREEFILE, 256*4);
+      stCachedPageManager pageManager(&diskPageManager, CACHESIZE);
+      TCompactIndex index(&pageManager);
+
+      index.Build(dataObjects, encodings[e],
+            SlimTree->GetMetricEvaluator()->GetBuildWeights());
+      pageManager.ResetStatistics();
+      index.GetTree()->GetMetricEvaluator()->ResetStatistics();
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      for (unsigned int i = 0; i < size; i++){
+         weights.clear();
+         for(int j=0; j < 50; j++){
+            weights.push_back(fRand());
+         }
+         index.SetWeights(weights);
+         result = index.NearestQuery(queryObjects[i], 15);
+         delete result;
+      }//end for
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      cout << "\nEncoding: " << names[e] << " Height: " << index.GetTree()->GetHeight() <<
+         " Nodes: " << index.GetTree()->GetNodeCount();
+      cout << "\nTotal Time: " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()<<"[µs]";
+      cout << "\nTotal Disk Accesses: " << (double )pageManager.GetReadCount();
+      cout << "\nTotal Distance Calculations: " <<
+         (double )index.GetTree()->GetMetricEvaluator()->GetDistanceCount();
+      cout << "\nTotal Exact Distance Calculations: " << (double )index.GetRefineCount();
+   }//end for
+}//end TApp::PerformCompactNearestQuery
+
+void TApp::KNNSearch(TFlatImage * image, int k, bool  weighted){
    myResult * result;
+
+   CheckReindex();
    vector<double> weights;
    if(weighted == true){
       for(int i=0; i < image->GetFeatures().size(); i++){
@@ -296,8 +730,10 @@ void TApp::KNNSearch(TImage * image, int k, bool  weighted){
    delete image;
 }
 
-void TApp::RangeSearch(TImage * image, double radius, bool  weighted){
+void TApp::RangeSearch(TFlatImage * image, double radius, bool  weighted){
    myResult * result;
+
+   CheckReindex();
    vector<double> weights;
    if(weighted == true){
       for(int i=0; i < image->GetFeatures().size(); i++){
@@ -311,11 +747,49 @@ void TApp::RangeSearch(TImage * image, double radius, bool  weighted){
    delete image;
 }
 
+void TApp::KNNSearch(vector<TFlatImage *> & images, int k, bool weighted){
+   vector<myResult *> results(images.size());
+
+   CheckReindex();
+   if(weighted == true && !images.empty()){
+      vector<double> weights;
+      for(int i=0; i < images[0]->size(); i++){
+         weights.push_back(fRand());
+      }
+      ChangeWeightSlimTree(weights);
+   }
+   SlimTree->NearestQuery(images.data(), images.size(), k, results.data());
+   for(size_t i=0; i < images.size(); i++){
+      delete results[i];
+      delete images[i];
+   }
+   images.clear();
+}
+
+void TApp::RangeSearch(vector<TFlatImage *> & images, double radius, bool weighted){
+   vector<myResult *> results(images.size());
+
+   CheckReindex();
+   if(weighted == true && !images.empty()){
+      vector<double> weights;
+      for(int i=0; i < images[0]->size(); i++){
+         weights.push_back(fRand());
+      }
+      ChangeWeightSlimTree(weights);
+   }
+   SlimTree->RangeQuery(images.data(), images.size(), radius, results.data());
+   for(size_t i=0; i < images.size(); i++){
+      delete results[i];
+      delete images[i];
+   }
+   images.clear();
+}
+
 
 void TApp::TimerNearestQuery(){
    /*
    myResult * result;
-   TImage * image = new TImage(queries[i].GetName(), queries[i].GetFeature());
+   TFlatImage * image = new TFlatImage(queries[i].GetName(), queries[i].GetFeature());
 
    result = SlimTree->NearestQuery(image, 30);
    */
@@ -325,9 +799,11 @@ void TApp::TimerRangeQuery(){
 
 }
 
-void TApp::KNNSearchImage(TImage * image){
+void TApp::KNNSearchImage(TFlatImage * image){
    myResult * result;
 
+   CheckReindex();
+
    cout << "\nCONSULTA POR KNN";
 
    //cout << "\nPESOS: " << SlimTree->GetMetricEvaluator()->GetWeights() << endl;
@@ -354,9 +830,11 @@ void TApp::KNNSearchImage(TImage * image){
    cout << "\n-------------------------";
 }
 
-vector<string> TApp::KNNSearchAndGetImage(TImage * image){
+vector<string> TApp::KNNSearchAndGetImage(TFlatImage * image){
    myResult * result;
 
+   CheckReindex();
+
    cout << "\nCONSULTA POR KNN";
 
    //cout << "\nPESOS: " << SlimTree->GetMetricEvaluator()->GetWeights() << endl;
@@ -377,9 +855,11 @@ vector<string> TApp::KNNSearchAndGetImage(TImage * image){
    return nameOfImages;
 }
 
-void TApp::RangeSearchImage(TImage * image){
+void TApp::RangeSearchImage(TFlatImage * image){
    myResult * result;
 
+   CheckReindex();
+
    cout << "\nCONSULTA POR RANGE";
 
    result = SlimTree->RangeQuery(image, 0.4);
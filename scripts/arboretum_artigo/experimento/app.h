@@ -8,24 +8,56 @@
 #define appH
 
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <exception>
 
+// Queries evaluate distances on the node pages (see TFlatImage)
+#define __stOBJECTVIEW__
+// The tree is rebuilt with BulkLoadMemoryParallel (see TApp::StartReindex)
+#define __BULKLOAD__
 
 // Metric Tree includes
 #include <arboretum/stMetricTree.h>
-#include <arboretum/stPlainDiskPageManager.h>
+#include <arboretum/stPositionalDiskPageManager.h>
+#include <arboretum/stCachedPageManager.h>
 #include <arboretum/stDiskPageManager.h>
 #include <arboretum/stMemoryPageManager.h>
 #include <arboretum/stSlimTree.h>
+#include <arboretum/stSlimTreeQueryPool.h>
+#include <arboretum/stSlimTreeFeedbackSession.h>
 #include <arboretum/stMetricTree.h>
 #include<util/CSVToVector.h>
+#include <util/CSVFeatureLoader.h>
+#include <util/FeatureSetFile.h>
 #include <hermes/EuclideanDistance.h>
 #include <hermes/EuclideanDistanceWeighted.h>
 // My object
-#include "image.h"
+#include "flatimage.h"
+#include "compactimage.h"
+#include "compactindex.h"
 
 #include <string.h>
 #include <fstream>
 
+#define TREEFILE "SlimTree.dat"
+#define REINDEXFILE "SlimTree.dat.new"
+// File of the trees of PerformCompactNearestQuery()
+#define COMPACTTREEFILE "CompactTree.dat"
+// Bytes of the page cache of the tree
+#define CACHESIZE (8 * 1024 * 1024)
+// Objects added to the tree by each AddBatch() of LoadTree()
+#define LOADBATCHSIZE 5000
+// Candidates fetched by the first query of a relevance feedback session
+#define FEEDBACKPOOLSIZE 100
+// Rounds of each relevance feedback session of PerformFeedbackNearestQuery()
+#define FEEDBACKROUNDS 5
+// Global pivots of the tree (see stSlimTree::SetPivots()); 0 disables them
+#define PIVOTCOUNT 4
+// Objects among which LoadTree() chooses the global pivots
+#define PIVOTSAMPLESIZE 1000
+
+// The data files may also be FeatureSetFiles written by csv2fsb.
 #define CITYFILE "../datastore-toy/toy_dataset_2_feature.csv"
 #define QUERYCITYFILE "../datastore-toy/query_no_classe_toy_dataset_2_feature.csv"
 
@@ -40,22 +72,39 @@ class TApp{
       /**
       * This is the type used by the result.
       */
-      typedef stResult < TImage > myResult;
+      typedef stResult < TFlatImage > myResult;
 
-      typedef stMetricTree < TImage, EuclideanDistanceWeighted<TImage> > MetricTree;
+      typedef stMetricTree < TFlatImage, EuclideanDistanceWeighted<TFlatImage> > MetricTree;
 
       /**
-      * This is the type of the Slim-Tree defined by TImage and
+      * This is the type of the Slim-Tree defined by TFlatImage and
       * TImageDistanceEvaluator.
       */
-      typedef stSlimTree < TImage, EuclideanDistanceWeighted<TImage> > mySlimTree;
+      typedef stSlimTree < TFlatImage, EuclideanDistanceWeighted<TFlatImage> > mySlimTree;
+
+      /**
+      * This is the type of the pool that runs batches of queries on the
+      * Slim-Tree.
+      */
+      typedef stSlimTreeQueryPool < TFlatImage, EuclideanDistanceWeighted<TFlatImage> > myQueryPool;
+
+      /**
+      * This is the type of the relevance feedback sessions on the Slim-Tree.
+      */
+      typedef stSlimTreeFeedbackSession < TFlatImage, EuclideanDistanceWeighted<TFlatImage> > myFeedbackSession;
 
       /**
       * Creates a new instance of this class.
       */
       TApp(){
+         DiskPageManager = NULL;
          PageManager = NULL;
          SlimTree = NULL;
+         QueryPool = NULL;
+         NewDiskPageManager = NULL;
+         NewPageManager = NULL;
+         NewSlimTree = NULL;
+         ReindexDone = false;
       }//end TApp
 
       /**
@@ -73,9 +122,47 @@ class TApp{
          CreateTree();
       }//end Init
 
+      /**
+      * Restores the build weights stored in the header of the tree.
+      *
+      * @exception std::length_error If the stored weights are corrupted.
+      */
       void LoadSlimTree();
+
+      /**
+      * Changes the weights of the metric. The tree is not rebuilt: the
+      * queries rescale its radii by the distortion between the new weights
+      * and the build weights, so the answers stay exact.
+      *
+      * @param weights The new weights.
+      */
       void ChangeWeightSlimTree(vector<double> weights);
 
+      /**
+      * Rebuilds the tree under the current weights in background. The new
+      * tree is bulk loaded from the objects kept by LoadTree() into
+      * REINDEXFILE while the queries keep running on the current tree. It
+      * replaces the current tree (and TREEFILE) at the first query after the
+      * build finishes.
+      *
+      * @return False if a rebuild is already running.
+      */
+      bool StartReindex();
+
+      /**
+      * Returns true while a rebuild started by StartReindex() has not
+      * replaced the current tree yet.
+      */
+      bool IsReindexing(){
+         return ReindexThread.joinable();
+      }//end IsReindexing
+
+      /**
+      * Waits for the rebuild started by StartReindex() and replaces the
+      * current tree. It does nothing if no rebuild is running.
+      */
+      void WaitReindex();
+
       /**
       * Runs the application.
       *
@@ -88,30 +175,112 @@ class TApp{
       * Deinitialize the application.
       */
       void Done();
-      void KNNSearchImage(TImage * image);
-      vector<string> KNNSearchAndGetImage(TImage * image);
-      void RangeSearchImage(TImage * image);
+      void KNNSearchImage(TFlatImage * image);
+      vector<string> KNNSearchAndGetImage(TFlatImage * image);
+      void RangeSearchImage(TFlatImage * image);
+
+      void KNNSearch(TFlatImage * image, int k, bool weighted);
+      void RangeSearch(TFlatImage * image, double radius, bool weighted);
 
-      void KNNSearch(TImage * image, int k, bool weighted);
-      void RangeSearch(TImage * image, double radius, bool weighted);
+      /**
+      * Same as KNNSearch(), but for a batch of images that share one weight
+      * vector and the node reads of the tree. The images are deleted.
+      */
+      void KNNSearch(vector<TFlatImage *> & images, int k, bool weighted);
 
+      /**
+      * Same as RangeSearch(), but for a batch of images that share one weight
+      * vector and the node reads of the tree. The images are deleted.
+      */
+      void RangeSearch(vector<TFlatImage *> & images, double radius, bool weighted);
+
+
+      /**
+      * Reads the objects of a CSV file or a FeatureSetFile. If file is not
+      * NULL, the FeatureSetFile is mapped by it and the objects of a float64
+      * file are views of the mapping, so file must outlive them.
+      *
+      * @param fileName The file name.
+      * @param objects The objects read are appended here.
+      * @param file The FeatureSetFile to keep the mapping or NULL.
+      */
+      static void ReadObjects(char * fileName, vector<TFlatImage *> & objects,
+                              FeatureSetFile * file = NULL);
 
    private:
 
       /**
-      * The Page Manager for SlimTree.
+      * The file of SlimTree.
       */
-      stPlainDiskPageManager * PageManager;
+      stPositionalDiskPageManager * DiskPageManager;
+
+      /**
+      * The Page Manager for SlimTree. It caches the pages of DiskPageManager.
+      */
+      stCachedPageManager * PageManager;
 
       /**
       * The SlimTree.
       */
-      MetricTree * SlimTree;
+      mySlimTree * SlimTree;
+
+      /**
+      * Runs batches of queries on SlimTree. It is created by
+      * PerformParallelNearestQuery().
+      */
+      myQueryPool * QueryPool;
 
       /**
       * Vector for holding the query objects.
       */
-      vector <TImage *> queryObjects;
+      vector <TFlatImage *> queryObjects;
+
+      /**
+      * The indexed objects, kept to rebuild the tree.
+      */
+      vector <TFlatImage *> dataObjects;
+
+      /**
+      * The mapped data file of the first LoadTree() that read a
+      * FeatureSetFile. The objects in dataObjects may be views of it, so it
+      * is never opened again.
+      */
+      FeatureSetFile DataFile;
+
+      /**
+      * The rebuild started by StartReindex().
+      */
+      std::thread ReindexThread;
+
+      /**
+      * Set by ReindexThread when the new tree is ready.
+      */
+      std::atomic<bool> ReindexDone;
+
+      /**
+      * The error raised by the rebuild, if any.
+      */
+      std::exception_ptr ReindexError;
+
+      /**
+      * The tree being built by ReindexThread and its page managers.
+      */
+      stPositionalDiskPageManager * NewDiskPageManager;
+      stCachedPageManager * NewPageManager;
+      mySlimTree * NewSlimTree;
+
+      /**
+      * Bulk loads NewSlimTree. It runs in ReindexThread.
+      *
+      * @param weights The weights of the new tree.
+      */
+      void Reindex(vector<double> weights);
+
+      /**
+      * Replaces the current tree if the rebuild has finished. It must be
+      * called by the thread that runs the queries.
+      */
+      void CheckReindex();
 
       /**
       * Creates a disk page manager. It must be called before CreateTree().
@@ -124,10 +293,21 @@ class TApp{
       void CreateTree();
 
       /**
-      * Loads the tree from file with a set of cities.
+      * Loads the tree from file with a set of cities. The objects are added
+      * in batches of LOADBATCHSIZE.
       */
       void LoadTree(char * fileName);
 
+      /**
+      * Records the current weights of a tree as its build weights and
+      * stores them in its header, followed by the number of features of the
+      * objects kept by LoadTree().
+      *
+      * @param tree The tree.
+      * @exception std::length_error If the weights do not fit in the header.
+      */
+      void SaveBuildWeights(mySlimTree * tree);
+
       /**
       * Loads the vector for queries.
       */
@@ -140,6 +320,48 @@ class TApp{
 
       void PerformNearestQuery();
 
+      /**
+      * Same as PerformNearestQuery(), but the queries run in parallel on
+      * QueryPool.
+      */
+      void PerformParallelNearestQuery();
+
+      /**
+      * Same as PerformNearestQuery(), but the queries run as one batch under
+      * a single weight vector, sharing the node reads.
+      */
+      void PerformBatchNearestQuery();
+
+      /**
+      * Runs a relevance feedback session for each query: the first round
+      * fetches a pool of FEEDBACKPOOLSIZE candidates and each of the next
+      * FEEDBACKROUNDS rounds changes the weights and ranks the pool again.
+      */
+      void PerformFeedbackNearestQuery();
+
+      /**
+      * Same as PerformNearestQuery(), but on a TCompactIndex of the objects
+      * kept by LoadTree(), once with float32 and once with int8 features.
+      */
+      void PerformCompactNearestQuery();
+
+      /**
+      * Sets the weights of a tree and the matching distortion.
+      *
+      * @param tree The tree.
+      * @param weights The new weights.
+      */
+      static void SetTreeWeights(mySlimTree * tree, vector<double> & weights);
+
+      /**
+      * Sets the variances of the features of the objects kept by LoadTree()
+      * in the evaluator of a tree, so its bounded distances visit the
+      * dimensions of largest variance first.
+      *
+      * @param tree The tree.
+      */
+      void SetTreeVariances(mySlimTree * tree);
+
       void PerformRangeQuery();
       void TimerNearestQuery();
       void TimerRangeQuery();
@@ -0,0 +1,474 @@
+//---------------------------------------------------------------------------
+// benchmark.cpp - Reproducible benchmark of the Slim-Tree queries
+//
+// Usage: benchmark [options]
+//    -d <file>  Data file, CSV or FeatureSetFile. Default CITYFILE.
+//    -q <file>  Query file, CSV or FeatureSetFile. Default QUERYCITYFILE.
+//    -o <file>  Output file. Default the standard output.
+//    -s <seed>  Seed of the weight vectors. Default 1.
+//    -n <n>     Queries of each configuration. Default all of the query file.
+//    -r <n>     Runs of each query. Default 3.
+//    -p <list>  Page sizes. Default 1024,4096.
+//    -m <list>  Dimensions: the first m features of each object are kept and
+//               0 keeps all of them. Default 0.
+//    -k <list>  k of the nearest neighbor queries. Default 1,5,15,50.
+//    -R <list>  Radii of the range queries, in percent of the diameter of the
+//               data set. Default 1,5,10.
+//    -u         Unweighted queries. By default each query draws its own
+//               weight vector, as TApp::PerformNearestQuery() does.
+//
+// The files are read once. A tree is built for each page size and dimension
+// and every query of every configuration is timed alone, so the latencies do
+// not include any parsing. The weight vectors come from a std::mt19937 with
+// the given seed, so two runs with the same options ask the same queries.
+//
+// The results are written as JSON: one entry per configuration with the
+// mean, p50, p95 and p99 of the latency, the distance calculations and the
+// disk accesses of a query.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+#include "app.h"
+
+using namespace std;
+
+// The trees of the benchmark are built in this file.
+#define BENCHFILE "Benchmark.dat"
+
+//---------------------------------------------------------------------------
+/**
+* Summary of a sample: mean and nearest-rank percentiles.
+*/
+struct tSummary{
+   double Mean;
+   double P50;
+   double P95;
+   double P99;
+};//end tSummary
+
+/**
+* Measures of each query of a configuration.
+*/
+struct tMeasures{
+   vector<double> Latency;
+   vector<double> Distances;
+   vector<double> DiskAccesses;
+   vector<double> CacheMisses;
+   vector<double> Results;
+};//end tMeasures
+
+/**
+* Options of the benchmark.
+*/
+struct tOptions{
+   string DataFile;
+   string QueryFile;
+   string OutputFile;
+   u_int32_t Seed;
+   u_int32_t Queries;
+   u_int32_t Runs;
+   vector<u_int32_t> PageSizes;
+   vector<u_int32_t> Dimensions;
+   vector<u_int32_t> Ks;
+   vector<double> Radii;
+   bool Weighted;
+};//end tOptions
+
+//---------------------------------------------------------------------------
+/**
+* Returns the percentile p of a sorted sample (nearest rank).
+*/
+double Percentile(const vector<double> & sorted, double p){
+   size_t rank;
+
+   if (sorted.empty()){
+      return 0;
+   }//end if
+   rank = (size_t) ceil((p / 100.0) * sorted.size());
+   if (rank == 0){
+      rank = 1;
+   }//end if
+   return sorted[min(rank, sorted.size()) - 1];
+}//end Percentile
+
+//---------------------------------------------------------------------------
+tSummary Summarize(vector<double> sample){
+   tSummary summary;
+   double sum = 0;
+
+   sort(sample.begin(), sample.end());
+   for (size_t i = 0; i < sample.size(); i++){
+      sum += sample[i];
+   }//end for
+   summary.Mean = sample.empty() ? 0 : sum / sample.size();
+   summary.P50 = Percentile(sample, 50);
+   summary.P95 = Percentile(sample, 95);
+   summary.P99 = Percentile(sample, 99);
+   return summary;
+}//end Summarize
+
+//---------------------------------------------------------------------------
+string JsonString(const string & value){
+   ostringstream out;
+   char code[8];
+
+   out << '"';
+   for (size_t i = 0; i < value.size(); i++){
+      unsigned char c = value[i];
+      if ((c == '"') || (c == '\\')){
+         out << '\\' << c;
+      }else if (c < 0x20){
+         snprintf(code, sizeof(code), "\\u%04x", c);
+         out << code;
+      }else{
+         out << c;
+      }//end if
+   }//end for
+   out << '"';
+   return out.str();
+}//end JsonString
+
+//---------------------------------------------------------------------------
+string JsonSummary(const vector<double> & sample){
+   tSummary summary = Summarize(sample);
+   ostringstream out;
+
+   out.precision(10);
+   out << "{\"mean\": " << summary.Mean << ", \"p50\": " << summary.P50
+       << ", \"p95\": " << summary.P95 << ", \"p99\": " << summary.P99 << "}";
+   return out.str();
+}//end JsonSummary
+
+//---------------------------------------------------------------------------
+/**
+* Parses a comma separated list of numbers.
+*/
+template <class T>
+vector<T> ParseList(const char * list){
+   vector<T> values;
+   stringstream in(list);
+   string item;
+
+   while (getline(in, item, ',')){
+      values.push_back((T) stod(item));
+   }//end while
+   if (values.empty()){
+      throw std::invalid_argument(string("Empty list: ") + list);
+   }//end if
+   return values;
+}//end ParseList
+
+//---------------------------------------------------------------------------
+/**
+* Reads the objects of a CSV file or a FeatureSetFile.
+*/
+void ReadFeatures(const string & fileName, CSVFeatureLoader::FeatureSet & data){
+
+   if (FeatureSetFile::IsFeatureSetFile(fileName)){
+      FeatureSetFile file;
+      size_t length;
+      const char * name;
+
+      file.Open(fileName);
+      data.Rows = file.GetRows();
+      data.Columns = file.GetDimension();
+      data.Features.resize(data.Rows * data.Columns);
+      data.NameOffsets.resize(data.Rows + 1);
+      data.Names.clear();
+      for (size_t i = 0; i < data.Rows; i++){
+         file.GetFeatures(i, data.Features.data() + i * data.Columns);
+         name = file.GetName(i, length);
+         data.NameOffsets[i] = data.Names.size();
+         data.Names.append(name, length);
+      }//end for
+      data.NameOffsets[data.Rows] = data.Names.size();
+   }else{
+      CSVFeatureLoader().Load(fileName, data);
+   }//end if
+}//end ReadFeatures
+
+//---------------------------------------------------------------------------
+/**
+* Creates the objects of a feature set keeping only its first dim features.
+*/
+vector<TFlatImage *> CreateObjects(const CSVFeatureLoader::FeatureSet & data,
+      size_t dim, size_t count){
+   vector<TFlatImage *> objects;
+
+   count = min(count, data.Rows);
+   for (size_t i = 0; i < count; i++){
+      objects.push_back(new TFlatImage(data.GetName(i), data.GetFeatures(i), dim));
+   }//end for
+   return objects;
+}//end CreateObjects
+
+//---------------------------------------------------------------------------
+void DeleteObjects(vector<TFlatImage *> & objects){
+
+   for (size_t i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+   objects.clear();
+}//end DeleteObjects
+
+//---------------------------------------------------------------------------
+/**
+* Estimates the diameter of a set of objects with two sweeps: the farthest
+* object from the first one, then the farthest object from that one. The
+* estimate is at least half of the diameter.
+*/
+double EstimateDiameter(vector<TFlatImage *> & objects){
+   EuclideanDistanceWeighted<TFlatImage> evaluator;
+   size_t far = 0;
+   double diameter = 0;
+   double d;
+
+   for (int sweep = 0; sweep < 2; sweep++){
+      TFlatImage * from = objects[far];
+      for (size_t i = 0; i < objects.size(); i++){
+         d = evaluator.GetDistance(*from, *objects[i]);
+         if (d > diameter){
+            diameter = d;
+            far = i;
+         }//end if
+      }//end for
+   }//end for
+   return diameter;
+}//end EstimateDiameter
+
+//---------------------------------------------------------------------------
+/**
+* Runs every query of a configuration opt.Runs times and records its
+* measures. If k is 0, the queries are range queries with the given radius.
+*/
+tMeasures RunQueries(TApp::mySlimTree * tree,
+      vector<TFlatImage *> & queries, vector<vector<double> > & weights,
+      u_int32_t k, double radius, const tOptions & opt){
+   tMeasures measures;
+   double lower, upper;
+   TApp::myResult * result;
+   stStatistics::tSnapshot start;
+   stStatistics::tSnapshot work;
+
+   for (u_int32_t run = 0; run < opt.Runs; run++){
+      for (size_t i = 0; i < queries.size(); i++){
+         if (opt.Weighted){
+            tree->GetMetricEvaluator()->SetWeights(weights[i]);
+            tree->GetMetricEvaluator()->GetDistortion(lower, upper);
+            tree->SetDistortion(lower, upper);
+         }//end if
+         // The counters of the query only, without the weights set above.
+         start = stStatistics::GetSnapshot();
+         std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+         if (k > 0){
+            result = tree->NearestQuery(queries[i], k);
+         }else{
+            result = tree->RangeQuery(queries[i], radius);
+         }//end if
+         std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+         work = stStatistics::GetDiff(start);
+
+         measures.Latency.push_back(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / 1000.0);
+         measures.Distances.push_back(work.Get(stStatistics::DISTANCES));
+         measures.DiskAccesses.push_back(work.Get(stStatistics::CACHEHITS) +
+               work.Get(stStatistics::CACHEMISSES));
+         measures.CacheMisses.push_back(work.Get(stStatistics::CACHEMISSES));
+         measures.Results.push_back(result->GetNumOfEntries());
+         delete result;
+      }//end for
+   }//end for
+   return measures;
+}//end RunQueries
+
+//---------------------------------------------------------------------------
+string JsonMeasures(u_int32_t pageSize, size_t dim, const char * type,
+      const char * parameter, double value, const tOptions & opt,
+      const tMeasures & measures){
+   ostringstream out;
+
+   out.precision(10);
+   out << "    {\"page_size\": " << pageSize << ", \"dimension\": " << dim
+       << ", \"query\": \"" << type << "\", \"" << parameter << "\": " << value
+       << ", \"weighted\": " << (opt.Weighted ? "true" : "false")
+       << ", \"samples\": " << measures.Latency.size()
+       << ",\n     \"latency_us\": " << JsonSummary(measures.Latency)
+       << ",\n     \"distance_calculations\": " << JsonSummary(measures.Distances)
+       << ",\n     \"disk_accesses\": " << JsonSummary(measures.DiskAccesses)
+       << ",\n     \"cache_misses\": " << JsonSummary(measures.CacheMisses)
+       << ",\n     \"results\": " << JsonSummary(measures.Results) << "}";
+   return out.str();
+}//end JsonMeasures
+
+//---------------------------------------------------------------------------
+void Usage(const char * name){
+
+   cerr << "Usage: " << name << " [-d data] [-q queries] [-o output.json]"
+        << " [-s seed] [-n queries] [-r runs] [-p pageSizes] [-m dimensions]"
+        << " [-k ks] [-R radii] [-u]\n";
+}//end Usage
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[]){
+   tOptions opt;
+   CSVFeatureLoader::FeatureSet data;
+   CSVFeatureLoader::FeatureSet queryData;
+   vector<string> entries;
+   ofstream file;
+
+   opt.DataFile = CITYFILE;
+   opt.QueryFile = QUERYCITYFILE;
+   opt.Seed = 1;
+   opt.Queries = 0;
+   opt.Runs = 3;
+   opt.PageSizes = ParseList<u_int32_t>("1024,4096");
+   opt.Dimensions = ParseList<u_int32_t>("0");
+   opt.Ks = ParseList<u_int32_t>("1,5,15,50");
+   opt.Radii = ParseList<double>("1,5,10");
+   opt.Weighted = true;
+
+   try{
+      for (int i = 1; i < argc; i++){
+         string arg = argv[i];
+         if (arg == "-u"){
+            opt.Weighted = false;
+            continue;
+         }//end if
+         if ((arg.size() != 2) || (arg[0] != '-') || (i + 1 >= argc)){
+            Usage(argv[0]);
+            return 1;
+         }//end if
+         const char * value = argv[++i];
+         switch (arg[1]){
+            case 'd': opt.DataFile = value; break;
+            case 'q': opt.QueryFile = value; break;
+            case 'o': opt.OutputFile = value; break;
+            case 's': opt.Seed = stoul(value); break;
+            case 'n': opt.Queries = stoul(value); break;
+            case 'r': opt.Runs = stoul(value); break;
+            case 'p': opt.PageSizes = ParseList<u_int32_t>(value); break;
+            case 'm': opt.Dimensions = ParseList<u_int32_t>(value); break;
+            case 'k': opt.Ks = ParseList<u_int32_t>(value); break;
+            case 'R': opt.Radii = ParseList<double>(value); break;
+            default:
+               Usage(argv[0]);
+               return 1;
+         }//end switch
+      }//end for
+
+      ReadFeatures(opt.DataFile, data);
+      ReadFeatures(opt.QueryFile, queryData);
+      if ((data.Rows == 0) || (queryData.Rows == 0)){
+         throw std::logic_error("Empty data or query file.");
+      }//end if
+      if (queryData.Columns != data.Columns){
+         throw std::logic_error("The data and query files have different dimensions.");
+      }//end if
+      if ((opt.Queries == 0) || (opt.Queries > queryData.Rows)){
+         opt.Queries = queryData.Rows;
+      }//end if
+
+      for (size_t d = 0; d < opt.Dimensions.size(); d++){
+         size_t dim = opt.Dimensions[d];
+         if ((dim == 0) || (dim > data.Columns)){
+            dim = data.Columns;
+         }//end if
+         vector<TFlatImage *> objects = CreateObjects(data, dim, data.Rows);
+         vector<TFlatImage *> queries = CreateObjects(queryData, dim, opt.Queries);
+         double diameter = EstimateDiameter(objects);
+
+         // The same weights for every page size, k and radius.
+         std::mt19937 rng(opt.Seed);
+         std::uniform_real_distribution<double> uniform(0, 1);
+         vector<vector<double> > weights(queries.size());
+         for (size_t i = 0; i < queries.size(); i++){
+            for (size_t j = 0; j < dim; j++){
+               weights[i].push_back(uniform(rng));
+            }//end for
+         }//end for
+
+         for (size_t p = 0; p < opt.PageSizes.size(); p++){
+            u_int32_t pageSize = opt.PageSizes[p];
+            remove(BENCHFILE);
+            stPositionalDiskPageManager * diskPageManager =
+                  new stPositionalDiskPageManager(BENCHFILE, pageSize);
+            stCachedPageManager * pageManager =
+                  new stCachedPageManager(diskPageManager, CACHESIZE);
+            TApp::mySlimTree * tree = new TApp::mySlimTree(pageManager);
+
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < objects.size(); i += LOADBATCHSIZE){
+               u_int32_t n = min(objects.size() - i, (size_t) LOADBATCHSIZE);
+               tree->AddBatch(&objects[i], n);
+            }//end for
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+            ostringstream build;
+            build.precision(10);
+            build << "    {\"page_size\": " << pageSize << ", \"dimension\": " << dim
+                  << ", \"query\": \"build\", \"objects\": " << tree->GetNumberOfObjects()
+                  << ", \"height\": " << tree->GetHeight()
+                  << ", \"nodes\": " << tree->GetNodeCount()
+                  << ", \"time_us\": "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()
+                  << ", \"diameter\": " << diameter << "}";
+            entries.push_back(build.str());
+
+            for (size_t i = 0; i < opt.Ks.size(); i++){
+               tMeasures measures = RunQueries(tree, queries, weights,
+                     opt.Ks[i], 0, opt);
+               entries.push_back(JsonMeasures(pageSize, dim, "knn", "k",
+                     opt.Ks[i], opt, measures));
+            }//end for
+            for (size_t i = 0; i < opt.Radii.size(); i++){
+               double radius = (opt.Radii[i] * diameter) / 100;
+               tMeasures measures = RunQueries(tree, queries, weights,
+                     0, radius, opt);
+               entries.push_back(JsonMeasures(pageSize, dim, "range", "radius_percent",
+                     opt.Radii[i], opt, measures));
+            }//end for
+
+            delete tree;
+            delete pageManager;
+            delete diskPageManager;
+            remove(BENCHFILE);
+            cerr << "page size " << pageSize << ", dimension " << dim << ": done\n";
+         }//end for
+         DeleteObjects(objects);
+         DeleteObjects(queries);
+      }//end for
+   }catch (std::exception & e){
+      cerr << argv[0] << ": " << e.what() << "\n";
+      return 1;
+   }//end try
+
+   if (!opt.OutputFile.empty()){
+      file.open(opt.OutputFile.c_str());
+      if (!file){
+         cerr << argv[0] << ": could not write " << opt.OutputFile << "\n";
+         return 1;
+      }//end if
+   }//end if
+   ostream & out = opt.OutputFile.empty() ? cout : file;
+
+   out << "{\n  \"data\": " << JsonString(opt.DataFile)
+       << ",\n  \"queries\": " << JsonString(opt.QueryFile)
+       << ",\n  \"objects\": " << data.Rows
+       << ",\n  \"query_objects\": " << opt.Queries
+       << ",\n  \"seed\": " << opt.Seed
+       << ",\n  \"runs\": " << opt.Runs
+       << ",\n  \"results\": [\n";
+   for (size_t i = 0; i < entries.size(); i++){
+      out << entries[i] << ((i + 1 < entries.size()) ? ",\n" : "\n");
+   }//end for
+   out << "  ]\n}\n";
+   return 0;
+}//end main
@@ -0,0 +1,157 @@
+//---------------------------------------------------------------------------
+// boundcheck.cpp - Checks that the M-Tree queries use bounded distances
+//
+// Usage: boundcheck
+//
+// Random objects are added to an M-Tree whose evaluator is an
+// EuclideanDistance that counts its bounded distances, one by one or in
+// blocks. The answers of the
+// kNN and range queries are compared with those of a scan of all objects.
+// The exit status is 0 if every answer is right and the queries evaluated
+// bounded distances.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <arboretum/stMTree.h>
+#include "app.h"
+
+using namespace std;
+
+// Dimension of the objects.
+#define CHECKDIMENSION 16
+// Objects of the tree.
+#define CHECKOBJECTS 2000
+// Queries.
+#define CHECKQUERIES 50
+// Page size of the tree.
+#define CHECKPAGESIZE 4096
+// File of the tree.
+#define CHECKTREEFILE "BoundCheck.dat"
+
+//---------------------------------------------------------------------------
+/**
+* EuclideanDistance that counts the bounded distances. It also takes
+* pointers, as the M-Tree evaluates its full distances on pointers.
+*/
+class TCountingDistance: public EuclideanDistance<TFlatImage>{
+   public:
+      /**
+      * Number of bounded distances.
+      */
+      u_int64_t BoundedCount;
+
+      TCountingDistance(){
+         BoundedCount = 0;
+      }//end TCountingDistance
+
+      using EuclideanDistance<TFlatImage>::GetDistance;
+
+      double GetDistance(TFlatImage * obj1, TFlatImage * obj2){
+         return GetDistance(*obj1, *obj2);
+      }//end GetDistance
+
+      double getDistance(TFlatImage & obj1, TFlatImage & obj2) throw (std::length_error){
+         return EuclideanDistance<TFlatImage>::getDistance(obj1, obj2);
+      }//end getDistance
+
+      double getDistance(TFlatImage & obj1, TFlatImage & obj2, double bound) throw (std::length_error){
+         BoundedCount++;
+         return EuclideanDistance<TFlatImage>::getDistance(obj1, obj2, bound);
+      }//end getDistance
+
+      void getDistances(TFlatImage & query, TFlatImage ** objects, size_t n,
+            double * distances, double bound) throw (std::length_error){
+         BoundedCount += n;
+         EuclideanDistance<TFlatImage>::getDistances(query, objects, n, distances, bound);
+      }//end getDistances
+};//end TCountingDistance
+
+typedef stMTree < TFlatImage, TCountingDistance > myMTree;
+
+//---------------------------------------------------------------------------
+/**
+* Returns the sorted distances of the answer of a query.
+*/
+vector<double> GetDistances(TApp::myResult * result){
+   vector<double> distances;
+
+   for (u_int32_t i = 0; i < result->GetNumOfEntries(); i++){
+      distances.push_back(result->GetPair(i)->GetDistance());
+   }//end for
+   sort(distances.begin(), distances.end());
+   return distances;
+}//end GetDistances
+
+//---------------------------------------------------------------------------
+/**
+* Returns a random object.
+*/
+TFlatImage * NewObject(std::mt19937 & rng, string name){
+   std::uniform_real_distribution<double> uniform(0, 1);
+   vector<double> features;
+
+   for (u_int32_t j = 0; j < CHECKDIMENSION; j++){
+      features.push_back(uniform(rng));
+   }//end for
+   return new TFlatImage(name, features);
+}//end NewObject
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[]){
+   std::mt19937 rng(1);
+   vector<TFlatImage *> objects;
+   EuclideanDistance<TFlatImage> evaluator;
+   u_int32_t wrong = 0;
+   u_int64_t bounded;
+
+   remove(CHECKTREEFILE);
+   {
+      stPositionalDiskPageManager pageManager(CHECKTREEFILE, CHECKPAGESIZE);
+      myMTree tree(&pageManager);
+
+      for (u_int32_t i = 0; i < CHECKOBJECTS; i++){
+         objects.push_back(NewObject(rng, to_string(i)));
+         tree.Add(objects.back());
+      }//end for
+      tree.GetMetricEvaluator()->BoundedCount = 0;
+
+      for (u_int32_t i = 0; i < CHECKQUERIES; i++){
+         TFlatImage * query = NewObject(rng, "query");
+         vector<double> all;
+         for (size_t j = 0; j < objects.size(); j++){
+            all.push_back(evaluator.GetDistance(*query, *objects[j]));
+         }//end for
+         sort(all.begin(), all.end());
+
+         // kNN: the k smallest distances.
+         TApp::myResult * result = tree.NearestQuery(query, 5);
+         if (GetDistances(result) != vector<double>(all.begin(), all.begin() + 5)){
+            wrong++;
+         }//end if
+         delete result;
+
+         // Range: every distance up to the one of the median object.
+         double radius = all[all.size() / 2];
+         result = tree.RangeQuery(query, radius);
+         if (GetDistances(result) != vector<double>(all.begin(),
+               upper_bound(all.begin(), all.end(), radius))){
+            wrong++;
+         }//end if
+         delete result;
+         delete query;
+      }//end for
+      bounded = tree.GetMetricEvaluator()->BoundedCount;
+   }
+   remove(CHECKTREEFILE);
+
+   cout << "M-Tree: " << wrong << " wrong answers of " << 2 * CHECKQUERIES
+        << ", " << bounded << " bounded distances\n";
+   for (size_t i = 0; i < objects.size(); i++){
+      delete objects[i];
+   }//end for
+   return ((wrong == 0) && (bounded > 0)) ? 0 : 1;
+}//end main
@@ -0,0 +1,136 @@
+//---------------------------------------------------------------------------
+// bulkcheck.cpp - Checks the bulk loaded Slim-Trees against brute force
+//
+// Usage: bulkcheck
+//
+// Random objects are bulk loaded by BulkLoadMemory() and
+// BulkLoadMemoryParallel() into trees of a single leaf (the root), of two
+// levels and of many levels. The answers of the kNN and range queries of
+// each tree are compared with those of a scan of all objects. The exit
+// status is 0 if every answer is right.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include "app.h"
+
+using namespace std;
+
+// Dimension of the objects.
+#define CHECKDIMENSION 16
+// Queries of each tree.
+#define CHECKQUERIES 50
+// Page size of the trees.
+#define CHECKPAGESIZE 4096
+
+//---------------------------------------------------------------------------
+/**
+* Returns the sorted distances of the answer of a query.
+*/
+vector<double> GetDistances(TApp::myResult * result){
+   vector<double> distances;
+
+   for (u_int32_t i = 0; i < result->GetNumOfEntries(); i++){
+      distances.push_back(result->GetPair(i)->GetDistance());
+   }//end for
+   sort(distances.begin(), distances.end());
+   return distances;
+}//end GetDistances
+
+//---------------------------------------------------------------------------
+/**
+* Bulk loads the objects and returns the number of wrong answers of its
+* queries.
+*/
+u_int32_t CheckTree(vector<TFlatImage *> & objects, vector<TFlatImage *> & queries,
+      bool parallel){
+   stMemoryPageManager pageManager(CHECKPAGESIZE);
+   TApp::mySlimTree tree(&pageManager);
+   EuclideanDistanceWeighted<TFlatImage> evaluator;
+   u_int32_t objSize = 0;
+   u_int32_t wrong = 0;
+
+   for (size_t i = 0; i < objects.size(); i++){
+      objSize = max(objSize, (u_int32_t) objects[i]->GetSerializedSize());
+   }//end for
+   if (parallel){
+      tree.BulkLoadMemoryParallel(objects.data(), objects.size(), 1.0, objSize,
+            TApp::mySlimTree::bulkFIXED, 2);
+   }else{
+      tree.BulkLoadMemory(objects.data(), objects.size(), 1.0, objSize,
+            TApp::mySlimTree::bulkFIXED);
+   }//end if
+
+   for (size_t i = 0; i < queries.size(); i++){
+      vector<double> all;
+      for (size_t j = 0; j < objects.size(); j++){
+         all.push_back(evaluator.GetDistance(*queries[i], *objects[j]));
+      }//end for
+      sort(all.begin(), all.end());
+
+      // kNN: the k smallest distances.
+      u_int32_t k = min((size_t) 5, all.size());
+      TApp::myResult * result = tree.NearestQuery(queries[i], k);
+      if (GetDistances(result) != vector<double>(all.begin(), all.begin() + k)){
+         wrong++;
+      }//end if
+      delete result;
+
+      // Range: every distance up to the one of the median object.
+      double radius = all[all.size() / 2];
+      result = tree.RangeQuery(queries[i], radius);
+      if (GetDistances(result) != vector<double>(all.begin(),
+            upper_bound(all.begin(), all.end(), radius))){
+         wrong++;
+      }//end if
+      delete result;
+   }//end for
+   return wrong;
+}//end CheckTree
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[]){
+   std::mt19937 rng(1);
+   std::uniform_real_distribution<double> uniform(0, 1);
+   vector<TFlatImage *> queries;
+   u_int32_t sizes[] = {1, 2, 12, 100, 2000};
+   u_int32_t failures = 0;
+
+   for (u_int32_t i = 0; i < CHECKQUERIES; i++){
+      vector<double> features;
+      for (u_int32_t j = 0; j < CHECKDIMENSION; j++){
+         features.push_back(uniform(rng));
+      }//end for
+      queries.push_back(new TFlatImage("query", features));
+   }//end for
+
+   for (u_int32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+      vector<TFlatImage *> objects;
+      for (u_int32_t i = 0; i < sizes[s]; i++){
+         vector<double> features;
+         for (u_int32_t j = 0; j < CHECKDIMENSION; j++){
+            features.push_back(uniform(rng));
+         }//end for
+         objects.push_back(new TFlatImage(to_string(i), features));
+      }//end for
+
+      for (int parallel = 0; parallel < 2; parallel++){
+         u_int32_t wrong = CheckTree(objects, queries, parallel != 0);
+         cout << (parallel ? "BulkLoadMemoryParallel" : "BulkLoadMemory")
+              << ", " << sizes[s] << " objects: " << wrong << " wrong answers of "
+              << 2 * queries.size() << "\n";
+         failures += wrong;
+      }//end for
+
+      for (size_t i = 0; i < objects.size(); i++){
+         delete objects[i];
+      }//end for
+   }//end for
+
+   for (size_t i = 0; i < queries.size(); i++){
+      delete queries[i];
+   }//end for
+   return (failures == 0) ? 0 : 1;
+}//end main
@@ -0,0 +1,148 @@
+//---------------------------------------------------------------------------
+// compactimage.cpp - Implementation of the User Layer
+//
+// In this file we have the implementation of TCompactImage and an output
+// operator for TCompactImage (which is not required by user layer).
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#pragma hdrstop
+#include "compactimage.h"
+#pragma package(smart_init)
+
+//---------------------------------------------------------------------------
+// Class TCompactImage
+//---------------------------------------------------------------------------
+TCompactImage::TCompactImage(u_int32_t row, const double * features,
+                             FeatureCodec & codec){
+   size_t n = codec.GetDimension();
+   size_t used = HeaderSize + codec.GetCodeSize();
+   size_t size = GetSize(codec.GetType(), n);
+   u_int16_t dim = n;
+   u_int8_t encoding = codec.GetType();
+
+   Buffer = NULL;
+   Capacity = 0;
+   Reserve(size);
+   memset(Buffer, 0, HeaderSize);
+   memcpy(Buffer, &row, sizeof(row));
+   memcpy(Buffer + 4, &dim, sizeof(dim));
+   memcpy(Buffer + 6, &encoding, sizeof(encoding));
+   codec.Encode(features, Buffer + HeaderSize);
+   memset(Buffer + used, 0, size - used);
+   Bind(Buffer, size);
+   Decode(codec);
+}//end TCompactImage::TCompactImage
+
+//---------------------------------------------------------------------------
+void TCompactImage::Unserialize(const uint8_t * data, size_t datasize){
+
+   Reserve(datasize);
+   memcpy(Buffer, data, datasize);
+   Bind(Buffer, datasize);
+}//end TCompactImage::Unserialize
+
+//---------------------------------------------------------------------------
+void TCompactImage::UnserializeView(const uint8_t * data, size_t datasize){
+
+   // Bind() copies whatever can not be read in place.
+   Bind(data, datasize);
+}//end TCompactImage::UnserializeView
+
+//---------------------------------------------------------------------------
+void TCompactImage::Reserve(size_t size){
+
+   if (size > Capacity){
+      free(Buffer);
+      Buffer = (uint8_t *) malloc(size);
+      if (Buffer == NULL){
+         Capacity = 0;
+         throw std::bad_alloc();
+      }//end if
+      Capacity = size;
+   }//end if
+}//end TCompactImage::Reserve
+
+//---------------------------------------------------------------------------
+void TCompactImage::Set(u_int32_t row, FeatureCodec::Encoding encoding,
+                        const uint8_t * codes, size_t n){
+   size_t used = HeaderSize + FeatureCodec::GetElementSize(encoding) * n;
+   size_t size = GetSize(encoding, n);
+   u_int16_t dim = n;
+   u_int8_t type = encoding;
+
+   Reserve(size);
+   memset(Buffer, 0, HeaderSize);
+   memcpy(Buffer, &row, sizeof(row));
+   memcpy(Buffer + 4, &dim, sizeof(dim));
+   memcpy(Buffer + 6, &type, sizeof(type));
+   if (n > 0){
+      memcpy(Buffer + HeaderSize, codes, used - HeaderSize);
+   }//end if
+   memset(Buffer + used, 0, size - used);
+   Bind(Buffer, size);
+}//end TCompactImage::Set
+
+//---------------------------------------------------------------------------
+void TCompactImage::Bind(const uint8_t * data, size_t datasize){
+   const uint8_t * codes = data + HeaderSize;
+   u_int16_t dim;
+   u_int8_t type;
+
+   memcpy(&Row, data, sizeof(Row));
+   memcpy(&dim, data + 4, sizeof(dim));
+   memcpy(&type, data + 6, sizeof(type));
+   Serialized = data;
+   Size = datasize;
+   Dim = dim;
+   Encoding = (FeatureCodec::Encoding) type;
+
+   if ((Encoding == FeatureCodec::FLOAT64) &&
+         (((uintptr_t) codes % sizeof(double)) == 0)){
+      Features = (const double *) codes;
+      return;
+   }//end if
+   if (Encoding == FeatureCodec::INT8){
+      // Decoded by Decode().
+      Features = NULL;
+      return;
+   }//end if
+   Decoded.resize(Dim);
+   if (Encoding == FeatureCodec::FLOAT32){
+      for (size_t i = 0; i < Dim; i++){
+         float value;
+         memcpy(&value, codes + (i * sizeof(float)), sizeof(float));
+         Decoded[i] = value;
+      }//end for
+   }else{
+      memcpy(Decoded.data(), codes, Dim * sizeof(double));
+   }//end if
+   Features = Decoded.data();
+}//end TCompactImage::Bind
+
+//---------------------------------------------------------------------------
+void TCompactImage::Decode(const FeatureCodec & codec){
+
+   if (Features != NULL){
+      return;
+   }//end if
+   if ((codec.GetType() != FeatureCodec::INT8) || (codec.GetDimension() != Dim)){
+      throw length_error("TCompactImage: the codec does not fit the int8 codes.");
+   }//end if
+   Decoded.resize(Dim);
+   codec.Decode(Serialized + HeaderSize, Decoded.data());
+   Features = Decoded.data();
+}//end TCompactImage::Decode
+
+//---------------------------------------------------------------------------
+// Output operator
+//---------------------------------------------------------------------------
+/**
+* This operator will write a string representation of an image to an
+* outputstream.
+*/
+ostream & operator << (ostream & out, TCompactImage & image){
+
+   out << "[row=" << image.GetRow() << "]";
+   return out;
+}//end operator <<
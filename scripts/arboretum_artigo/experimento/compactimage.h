@@ -0,0 +1,309 @@
+//---------------------------------------------------------------------------
+// compactimage.h - Implementation of the User Layer
+//
+// TCompactImage is the object of the compact trees of TCompactIndex. It keeps
+// the features of an image encoded by a FeatureCodec (as float32 values or as
+// int8 codes) and the row of the image in the side store that holds the full
+// precision features. The name is not stored: it is read from the side store
+// too. A compact object is much smaller than a TFlatImage, so many more of
+// them fit in a node page.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#ifndef compactimageH
+#define compactimageH
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <ostream>
+#include <vector>
+#include <sys/types.h>
+
+#include <util/FeatureCodec.h>
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Class TCompactImage
+//---------------------------------------------------------------------------
+/**
+* This class abstracts an image described by an encoded feature vector.
+*
+* <P>It implements the stObject interface, as TFlatImage does. The
+* serialized layout is:<BR>
+* <CODE>
+* +-----------+-----------+----------+----------+---------------+---------+<BR>
+* | u_int32_t | u_int16_t | u_int8_t | u_int8_t | Codes[]       | Padding |<BR>
+* | Row       | Dim       | Encoding | Reserved |               |         |<BR>
+* +-----------+-----------+----------+----------+---------------+---------+<BR>
+* </CODE>
+*
+* <P>Codes holds Dim values of the given encoding (see FeatureCodec) and is
+* padded with zeros up to a multiple of 8 bytes. data() returns the decoded
+* features, so the distance functions of TFlatImage work unchanged: they see
+* the image as its decoded version.
+*
+* <P>The int8 codes are decoded by Decode(), with the codec that encoded
+* them, which is kept by the index of the image (see TCompactDistance).
+* Until then data() is not available. The float32 and float64 encodings
+* need no codec. Query objects use the float64 encoding, which is exact.
+*
+* @version 1.0
+*/
+class TCompactImage{
+   public:
+      /**
+      * Default constructor. It creates an image with no features.
+      * This constructor is required by stObject interface.
+      */
+      TCompactImage(){
+         Buffer = NULL;
+         Capacity = 0;
+         Set(0, FeatureCodec::FLOAT64, NULL, 0);
+      }//end TCompactImage
+
+      /**
+      * Creates a new image with the exact (float64) encoding.
+      *
+      * @param row The row of the image in the side store.
+      * @param features The features.
+      * @param n Number of features.
+      */
+      TCompactImage(u_int32_t row, const double * features, size_t n){
+         Buffer = NULL;
+         Capacity = 0;
+         Set(row, FeatureCodec::FLOAT64, (const uint8_t *) features, n);
+      }//end TCompactImage
+
+      /**
+      * Creates a new image encoded by a codec. The error of the encoding is
+      * recorded by the codec.
+      *
+      * @param row The row of the image in the side store.
+      * @param features The features. There must be codec.GetDimension().
+      * @param codec The codec.
+      */
+      TCompactImage(u_int32_t row, const double * features, FeatureCodec & codec);
+
+      /**
+      * Destroys this instance and releases all associated resources.
+      */
+      ~TCompactImage(){
+         free(Buffer);
+      }//end ~TCompactImage
+
+      /**
+      * Returns the number of features.
+      */
+      size_t size(){
+         return Dim;
+      }//end size
+
+      /**
+      * Gets the decoded features as a contiguous span of size() doubles.
+      *
+      * @exception std::logic_error If the int8 codes were not decoded.
+      */
+      const double * data(){
+         if (Features == NULL){
+            throw logic_error("TCompactImage: the int8 codes were not decoded.");
+         }//end if
+         return Features;
+      }//end data
+
+      /**
+      * Returns true if data() is available, that is, unless the features
+      * are int8 codes not decoded yet.
+      */
+      bool IsDecoded(){
+         return Features != NULL;
+      }//end IsDecoded
+
+      /**
+      * Decodes the int8 codes, if not decoded yet, with the codec that
+      * encoded them. It does nothing for the other encodings.
+      *
+      * @param codec The codec.
+      * @exception std::length_error If the codec does not fit the codes.
+      */
+      void Decode(const FeatureCodec & codec);
+
+      /**
+      * Gets the row of the image in the side store.
+      */
+      u_int32_t GetRow(){
+         return Row;
+      }//end GetRow
+
+      /**
+      * Gets the encoding of the features.
+      */
+      FeatureCodec::Encoding GetEncoding(){
+         return Encoding;
+      }//end GetEncoding
+
+      // The following methods are required by the stObject interface.
+      /**
+      * Creates a perfect clone of this object. This method is required by
+      * stObject interface.
+      *
+      * @return A new instance of TCompactImage.
+      */
+      TCompactImage * Clone(){
+         TCompactImage * clone = new TCompactImage();
+         clone->Unserialize(Serialized, Size);
+         return clone;
+      }//end Clone
+
+      /**
+      * Checks to see if this object is equal to other, that is, if their
+      * decoded features are equal. Two sets of int8 codes of the same index
+      * are compared as codes, so they need not be decoded. This method is
+      * required by stObject interface.
+      *
+      * @param obj Another instance of TCompactImage.
+      * @return True if they are equal or false otherwise.
+      */
+      bool IsEqual(TCompactImage * obj){
+         if (Dim != obj->Dim){
+            return false;
+         }else if ((Encoding == FeatureCodec::INT8) &&
+               (obj->Encoding == FeatureCodec::INT8)){
+            return memcmp(Serialized + HeaderSize, obj->Serialized + HeaderSize,
+                          Dim) == 0;
+         }//end if
+         return memcmp(data(), obj->data(), Dim * sizeof(double)) == 0;
+      }//end IsEqual
+
+      /**
+      * Returns the size of the serialized version of this object in bytes.
+      * This method is required by stObject interface.
+      */
+      size_t GetSerializedSize(){
+         return Size;
+      }//end GetSerializedSize
+
+      /**
+      * Returns the serialized version of this object. No copy is made.
+      * This method is required by stObject interface.
+      */
+      const uint8_t * Serialize(){
+         return Serialized;
+      }//end Serialize
+
+      /**
+      * Rebuilds a serialized object. The bytes are copied into the internal
+      * buffer, which is reused when large enough.
+      * This method is required by stObject interface.
+      *
+      * @param data The serialized object.
+      * @param datasize The size of the serialized object in bytes.
+      */
+      void Unserialize(const uint8_t * data, size_t datasize);
+
+      /**
+      * Makes this instance a view of a serialized object. Only the decoded
+      * features are written (float64 codes aligned to a double are not even
+      * decoded), so the bytes must stay valid until the instance is
+      * reloaded or destroyed.
+      *
+      * @param data The serialized object.
+      * @param datasize The size of the serialized object in bytes.
+      */
+      void UnserializeView(const uint8_t * data, size_t datasize);
+
+   private:
+      /**
+      * Size of the fields before the codes.
+      */
+      static const size_t HeaderSize = 8;
+
+      /**
+      * Owned buffer with the serialized layout. It may be NULL.
+      */
+      uint8_t * Buffer;
+
+      /**
+      * Capacity of Buffer in bytes.
+      */
+      size_t Capacity;
+
+      /**
+      * The serialized object. It is Buffer or the viewed bytes.
+      */
+      const uint8_t * Serialized;
+
+      /**
+      * Size of Serialized in bytes.
+      */
+      size_t Size;
+
+      /**
+      * Row of the image in the side store.
+      */
+      u_int32_t Row;
+
+      /**
+      * Encoding of the codes.
+      */
+      FeatureCodec::Encoding Encoding;
+
+      /**
+      * Number of features.
+      */
+      size_t Dim;
+
+      /**
+      * Decoded features. It points to Decoded or to the float64 codes, or
+      * is NULL for int8 codes not decoded yet.
+      */
+      const double * Features;
+
+      /**
+      * Buffer of the decoded features.
+      */
+      vector<double> Decoded;
+
+      /**
+      * Makes sure Buffer has at least size bytes.
+      */
+      void Reserve(size_t size);
+
+      /**
+      * Fills the internal buffer with the given codes.
+      */
+      void Set(u_int32_t row, FeatureCodec::Encoding encoding,
+               const uint8_t * codes, size_t n);
+
+      /**
+      * Points the fields to the given serialized bytes and decodes them,
+      * unless they are int8 codes.
+      */
+      void Bind(const uint8_t * data, size_t datasize);
+
+      /**
+      * Returns the size of a serialized object.
+      */
+      static size_t GetSize(FeatureCodec::Encoding encoding, size_t n){
+         size_t used = HeaderSize + FeatureCodec::GetElementSize(encoding) * n;
+         return (used + 7) & ~((size_t) 7);
+      }//end GetSize
+
+      // Copies are not allowed. Use Clone().
+      TCompactImage(const TCompactImage &);
+      TCompactImage & operator = (const TCompactImage &);
+};//end TCompactImage
+
+//---------------------------------------------------------------------------
+// Output operator
+//---------------------------------------------------------------------------
+/**
+* This operator will write a string representation of an image to an
+* outputstream.
+*/
+ostream & operator << (ostream & out, TCompactImage & image);
+
+#endif //end compactimageH
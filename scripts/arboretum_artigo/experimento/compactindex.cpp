@@ -0,0 +1,221 @@
+//---------------------------------------------------------------------------
+// compactindex.cpp - Implementation of the application.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#pragma hdrstop
+#include "app.h"
+#pragma package(smart_init)
+
+//------------------------------------------------------------------------------
+// class TCompactIndex
+//------------------------------------------------------------------------------
+void TCompactIndex::Build(vector<TFlatImage *> & objects,
+                          FeatureCodec::Encoding encoding, vector<double> weights){
+   vector<const double *> rows(objects.size());
+   vector<TCompactImage *> images(objects.size());
+   size_t dim = objects.empty() ? 0 : objects[0]->size();
+
+   delete Tree;
+   Tree = NULL;
+   Objects = objects;
+   for (size_t i = 0; i < objects.size(); i++){
+      rows[i] = objects[i]->data();
+   }//end for
+   Codec.Train(encoding, rows.data(), rows.size(), dim);
+
+   Tree = new myCompactTree(PageManager);
+   Tree->GetMetricEvaluator()->SetCodec(&Codec);
+   if (weights.empty()){
+      weights.assign(dim, 1);
+   }//end if
+   if (dim > 0){
+      Tree->GetMetricEvaluator()->SetWeights(weights);
+      Evaluator.SetWeights(weights);
+   }//end if
+   for (size_t i = 0; i < objects.size(); i++){
+      images[i] = new TCompactImage(i, rows[i], Codec);
+   }//end for
+   if (!images.empty()){
+      Tree->AddBatch(images.data(), images.size());
+   }//end if
+   for (size_t i = 0; i < images.size(); i++){
+      delete images[i];
+   }//end for
+   Tree->GetMetricEvaluator()->SetBuildWeights(weights, dim);
+   Tree->SetDistortion(1, 1);
+   // Encoding errors are only known after all images are encoded.
+   SaveCodec(weights);
+   ResetStatistics();
+}//end TCompactIndex::Build
+
+//------------------------------------------------------------------------------
+void TCompactIndex::Open(vector<TFlatImage *> & objects){
+   vector<double> weights;
+
+   delete Tree;
+   Tree = NULL;
+   Objects = objects;
+   Tree = new myCompactTree(PageManager);
+   LoadCodec(weights);
+   Tree->GetMetricEvaluator()->SetCodec(&Codec);
+   if (!weights.empty()){
+      Tree->GetMetricEvaluator()->SetWeights(weights);
+      Tree->GetMetricEvaluator()->SetBuildWeights(weights, Codec.GetDimension());
+      Evaluator.SetWeights(weights);
+   }//end if
+   Tree->SetDistortion(1, 1);
+   ResetStatistics();
+}//end TCompactIndex::Open
+
+//------------------------------------------------------------------------------
+void TCompactIndex::SetWeights(vector<double> weights){
+   double lower, upper;
+
+   Evaluator.SetWeights(weights);
+   Tree->GetMetricEvaluator()->SetWeights(weights);
+   Tree->GetMetricEvaluator()->GetDistortion(lower, upper);
+   Tree->SetDistortion(lower, upper);
+}//end TCompactIndex::SetWeights
+
+//------------------------------------------------------------------------------
+double TCompactIndex::GetErrorBound(){
+
+   // The slack covers the rounding of the distances.
+   return Codec.GetErrorBound(Evaluator.GetWeights()) * (1 + 1e-12);
+}//end TCompactIndex::GetErrorBound
+
+//------------------------------------------------------------------------------
+void TCompactIndex::SaveCodec(vector<double> & weights){
+   tCodecInfo info;
+   vector<uint8_t> data;
+   stPage * page;
+   u_int32_t pageID = 0;
+   size_t capacity, start;
+
+   info.CodecSize = Codec.GetSerializedSize();
+   info.WeightCount = weights.size();
+   data.resize(info.CodecSize + weights.size() * sizeof(double));
+   Codec.Serialize(data.data());
+   memcpy(data.data() + info.CodecSize, weights.data(), weights.size() * sizeof(double));
+
+   // The pages are written from the last one, so each knows the next.
+   page = PageManager->GetNewPage();
+   capacity = page->GetPageSize() - sizeof(pageID);
+   for (size_t i = (data.size() + capacity - 1) / capacity; i > 0; i--){
+      if (page == NULL){
+         page = PageManager->GetNewPage();
+      }//end if
+      start = (i - 1) * capacity;
+      page->Clear();
+      memcpy(page->GetData(), &pageID, sizeof(pageID));
+      memcpy(page->GetData() + sizeof(pageID), data.data() + start,
+             min(capacity, data.size() - start));
+      PageManager->WritePage(page);
+      pageID = page->GetPageID();
+      PageManager->ReleasePage(page);
+      page = NULL;
+   }//end for
+   info.PageID = pageID;
+   if (!Tree->WriteUserData((unsigned char *) &info, sizeof(info))){
+      throw length_error("No room for the codec in the tree header.");
+   }//end if
+}//end TCompactIndex::SaveCodec
+
+//------------------------------------------------------------------------------
+void TCompactIndex::LoadCodec(vector<double> & weights){
+   tCodecInfo info;
+   vector<uint8_t> data;
+   stPage * page;
+   u_int32_t pageID;
+   size_t offset, size;
+
+   if ((!Tree->ReadUserData((unsigned char *) &info, sizeof(info))) ||
+         (info.PageID == 0)){
+      throw length_error("The tree has no codec.");
+   }//end if
+   data.resize(info.CodecSize + (size_t) info.WeightCount * sizeof(double));
+   pageID = info.PageID;
+   for (offset = 0; offset < data.size(); offset += size){
+      if (pageID == 0){
+         throw length_error("The codec pages are corrupted.");
+      }//end if
+      page = PageManager->GetPage(pageID);
+      size = min(page->GetPageSize() - sizeof(pageID), data.size() - offset);
+      memcpy(data.data() + offset, page->GetData() + sizeof(pageID), size);
+      memcpy(&pageID, page->GetData(), sizeof(pageID));
+      PageManager->ReleasePage(page);
+   }//end for
+   Codec.Unserialize(data.data(), info.CodecSize);
+   weights.resize(info.WeightCount);
+   memcpy(weights.data(), data.data() + info.CodecSize,
+          weights.size() * sizeof(double));
+}//end TCompactIndex::LoadCodec
+
+//------------------------------------------------------------------------------
+TCompactImage * TCompactIndex::GetQuery(TFlatImage * sample){
+
+   return new TCompactImage(0, sample->data(), sample->size());
+}//end TCompactIndex::GetQuery
+
+//------------------------------------------------------------------------------
+double TCompactIndex::Refine(TFlatImage * sample,
+                             myCompactTree::tResult * candidates, double range,
+                             myResult * result){
+   double max = 0;
+
+   for (u_int32_t i = 0; i < candidates->GetNumOfEntries(); i++){
+      TFlatImage * image = Objects[candidates->GetPair(i)->GetObject()->GetRow()];
+      double distance = Evaluator.GetDistance(*sample, *image);
+
+      RefineCount++;
+      if (distance > max){
+         max = distance;
+      }//end if
+      if ((result != NULL) && (distance <= range)){
+         result->AddPair(image->Clone(), distance);
+      }//end if
+   }//end for
+   return max;
+}//end TCompactIndex::Refine
+
+//------------------------------------------------------------------------------
+TCompactIndex::myResult * TCompactIndex::NearestQuery(TFlatImage * sample,
+                                                      u_int32_t k){
+   TCompactImage * query = GetQuery(sample);
+   myResult * result = new myResult();
+   myCompactTree::tResult * candidates;
+   double range = MAXDOUBLE;
+
+   result->SetQueryInfo(sample->Clone(), KNEARESTQUERY, k, -1.0, false);
+   candidates = Tree->NearestQuery(query, k);
+   if (candidates->GetNumOfEntries() >= k){
+      // The k candidates bound the k-th exact distance. An image closer than
+      // that has a decoded version closer than it plus the error bound.
+      range = Refine(sample, candidates, range, NULL);
+      delete candidates;
+      candidates = Tree->RangeQuery(query, (range + GetErrorBound()) * (1 + 1e-12));
+   }//end if
+   Refine(sample, candidates, range, result);
+   result->Cut(k);
+
+   delete candidates;
+   delete query;
+   return result;
+}//end TCompactIndex::NearestQuery
+
+//------------------------------------------------------------------------------
+TCompactIndex::myResult * TCompactIndex::RangeQuery(TFlatImage * sample,
+                                                    double range){
+   TCompactImage * query = GetQuery(sample);
+   myResult * result = new myResult();
+   myCompactTree::tResult * candidates;
+
+   result->SetQueryInfo(sample->Clone(), RANGEQUERY, 0, range, false);
+   candidates = Tree->RangeQuery(query, (range + GetErrorBound()) * (1 + 1e-12));
+   Refine(sample, candidates, range, result);
+
+   delete candidates;
+   delete query;
+   return result;
+}//end TCompactIndex::RangeQuery
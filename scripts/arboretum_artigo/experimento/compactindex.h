@@ -0,0 +1,342 @@
+//---------------------------------------------------------------------------
+// compactindex.h - Implementation of the application.
+//
+// TCompactIndex is a Slim-Tree of TCompactImage (features encoded as float32
+// or int8) over a side store of TFlatImage with the full precision features.
+// The tree prunes with the distances to the decoded features and the
+// candidates are ranked again with the exact features, so the answers are
+// the ones of a tree of TFlatImage with fewer, fuller pages.
+//
+// It is included by app.h, which sets the flags of the arboretum headers.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#ifndef compactindexH
+#define compactindexH
+
+#include <arboretum/stSlimTree.h>
+#include <hermes/EuclideanDistanceWeighted.h>
+#include <util/FeatureCodec.h>
+
+#include "flatimage.h"
+#include "compactimage.h"
+
+//---------------------------------------------------------------------------
+// class TCompactDistance
+//---------------------------------------------------------------------------
+/**
+* The metric evaluator of the trees of TCompactImage. It decodes the int8
+* codes of each image with the codec of its index before the weighted
+* Euclidean distance. Each tree has its own evaluator, so indexes with
+* different codecs may be queried at once, by any number of threads.
+*
+* @version 1.0
+*/
+class TCompactDistance : public EuclideanDistanceWeighted<TCompactImage>{
+   public:
+      /**
+      * Creates an evaluator without a codec. It can not evaluate int8 codes.
+      */
+      TCompactDistance(){
+         Codec = NULL;
+      }//end TCompactDistance
+
+      /**
+      * Sets the codec of the int8 codes. It is not owned by this evaluator.
+      */
+      void SetCodec(const FeatureCodec * codec){
+         Codec = codec;
+      }//end SetCodec
+
+      /**
+      * Gets the codec of the int8 codes.
+      */
+      const FeatureCodec * GetCodec(){
+         return Codec;
+      }//end GetCodec
+
+      // The distances of EuclideanDistanceWeighted over decoded images.
+      double getDistance(TCompactImage & obj1, TCompactImage & obj2) throw (std::length_error){
+         Decode(obj1);
+         Decode(obj2);
+         return EuclideanDistanceWeighted<TCompactImage>::getDistance(obj1, obj2);
+      }//end getDistance
+
+      double getDistance(TCompactImage & obj1, TCompactImage & obj2, double bound) throw (std::length_error){
+         Decode(obj1);
+         Decode(obj2);
+         return EuclideanDistanceWeighted<TCompactImage>::getDistance(obj1, obj2, bound);
+      }//end getDistance
+
+      void getDistances(TCompactImage & query, TCompactImage ** objects, size_t n,
+                        double * distances) throw (std::length_error){
+         Decode(query);
+         for (size_t i = 0; i < n; i++){
+            Decode(*objects[i]);
+         }//end for
+         EuclideanDistanceWeighted<TCompactImage>::getDistances(query, objects, n, distances);
+      }//end getDistances
+
+      void getDistances(TCompactImage & query, TCompactImage ** objects, size_t n,
+                        double * distances, double bound) throw (std::length_error){
+         Decode(query);
+         for (size_t i = 0; i < n; i++){
+            Decode(*objects[i]);
+         }//end for
+         EuclideanDistanceWeighted<TCompactImage>::getDistances(query, objects, n,
+                                                                distances, bound);
+      }//end getDistances
+
+   private:
+      /**
+      * The codec of the int8 codes or NULL.
+      */
+      const FeatureCodec * Codec;
+
+      /**
+      * Decodes the int8 codes of an image, if not decoded yet.
+      */
+      void Decode(TCompactImage & image) throw (std::length_error){
+         if (!image.IsDecoded()){
+            if (Codec == NULL){
+               throw std::length_error("TCompactDistance: no codec for the int8 codes.");
+            }//end if
+            image.Decode(*Codec);
+         }//end if
+      }//end Decode
+};//end TCompactDistance
+
+//---------------------------------------------------------------------------
+// class TCompactIndex
+//---------------------------------------------------------------------------
+/**
+* This class answers exact queries on a Slim-Tree of encoded images.
+*
+* <P>The tree indexes the decoded version x' of each image x, so it answers
+* exact queries over the decoded images. The codec bounds the distance
+* between x and x' by eps (see FeatureCodec::GetErrorBound()), so for any
+* query q, |d(q, x) - d(q, x')| <= eps. Hence:
+*     - A range query of radius r fetches the images with d(q, x') <= r + eps
+*       from the tree and keeps the ones with d(q, x) <= r.
+*     - A k-nearest neighbor query fetches the k nearest decoded images and
+*       takes the largest exact distance r among them. Then it runs the range
+*       query of radius r, whose k nearest images are the answer.
+*
+* <P>The exact distances read the features of the side store, given to
+* Build(), by the row kept in each TCompactImage. The results hold clones of
+* the images of the side store.
+*
+* <P>The codec belongs to the index: the evaluator of the tree (see
+* TCompactDistance) decodes the int8 codes with it. Build() stores the codec
+* and the build weights in pages of the tree, referenced by its user data,
+* and Open() reads them back.
+*
+* @version 1.0
+*/
+class TCompactIndex{
+   public:
+      /**
+      * This is the type used by the result.
+      */
+      typedef stResult < TFlatImage > myResult;
+
+      /**
+      * This is the type of the Slim-Tree of encoded images.
+      */
+      typedef stSlimTree < TCompactImage, TCompactDistance > myCompactTree;
+
+      /**
+      * Creates a new index. The tree is created by Build().
+      *
+      * @param pageManager The page manager of the tree. It is not deleted
+      * by this index.
+      */
+      TCompactIndex(stPageManager * pageManager){
+         PageManager = pageManager;
+         Tree = NULL;
+         RefineCount = 0;
+      }//end TCompactIndex
+
+      /**
+      * Disposes this index and its tree.
+      */
+      ~TCompactIndex(){
+         delete Tree;
+      }//end ~TCompactIndex
+
+      /**
+      * Encodes the images and builds the tree under the given weights,
+      * which become its build weights.
+      *
+      * @param objects The side store. It must outlive this index, since it
+      * is read by the queries.
+      * @param encoding The encoding of the features in the tree.
+      * @param weights The weights of the metric.
+      */
+      void Build(vector<TFlatImage *> & objects, FeatureCodec::Encoding encoding,
+                 vector<double> weights);
+
+      /**
+      * Opens the tree written by Build() in the page manager, with its codec
+      * and build weights.
+      *
+      * @param objects The side store given to Build().
+      * @exception std::length_error If the tree has no codec or the codec
+      * pages are corrupted.
+      */
+      void Open(vector<TFlatImage *> & objects);
+
+      /**
+      * Changes the weights of the metric. The tree is not rebuilt, as in
+      * TApp::ChangeWeightSlimTree().
+      *
+      * @param weights The new weights.
+      */
+      void SetWeights(vector<double> weights);
+
+      /**
+      * Performs an exact k-nearest neighbor query.
+      *
+      * @param sample The sample object.
+      * @param k The number of neighbors.
+      * @return The result. It must be deleted by the caller.
+      */
+      myResult * NearestQuery(TFlatImage * sample, u_int32_t k);
+
+      /**
+      * Performs an exact range query.
+      *
+      * @param sample The sample object.
+      * @param range The range of the results.
+      * @return The result. It must be deleted by the caller.
+      */
+      myResult * RangeQuery(TFlatImage * sample, double range);
+
+      /**
+      * Returns the bound of the distance between an image and its decoded
+      * version under the current weights.
+      */
+      double GetErrorBound();
+
+      /**
+      * Returns the tree, or NULL before Build().
+      */
+      myCompactTree * GetTree(){
+         return Tree;
+      }//end GetTree
+
+      /**
+      * Returns the codec of the images of the tree.
+      */
+      FeatureCodec & GetCodec(){
+         return Codec;
+      }//end GetCodec
+
+      /**
+      * Returns the metric evaluator of the exact distances.
+      */
+      EuclideanDistanceWeighted<TFlatImage> * GetMetricEvaluator(){
+         return &Evaluator;
+      }//end GetMetricEvaluator
+
+      /**
+      * Returns the number of images read from the side store by the queries.
+      */
+      u_int64_t GetRefineCount(){
+         return RefineCount;
+      }//end GetRefineCount
+
+      /**
+      * Resets the statistics of the queries.
+      */
+      void ResetStatistics(){
+         RefineCount = 0;
+      }//end ResetStatistics
+
+   private:
+      /**
+      * The page manager of the tree.
+      */
+      stPageManager * PageManager;
+
+      /**
+      * The tree of encoded images.
+      */
+      myCompactTree * Tree;
+
+      /**
+      * The codec of the images of the tree.
+      */
+      FeatureCodec Codec;
+
+      /**
+      * The side store.
+      */
+      vector<TFlatImage *> Objects;
+
+      /**
+      * The metric evaluator of the exact distances. It has the same weights
+      * as the one of the tree.
+      */
+      EuclideanDistanceWeighted<TFlatImage> Evaluator;
+
+      /**
+      * Number of images read from the side store.
+      */
+      u_int64_t RefineCount;
+
+      /**
+      * The user data of the tree: the pages that hold the codec and the
+      * build weights. Each page starts with the ID of the next one, or 0.
+      */
+      struct tCodecInfo{
+         /**
+         * The first page.
+         */
+         u_int32_t PageID;
+
+         /**
+         * Size in bytes of the parameters of the codec, which come first.
+         */
+         u_int32_t CodecSize;
+
+         /**
+         * Number of build weights, which follow the codec.
+         */
+         u_int32_t WeightCount;
+      };//end tCodecInfo
+
+      /**
+      * Writes the codec and the build weights in new pages of the tree.
+      *
+      * @param weights The build weights.
+      */
+      void SaveCodec(vector<double> & weights);
+
+      /**
+      * Reads the codec and the build weights written by SaveCodec().
+      *
+      * @param weights The build weights.
+      */
+      void LoadCodec(vector<double> & weights);
+
+      /**
+      * Encodes a sample with the exact encoding.
+      */
+      TCompactImage * GetQuery(TFlatImage * sample);
+
+      /**
+      * Adds to result the images of the candidates whose exact distance to
+      * the sample is not greater than range.
+      *
+      * @param sample The sample object.
+      * @param candidates A result of the tree.
+      * @param range The range.
+      * @param result The result.
+      * @return The largest exact distance of the candidates.
+      */
+      double Refine(TFlatImage * sample, myCompactTree::tResult * candidates,
+                    double range, myResult * result);
+};//end TCompactIndex
+
+#endif //end compactindexH
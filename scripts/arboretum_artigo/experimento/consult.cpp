@@ -26,7 +26,7 @@ int main(int argc, char* argv[]){
       break;;
    }
 
-   TImage * image = new TImage(name, features);
+   TFlatImage * image = new TFlatImage(name, features);
 
    app.KNNSearchImage(image);
    
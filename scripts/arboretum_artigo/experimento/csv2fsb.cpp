@@ -0,0 +1,42 @@
+//---------------------------------------------------------------------------
+// csv2fsb.cpp - Converts a CSV file of features to a FeatureSetFile
+//
+// Usage: csv2fsb <input.csv> <output.fsb> [float32]
+//
+// The CSV file has the features first and the name in the last column, as
+// the files read by TApp. The output is read by TApp::LoadTree() and
+// TApp::LoadVectorFromFile() in place of the CSV file.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <stdexcept>
+#include <string.h>
+#include <util/CSVFeatureLoader.h>
+#include <util/FeatureSetFile.h>
+
+using namespace std;
+
+int main(int argc, char* argv[]){
+   CSVFeatureLoader::FeatureSet data;
+   FeatureSetFile::DataType type = FeatureSetFile::FLOAT64;
+
+   if ((argc < 3) || (argc > 4) || ((argc == 4) && (strcmp(argv[3], "float32") != 0))){
+      cerr << "Usage: " << argv[0] << " <input.csv> <output.fsb> [float32]\n";
+      return 1;
+   }//end if
+   if (argc == 4){
+      type = FeatureSetFile::FLOAT32;
+   }//end if
+
+   try{
+      CSVFeatureLoader().Load(argv[1], data);
+      FeatureSetFile::Write(argv[2], data, type);
+   }catch (std::exception & e){
+      cerr << argv[0] << ": " << e.what() << "\n";
+      return 1;
+   }//end try
+   cout << "Wrote " << data.Rows << " objects with " << data.Columns
+        << " features to " << argv[2] << "\n";
+   return 0;
+}//end main
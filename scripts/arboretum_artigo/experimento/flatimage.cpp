@@ -0,0 +1,122 @@
+//---------------------------------------------------------------------------
+// flatimage.cpp - Implementation of the User Layer
+//
+// In this file we have the implementation of TFlatImage::Unserialize(),
+// TFlatImage::UnserializeView(), TFlatImage::SetView() and an output operator
+// for TFlatImage (which is not required by user layer).
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#pragma hdrstop
+#include "flatimage.h"
+#pragma package(smart_init)
+
+//---------------------------------------------------------------------------
+// Class TFlatImage
+//---------------------------------------------------------------------------
+/**
+* Serialized form of an image with no name and no features.
+*/
+static const size_t EmptyFlatImage[1] = {0};
+
+//---------------------------------------------------------------------------
+void TFlatImage::Unserialize(const uint8_t * data, size_t datasize){
+
+   Reserve(datasize);
+   memcpy(Buffer, data, datasize);
+   Bind(Buffer, datasize);
+}//end TFlatImage::Unserialize
+
+//---------------------------------------------------------------------------
+void TFlatImage::UnserializeView(const uint8_t * data, size_t datasize){
+
+   // Features must be read as doubles, so misaligned bytes are copied.
+   if (((uintptr_t)(data + sizeof(size_t)) % sizeof(double)) != 0){
+      Unserialize(data, datasize);
+   }else{
+      Bind(data, datasize);
+   }//end if
+}//end TFlatImage::UnserializeView
+
+//---------------------------------------------------------------------------
+void TFlatImage::SetView(const char * name, size_t nameLength,
+                         const double * features, size_t n){
+   size_t used;
+
+   used = sizeof(size_t) + (sizeof(double) * n) + nameLength;
+   // The serialized object is built by Serialize().
+   Serialized = NULL;
+   Size = (used + 7) & ~((size_t) 7);
+   Dim = n;
+   Features = features;
+   NameData = name;
+   NameLength = nameLength;
+}//end TFlatImage::SetView
+
+//---------------------------------------------------------------------------
+void TFlatImage::Clear(){
+
+   Bind((const uint8_t *) EmptyFlatImage, sizeof(size_t));
+}//end TFlatImage::Clear
+
+//---------------------------------------------------------------------------
+void TFlatImage::Reserve(size_t size){
+
+   if (size > Capacity){
+      free(Buffer);
+      Buffer = (uint8_t *) malloc(size);
+      if (Buffer == NULL){
+         Capacity = 0;
+         throw std::bad_alloc();
+      }//end if
+      Capacity = size;
+   }//end if
+}//end TFlatImage::Reserve
+
+//---------------------------------------------------------------------------
+void TFlatImage::Set(const char * name, size_t nameLength,
+                     const double * features, size_t n){
+   size_t used;
+   size_t size;
+
+   used = sizeof(size_t) + (sizeof(double) * n) + nameLength;
+   // Pad the name up to the next multiple of 8.
+   size = (used + 7) & ~((size_t) 7);
+
+   Reserve(size);
+   memcpy(Buffer, &n, sizeof(size_t));
+   memcpy(Buffer + sizeof(size_t), features, sizeof(double) * n);
+   memcpy(Buffer + sizeof(size_t) + (sizeof(double) * n), name, nameLength);
+   memset(Buffer + used, 0, size - used);
+   Bind(Buffer, size);
+}//end TFlatImage::Set
+
+//---------------------------------------------------------------------------
+void TFlatImage::Bind(const uint8_t * data, size_t datasize){
+   size_t n;
+
+   memcpy(&n, data, sizeof(size_t));
+   Serialized = data;
+   Size = datasize;
+   Dim = n;
+   Features = (const double *)(data + sizeof(size_t));
+   NameData = (const char *)(data + sizeof(size_t) + (sizeof(double) * n));
+   NameLength = datasize - sizeof(size_t) - (sizeof(double) * n);
+   // Drop the padding.
+   while ((NameLength > 0) && (NameData[NameLength - 1] == '\0')){
+      NameLength--;
+   }//end while
+}//end TFlatImage::Bind
+
+//---------------------------------------------------------------------------
+// Output operator
+//---------------------------------------------------------------------------
+/**
+* This operator will write a string representation of an image to an
+* outputstream.
+*/
+ostream & operator << (ostream & out, TFlatImage & image){
+
+   out << "[image=" << image.GetName() << "]";
+   return out;
+}//end operator <<
@@ -0,0 +1,310 @@
+//---------------------------------------------------------------------------
+// flatimage.h - Implementation of the User Layer
+//
+// TFlatImage is a TImage with flat storage. The features and the name live
+// in a single buffer that has exactly the layout of the serialized object,
+// so Serialize() is free and Unserialize() only copies bytes. It may also be
+// a view of bytes owned by someone else (a node page or a memory mapped
+// feature set file, for instance), in which case it does not copy anything
+// until it is serialized.
+//
+// Both classes share the same serialized layout, so a tree built with TImage
+// can be read with TFlatImage.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#ifndef flatimageH
+#define flatimageH
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <ostream>
+#include <vector>
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Class TFlatImage
+//---------------------------------------------------------------------------
+/**
+* This class abstracts an image described by a feature vector and a name.
+*
+* <P>It implements the stObject interface, as TImage does:
+*     - TFlatImage() - A default constructor.
+*     - Clone() - Creates a clone of this object.
+*     - IsEqual() - Checks if this instance is equal to another.
+*     - GetSerializedSize() - Gets the size of the serialized version of this object.
+*     - Serialize() - Gets the serialzied version of this object.
+*     - Unserialize() - Restores a serialzied object.
+*
+* <P>The data is kept in one buffer with the serialized layout:<BR>
+* <CODE>
+* +--------+--------------+--------+---------+<BR>
+* | size_t | double[size] | Name[] | Padding |<BR>
+* +--------+--------------+--------+---------+<BR>
+* </CODE>
+*
+* <P>The name is padded with up to 7 zero bytes so the serialized size is a
+* multiple of 8. Since node pages store objects back to back, this keeps the
+* features of every entry aligned to a double inside the page.
+*
+* <P>The buffer is reused by Unserialize(), so an instance that is reloaded
+* many times (like the temporary object of a query) allocates only when it
+* meets a larger object. UnserializeView() goes further and makes the instance
+* point to the given bytes; they must outlive the view. Bytes that are not
+* aligned to a double (objects written by TImage, for instance) are copied.
+* SetView() points the instance to a feature span and a name kept apart (as
+* in a FeatureSetFile); the serialized object is only built, in the internal
+* buffer, when Serialize() is called.
+*
+* @version 1.0
+*/
+class TFlatImage{
+   public:
+      /**
+      * Default constructor. It creates an image with no name and no features.
+      * This constructor is required by stObject interface.
+      */
+      TFlatImage(){
+         Buffer = NULL;
+         Capacity = 0;
+         Clear();
+      }//end TFlatImage
+
+      /**
+      * Creates a new image.
+      *
+      * @param name The name of the image.
+      * @param features The feature vector.
+      */
+      TFlatImage(const string name, vector<double> features){
+         Buffer = NULL;
+         Capacity = 0;
+         Set(name.c_str(), name.length(), features.data(), features.size());
+      }//end TFlatImage
+
+      /**
+      * Creates a new image from a feature span.
+      *
+      * @param name The name of the image.
+      * @param features The features.
+      * @param n Number of features.
+      */
+      TFlatImage(const string & name, const double * features, size_t n){
+         Buffer = NULL;
+         Capacity = 0;
+         Set(name.c_str(), name.length(), features, n);
+      }//end TFlatImage
+
+      /**
+      * Destroys this instance and releases all associated resources.
+      */
+      ~TFlatImage(){
+         free(Buffer);
+      }//end ~TFlatImage
+
+      /**
+      * Returns the number of features.
+      */
+      size_t size(){
+         return Dim;
+      }//end size
+
+      /**
+      * Gets the features as a contiguous span of size() doubles.
+      */
+      const double * data(){
+         return Features;
+      }//end data
+
+      /**
+      * Gets a copy of the features.
+      */
+      vector<double> GetFeatures(){
+         return vector<double>(Features, Features + Dim);
+      }//end GetFeatures
+
+      /**
+      * Gets the name of the image.
+      */
+      string GetName(){
+         return string(NameData, NameLength);
+      }//end GetName
+
+      /**
+      * Returns true if this instance points to bytes it does not own.
+      */
+      bool IsView(){
+         return (Serialized == NULL) || (Serialized != Buffer);
+      }//end IsView
+
+      // The following methods are required by the stObject interface.
+      /**
+      * Creates a perfect clone of this object. The clone always owns its data,
+      * even if this instance is a view. This method is required by stObject
+      * interface.
+      *
+      * @return A new instance of TFlatImage.
+      */
+      TFlatImage * Clone(){
+         TFlatImage * clone = new TFlatImage();
+         clone->Unserialize(Serialize(), GetSerializedSize());
+         return clone;
+      }//end Clone
+
+      /**
+      * Checks to see if this object is equal to other. This method is required
+      * by stObject interface.
+      *
+      * @param obj Another instance of TFlatImage.
+      * @return True if they are equal or false otherwise.
+      */
+      bool IsEqual(TFlatImage * obj){
+         if (Dim != obj->Dim){
+            return false;
+         }//end if
+         for (size_t x = 0; x < Dim; x++){
+            if (Features[x] != obj->Features[x]){
+               return false;
+            }//end if
+         }//end for
+         return true;
+      }//end IsEqual
+
+      /**
+      * Returns the size of the serialized version of this object in bytes.
+      * This method is required by stObject interface.
+      */
+      size_t GetSerializedSize(){
+         return Size;
+      }//end GetSerializedSize
+
+      /**
+      * Returns the serialized version of this object. The returned pointer
+      * is the internal buffer (or the viewed bytes), so no copy is made,
+      * except for the first call after SetView(), which copies the features
+      * and the name into the internal buffer.
+      * This method is required by stObject interface.
+      */
+      const uint8_t * Serialize(){
+         if (Serialized == NULL){
+            Set(NameData, NameLength, Features, Dim);
+         }//end if
+         return Serialized;
+      }//end Serialize
+
+      /**
+      * Rebuilds a serialized object. The bytes are copied into the internal
+      * buffer, which is reused when large enough.
+      * This method is required by stObject interface.
+      *
+      * @param data The serialized object.
+      * @param datasize The size of the serialized object in bytes.
+      */
+      void Unserialize(const uint8_t * data, size_t datasize);
+
+      /**
+      * Makes this instance a view of a serialized object. Nothing is copied:
+      * the instance reads the given bytes until it is reloaded or destroyed,
+      * so they must stay valid meanwhile.
+      *
+      * @param data The serialized object.
+      * @param datasize The size of the serialized object in bytes.
+      */
+      void UnserializeView(const uint8_t * data, size_t datasize);
+
+      /**
+      * Makes this instance a view of a feature span and a name. Nothing is
+      * copied: they must stay valid until the instance is reloaded, destroyed
+      * or serialized (Serialize() makes the instance own a copy).
+      *
+      * @param name The name of the image. It needs no terminator.
+      * @param nameLength The length of the name.
+      * @param features The features. They must be aligned to a double.
+      * @param n Number of features.
+      */
+      void SetView(const char * name, size_t nameLength,
+                   const double * features, size_t n);
+
+   private:
+      /**
+      * Owned buffer with the serialized layout. It may be NULL.
+      */
+      uint8_t * Buffer;
+
+      /**
+      * Capacity of Buffer in bytes.
+      */
+      size_t Capacity;
+
+      /**
+      * The serialized object. It is Buffer or the viewed bytes, or NULL
+      * after SetView() until Serialize() is called.
+      */
+      const uint8_t * Serialized;
+
+      /**
+      * Size of Serialized in bytes.
+      */
+      size_t Size;
+
+      /**
+      * Features inside Serialized (or the features given to SetView()).
+      */
+      const double * Features;
+
+      /**
+      * Number of features.
+      */
+      size_t Dim;
+
+      /**
+      * Name inside Serialized (or the name given to SetView()). It has no
+      * terminator.
+      */
+      const char * NameData;
+
+      /**
+      * Length of the name.
+      */
+      size_t NameLength;
+
+      /**
+      * Makes this instance an empty image.
+      */
+      void Clear();
+
+      /**
+      * Makes sure Buffer has at least size bytes.
+      */
+      void Reserve(size_t size);
+
+      /**
+      * Fills the internal buffer.
+      */
+      void Set(const char * name, size_t nameLength, const double * features,
+               size_t n);
+
+      /**
+      * Points the fields to the given serialized bytes.
+      */
+      void Bind(const uint8_t * data, size_t datasize);
+
+      // Copies are not allowed. Use Clone().
+      TFlatImage(const TFlatImage &);
+      TFlatImage & operator = (const TFlatImage &);
+};//end TFlatImage
+
+//---------------------------------------------------------------------------
+// Output operator
+//---------------------------------------------------------------------------
+/**
+* This operator will write a string representation of an image to an
+* outputstream.
+*/
+ostream & operator << (ostream & out, TFlatImage & image);
+
+#endif //end flatimageH
@@ -135,6 +135,14 @@ class TImage{
          return Features;
       }
 
+      /**
+      * Gets the features as a contiguous span of size() doubles, without
+      * copying them.
+      */
+      const double * data(){
+         return Features.data();
+      }
+
       /**
       * Gets the name of the city.
       */
@@ -1,7 +1,7 @@
 #pragma hdrstop
 #include "app.h"
 #include <iostream>
-#include<util/CSVToVector.h>
+#include <util/CSVFeatureLoader.h>
 #include <opencv2/opencv.hpp>
 
 #pragma argsused
@@ -31,25 +31,13 @@ struct Data{
 };
 
 vector<Data> GetDatasetCSV(string filename){
-    CSVToVector * csvReader = new CSVToVector();
-    vector<vector<string>> data = csvReader->GetData(filename);
-    int nameColumn = data[0].size()-1;
-    vector<Data> dataset;
-    for(int i=0;i<data.size();i++)
+    CSVFeatureLoader::FeatureSet data;
+    CSVFeatureLoader().Load(filename, data);
+    vector<Data> dataset(data.Rows);
+    for(size_t i=0;i<data.Rows;i++)
     {   
-        string name = data[i][nameColumn];
-        
-        int id = i;
-        vector<double> features;
-        features.clear();
-        for(int j=0;j<data[i].size()-1;j++)
-        {
-            features.push_back(std::stod(data[i][j]));
-        }
-
-        Data data;
-        data.SetData(name, features);
-        dataset.push_back(data);
+        const double * features = data.GetFeatures(i);
+        dataset[i].SetData(data.GetName(i), vector<double>(features, features + data.Columns));
     }
     return dataset;
 }
@@ -59,12 +47,10 @@ double ffRand()
     return ((double)rand() / RAND_MAX);
 }
 
-void Workflow(TApp app, int percent, bool weighted, string type){
-    //CSVToVector * csvReader = new CSVToVector();
-    //vector<vector<string>> data = csvReader->GetData(QUERYCITYFILE);
-    vector<Data> dataset = GetDatasetCSV(CITYFILE);
-    vector<Data> queries = GetDatasetCSV(QUERYCITYFILE);
-
+// The files are parsed once by main(), so the time of a workflow is only the
+// time of its queries. See benchmark.cpp for latency percentiles.
+void Workflow(TApp & app, vector<Data> & dataset, vector<Data> & queries,
+              int percent, bool weighted, string type){
     int total = dataset.size();
     int qtd = (percent * total)/100;
 
@@ -72,14 +58,20 @@ void Workflow(TApp app, int percent, bool weighted, string type){
     double radius = (percent * maxDistance)/100;
 
 
+    // The queries run as one batch under one weight vector.
+    vector<TFlatImage *> images;
     for (int i = 0; i < 50; i++)
     {
-        TImage * image = new TImage(queries[i].GetName(), queries[i].GetFeature());
-        if(type == "KNN")
-            app.KNNSearch(image, qtd, weighted);
-        else if(type == "Range"){
-            app.RangeSearch(image, radius, weighted);
-        }
+        images.push_back(new TFlatImage(queries[i].GetName(), queries[i].GetFeature()));
+    }
+    if(type == "KNN")
+        app.KNNSearch(images, qtd, weighted);
+    else if(type == "Range"){
+        app.RangeSearch(images, radius, weighted);
+    }
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        delete images[i];
     }
 }
 
@@ -90,6 +82,8 @@ int main(int argc, char* argv[]){
     app.Init();
     // Run it.
     app.Run();
+    vector<Data> dataset = GetDatasetCSV(CITYFILE);
+    vector<Data> queries = GetDatasetCSV(QUERYCITYFILE);
     vector<double> times(20, 0);
     for(int x = 0; x < 10; x++){
         cout << "\n-" << x;
@@ -101,7 +95,7 @@ int main(int argc, char* argv[]){
             //cout << "\nPORCENTAGEM:" << 5*i;
             start = clock();
             //std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-            Workflow(app, i*5, true, "Range");
+            Workflow(app, dataset, queries, i*5, true, "Range");
             //std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
             end = clock();
 
@@ -0,0 +1,85 @@
+//---------------------------------------------------------------------------
+// queryserver.cpp - Query server daemon
+//
+// Usage: queryserver [options]
+//    -t <file>  Tree file. Default TREEFILE.
+//    -d <file>  Data file, CSV or FeatureSetFile, read only if the tree file
+//               does not exist. Default CITYFILE.
+//    -s <path>  Unix domain socket. Default QUERYSOCKET.
+//    -j <n>     Threads of the pool. Default SERVERTHREADS.
+//
+// The tree is opened (or built) once and served until SIGINT or SIGTERM.
+// See server.h for the protocol.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <stdexcept>
+#include <signal.h>
+#include "server.h"
+
+using namespace std;
+
+// Default socket of the server.
+#define QUERYSOCKET "/tmp/queryserver.sock"
+
+/**
+* The server stopped by the signals.
+*/
+static TServer * Server = NULL;
+
+//---------------------------------------------------------------------------
+void OnSignal(int sig){
+
+   if (Server != NULL){
+      Server->Stop();
+   }//end if
+}//end OnSignal
+
+//---------------------------------------------------------------------------
+void Usage(const char * name){
+
+   cerr << "Usage: " << name << " [-t tree] [-d data] [-s socket] [-j threads]\n";
+}//end Usage
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[]){
+   string treeFile = TREEFILE;
+   string dataFile = CITYFILE;
+   string socketFile = QUERYSOCKET;
+   u_int32_t nThreads = SERVERTHREADS;
+   TServer server;
+
+   for (int i = 1; i < argc; i++){
+      string arg = argv[i];
+      if ((arg.size() != 2) || (arg[0] != '-') || (i + 1 >= argc)){
+         Usage(argv[0]);
+         return 1;
+      }//end if
+      const char * value = argv[++i];
+      switch (arg[1]){
+         case 't': treeFile = value; break;
+         case 'd': dataFile = value; break;
+         case 's': socketFile = value; break;
+         case 'j': nThreads = stoul(value); break;
+         default:
+            Usage(argv[0]);
+            return 1;
+      }//end switch
+   }//end for
+
+   try{
+      server.Open(treeFile.c_str(), dataFile.c_str());
+      Server = &server;
+      signal(SIGINT, OnSignal);
+      signal(SIGTERM, OnSignal);
+      signal(SIGPIPE, SIG_IGN);
+      cerr << argv[0] << ": serving " << treeFile << " on " << socketFile << "\n";
+      server.Run(socketFile.c_str(), nThreads);
+   }catch (std::exception & e){
+      cerr << argv[0] << ": " << e.what() << "\n";
+      return 1;
+   }//end try
+   Server = NULL;
+   return 0;
+}//end main
@@ -0,0 +1,532 @@
+//---------------------------------------------------------------------------
+// server.cpp - Implementation of the query server.
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#pragma hdrstop
+#include "server.h"
+
+#include <stdexcept>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#pragma package(smart_init)
+
+//------------------------------------------------------------------------------
+/**
+* Appends a value to a frame.
+*/
+template <class T>
+static void Put(vector<unsigned char> & frame, T value){
+   size_t size = frame.size();
+
+   frame.resize(size + sizeof(T));
+   memcpy(frame.data() + size, &value, sizeof(T));
+}//end Put
+
+//------------------------------------------------------------------------------
+/**
+* Reads a value from a request and moves the offset past it.
+*
+* @exception std::logic_error If the request is too short.
+*/
+template <class T>
+static T Get(const vector<unsigned char> & request, size_t & offset){
+   T value;
+
+   if (offset + sizeof(T) > request.size()){
+      throw std::logic_error("Truncated request.");
+   }//end if
+   memcpy(&value, request.data() + offset, sizeof(T));
+   offset += sizeof(T);
+   return value;
+}//end Get
+
+//------------------------------------------------------------------------------
+// class TServer
+//------------------------------------------------------------------------------
+TServer::TServer(){
+   DiskPageManager = NULL;
+   PageManager = NULL;
+   SlimTree = NULL;
+   BuildDimension = 0;
+   Listener = -1;
+   Wake[0] = -1;
+   Wake[1] = -1;
+   Queued = 0;
+   Stopped = false;
+}//end TServer::TServer
+
+//------------------------------------------------------------------------------
+TServer::~TServer(){
+
+   for (size_t i = 0; i < Connections.size(); i++){
+      delete Connections[i]->Session;
+      delete Connections[i]->Tree;
+      close(Connections[i]->Socket);
+      delete Connections[i];
+   }//end for
+   if (Wake[0] >= 0){
+      close(Wake[0]);
+      close(Wake[1]);
+   }//end if
+   delete SlimTree;
+   delete PageManager;
+   delete DiskPageManager;
+}//end TServer::~TServer
+
+//------------------------------------------------------------------------------
+void TServer::Open(const char * treeFile, const char * dataFile){
+   ifstream test(treeFile);
+   bool exists = test.good();
+   u_int32_t n = 0;
+
+   test.close();
+   if (exists){
+      DiskPageManager = new stPositionalDiskPageManager(treeFile);
+   }else{
+      DiskPageManager = new stPositionalDiskPageManager(treeFile, 256*4);
+   }//end if
+   PageManager = new stCachedPageManager(DiskPageManager, CACHESIZE);
+   SlimTree = new TApp::mySlimTree(PageManager);
+
+   if (SlimTree->GetNumberOfObjects() == 0){
+      vector<TFlatImage *> objects;
+
+      TApp::ReadObjects((char *) dataFile, objects);
+      if (objects.empty()){
+         throw std::logic_error("No objects to build the tree.");
+      }//end if
+      if ((PIVOTCOUNT > 0) && (objects.size() >= PIVOTCOUNT)){
+         SlimTree->FindPivots(objects.data(),
+               std::min(objects.size(), (size_t) PIVOTSAMPLESIZE), PIVOTCOUNT);
+      }//end if
+      for (size_t i = 0; i < objects.size(); i += LOADBATCHSIZE){
+         SlimTree->AddBatch(&objects[i],
+               std::min(objects.size() - i, (size_t) LOADBATCHSIZE));
+      }//end for
+
+      // The build weights are stored as TApp::SaveBuildWeights() does.
+      BuildWeights.assign(objects[0]->size(), 1);
+      BuildDimension = objects[0]->size();
+      n = BuildWeights.size();
+      vector<unsigned char> data(sizeof(n) + n * sizeof(double) + sizeof(BuildDimension));
+      memcpy(data.data(), &n, sizeof(n));
+      memcpy(data.data() + sizeof(n), BuildWeights.data(), n * sizeof(double));
+      memcpy(data.data() + sizeof(n) + n * sizeof(double), &BuildDimension,
+            sizeof(BuildDimension));
+      if (!SlimTree->WriteUserData(data.data(), data.size())){
+         throw std::length_error("Too many weights to store in the tree header.");
+      }//end if
+      for (size_t i = 0; i < objects.size(); i++){
+         delete objects[i];
+      }//end for
+   }else if (SlimTree->GetUserDataSize() >= sizeof(n)){
+      // The build weights stored by TApp::SaveBuildWeights().
+      SlimTree->ReadUserData((unsigned char *) &n, sizeof(n));
+      if (sizeof(n) + n * sizeof(double) > SlimTree->GetUserDataSize()){
+         throw std::length_error("The build weights in the tree header are corrupted.");
+      }else if (n > 0){
+         vector<unsigned char> data(sizeof(n) + n * sizeof(double));
+         SlimTree->ReadUserData(data.data(), data.size());
+         BuildWeights.resize(n);
+         memcpy(BuildWeights.data(), data.data() + sizeof(n), n * sizeof(double));
+         if (data.size() + sizeof(BuildDimension) <= SlimTree->GetUserDataSize()){
+            // The number of features follows the weights. Older trees have
+            // none.
+            data.resize(data.size() + sizeof(BuildDimension));
+            SlimTree->ReadUserData(data.data(), data.size());
+            memcpy(&BuildDimension, data.data() + sizeof(n) + n * sizeof(double),
+                  sizeof(BuildDimension));
+            if (BuildDimension > n){
+               BuildDimension = 0;
+            }//end if
+         }//end if
+      }//end if
+   }//end if
+
+   // The trees of the connections read the header from the page manager.
+   SlimTree->Flush();
+}//end TServer::Open
+
+//------------------------------------------------------------------------------
+void TServer::Run(const char * socketFile, u_int32_t nThreads){
+   struct sockaddr_un address;
+   vector<struct pollfd> fds;
+   vector<tConnection *> polled;
+   bool reading;
+   char buffer[64];
+
+   if ((SlimTree == NULL) || (strlen(socketFile) >= sizeof(address.sun_path))){
+      throw std::runtime_error("No tree or invalid socket path.");
+   }//end if
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strcpy(address.sun_path, socketFile);
+   unlink(socketFile);
+   Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+   if ((Listener < 0) ||
+         (bind(Listener, (struct sockaddr *) &address, sizeof(address)) != 0) ||
+         (listen(Listener, SERVERMAXCONNECTIONS) != 0) || (pipe(Wake) != 0)){
+      throw std::runtime_error(string("Can not listen on ") + socketFile);
+   }//end if
+   fcntl(Wake[0], F_SETFL, O_NONBLOCK);
+   fcntl(Wake[1], F_SETFL, O_NONBLOCK);
+
+   if (nThreads == 0){
+      nThreads = std::thread::hardware_concurrency();
+      if (nThreads == 0){
+         nThreads = 1;
+      }//end if
+   }//end if
+   for (u_int32_t i = 0; i < nThreads; i++){
+      Threads.push_back(std::thread(&TServer::Work, this));
+   }//end for
+
+   while (!Stopped){
+      // Only the connections with room for more requests are read.
+      fds.clear();
+      polled.clear();
+      fds.push_back({Wake[0], POLLIN, 0});
+      if (Connections.size() < SERVERMAXCONNECTIONS){
+         fds.push_back({Listener, POLLIN, 0});
+      }//end if
+      {
+         std::lock_guard<std::mutex> lock(Mutex);
+         reading = Queued < SERVERQUEUESIZE;
+         for (size_t i = 0; i < Connections.size(); i++){
+            tConnection * conn = Connections[i];
+            if ((!conn->Closed) && reading &&
+                  (conn->Requests.size() < SERVERPIPELINE)){
+               fds.push_back({conn->Socket, POLLIN, 0});
+               polled.push_back(conn);
+            }//end if
+         }//end for
+      }
+      if (poll(fds.data(), fds.size(), -1) < 0){
+         if (errno == EINTR){
+            continue;
+         }//end if
+         break;
+      }//end if
+
+      if (fds[0].revents != 0){
+         while (read(Wake[0], buffer, sizeof(buffer)) > 0);
+      }//end if
+      if ((fds.size() > polled.size() + 1) && (fds[1].revents != 0)){
+         Accept();
+      }//end if
+      for (size_t i = 0; i < polled.size(); i++){
+         if (fds[fds.size() - polled.size() + i].revents != 0){
+            if (!Receive(polled[i])){
+               std::lock_guard<std::mutex> lock(Mutex);
+               polled[i]->Closed = true;
+            }//end if
+         }//end if
+      }//end for
+      Reap();
+   }//end while
+
+   // Stop the pool. The requests not answered yet are dropped.
+   {
+      std::lock_guard<std::mutex> lock(Mutex);
+      Stopped = true;
+   }
+   Changed.notify_all();
+   for (size_t i = 0; i < Threads.size(); i++){
+      Threads[i].join();
+   }//end for
+   Threads.clear();
+   close(Listener);
+   Listener = -1;
+   unlink(socketFile);
+}//end TServer::Run
+
+//------------------------------------------------------------------------------
+void TServer::Stop(){
+
+   Stopped = true;
+   Notify();
+}//end TServer::Stop
+
+//------------------------------------------------------------------------------
+void TServer::Notify(){
+   char c = 0;
+
+   if (Wake[1] >= 0){
+      // A full pipe already wakes the loop.
+      if (write(Wake[1], &c, 1) < 0){
+         return;
+      }//end if
+   }//end if
+}//end TServer::Notify
+
+//------------------------------------------------------------------------------
+void TServer::Accept(){
+   struct timeval timeout;
+   tConnection * conn;
+   int s;
+
+   s = accept(Listener, NULL, NULL);
+   if (s < 0){
+      return;
+   }//end if
+   timeout.tv_sec = SERVERSENDTIMEOUT;
+   timeout.tv_usec = 0;
+   setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+   conn = new tConnection();
+   conn->Socket = s;
+   conn->Busy = false;
+   conn->Closed = false;
+   conn->Tree = new TApp::mySlimTree(PageManager);
+   SetWeights(conn->Tree, vector<double>());
+   conn->Session = new TApp::myFeedbackSession(conn->Tree, FEEDBACKPOOLSIZE);
+   Connections.push_back(conn);
+}//end TServer::Accept
+
+//------------------------------------------------------------------------------
+bool TServer::Receive(tConnection * conn){
+   unsigned char buffer[16384];
+   ssize_t n;
+   u_int32_t size;
+   size_t offset = 0;
+   bool ready = false;
+
+   n = recv(conn->Socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+   if (n == 0){
+      return false;
+   }else if (n < 0){
+      return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+   }//end if
+   conn->Input.insert(conn->Input.end(), buffer, buffer + n);
+
+   // Split the complete frames.
+   std::lock_guard<std::mutex> lock(Mutex);
+   while (conn->Input.size() - offset >= sizeof(size)){
+      memcpy(&size, conn->Input.data() + offset, sizeof(size));
+      if ((size == 0) || (size > SERVERMAXFRAME)){
+         return false;
+      }//end if
+      if (conn->Input.size() - offset - sizeof(size) < size){
+         break;
+      }//end if
+      offset += sizeof(size);
+      conn->Requests.push_back(vector<unsigned char>(
+            conn->Input.begin() + offset, conn->Input.begin() + offset + size));
+      offset += size;
+      Queued++;
+      ready = true;
+   }//end while
+   conn->Input.erase(conn->Input.begin(), conn->Input.begin() + offset);
+
+   if (ready && (!conn->Busy)){
+      conn->Busy = true;
+      Ready.push_back(conn);
+      Changed.notify_one();
+   }//end if
+   return true;
+}//end TServer::Receive
+
+//------------------------------------------------------------------------------
+void TServer::Reap(){
+   vector<tConnection *> closed;
+   size_t i = 0;
+
+   {
+      std::lock_guard<std::mutex> lock(Mutex);
+      while (i < Connections.size()){
+         if (Connections[i]->Closed && (!Connections[i]->Busy)){
+            Queued -= Connections[i]->Requests.size();
+            closed.push_back(Connections[i]);
+            Connections[i] = Connections.back();
+            Connections.pop_back();
+         }else{
+            i++;
+         }//end if
+      }//end while
+   }
+   for (i = 0; i < closed.size(); i++){
+      delete closed[i]->Session;
+      delete closed[i]->Tree;
+      close(closed[i]->Socket);
+      delete closed[i];
+   }//end for
+}//end TServer::Reap
+
+//------------------------------------------------------------------------------
+void TServer::Work(){
+   vector<unsigned char> request;
+   vector<unsigned char> response;
+   vector<unsigned char> frame;
+   tConnection * conn;
+   u_int32_t size;
+
+   while (true){
+      {
+         std::unique_lock<std::mutex> lock(Mutex);
+         while ((!Stopped) && Ready.empty()){
+            Changed.wait(lock);
+         }//end while
+         if (Stopped){
+            return;
+         }//end if
+         conn = Ready.front();
+         Ready.pop_front();
+         request.swap(conn->Requests.front());
+         conn->Requests.pop_front();
+         Queued--;
+      }
+
+      response.clear();
+      Answer(conn, request, response);
+      size = response.size();
+      frame.resize(sizeof(size));
+      memcpy(frame.data(), &size, sizeof(size));
+      frame.insert(frame.end(), response.begin(), response.end());
+      bool sent = Send(conn->Socket, frame);
+
+      {
+         std::lock_guard<std::mutex> lock(Mutex);
+         if (!sent){
+            conn->Closed = true;
+         }//end if
+         if ((!conn->Closed) && (!conn->Requests.empty())){
+            Ready.push_back(conn);
+            Changed.notify_one();
+         }else{
+            conn->Busy = false;
+         }//end if
+      }
+      // There may be room to read more requests or a connection to dispose.
+      Notify();
+   }//end while
+}//end TServer::Work
+
+//------------------------------------------------------------------------------
+void TServer::Answer(tConnection * conn, const vector<unsigned char> & request,
+                     vector<unsigned char> & response){
+   TApp::myResult * result = NULL;
+   TFlatImage * sample = NULL;
+   size_t offset = 1;
+   u_int32_t k, n;
+   double radius;
+
+   try{
+      switch (request[0]){
+         case SRV_NEAREST:
+            k = Get<u_int32_t>(request, offset);
+            sample = ReadSample(request, offset);
+            result = conn->Tree->NearestQuery(sample, k);
+            break;
+         case SRV_RANGE:
+            radius = Get<double>(request, offset);
+            sample = ReadSample(request, offset);
+            result = conn->Tree->RangeQuery(sample, radius);
+            break;
+         case SRV_WEIGHTS:{
+            n = Get<u_int32_t>(request, offset);
+            if (offset + n * sizeof(double) != request.size()){
+               throw std::logic_error("Invalid weights.");
+            }//end if
+            vector<double> weights(n);
+            memcpy(weights.data(), request.data() + offset, n * sizeof(double));
+            SetWeights(conn->Tree, weights);
+            break;
+         }
+         case SRV_FEEDBACKSTART:
+            k = Get<u_int32_t>(request, offset);
+            sample = ReadSample(request, offset);
+            result = conn->Session->NearestQuery(sample, k);
+            break;
+         case SRV_FEEDBACKNEXT:
+            k = Get<u_int32_t>(request, offset);
+            result = conn->Session->NearestQuery(k);
+            break;
+         default:
+            throw std::logic_error("Unknown request.");
+      }//end switch
+   }catch (std::exception & e){
+      delete sample;
+      response.push_back(SRV_ERROR);
+      response.insert(response.end(), e.what(), e.what() + strlen(e.what()));
+      return;
+   }//end try
+
+   response.push_back(SRV_OK);
+   Put<u_int32_t>(response, (result != NULL) ? result->GetNumOfEntries() : 0);
+   if (result != NULL){
+      for (u_int32_t i = 0; i < result->GetNumOfEntries(); i++){
+         string name = result->GetPair(i)->GetObject()->GetName();
+         Put<double>(response, result->GetPair(i)->GetDistance());
+         Put<u_int32_t>(response, name.size());
+         response.insert(response.end(), name.begin(), name.end());
+      }//end for
+      delete result;
+   }//end if
+   delete sample;
+}//end TServer::Answer
+
+//------------------------------------------------------------------------------
+TFlatImage * TServer::ReadSample(const vector<unsigned char> & request,
+                                 size_t & offset){
+   u_int32_t n = Get<u_int32_t>(request, offset);
+
+   if ((offset + n * sizeof(double) != request.size()) || (n == 0) ||
+         ((BuildDimension != 0) && (n != BuildDimension)) ||
+         ((BuildDimension == 0) && (!BuildWeights.empty()) && (n != BuildWeights.size()))){
+      throw std::logic_error("Invalid query object.");
+   }//end if
+   vector<double> features(n);
+   memcpy(features.data(), request.data() + offset, n * sizeof(double));
+   offset += n * sizeof(double);
+   return new TFlatImage("", features);
+}//end TServer::ReadSample
+
+//------------------------------------------------------------------------------
+void TServer::SetWeights(TApp::mySlimTree * tree, vector<double> weights){
+   EuclideanDistanceWeighted<TFlatImage> * evaluator = tree->GetMetricEvaluator();
+   double lower, upper;
+
+   if (weights.empty()){
+      weights = BuildWeights;
+   }else if ((!BuildWeights.empty()) && (weights.size() != BuildWeights.size())){
+      throw std::logic_error("Invalid weights.");
+   }//end if
+   for (size_t i = 0; i < weights.size(); i++){
+      if (!(weights[i] >= 0)){
+         throw std::logic_error("Invalid weights.");
+      }//end if
+   }//end for
+   evaluator->SetBuildWeights(BuildWeights, BuildDimension);
+   if (weights.empty()){
+      // Unknown build weights: the tree keeps its metric.
+      tree->SetDistortion(1, 1);
+      return;
+   }//end if
+   evaluator->SetWeights(weights);
+   evaluator->GetDistortion(lower, upper);
+   tree->SetDistortion(lower, upper);
+}//end TServer::SetWeights
+
+//------------------------------------------------------------------------------
+bool TServer::Send(int socket, const vector<unsigned char> & frame){
+   size_t offset = 0;
+   ssize_t n;
+
+   while (offset < frame.size()){
+      n = send(socket, frame.data() + offset, frame.size() - offset, MSG_NOSIGNAL);
+      if (n < 0){
+         if (errno == EINTR){
+            continue;
+         }//end if
+         return false;
+      }//end if
+      offset += n;
+   }//end while
+   return true;
+}//end TServer::Send
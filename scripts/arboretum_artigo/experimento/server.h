@@ -0,0 +1,312 @@
+//---------------------------------------------------------------------------
+// server.h - Query server of the application.
+//
+// TServer answers the queries of many clients on a Slim-Tree opened once. The
+// clients connect to a Unix domain socket and send requests in the binary
+// framing below. Each connection has its own weights and its own relevance
+// feedback session, and its requests are answered in order by a pool of
+// threads.
+//
+// Every integer and double is sent in the byte order of the host, since both
+// ends run on the same machine. A frame is:
+//
+//    u_int32_t Size   - number of bytes after this field
+//    u_int8_t Type    - request type or response status
+//    payload          - Size - 1 bytes
+//
+// Requests (Type and payload):
+//    SRV_NEAREST        u_int32_t k, u_int32_t n, double features[n]
+//    SRV_RANGE          double radius, u_int32_t n, double features[n]
+//    SRV_WEIGHTS        u_int32_t n, double weights[n] (n = 0 restores the
+//                       build weights)
+//    SRV_FEEDBACKSTART  u_int32_t k, u_int32_t n, double features[n]
+//    SRV_FEEDBACKNEXT   u_int32_t k
+//
+// Responses (Type is the status):
+//    SRV_OK             u_int32_t count, then count times
+//                       double distance, u_int32_t length, char name[length]
+//                       (count is 0 for SRV_WEIGHTS)
+//    SRV_ERROR          char message[Size - 1]
+//
+// Copyright (c) 2003 GBDI-ICMC-USP
+//---------------------------------------------------------------------------
+#ifndef serverH
+#define serverH
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "app.h"
+
+// Threads of the pool; 0 uses the number of cores
+#define SERVERTHREADS 0
+// Connections served at once; others wait in the listen queue
+#define SERVERMAXCONNECTIONS 64
+// Requests of a connection read ahead of its answers
+#define SERVERPIPELINE 8
+// Requests read ahead by all connections
+#define SERVERQUEUESIZE 256
+// Largest frame accepted, in bytes
+#define SERVERMAXFRAME (1 << 20)
+// Seconds a client may take to read an answer before it is dropped
+#define SERVERSENDTIMEOUT 10
+
+/**
+* Types of the requests of TServer.
+*/
+enum tServerRequest{
+   SRV_NEAREST = 1,
+   SRV_RANGE = 2,
+   SRV_WEIGHTS = 3,
+   SRV_FEEDBACKSTART = 4,
+   SRV_FEEDBACKNEXT = 5
+};//end tServerRequest
+
+/**
+* Status of the responses of TServer.
+*/
+enum tServerStatus{
+   SRV_OK = 0,
+   SRV_ERROR = 1
+};//end tServerStatus
+
+//---------------------------------------------------------------------------
+// class TServer
+//---------------------------------------------------------------------------
+/**
+* This class serves queries on a Slim-Tree over a Unix domain socket.
+*
+* <P>The thread that calls Run() accepts the connections and reads their
+* requests. The pool threads answer them. Each connection owns a
+* TApp::mySlimTree opened over the page manager of the server, as the threads
+* of stSlimTreeQueryPool do, so its weights never affect other connections,
+* and a TApp::myFeedbackSession on that tree. A connection is served by one
+* thread at a time, so its answers keep the order of its requests.
+*
+* <P>Backpressure: a connection is not read while it has SERVERPIPELINE
+* requests waiting, no connection is read while SERVERQUEUESIZE requests are
+* waiting and no connection is accepted while SERVERMAXCONNECTIONS are open.
+* The clients then block on their own sockets. A client that does not read
+* its answers for SERVERSENDTIMEOUT seconds is dropped.
+*
+* @version 1.0
+*/
+class TServer{
+   public:
+      /**
+      * Creates a new server.
+      */
+      TServer();
+
+      /**
+      * Stops the threads and disposes the tree and the connections.
+      */
+      ~TServer();
+
+      /**
+      * Opens the tree stored in a file. If the file does not exist, the tree
+      * is built there from a data file first, as TApp::LoadTree() does.
+      *
+      * @param treeFile The file of the tree.
+      * @param dataFile A CSV file or a FeatureSetFile. It is only read if
+      * the tree must be built.
+      * @exception std::logic_error If the tree can not be built.
+      */
+      void Open(const char * treeFile, const char * dataFile);
+
+      /**
+      * Serves the clients until Stop() is called.
+      *
+      * @param socketFile The path of the socket. An old socket is removed.
+      * @param nThreads The number of threads of the pool. If 0, the number
+      * of cores is used.
+      * @exception std::runtime_error If the socket can not be created.
+      */
+      void Run(const char * socketFile, u_int32_t nThreads = SERVERTHREADS);
+
+      /**
+      * Makes Run() return. It may be called by a signal handler.
+      */
+      void Stop();
+
+   private:
+      /**
+      * A connection.
+      */
+      struct tConnection{
+         /**
+         * The socket.
+         */
+         int Socket;
+
+         /**
+         * The tree of this connection.
+         */
+         TApp::mySlimTree * Tree;
+
+         /**
+         * The relevance feedback session of this connection.
+         */
+         TApp::myFeedbackSession * Session;
+
+         /**
+         * Bytes read that do not form a frame yet.
+         */
+         vector<unsigned char> Input;
+
+         /**
+         * Requests waiting to be answered, without their Size field.
+         */
+         std::deque<vector<unsigned char> > Requests;
+
+         /**
+         * If true, a thread is answering a request of this connection.
+         */
+         bool Busy;
+
+         /**
+         * If true, the socket was closed by the client or failed.
+         */
+         bool Closed;
+      };//end tConnection
+
+      /**
+      * The file of the tree and its page managers.
+      */
+      stPositionalDiskPageManager * DiskPageManager;
+      stCachedPageManager * PageManager;
+
+      /**
+      * The tree. The connections open their own trees over PageManager.
+      */
+      TApp::mySlimTree * SlimTree;
+
+      /**
+      * The weights used to build the tree. It is empty if they are unknown.
+      */
+      vector<double> BuildWeights;
+
+      /**
+      * The number of features of the objects in the tree, 0 if it is unknown.
+      */
+      u_int32_t BuildDimension;
+
+      /**
+      * The listening socket.
+      */
+      int Listener;
+
+      /**
+      * Pipe that wakes the thread of Run().
+      */
+      int Wake[2];
+
+      /**
+      * The open connections. Only the thread of Run() changes it.
+      */
+      vector<tConnection *> Connections;
+
+      /**
+      * The pool threads.
+      */
+      vector<std::thread> Threads;
+
+      /**
+      * Guards the fields below and the Requests, Busy and Closed fields of
+      * the connections.
+      */
+      std::mutex Mutex;
+
+      /**
+      * Signals the pool threads that a connection is ready.
+      */
+      std::condition_variable Changed;
+
+      /**
+      * Connections with requests and no thread.
+      */
+      std::deque<tConnection *> Ready;
+
+      /**
+      * Number of requests waiting in all connections.
+      */
+      u_int32_t Queued;
+
+      /**
+      * If true, the threads must stop.
+      */
+      std::atomic<bool> Stopped;
+
+      /**
+      * Accepts a new connection.
+      */
+      void Accept();
+
+      /**
+      * Reads the bytes available in a connection and queues its complete
+      * frames.
+      *
+      * @param conn The connection.
+      * @return False if the connection must be closed.
+      */
+      bool Receive(tConnection * conn);
+
+      /**
+      * Disposes the closed connections that no thread is answering.
+      */
+      void Reap();
+
+      /**
+      * Main loop of a pool thread.
+      */
+      void Work();
+
+      /**
+      * Answers a request.
+      *
+      * @param conn The connection.
+      * @param request The request, without its Size field.
+      * @param response The response, without its Size field.
+      */
+      void Answer(tConnection * conn, const vector<unsigned char> & request,
+                  vector<unsigned char> & response);
+
+      /**
+      * Reads a query object from a request.
+      *
+      * @param request The request.
+      * @param offset Where the object starts. It is moved past it.
+      * @return The object. It must be deleted by the caller.
+      * @exception std::logic_error If the request is too short or the
+      * object has the wrong dimension.
+      */
+      TFlatImage * ReadSample(const vector<unsigned char> & request, size_t & offset);
+
+      /**
+      * Sets the weights of the tree of a connection.
+      *
+      * @param tree The tree.
+      * @param weights The weights. If empty, the build weights are used.
+      */
+      void SetWeights(TApp::mySlimTree * tree, vector<double> weights);
+
+      /**
+      * Writes a whole frame to a socket.
+      *
+      * @return False if the socket failed.
+      */
+      static bool Send(int socket, const vector<unsigned char> & frame);
+
+      /**
+      * Wakes the thread of Run().
+      */
+      void Notify();
+
+      // Copies are not allowed.
+      TServer(const TServer &);
+      TServer & operator = (const TServer &);
+};//end TServer
+
+#endif //end serverH